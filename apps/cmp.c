@@ -2156,9 +2156,9 @@ static int set_gennames(char *names, int type,
             n = a2i_GENERAL_NAME(NULL, NULL, NULL,
                                  type != GEN_DNS ? type : GEN_IPADD, names, 0);
         } else { /* try IP address first, then domain name */
-            (void)ERR_set_mark();
+            (void)ERR_suppress_start();
             n = a2i_GENERAL_NAME(NULL, NULL, NULL, GEN_IPADD, names, 0);
-            (void)ERR_pop_to_mark();
+            (void)ERR_suppress_end();
             if (n == NULL) {
                 n = a2i_GENERAL_NAME(NULL, NULL, NULL, GEN_DNS, names, 0);
             }
@@ -126,11 +126,16 @@ int main(int argc, char *argv[])
     char buf[1024];
     const char *prompt;
     ARGS arg;
-    int first, n, i, ret = 0;
+    int first, n, i, ret = 0, mem_acct = 0;
 
     arg.argv = NULL;
     arg.size = 0;
 
+    /* This has to come before anything is allocated */
+    p = getenv("OPENSSL_MEM_ACCOUNTING");
+    if (p != NULL)
+        mem_acct = CRYPTO_mem_acct_enable(atoi(p));
+
     /* Set up some of the environment. */
     default_config_file = make_config_name();
     bio_in = dup_bio_in(FORMAT_TEXT);
@@ -265,6 +270,8 @@ int main(int argc, char *argv[])
     if (CRYPTO_mem_leaks(bio_err) <= 0)
         ret = 1;
 #endif
+    if (mem_acct)
+        CRYPTO_mem_acct_report(bio_err);
     BIO_free(bio_err);
     EXIT(ret);
 }
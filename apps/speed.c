@@ -171,6 +171,7 @@ static int EVP_Update_loop(void *args);
 static int EVP_Update_loop_ccm(void *args);
 static int EVP_Update_loop_aead(void *args);
 static int EVP_Digest_loop(void *args);
+static int EVP_DigestMulti_loop(void *args);
 #ifndef OPENSSL_NO_RSA
 static int RSA_sign_loop(void *args);
 static int RSA_verify_loop(void *args);
@@ -305,11 +306,12 @@ const OPTIONS speed_options[] = {
     {"help", OPT_HELP, '-', "Display this summary"},
     {"evp", OPT_EVP, 's', "Use EVP-named cipher or digest"},
     {"decrypt", OPT_DECRYPT, '-',
-     "Time decryption instead of encryption (only EVP)"},
+     "Time decryption instead of encryption (only EVP, SM4 and ARIA)"},
     {"aead", OPT_AEAD, '-',
      "Benchmark EVP-named AEAD cipher in TLS-like sequence"},
     {"mb", OPT_MB, '-',
-     "Enable (tls1>=1) multi-block mode on EVP-named cipher"},
+     "Enable (tls1>=1) multi-block mode on EVP-named cipher,"
+     " or multi-buffer mode on EVP-named digest"},
     {"mr", OPT_MR, '-', "Produce machine readable output"},
 #ifndef NO_FORK
     {"multi", OPT_MULTI, 'p', "Run benchmarks in parallel"},
@@ -365,6 +367,10 @@ const OPTIONS speed_options[] = {
 #define D_IGE_256_AES   28
 #define D_GHASH         29
 #define D_RAND          30
+#define D_CBC_SM4       31
+#define D_CTR_SM4       32
+#define D_CTR_128_ARIA  33
+#define D_GCM_128_ARIA  34
 /* name of algorithms to test */
 static const char *names[] = {
     "md2", "mdc2", "md4", "md5", "hmac(md5)", "sha1", "rmd160", "rc4",
@@ -374,7 +380,7 @@ static const char *names[] = {
     "camellia-128 cbc", "camellia-192 cbc", "camellia-256 cbc",
     "evp", "sha256", "sha512", "whirlpool",
     "aes-128 ige", "aes-192 ige", "aes-256 ige", "ghash",
-    "rand"
+    "rand", "sm4 cbc", "sm4 ctr", "aria-128 ctr", "aria-128 gcm"
 };
 #define ALGOR_NUM       OSSL_NELEM(names)
 
@@ -442,6 +448,14 @@ static const OPT_PAIR doit_choices[] = {
     {"cast-cbc", D_CBC_CAST},
     {"cast", D_CBC_CAST},
     {"cast5", D_CBC_CAST},
+#endif
+#ifndef OPENSSL_NO_SM4
+    {"sm4-cbc", D_CBC_SM4},
+    {"sm4-ctr", D_CTR_SM4},
+#endif
+#ifndef OPENSSL_NO_ARIA
+    {"aria-128-ctr", D_CTR_128_ARIA},
+    {"aria-128-gcm", D_GCM_128_ARIA},
 #endif
     {"ghash", D_GHASH},
     {"rand", D_RAND}
@@ -1016,6 +1030,33 @@ static int EVP_Digest_loop(void *args)
     return count;
 }
 
+/* Number of buffers hashed per EVP_DigestMulti() call */
+#define MB_DIGEST_NUM 8
+
+static int EVP_DigestMulti_loop(void *args)
+{
+    loopargs_t *tempargs = *(loopargs_t **) args;
+    const unsigned char *data[MB_DIGEST_NUM];
+    size_t datalen[MB_DIGEST_NUM];
+    unsigned char mdbuf[MB_DIGEST_NUM][EVP_MAX_MD_SIZE];
+    unsigned char *md[MB_DIGEST_NUM];
+    int count, i;
+#ifndef SIGALRM
+    int nb_iter = save_count * 4 * lengths[0] / lengths[testnum];
+#endif
+
+    for (i = 0; i < MB_DIGEST_NUM; i++) {
+        data[i] = tempargs->buf;
+        datalen[i] = lengths[testnum];
+        md[i] = mdbuf[i];
+    }
+    for (count = 0; COND(nb_iter); count += MB_DIGEST_NUM) {
+        if (!EVP_DigestMulti(evp_md, data, datalen, md, MB_DIGEST_NUM))
+            return -1;
+    }
+    return count;
+}
+
 #ifndef OPENSSL_NO_RSA
 static long rsa_c[RSA_NUM][2];  /* # RSA iteration test */
 
@@ -1617,6 +1658,18 @@ int speed_main(int argc, char **argv)
             doit[D_CBC_128_AES] = doit[D_CBC_192_AES] = doit[D_CBC_256_AES] = 1;
             continue;
         }
+#ifndef OPENSSL_NO_SM4
+        if (strcmp(*argv, "sm4") == 0) {
+            doit[D_CBC_SM4] = doit[D_CTR_SM4] = 1;
+            continue;
+        }
+#endif
+#ifndef OPENSSL_NO_ARIA
+        if (strcmp(*argv, "aria") == 0) {
+            doit[D_CTR_128_ARIA] = doit[D_GCM_128_ARIA] = 1;
+            continue;
+        }
+#endif
 #ifndef OPENSSL_NO_CAMELLIA
         if (strcmp(*argv, "camellia") == 0) {
             doit[D_CBC_128_CML] = doit[D_CBC_192_CML] = doit[D_CBC_256_CML] = 1;
@@ -1660,11 +1713,11 @@ int speed_main(int argc, char **argv)
         }
     }
     if (multiblock) {
-        if (evp_cipher == NULL) {
+        if (evp_cipher == NULL && evp_md == NULL) {
             BIO_printf(bio_err,"-mb can be used only with a multi-block"
-                               " capable cipher\n");
+                               " capable cipher or a digest\n");
             goto end;
-        } else if (!(EVP_CIPHER_flags(evp_cipher) &
+        } else if (evp_cipher != NULL && !(EVP_CIPHER_flags(evp_cipher) &
                      EVP_CIPH_FLAG_TLS1_1_MULTIBLOCK)) {
             BIO_printf(bio_err, "%s is not a multi-block capable\n",
                        OBJ_nid2ln(EVP_CIPHER_nid(evp_cipher)));
@@ -1858,6 +1911,10 @@ int speed_main(int argc, char **argv)
     c[D_IGE_256_AES][0] = count;
     c[D_GHASH][0] = count;
     c[D_RAND][0] = count;
+    c[D_CBC_SM4][0] = count;
+    c[D_CTR_SM4][0] = count;
+    c[D_CTR_128_ARIA][0] = count;
+    c[D_GCM_128_ARIA][0] = count;
 
     for (i = 1; i < size_num; i++) {
         long l0, l1;
@@ -1898,6 +1955,10 @@ int speed_main(int argc, char **argv)
         c[D_IGE_128_AES][i] = c[D_IGE_128_AES][i - 1] * l0 / l1;
         c[D_IGE_192_AES][i] = c[D_IGE_192_AES][i - 1] * l0 / l1;
         c[D_IGE_256_AES][i] = c[D_IGE_256_AES][i - 1] * l0 / l1;
+        c[D_CBC_SM4][i] = c[D_CBC_SM4][i - 1] * l0 / l1;
+        c[D_CTR_SM4][i] = c[D_CTR_SM4][i - 1] * l0 / l1;
+        c[D_CTR_128_ARIA][i] = c[D_CTR_128_ARIA][i - 1] * l0 / l1;
+        c[D_GCM_128_ARIA][i] = c[D_GCM_128_ARIA][i - 1] * l0 / l1;
     }
 
 #  ifndef OPENSSL_NO_RSA
@@ -2498,6 +2559,52 @@ int speed_main(int argc, char **argv)
             print_result(D_RAND, testnum, count, d);
         }
     }
+#if !defined(OPENSSL_NO_SM4) || !defined(OPENSSL_NO_ARIA)
+    /*
+     * There are no public SM4 and ARIA APIs, so these go through EVP; see
+     * -decrypt
+     */
+    for (k = D_CBC_SM4; k <= D_GCM_128_ARIA; k++) {
+        const EVP_CIPHER *cipher = NULL;
+
+        if (!doit[k])
+            continue;
+        switch (k) {
+# ifndef OPENSSL_NO_SM4
+        case D_CBC_SM4:
+            cipher = EVP_sm4_cbc();
+            break;
+        case D_CTR_SM4:
+            cipher = EVP_sm4_ctr();
+            break;
+# endif
+# ifndef OPENSSL_NO_ARIA
+        case D_CTR_128_ARIA:
+            cipher = EVP_aria_128_ctr();
+            break;
+        case D_GCM_128_ARIA:
+            cipher = EVP_aria_128_gcm();
+            break;
+# endif
+        }
+        for (i = 0; i < loopargs_len; i++) {
+            loopargs[i].ctx = EVP_CIPHER_CTX_new();
+            EVP_CipherInit_ex(loopargs[i].ctx, cipher, NULL, key16, iv,
+                              decrypt ? 0 : 1);
+            EVP_CIPHER_CTX_set_padding(loopargs[i].ctx, 0);
+        }
+        for (testnum = 0; testnum < size_num; testnum++) {
+            print_message(names[k], c[k][testnum], lengths[testnum],
+                          seconds.sym);
+            Time_F(START);
+            count = run_benchmark(async_jobs, EVP_Update_loop, loopargs);
+            d = Time_F(STOP);
+            print_result(k, testnum, count, d);
+        }
+        for (i = 0; i < loopargs_len; i++)
+            EVP_CIPHER_CTX_free(loopargs[i].ctx);
+    }
+#endif
 
     if (doit[D_EVP]) {
         if (evp_cipher != NULL) {
@@ -2551,13 +2658,18 @@ int speed_main(int argc, char **argv)
                 print_result(D_EVP, testnum, count, d);
             }
         } else if (evp_md != NULL) {
+            int (*loopfunc)(void *args) = EVP_Digest_loop;
+
+            if (multiblock)
+                loopfunc = EVP_DigestMulti_loop;
+
             names[D_EVP] = OBJ_nid2ln(EVP_MD_type(evp_md));
 
             for (testnum = 0; testnum < size_num; testnum++) {
                 print_message(names[D_EVP], save_count, lengths[testnum],
                               seconds.sym);
                 Time_F(START);
-                count = run_benchmark(async_jobs, EVP_Digest_loop, loopargs);
+                count = run_benchmark(async_jobs, loopfunc, loopargs);
                 d = Time_F(STOP);
                 print_result(D_EVP, testnum, count, d);
             }
@@ -15,6 +15,7 @@
 #include <openssl/buffer.h>
 #include <openssl/err.h>
 #include "internal/numbers.h"
+#include "internal/asn1_int.h"
 #include "asn1_locl.h"
 
 
@@ -26,11 +27,27 @@
  */
 #define ASN1_MAX_CONSTRUCTED_NEST 30
 
+/*
+ * The context of a decode: the ASN1_TLC header cache along with the
+ * ASN1_D2I_* options.  Every ASN1_TLC the decoder hands to extern decoders
+ * and callbacks is the first member of one of these.
+ */
+typedef struct asn1_d2i_ctx_st {
+    ASN1_TLC tlc;
+    unsigned long flags;
+} ASN1_D2I_CTX;
+
 static int asn1_item_embed_d2i(ASN1_VALUE **pval, const unsigned char **in,
                                long len, const ASN1_ITEM *it,
                                int tag, int aclass, char opt, ASN1_TLC *ctx,
                                int depth);
 
+/*
+ * Whether to take the decoder's fast paths, only ever cleared by the tests
+ * and benchmark that compare them with the general code.
+ */
+static int asn1_d2i_fast_paths = 1;
+
 static int asn1_check_eoc(const unsigned char **in, long len);
 static int asn1_find_end(const unsigned char **in, long len, char inf);
 
@@ -94,6 +111,20 @@ unsigned long ASN1_tag2bit(int tag)
 #define asn1_tlc_clear(c)       if (c) (c)->valid = 0
 /* Version to avoid compiler warning about 'c' always non-NULL */
 #define asn1_tlc_clear_nc(c)    (c)->valid = 0
+/* Initialize an ASN1_D2I_CTX */
+#define asn1_d2i_ctx_init(c, fl) \
+        ((c)->tlc.valid = 0, (c)->flags = (fl))
+
+static int asn1_item_ex_d2i_int(ASN1_VALUE **pval, const unsigned char **in,
+                                long len, const ASN1_ITEM *it, int tag,
+                                int aclass, char opt, ASN1_TLC *ctx)
+{
+    int rv;
+    rv = asn1_item_embed_d2i(pval, in, len, it, tag, aclass, opt, ctx, 0);
+    if (rv <= 0)
+        ASN1_item_ex_free(pval, it);
+    return rv;
+}
 
 /*
  * Decode an ASN1 item, this currently behaves just like a standard 'd2i'
@@ -106,27 +137,63 @@ ASN1_VALUE *ASN1_item_d2i(ASN1_VALUE **pval,
                           const unsigned char **in, long len,
                           const ASN1_ITEM *it)
 {
-    ASN1_TLC c;
+    return ASN1_item_d2i_flags(pval, in, len, it, 0);
+}
+
+/*
+ * As ASN1_item_d2i() but with ASN1_D2I_* options, which the callbacks and
+ * extern decoders of the items get with asn1_d2i_flags().
+ */
+
+ASN1_VALUE *ASN1_item_d2i_flags(ASN1_VALUE **pval,
+                                const unsigned char **in, long len,
+                                const ASN1_ITEM *it, unsigned long flags)
+{
+    ASN1_D2I_CTX c;
     ASN1_VALUE *ptmpval = NULL;
     if (!pval)
         pval = &ptmpval;
-    asn1_tlc_clear_nc(&c);
-    if (ASN1_item_ex_d2i(pval, in, len, it, -1, 0, 0, &c) > 0)
+    asn1_d2i_ctx_init(&c, flags);
+    if (asn1_item_ex_d2i_int(pval, in, len, it, -1, 0, 0, &c.tlc) > 0)
         return *pval;
     return NULL;
 }
 
+/*
+ * |ctx| may be the caller's own ASN1_TLC, so the decode is done with a
+ * copy of it in an ASN1_D2I_CTX, without options.
+ */
 int ASN1_item_ex_d2i(ASN1_VALUE **pval, const unsigned char **in, long len,
                      const ASN1_ITEM *it,
                      int tag, int aclass, char opt, ASN1_TLC *ctx)
 {
+    ASN1_D2I_CTX c;
     int rv;
-    rv = asn1_item_embed_d2i(pval, in, len, it, tag, aclass, opt, ctx, 0);
-    if (rv <= 0)
-        ASN1_item_ex_free(pval, it);
+
+    asn1_d2i_ctx_init(&c, 0);
+    if (ctx != NULL)
+        c.tlc = *ctx;
+    rv = asn1_item_ex_d2i_int(pval, in, len, it, tag, aclass, opt, &c.tlc);
+    if (ctx != NULL)
+        *ctx = c.tlc;
     return rv;
 }
 
+/*
+ * The ASN1_D2I_* options of the decode |ctx| belongs to.  Only valid for
+ * the ASN1_TLC passed to extern decoders and, as |exarg|, to D2I_PRE and
+ * D2I_POST callbacks.
+ */
+unsigned long asn1_d2i_flags(const ASN1_TLC *ctx)
+{
+    return ctx == NULL ? 0 : ((const ASN1_D2I_CTX *)ctx)->flags;
+}
+
+void asn1_d2i_set_fast_paths(int on)
+{
+    asn1_d2i_fast_paths = on;
+}
+
 /*
  * Decode an item, taking care of IMPLICIT tagging, if any. If 'opt' set and
  * tag mismatch return -1 to handle OPTIONAL
@@ -215,7 +282,7 @@ static int asn1_item_embed_d2i(ASN1_VALUE **pval, const unsigned char **in,
         return ef->asn1_ex_d2i(pval, in, len, it, tag, aclass, opt, ctx);
 
     case ASN1_ITYPE_CHOICE:
-        if (asn1_cb && !asn1_cb(ASN1_OP_D2I_PRE, pval, it, NULL))
+        if (asn1_cb && !asn1_cb(ASN1_OP_D2I_PRE, pval, it, ctx))
             goto auxerr;
         if (*pval) {
             /* Free up and zero CHOICE value if initialised */
@@ -268,7 +335,7 @@ static int asn1_item_embed_d2i(ASN1_VALUE **pval, const unsigned char **in,
 
         asn1_set_choice_selector(pval, i, it);
 
-        if (asn1_cb && !asn1_cb(ASN1_OP_D2I_POST, pval, it, NULL))
+        if (asn1_cb && !asn1_cb(ASN1_OP_D2I_POST, pval, it, ctx))
             goto auxerr;
         *in = p;
         return 1;
@@ -308,7 +375,7 @@ static int asn1_item_embed_d2i(ASN1_VALUE **pval, const unsigned char **in,
             goto err;
         }
 
-        if (asn1_cb && !asn1_cb(ASN1_OP_D2I_PRE, pval, it, NULL))
+        if (asn1_cb && !asn1_cb(ASN1_OP_D2I_PRE, pval, it, ctx))
             goto auxerr;
 
         /* Free up and zero any ADB found */
@@ -328,7 +395,8 @@ static int asn1_item_embed_d2i(ASN1_VALUE **pval, const unsigned char **in,
         for (i = 0, tt = it->templates; i < it->tcount; i++, tt++) {
             const ASN1_TEMPLATE *seqtt;
             ASN1_VALUE **pseqval;
-            seqtt = asn1_do_adb(pval, tt, 1);
+            seqtt = (tt->flags & ASN1_TFLG_ADB_MASK) != 0
+                    ? asn1_do_adb(pval, tt, 1) : tt;
             if (seqtt == NULL)
                 goto err;
             pseqval = asn1_get_field_ptr(pval, seqtt);
@@ -410,7 +478,7 @@ static int asn1_item_embed_d2i(ASN1_VALUE **pval, const unsigned char **in,
         /* Save encoding */
         if (!asn1_enc_save(pval, *in, p - *in, it))
             goto auxerr;
-        if (asn1_cb && !asn1_cb(ASN1_OP_D2I_POST, pval, it, NULL))
+        if (asn1_cb && !asn1_cb(ASN1_OP_D2I_POST, pval, it, ctx))
             goto auxerr;
         *in = p;
         return 1;
@@ -609,20 +677,28 @@ static int asn1_template_noexp_d2i(ASN1_VALUE **val,
             ASN1err(ASN1_F_ASN1_TEMPLATE_NOEXP_D2I, ASN1_R_MISSING_EOC);
             goto err;
         }
-    } else if (flags & ASN1_TFLG_IMPTAG) {
-        /* IMPLICIT tagging */
-        ret = asn1_item_embed_d2i(val, &p, len,
-                                  ASN1_ITEM_ptr(tt->item), tt->tag, aclass, opt,
-                                  ctx, depth);
-        if (!ret) {
-            ASN1err(ASN1_F_ASN1_TEMPLATE_NOEXP_D2I, ERR_R_NESTED_ASN1_ERROR);
-            goto err;
-        } else if (ret == -1)
-            return -1;
     } else {
-        /* Nothing special */
-        ret = asn1_item_embed_d2i(val, &p, len, ASN1_ITEM_ptr(tt->item),
-                                  -1, 0, opt, ctx, depth);
+        const ASN1_ITEM *it = ASN1_ITEM_ptr(tt->item);
+        int tag = -1;
+
+        if (flags & ASN1_TFLG_IMPTAG) {
+            /* IMPLICIT tagging */
+            tag = tt->tag;
+        } else {
+            /* Nothing special */
+            aclass = 0;
+        }
+        /*
+         * Most fields are plain primitives: go straight to the primitive
+         * decoder, which is all asn1_item_embed_d2i() would do for them.
+         */
+        if (it->itype == ASN1_ITYPE_PRIMITIVE && it->templates == NULL
+                && depth < ASN1_MAX_CONSTRUCTED_NEST && asn1_d2i_fast_paths)
+            ret = asn1_d2i_ex_primitive(val, &p, len, it, tag, aclass, opt,
+                                        ctx);
+        else
+            ret = asn1_item_embed_d2i(val, &p, len, it, tag, aclass, opt,
+                                      ctx, depth);
         if (!ret) {
             ASN1err(ASN1_F_ASN1_TEMPLATE_NOEXP_D2I, ERR_R_NESTED_ASN1_ERROR);
             goto err;
@@ -1075,6 +1151,45 @@ static int asn1_check_eoc(const unsigned char **in, long len)
  * the header length just read.
  */
 
+/*
+ * Read an object header as ASN1_get_object() does. Nearly all DER has a
+ * low tag number and a definite length of at most two octets which fits
+ * in the input: these are decoded here and anything else, errors
+ * included, is left to ASN1_get_object().
+ */
+
+static ossl_inline int asn1_get_header(const unsigned char **pp,
+                                       long *plength, int *ptag, int *pclass,
+                                       long max)
+{
+    const unsigned char *p = *pp;
+    long l;
+    int hdrlen;
+
+    if (max < 2 || (p[0] & V_ASN1_PRIMITIVE_TAG) == V_ASN1_PRIMITIVE_TAG
+            || !asn1_d2i_fast_paths)
+        return ASN1_get_object(pp, plength, ptag, pclass, max);
+    if (p[1] < 0x80) {
+        l = p[1];
+        hdrlen = 2;
+    } else if (p[1] == 0x81 && max >= 4) {
+        l = p[2];
+        hdrlen = 3;
+    } else if (p[1] == 0x82 && max >= 5) {
+        l = ((long)p[2] << 8) | p[3];
+        hdrlen = 4;
+    } else {
+        return ASN1_get_object(pp, plength, ptag, pclass, max);
+    }
+    if (l > max - hdrlen)
+        return ASN1_get_object(pp, plength, ptag, pclass, max);
+    *ptag = p[0] & V_ASN1_PRIMITIVE_TAG;
+    *pclass = p[0] & V_ASN1_PRIVATE;
+    *plength = l;
+    *pp = p + hdrlen;
+    return p[0] & V_ASN1_CONSTRUCTED;
+}
+
 static int asn1_check_tlen(long *olen, int *otag, unsigned char *oclass,
                            char *inf, char *cst,
                            const unsigned char **in, long len,
@@ -1094,7 +1209,7 @@ static int asn1_check_tlen(long *olen, int *otag, unsigned char *oclass,
         ptag = ctx->ptag;
         p += ctx->hdrlen;
     } else {
-        i = ASN1_get_object(&p, &plen, &ptag, &pclass, len);
+        i = asn1_get_header(&p, &plen, &ptag, &pclass, len);
         if (ctx) {
             ctx->ret = i;
             ctx->plen = plen;
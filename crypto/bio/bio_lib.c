@@ -384,6 +384,55 @@ int BIO_write_ex(BIO *b, const void *data, size_t dlen, size_t *written)
     return ret;
 }
 
+/*
+ * Write the |iovcnt| buffers in |iov| in order with as few calls into the
+ * underlying method as possible. Methods without a gathered write, and BIOs
+ * with a callback set (which expects to see every buffer), get one write per
+ * element instead. As with BIO_write() a short write is not an error.
+ */
+int BIO_writev(BIO *b, const BIO_IOVEC *iov, size_t iovcnt, size_t *written)
+{
+    size_t i, tmpwrit, total = 0;
+    int ret = 0;
+
+    if (b == NULL)
+        return 0;
+
+    *written = 0;
+
+    if (b->method != NULL && b->method->bwritev != NULL
+            && b->callback == NULL && b->callback_ex == NULL) {
+        if (!b->init) {
+            BIOerr(BIO_F_BIO_WRITEV, BIO_R_UNINITIALIZED);
+            return -2;
+        }
+
+        ret = b->method->bwritev(b, iov, iovcnt, written);
+
+        if (ret > 0)
+            b->num_write += (uint64_t)*written;
+
+        return ret;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].len == 0)
+            continue;
+        ret = bio_write_intern(b, iov[i].base, iov[i].len, &tmpwrit);
+        if (ret <= 0)
+            break;
+        total += tmpwrit;
+        if (tmpwrit < iov[i].len)
+            break;
+    }
+
+    if (total == 0)
+        return ret;
+
+    *written = total;
+    return 1;
+}
+
 int BIO_puts(BIO *b, const char *buf)
 {
     int ret;
@@ -102,6 +102,20 @@ int BIO_meth_set_write_ex(BIO_METHOD *biom,
     return 1;
 }
 
+int (*BIO_meth_get_writev(const BIO_METHOD *biom)) (BIO *, const BIO_IOVEC *,
+                                                     size_t, size_t *)
+{
+    return biom->bwritev;
+}
+
+int BIO_meth_set_writev(BIO_METHOD *biom,
+                        int (*bwritev) (BIO *, const BIO_IOVEC *, size_t,
+                                        size_t *))
+{
+    biom->bwritev = bwritev;
+    return 1;
+}
+
 int (*BIO_meth_get_read(const BIO_METHOD *biom)) (BIO *, char *, int)
 {
     return biom->bread_old;
@@ -15,6 +15,10 @@
 #ifndef OPENSSL_NO_SOCK
 
 # include <openssl/bio.h>
+# ifdef OPENSSL_SYS_UNIX
+#  include <limits.h>
+#  include <sys/uio.h>
+# endif
 
 # ifdef WATT32
 /* Watt-32 uses same names */
@@ -27,6 +31,12 @@
 # endif
 
 static int sock_write(BIO *h, const char *buf, int num);
+# ifdef OPENSSL_SYS_UNIX
+static int sock_writev(BIO *h, const BIO_IOVEC *iov, size_t iovcnt,
+                       size_t *written);
+# else
+#  define sock_writev NULL
+# endif
 static int sock_read(BIO *h, char *buf, int size);
 static int sock_puts(BIO *h, const char *str);
 static long sock_ctrl(BIO *h, int cmd, long arg1, void *arg2);
@@ -49,6 +59,7 @@ static const BIO_METHOD methods_sockp = {
     sock_new,
     sock_free,
     NULL,                       /* sock_callback_ctrl */
+    sock_writev,
 };
 
 const BIO_METHOD *BIO_s_socket(void)
@@ -158,6 +169,41 @@ static long sock_ctrl(BIO *b, int cmd, long num, void *ptr)
     return ret;
 }
 
+# ifdef OPENSSL_SYS_UNIX
+/* Maximum number of buffers handed to a single writev() call */
+#  define SOCK_IOV_MAX 64
+
+static int sock_writev(BIO *b, const BIO_IOVEC *iov, size_t iovcnt,
+                       size_t *written)
+{
+    struct iovec vec[SOCK_IOV_MAX];
+    size_t i;
+    ssize_t ret;
+
+    if (iovcnt > SOCK_IOV_MAX)
+        iovcnt = SOCK_IOV_MAX;
+#  ifdef IOV_MAX
+    if (iovcnt > IOV_MAX)
+        iovcnt = IOV_MAX;
+#  endif
+    for (i = 0; i < iovcnt; i++) {
+        vec[i].iov_base = (void *)iov[i].base;
+        vec[i].iov_len = iov[i].len;
+    }
+
+    clear_socket_error();
+    ret = writev(b->num, vec, (int)iovcnt);
+    BIO_clear_retry_flags(b);
+    if (ret <= 0) {
+        if (BIO_sock_should_retry((int)ret))
+            BIO_set_retry_write(b);
+        return (int)ret;
+    }
+    *written = (size_t)ret;
+    return 1;
+}
+# endif
+
 static int sock_puts(BIO *bp, const char *str)
 {
     int n, ret;
@@ -0,0 +1,677 @@
+#! /usr/bin/env perl
+# Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the OpenSSL license (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+#
+# BLAKE2 compression functions for x86_64.
+#
+# October 2018
+#
+# blake2s_compress_sse41 and blake2b_compress_avx2 keep the 4x4 state
+# matrix one row per register, so that each half of a round is a single
+# vectorized G over four columns or four diagonals.  Message words are
+# gathered straight from the input block with [v]pinsr[dq].
+#
+# blake2bp_compress_avx2 and blake2sp_compress_avx2 hash the leaves of
+# BLAKE2bp and BLAKE2sp side by side, one leaf per lane.  The 4 or 8
+# interleaved input blocks are transposed onto the stack once, after
+# which every G is plain vertical arithmetic with no shuffles.
+#
+# Cycles per byte for 16KB inputs, measured with EVP and counted at
+# the nominal clock of Emerald Rapids:
+#
+#		C	SSE4.1/AVX2	AVX2 4x/8x
+# BLAKE2b	3.2	2.9		1.3 (BLAKE2bp)
+# BLAKE2s	5.0	4.5		1.3 (BLAKE2sp)
+#
+# Single-stream BLAKE2 is bound by the latency of G, so the per-row
+# kernels gain only ~10%.  The tree modes are 2.4x (BLAKE2bp) and 3.5x
+# (BLAKE2sp) faster than BLAKE2b and BLAKE2s, and faster than SHA-256
+# with the SHA extensions (1.7 cycles per byte).
+
+$flavour = shift;
+$output  = shift;
+if ($flavour =~ /\./) { $output = $flavour; undef $flavour; }
+
+$win64=0; $win64=1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/; $dir=$1;
+( $xlate="${dir}x86_64-xlate.pl" and -f $xlate ) or
+( $xlate="${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate) or
+die "can't locate x86_64-xlate.pl";
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
+		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.19) + ($1>=2.22);
+}
+
+if (!$avx && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
+	   `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.09) + ($1>=2.10);
+}
+
+if (!$avx && $win64 && ($flavour =~ /masm/ || $ENV{ASM} =~ /ml64/) &&
+	   `ml64 2>&1` =~ /Version ([0-9]+)\./) {
+	$avx = ($1>=10) + ($1>=11);
+}
+
+if (!$avx && `$ENV{CC} -v 2>&1` =~ /((?:^clang|LLVM) version|.*based on LLVM) ([3-9]\.[0-9]+)/) {
+	$avx = ($2>=3.0) + ($2>3.0);
+}
+
+open OUT,"| \"$^X\" \"$xlate\" $flavour \"$output\"";
+*STDOUT=*OUT;
+
+my @sigma = (
+	[  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 ],
+	[ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 ],
+	[ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 ],
+	[  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 ],
+	[  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 ],
+	[  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 ],
+	[ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 ],
+	[ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 ],
+	[  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 ],
+	[ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 ]
+);
+
+$code.=<<___;
+.text
+
+.align	64
+.Lblake2s_iv:
+.long	0x6a09e667,0xbb67ae85,0x3c6ef372,0xa54ff53a
+.long	0x510e527f,0x9b05688c,0x1f83d9ab,0x5be0cd19
+.Lblake2b_iv:
+.quad	0x6a09e667f3bcc908,0xbb67ae8584caa73b
+.quad	0x3c6ef372fe94f82b,0xa54ff53a5f1d36f1
+.quad	0x510e527fade682d1,0x9b05688c2b3e6c1f
+.quad	0x1f83d9abfb41bd6b,0x5be0cd19137e2179
+.Lrot16:
+.byte	0x2,0x3,0x0,0x1, 0x6,0x7,0x4,0x5, 0xa,0xb,0x8,0x9, 0xe,0xf,0xc,0xd
+.byte	0x2,0x3,0x0,0x1, 0x6,0x7,0x4,0x5, 0xa,0xb,0x8,0x9, 0xe,0xf,0xc,0xd
+.Lrot8:
+.byte	0x1,0x2,0x3,0x0, 0x5,0x6,0x7,0x4, 0x9,0xa,0xb,0x8, 0xd,0xe,0xf,0xc
+.byte	0x1,0x2,0x3,0x0, 0x5,0x6,0x7,0x4, 0x9,0xa,0xb,0x8, 0xd,0xe,0xf,0xc
+.Lrot24q:
+.byte	0x3,0x4,0x5,0x6,0x7,0x0,0x1,0x2, 0xb,0xc,0xd,0xe,0xf,0x8,0x9,0xa
+.byte	0x3,0x4,0x5,0x6,0x7,0x0,0x1,0x2, 0xb,0xc,0xd,0xe,0xf,0x8,0x9,0xa
+.Lrot16q:
+.byte	0x2,0x3,0x4,0x5,0x6,0x7,0x0,0x1, 0xa,0xb,0xc,0xd,0xe,0xf,0x8,0x9
+.byte	0x2,0x3,0x4,0x5,0x6,0x7,0x0,0x1, 0xa,0xb,0xc,0xd,0xe,0xf,0x8,0x9
+___
+
+########################################################################
+# int blake2s_compress_sse41(BLAKE2S_CTX *S, const uint8_t *blocks,
+#                            size_t len);
+#
+# Same contract as blake2s_compress in blake2s.c, |len| is either a
+# multiple of the block size or less than it.  Always returns 1.
+{
+my ($ctx,$inp,$len) = $win64 ? ("%rcx","%rdx","%r8") : ("%rdi","%rsi","%rdx");
+my $inc = "%rax";
+my ($a,$b,$c,$d,$m,$t) = map("%xmm$_",(0..5));
+
+sub halfround_sse41 {
+my ($w,$rotb,$shr) = @_;
+
+$code.=<<___;
+	movd		`4*$$w[0]`($inp),$m
+	pinsrd		\$1,`4*$$w[1]`($inp),$m
+	pinsrd		\$2,`4*$$w[2]`($inp),$m
+	pinsrd		\$3,`4*$$w[3]`($inp),$m
+	paddd		$m,$a
+	paddd		$b,$a
+	pxor		$a,$d
+	pshufb		$rotb(%rip),$d
+	paddd		$d,$c
+	pxor		$c,$b
+	movdqa		$b,$t
+	psrld		\$$shr,$b
+	pslld		\$`32-$shr`,$t
+	por		$t,$b
+___
+}
+
+$code.=<<___;
+.globl	blake2s_compress_sse41
+.type	blake2s_compress_sse41,\@abi-omnipotent
+.align	32
+blake2s_compress_sse41:
+.cfi_startproc
+	mov		\$64,$inc
+	cmp		$inc,$len
+	cmovb		$len,$inc		# increment = min(len, 64)
+	movdqu		0x00($ctx),$a
+	movdqu		0x10($ctx),$b
+	jmp		.Loop_blake2s_sse41
+
+.align	32
+.Loop_blake2s_sse41:
+	add		%eax,0x20($ctx)		# t[0] += increment
+	adcl		\$0,0x24($ctx)
+	movdqa		.Lblake2s_iv(%rip),$c
+	movdqu		0x20($ctx),$d		# t[0], t[1], f[0], f[1]
+	pxor		.Lblake2s_iv+16(%rip),$d
+___
+for (my $r=0; $r<10; $r++) {
+    my @s = @{$sigma[$r]};
+
+    &halfround_sse41([@s[0,2,4,6]],".Lrot16",12);
+    &halfround_sse41([@s[1,3,5,7]],".Lrot8",7);
+    $code.=<<___;
+	pshufd		\$0x39,$b,$b
+	pshufd		\$0x4e,$c,$c
+	pshufd		\$0x93,$d,$d
+___
+    &halfround_sse41([@s[8,10,12,14]],".Lrot16",12);
+    &halfround_sse41([@s[9,11,13,15]],".Lrot8",7);
+    $code.=<<___;
+	pshufd		\$0x93,$b,$b
+	pshufd		\$0x4e,$c,$c
+	pshufd		\$0x39,$d,$d
+___
+}
+$code.=<<___;
+	pxor		$c,$a
+	pxor		$d,$b
+	movdqu		0x00($ctx),$t
+	pxor		$t,$a
+	movdqu		0x10($ctx),$t
+	pxor		$t,$b
+	movdqu		$a,0x00($ctx)
+	movdqu		$b,0x10($ctx)
+	lea		($inp,$inc),$inp
+	sub		$inc,$len
+	jnz		.Loop_blake2s_sse41
+
+	mov		\$1,%eax
+	ret
+.cfi_endproc
+.size	blake2s_compress_sse41,.-blake2s_compress_sse41
+___
+}
+
+if ($avx>1) {
+########################################################################
+# int blake2b_compress_avx2(BLAKE2B_CTX *S, const uint8_t *blocks,
+#                           size_t len);
+#
+# Counterpart of blake2b_compress in blake2b.c.  Only %ymm0-5 are used,
+# so there is nothing to preserve on Win64.  Always returns 1.
+{
+my ($ctx,$inp,$len) = $win64 ? ("%rcx","%rdx","%r8") : ("%rdi","%rsi","%rdx");
+my $inc = "%rax";
+my ($a,$b,$c,$d,$m,$t) = map("%ymm$_",(0..5));
+my ($mx,$tx) = map("%xmm$_",(4..5));
+
+sub halfround_avx2 {
+my ($w,$half) = @_;
+
+$code.=<<___;
+	vmovq		`8*$$w[0]`($inp),$mx
+	vpinsrq		\$1,`8*$$w[1]`($inp),$mx,$mx
+	vmovq		`8*$$w[2]`($inp),$tx
+	vpinsrq		\$1,`8*$$w[3]`($inp),$tx,$tx
+	vinserti128	\$1,$tx,$m,$m
+	vpaddq		$m,$a,$a
+	vpaddq		$b,$a,$a
+	vpxor		$a,$d,$d
+___
+$code.=<<___	if ($half==0);
+	vpshufd		\$0xb1,$d,$d
+	vpaddq		$d,$c,$c
+	vpxor		$c,$b,$b
+	vpshufb		.Lrot24q(%rip),$b,$b
+___
+$code.=<<___	if ($half==1);
+	vpshufb		.Lrot16q(%rip),$d,$d
+	vpaddq		$d,$c,$c
+	vpxor		$c,$b,$b
+	vpsrlq		\$63,$b,$t
+	vpaddq		$b,$b,$b
+	vpor		$t,$b,$b
+___
+}
+
+$code.=<<___;
+.globl	blake2b_compress_avx2
+.type	blake2b_compress_avx2,\@abi-omnipotent
+.align	32
+blake2b_compress_avx2:
+.cfi_startproc
+	mov		\$128,$inc
+	cmp		$inc,$len
+	cmovb		$len,$inc		# increment = min(len, 128)
+	vmovdqu		0x00($ctx),$a
+	vmovdqu		0x20($ctx),$b
+	jmp		.Loop_blake2b_avx2
+
+.align	32
+.Loop_blake2b_avx2:
+	add		$inc,0x40($ctx)		# t[0] += increment
+	adcq		\$0,0x48($ctx)
+	vmovdqu		.Lblake2b_iv(%rip),$c
+	vmovdqu		0x40($ctx),$d		# t[0], t[1], f[0], f[1]
+	vpxor		.Lblake2b_iv+32(%rip),$d,$d
+___
+for (my $r=0; $r<12; $r++) {
+    my @s = @{$sigma[$r%10]};
+
+    &halfround_avx2([@s[0,2,4,6]],0);
+    &halfround_avx2([@s[1,3,5,7]],1);
+    $code.=<<___;
+	vpermq		\$0x39,$b,$b
+	vpermq		\$0x4e,$c,$c
+	vpermq		\$0x93,$d,$d
+___
+    &halfround_avx2([@s[8,10,12,14]],0);
+    &halfround_avx2([@s[9,11,13,15]],1);
+    $code.=<<___;
+	vpermq		\$0x93,$b,$b
+	vpermq		\$0x4e,$c,$c
+	vpermq		\$0x39,$d,$d
+___
+}
+$code.=<<___;
+	vpxor		$c,$a,$a
+	vpxor		$d,$b,$b
+	vpxor		0x00($ctx),$a,$a
+	vpxor		0x20($ctx),$b,$b
+	vmovdqu		$a,0x00($ctx)
+	vmovdqu		$b,0x20($ctx)
+	lea		($inp,$inc),$inp
+	sub		$inc,$len
+	jnz		.Loop_blake2b_avx2
+
+	vzeroupper
+	mov		\$1,%eax
+	ret
+.cfi_endproc
+.size	blake2b_compress_avx2,.-blake2b_compress_avx2
+___
+}
+
+########################################################################
+# int blake2bp_compress_avx2(uint64_t h[8][4], uint64_t t[2],
+#                            const uint8_t *inp, size_t num);
+# int blake2sp_compress_avx2(uint32_t h[8][8], uint32_t t[2],
+#                            const uint8_t *inp, size_t num);
+#
+# Compress |num| > 0 runs of 4 (or 8) consecutive blocks, block i of
+# each run going to leaf i.  |h| holds the leaf chaining values word by
+# word, word j of leaf i at h[j][i]; all leaves share the counter |t|.
+# None of the blocks may be the last one of its leaf.  Always return 1.
+{
+my ($h,$tp,$inp,$num) = ("%rdi","%rsi","%rdx","%rcx");
+my @v = map("%ymm$_",(0..15));
+my $xframe = $win64 ? 0xa8 : 8;
+
+sub G_lanes {
+my ($sz,$a,$b,$c,$d,$mx,$my,$t) = @_;
+my $add = "vpadd$sz";
+
+$code.=<<___;
+	$add		`32*$mx`(%rsp),$a,$a
+	$add		$b,$a,$a
+	vpxor		$a,$d,$d
+___
+$code.=<<___	if ($sz eq "q");
+	vpshufd		\$0xb1,$d,$d
+	$add		$d,$c,$c
+	vpxor		$c,$b,$b
+	vpshufb		.Lrot24q(%rip),$b,$b
+	$add		`32*$my`(%rsp),$a,$a
+	$add		$b,$a,$a
+	vpxor		$a,$d,$d
+	vpshufb		.Lrot16q(%rip),$d,$d
+	$add		$d,$c,$c
+	vpxor		$c,$b,$b
+	vmovdqa		$t,0x200(%rsp)
+	vpsrlq		\$63,$b,$t
+	vpaddq		$b,$b,$b
+	vpor		$t,$b,$b
+	vmovdqa		0x200(%rsp),$t
+___
+$code.=<<___	if ($sz eq "d");
+	vpshufb		.Lrot16(%rip),$d,$d
+	$add		$d,$c,$c
+	vpxor		$c,$b,$b
+	vmovdqa		$t,0x200(%rsp)
+	vpsrld		\$12,$b,$t
+	vpslld		\$20,$b,$b
+	vpor		$t,$b,$b
+	$add		`32*$my`(%rsp),$a,$a
+	$add		$b,$a,$a
+	vpxor		$a,$d,$d
+	vpshufb		.Lrot8(%rip),$d,$d
+	$add		$d,$c,$c
+	vpxor		$c,$b,$b
+	vpsrld		\$7,$b,$t
+	vpslld		\$25,$b,$b
+	vpor		$t,$b,$b
+	vmovdqa		0x200(%rsp),$t
+___
+}
+
+sub blake2_lanes_avx2 {
+my ($name,$sz,$rounds) = @_;
+my ($lanes,$bsz) = $sz eq "q" ? (4,128) : (8,64);
+
+$code.=<<___;
+.globl	${name}_compress_avx2
+.type	${name}_compress_avx2,\@function,4
+.align	32
+${name}_compress_avx2:
+.cfi_startproc
+	mov		%rsp,%r9		# frame register
+.cfi_def_cfa_register	%r9
+	sub		\$0x220+$xframe,%rsp
+	and		\$-32,%rsp
+___
+$code.=<<___	if ($win64);
+	movaps		%xmm6,-0xa8(%r9)
+	movaps		%xmm7,-0x98(%r9)
+	movaps		%xmm8,-0x88(%r9)
+	movaps		%xmm9,-0x78(%r9)
+	movaps		%xmm10,-0x68(%r9)
+	movaps		%xmm11,-0x58(%r9)
+	movaps		%xmm12,-0x48(%r9)
+	movaps		%xmm13,-0x38(%r9)
+	movaps		%xmm14,-0x28(%r9)
+	movaps		%xmm15,-0x18(%r9)
+.L${name}_body:
+___
+$code.=<<___;
+	################ stack layout
+	# +0x000	message word i of every lane at 32*i
+	# ...
+	# +0x200	spill slot
+	jmp		.Loop_${name}_avx2
+
+.align	32
+.Loop_${name}_avx2:
+___
+if ($sz eq "q") {
+    # 4x4 transpose of 64-bit words, 4 words of each block at a time
+    for (my $g=0; $g<4; $g++) {
+	$code.=<<___;
+	vmovdqu		`32*$g+0*$bsz`($inp),@v[0]
+	vmovdqu		`32*$g+1*$bsz`($inp),@v[1]
+	vmovdqu		`32*$g+2*$bsz`($inp),@v[2]
+	vmovdqu		`32*$g+3*$bsz`($inp),@v[3]
+	vpunpcklqdq	@v[1],@v[0],@v[4]
+	vpunpckhqdq	@v[1],@v[0],@v[5]
+	vpunpcklqdq	@v[3],@v[2],@v[6]
+	vpunpckhqdq	@v[3],@v[2],@v[7]
+	vperm2i128	\$0x20,@v[6],@v[4],@v[0]
+	vperm2i128	\$0x20,@v[7],@v[5],@v[1]
+	vperm2i128	\$0x31,@v[6],@v[4],@v[2]
+	vperm2i128	\$0x31,@v[7],@v[5],@v[3]
+	vmovdqa		@v[0],`32*(4*$g+0)`(%rsp)
+	vmovdqa		@v[1],`32*(4*$g+1)`(%rsp)
+	vmovdqa		@v[2],`32*(4*$g+2)`(%rsp)
+	vmovdqa		@v[3],`32*(4*$g+3)`(%rsp)
+___
+    }
+    $code.=<<___;
+	addq		\$$bsz,0($tp)		# all leaves advance by a block
+	adcq		\$0,8($tp)
+	vpbroadcastq	0($tp),@v[12]
+	vpbroadcastq	8($tp),@v[13]
+	vpbroadcastq	.Lblake2b_iv+0x00(%rip),@v[8]
+	vpbroadcastq	.Lblake2b_iv+0x08(%rip),@v[9]
+	vpbroadcastq	.Lblake2b_iv+0x10(%rip),@v[10]
+	vpbroadcastq	.Lblake2b_iv+0x18(%rip),@v[11]
+	vpbroadcastq	.Lblake2b_iv+0x20(%rip),@v[14]
+	vpxor		@v[14],@v[12],@v[12]
+	vpbroadcastq	.Lblake2b_iv+0x28(%rip),@v[14]
+	vpxor		@v[14],@v[13],@v[13]
+	vpbroadcastq	.Lblake2b_iv+0x30(%rip),@v[14]
+	vpbroadcastq	.Lblake2b_iv+0x38(%rip),@v[15]
+___
+} else {
+    # 8x8 transpose of 32-bit words, 8 words of each block at a time
+    for (my $g=0; $g<2; $g++) {
+	for (my $i=0; $i<8; $i++) {
+	    $code.="\tvmovdqu\t\t".(32*$g+$i*$bsz)."($inp),@v[$i]\n";
+	}
+	for (my $i=0; $i<8; $i+=2) {
+	    $code.=<<___;
+	vpunpckldq	@v[$i+1],@v[$i],@v[8+$i]
+	vpunpckhdq	@v[$i+1],@v[$i],@v[9+$i]
+___
+	}
+	for (my $i=0; $i<8; $i+=4) {
+	    $code.=<<___;
+	vpunpcklqdq	@v[10+$i],@v[8+$i],@v[0+$i]
+	vpunpckhqdq	@v[10+$i],@v[8+$i],@v[1+$i]
+	vpunpcklqdq	@v[11+$i],@v[9+$i],@v[2+$i]
+	vpunpckhqdq	@v[11+$i],@v[9+$i],@v[3+$i]
+___
+	}
+	for (my $i=0; $i<4; $i++) {
+	    $code.=<<___;
+	vperm2i128	\$0x20,@v[4+$i],@v[$i],@v[8+$i]
+	vperm2i128	\$0x31,@v[4+$i],@v[$i],@v[12+$i]
+	vmovdqa		@v[8+$i],`32*(8*$g+$i)`(%rsp)
+	vmovdqa		@v[12+$i],`32*(8*$g+4+$i)`(%rsp)
+___
+	}
+    }
+    $code.=<<___;
+	addl		\$$bsz,0($tp)		# all leaves advance by a block
+	adcl		\$0,4($tp)
+	vpbroadcastd	0($tp),@v[12]
+	vpbroadcastd	4($tp),@v[13]
+	vpbroadcastd	.Lblake2s_iv+0x00(%rip),@v[8]
+	vpbroadcastd	.Lblake2s_iv+0x04(%rip),@v[9]
+	vpbroadcastd	.Lblake2s_iv+0x08(%rip),@v[10]
+	vpbroadcastd	.Lblake2s_iv+0x0c(%rip),@v[11]
+	vpbroadcastd	.Lblake2s_iv+0x10(%rip),@v[14]
+	vpxor		@v[14],@v[12],@v[12]
+	vpbroadcastd	.Lblake2s_iv+0x14(%rip),@v[14]
+	vpxor		@v[14],@v[13],@v[13]
+	vpbroadcastd	.Lblake2s_iv+0x18(%rip),@v[14]
+	vpbroadcastd	.Lblake2s_iv+0x1c(%rip),@v[15]
+___
+}
+for (my $i=0; $i<8; $i++) {
+    $code.="\tvmovdqu\t\t".(32*$i)."($h),@v[$i]\n";
+}
+for (my $r=0; $r<$rounds; $r++) {
+    my @s = @{$sigma[$r%10]};
+
+    # the spill register is the first row of the next G
+    for (my $i=0; $i<4; $i++) {
+	&G_lanes($sz,@v[$i,4+$i,8+$i,12+$i],@s[2*$i,2*$i+1],
+		 @v[($i+1)%4]);
+    }
+    for (my $i=0; $i<4; $i++) {
+	&G_lanes($sz,@v[$i,4+($i+1)%4,8+($i+2)%4,12+($i+3)%4],
+		 @s[8+2*$i,9+2*$i],@v[($i+1)%4]);
+    }
+}
+for (my $i=0; $i<8; $i++) {
+    $code.=<<___;
+	vpxor		@v[8+$i],@v[$i],@v[$i]
+	vpxor		`32*$i`($h),@v[$i],@v[$i]
+	vmovdqu		@v[$i],`32*$i`($h)
+___
+}
+$code.=<<___;
+	lea		`$lanes*$bsz`($inp),$inp
+	dec		$num
+	jnz		.Loop_${name}_avx2
+
+	vzeroall
+___
+$code.=<<___	if ($win64);
+	movaps		-0xa8(%r9),%xmm6
+	movaps		-0x98(%r9),%xmm7
+	movaps		-0x88(%r9),%xmm8
+	movaps		-0x78(%r9),%xmm9
+	movaps		-0x68(%r9),%xmm10
+	movaps		-0x58(%r9),%xmm11
+	movaps		-0x48(%r9),%xmm12
+	movaps		-0x38(%r9),%xmm13
+	movaps		-0x28(%r9),%xmm14
+	movaps		-0x18(%r9),%xmm15
+___
+$code.=<<___;
+	mov		\$1,%eax
+	lea		(%r9),%rsp
+.cfi_def_cfa_register	%rsp
+.L${name}_epilogue:
+	ret
+.cfi_endproc
+.size	${name}_compress_avx2,.-${name}_compress_avx2
+___
+}
+
+&blake2_lanes_avx2("blake2bp","q",12);
+&blake2_lanes_avx2("blake2sp","d",10);
+}
+
+} else {
+########################################################################
+# Assembler is too old for AVX2, callers fall back to C.
+$code.=<<___;
+.globl	blake2b_compress_avx2
+.type	blake2b_compress_avx2,\@abi-omnipotent
+blake2b_compress_avx2:
+.globl	blake2bp_compress_avx2
+.type	blake2bp_compress_avx2,\@abi-omnipotent
+blake2bp_compress_avx2:
+.globl	blake2sp_compress_avx2
+.type	blake2sp_compress_avx2,\@abi-omnipotent
+blake2sp_compress_avx2:
+	xor	%eax,%eax
+	ret
+.size	blake2b_compress_avx2,.-blake2b_compress_avx2
+___
+}
+
+# EXCEPTION_DISPOSITION handler (EXCEPTION_RECORD *rec,ULONG64 frame,
+#		CONTEXT *context,DISPATCHER_CONTEXT *disp)
+if ($win64 && $avx>1) {
+$rec="%rcx";
+$frame="%rdx";
+$context="%r8";
+$disp="%r9";
+
+$code.=<<___;
+.extern	__imp_RtlVirtualUnwind
+.type	simd_handler,\@abi-omnipotent
+.align	16
+simd_handler:
+	push	%rsi
+	push	%rdi
+	push	%rbx
+	push	%rbp
+	push	%r12
+	push	%r13
+	push	%r14
+	push	%r15
+	pushfq
+	sub	\$64,%rsp
+
+	mov	120($context),%rax	# pull context->Rax
+	mov	248($context),%rbx	# pull context->Rip
+
+	mov	8($disp),%rsi		# disp->ImageBase
+	mov	56($disp),%r11		# disp->HandlerData
+
+	mov	0(%r11),%r10d		# HandlerData[0]
+	lea	(%rsi,%r10),%r10	# prologue label
+	cmp	%r10,%rbx		# context->Rip<prologue label
+	jb	.Lcommon_seh_tail
+
+	mov	192($context),%rax	# pull context->R9
+
+	mov	4(%r11),%r10d		# HandlerData[1]
+	mov	8(%r11),%ecx		# HandlerData[2]
+	lea	(%rsi,%r10),%r10	# epilogue label
+	cmp	%r10,%rbx		# context->Rip>=epilogue label
+	jae	.Lcommon_seh_tail
+
+	neg	%rcx
+	lea	-8(%rax,%rcx),%rsi
+	lea	512($context),%rdi	# &context.Xmm6
+	neg	%ecx
+	shr	\$3,%ecx
+	.long	0xa548f3fc		# cld; rep movsq
+
+.Lcommon_seh_tail:
+	mov	8(%rax),%rdi
+	mov	16(%rax),%rsi
+	mov	%rax,152($context)	# restore context->Rsp
+	mov	%rsi,168($context)	# restore context->Rsi
+	mov	%rdi,176($context)	# restore context->Rdi
+
+	mov	40($disp),%rdi		# disp->ContextRecord
+	mov	$context,%rsi		# context
+	mov	\$154,%ecx		# sizeof(CONTEXT)
+	.long	0xa548f3fc		# cld; rep movsq
+
+	mov	$disp,%rsi
+	xor	%rcx,%rcx		# arg1, UNW_FLAG_NHANDLER
+	mov	8(%rsi),%rdx		# arg2, disp->ImageBase
+	mov	0(%rsi),%r8		# arg3, disp->ControlPc
+	mov	16(%rsi),%r9		# arg4, disp->FunctionEntry
+	mov	40(%rsi),%r10		# disp->ContextRecord
+	lea	56(%rsi),%r11		# &disp->HandlerData
+	lea	24(%rsi),%r12		# &disp->EstablisherFrame
+	mov	%r10,32(%rsp)		# arg5
+	mov	%r11,40(%rsp)		# arg6
+	mov	%r12,48(%rsp)		# arg7
+	mov	%rcx,56(%rsp)		# arg8, (NULL)
+	call	*__imp_RtlVirtualUnwind(%rip)
+
+	mov	\$1,%eax		# ExceptionContinueSearch
+	add	\$64,%rsp
+	popfq
+	pop	%r15
+	pop	%r14
+	pop	%r13
+	pop	%r12
+	pop	%rbp
+	pop	%rbx
+	pop	%rdi
+	pop	%rsi
+	ret
+.size	simd_handler,.-simd_handler
+
+.section	.pdata
+.align	4
+	.rva	.LSEH_begin_blake2bp_compress_avx2
+	.rva	.LSEH_end_blake2bp_compress_avx2
+	.rva	.LSEH_info_blake2bp_compress_avx2
+
+	.rva	.LSEH_begin_blake2sp_compress_avx2
+	.rva	.LSEH_end_blake2sp_compress_avx2
+	.rva	.LSEH_info_blake2sp_compress_avx2
+
+.section	.xdata
+.align	8
+.LSEH_info_blake2bp_compress_avx2:
+	.byte	9,0,0,0
+	.rva	simd_handler
+	.rva	.Lblake2bp_body,.Lblake2bp_epilogue	# HandlerData[]
+	.long	0xa0,0
+
+.LSEH_info_blake2sp_compress_avx2:
+	.byte	9,0,0,0
+	.rva	simd_handler
+	.rva	.Lblake2sp_body,.Lblake2sp_epilogue	# HandlerData[]
+	.long	0xa0,0
+___
+}
+
+$code =~ s/\`([^\`]*)\`/eval $1/gem;
+print $code;
+close STDOUT;
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2017 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2016-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -88,3 +88,64 @@ int BLAKE2b_Final(unsigned char *md, BLAKE2B_CTX *c);
 int BLAKE2s_Init(BLAKE2S_CTX *c);
 int BLAKE2s_Update(BLAKE2S_CTX *c, const void *data, size_t datalen);
 int BLAKE2s_Final(unsigned char *md, BLAKE2S_CTX *c);
+
+void blake2b_init_param(BLAKE2B_CTX *S, const BLAKE2B_PARAM *P);
+void blake2b_compress(BLAKE2B_CTX *S, const uint8_t *blocks, size_t len);
+void blake2s_init_param(BLAKE2S_CTX *S, const BLAKE2S_PARAM *P);
+void blake2s_compress(BLAKE2S_CTX *S, const uint8_t *blocks, size_t len);
+
+/*
+ * BLAKE2bp and BLAKE2sp deal the input out to 4 and 8 leaves one block at
+ * a time, a stripe being one block for each leaf.  The leaves always
+ * hash whole stripes until finalization, so they share a single counter
+ * and their chaining values are kept interleaved, word j of leaf i at
+ * h[j][i], which is the layout the multi-lane assembly works with.
+ */
+#define BLAKE2BP_LEAVES       4
+#define BLAKE2SP_LEAVES       8
+#define BLAKE2BP_STRIPEBYTES  (BLAKE2BP_LEAVES * BLAKE2B_BLOCKBYTES)
+#define BLAKE2SP_STRIPEBYTES  (BLAKE2SP_LEAVES * BLAKE2S_BLOCKBYTES)
+
+struct blake2bp_ctx_st {
+    uint64_t h[8][BLAKE2BP_LEAVES];
+    uint64_t t[2];
+    uint8_t  buf[2 * BLAKE2BP_STRIPEBYTES];
+    size_t   buflen;
+};
+
+struct blake2sp_ctx_st {
+    uint32_t h[8][BLAKE2SP_LEAVES];
+    uint32_t t[2];
+    uint8_t  buf[2 * BLAKE2SP_STRIPEBYTES];
+    size_t   buflen;
+};
+
+#define BLAKE2BP_DIGEST_LENGTH BLAKE2B_DIGEST_LENGTH
+#define BLAKE2SP_DIGEST_LENGTH BLAKE2S_DIGEST_LENGTH
+
+typedef struct blake2bp_ctx_st BLAKE2BP_CTX;
+typedef struct blake2sp_ctx_st BLAKE2SP_CTX;
+
+int BLAKE2bp_Init(BLAKE2BP_CTX *c);
+int BLAKE2bp_Update(BLAKE2BP_CTX *c, const void *data, size_t datalen);
+int BLAKE2bp_Final(unsigned char *md, BLAKE2BP_CTX *c);
+
+int BLAKE2sp_Init(BLAKE2SP_CTX *c);
+int BLAKE2sp_Update(BLAKE2SP_CTX *c, const void *data, size_t datalen);
+int BLAKE2sp_Final(unsigned char *md, BLAKE2SP_CTX *c);
+
+#if defined(BLAKE2_ASM) && \
+    (defined(__x86_64) || defined(_M_AMD64) || defined(_M_X64))
+# define BLAKE2_X86_64
+extern unsigned int OPENSSL_ia32cap_P[];
+# define BLAKE2_SSE41_CAPABLE (OPENSSL_ia32cap_P[1] & (1 << (51 - 32)))
+# define BLAKE2_AVX2_CAPABLE  (OPENSSL_ia32cap_P[2] & (1 << 5))
+
+/* These return 0 if the assembler could not handle the instructions */
+int blake2s_compress_sse41(BLAKE2S_CTX *S, const uint8_t *blocks, size_t len);
+int blake2b_compress_avx2(BLAKE2B_CTX *S, const uint8_t *blocks, size_t len);
+int blake2bp_compress_avx2(uint64_t h[8][BLAKE2BP_LEAVES], uint64_t t[2],
+                           const uint8_t *inp, size_t num);
+int blake2sp_compress_avx2(uint32_t h[8][BLAKE2SP_LEAVES], uint32_t t[2],
+                           const uint8_t *inp, size_t num);
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2017 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2016-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -63,7 +63,7 @@ static ossl_inline void blake2b_init0(BLAKE2B_CTX *S)
 }
 
 /* init xors IV with input parameter block */
-static void blake2b_init_param(BLAKE2B_CTX *S, const BLAKE2B_PARAM *P)
+void blake2b_init_param(BLAKE2B_CTX *S, const BLAKE2B_PARAM *P)
 {
     size_t i;
     const uint8_t *p = (const uint8_t *)(P);
@@ -98,9 +98,9 @@ int BLAKE2b_Init(BLAKE2B_CTX *c)
 }
 
 /* Permute the state while xoring in the block of data. */
-static void blake2b_compress(BLAKE2B_CTX *S,
-                            const uint8_t *blocks,
-                            size_t len)
+void blake2b_compress(BLAKE2B_CTX *S,
+                     const uint8_t *blocks,
+                     size_t len)
 {
     uint64_t m[16];
     uint64_t v[16];
@@ -119,6 +119,11 @@ static void blake2b_compress(BLAKE2B_CTX *S,
      */
     assert(len < BLAKE2B_BLOCKBYTES || len % BLAKE2B_BLOCKBYTES == 0);
 
+#ifdef BLAKE2_X86_64
+    if (BLAKE2_AVX2_CAPABLE && blake2b_compress_avx2(S, blocks, len))
+        return;
+#endif
+
     /*
      * Since last block is always processed with separate call,
      * |len| not being multiple of complete blocks can be observed
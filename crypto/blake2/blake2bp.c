@@ -0,0 +1,185 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * BLAKE2bp, the 4-way parallel mode of BLAKE2b specified in the BLAKE2
+ * paper and implemented by the BLAKE2 reference code.  Input blocks are
+ * dealt round-robin to 4 leaves, and a root node hashes the 4 leaf
+ * digests.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <openssl/crypto.h>
+
+#include "blake2_locl.h"
+#include "blake2_impl.h"
+
+/*
+ * The last block of every leaf has to be compressed as final, so the
+ * stripe at the front of the buffer is only compressed once more than
+ * this many bytes from its start are known: the last leaf then has data
+ * beyond it as well.
+ */
+#define BLAKE2BP_LOOKAHEAD (2 * BLAKE2BP_STRIPEBYTES - BLAKE2B_BLOCKBYTES)
+
+static void blake2bp_init_node(BLAKE2B_CTX *S, uint64_t node_offset,
+                               uint8_t node_depth)
+{
+    BLAKE2B_PARAM P[1];
+
+    P->digest_length = BLAKE2BP_DIGEST_LENGTH;
+    P->key_length    = 0;
+    P->fanout        = BLAKE2BP_LEAVES;
+    P->depth         = 2;
+    store32(P->leaf_length, 0);
+    store64(P->node_offset, node_offset);
+    P->node_depth    = node_depth;
+    P->inner_length  = BLAKE2B_OUTBYTES;
+    memset(P->reserved, 0, sizeof(P->reserved));
+    memset(P->salt,     0, sizeof(P->salt));
+    memset(P->personal, 0, sizeof(P->personal));
+    blake2b_init_param(S, P);
+}
+
+static void blake2bp_get_leaf(BLAKE2B_CTX *S, const BLAKE2BP_CTX *c, int i)
+{
+    int j;
+
+    memset(S, 0, sizeof(*S));
+    for (j = 0; j < 8; j++)
+        S->h[j] = c->h[j][i];
+    S->t[0] = c->t[0];
+    S->t[1] = c->t[1];
+}
+
+static void blake2bp_put_leaf(BLAKE2BP_CTX *c, const BLAKE2B_CTX *S, int i)
+{
+    int j;
+
+    for (j = 0; j < 8; j++)
+        c->h[j][i] = S->h[j];
+}
+
+/* Compress |num| stripes, none of which may hold the last block of a leaf */
+static void blake2bp_compress(BLAKE2BP_CTX *c, const uint8_t *in, size_t num)
+{
+    BLAKE2B_CTX S;
+    int i;
+
+#ifdef BLAKE2_X86_64
+    if (BLAKE2_AVX2_CAPABLE && blake2bp_compress_avx2(c->h, c->t, in, num))
+        return;
+#endif
+    for (; num > 0; num--, in += BLAKE2BP_STRIPEBYTES) {
+        for (i = 0; i < BLAKE2BP_LEAVES; i++) {
+            blake2bp_get_leaf(&S, c, i);
+            blake2b_compress(&S, in + i * BLAKE2B_BLOCKBYTES,
+                             BLAKE2B_BLOCKBYTES);
+            blake2bp_put_leaf(c, &S, i);
+        }
+        c->t[0] += BLAKE2B_BLOCKBYTES;
+        c->t[1] += (c->t[0] < BLAKE2B_BLOCKBYTES);
+    }
+    OPENSSL_cleanse(&S, sizeof(S));
+}
+
+/* Initialize the hashing context.  Always returns 1. */
+int BLAKE2bp_Init(BLAKE2BP_CTX *c)
+{
+    BLAKE2B_CTX S;
+    int i;
+
+    memset(c, 0, sizeof(*c));
+    for (i = 0; i < BLAKE2BP_LEAVES; i++) {
+        blake2bp_init_node(&S, i, 0);
+        blake2bp_put_leaf(c, &S, i);
+    }
+    return 1;
+}
+
+/* Absorb the input data into the hash state.  Always returns 1. */
+int BLAKE2bp_Update(BLAKE2BP_CTX *c, const void *data, size_t datalen)
+{
+    const uint8_t *in = data;
+    size_t n, off;
+
+    if (c->buflen > 0) {
+        /* Top the buffer up to a stripe boundary */
+        n = BLAKE2BP_STRIPEBYTES - c->buflen % BLAKE2BP_STRIPEBYTES;
+        if (n > datalen)
+            n = datalen;
+        memcpy(c->buf + c->buflen, in, n);
+        c->buflen += n;
+        in += n;
+        datalen -= n;
+
+        for (off = 0; off + BLAKE2BP_STRIPEBYTES <= c->buflen
+                      && c->buflen - off + datalen > BLAKE2BP_LOOKAHEAD;
+             off += BLAKE2BP_STRIPEBYTES)
+            blake2bp_compress(c, c->buf + off, 1);
+        c->buflen -= off;
+        memmove(c->buf, c->buf + off, c->buflen);
+
+        if (c->buflen > 0) {
+            assert(c->buflen + datalen <= BLAKE2BP_LOOKAHEAD);
+            memcpy(c->buf + c->buflen, in, datalen);
+            c->buflen += datalen;
+            return 1;
+        }
+    }
+
+    /* The buffer is empty, hash straight from the input */
+    if (datalen > BLAKE2BP_LOOKAHEAD) {
+        n = (datalen - BLAKE2BP_LOOKAHEAD + BLAKE2BP_STRIPEBYTES - 1)
+            / BLAKE2BP_STRIPEBYTES;
+        blake2bp_compress(c, in, n);
+        in += n * BLAKE2BP_STRIPEBYTES;
+        datalen -= n * BLAKE2BP_STRIPEBYTES;
+    }
+    memcpy(c->buf, in, datalen);
+    c->buflen = datalen;
+
+    return 1;
+}
+
+/*
+ * Calculate the final hash and save it in md.
+ * Always returns 1.
+ */
+int BLAKE2bp_Final(unsigned char *md, BLAKE2BP_CTX *c)
+{
+    uint8_t hash[BLAKE2BP_LEAVES][BLAKE2B_OUTBYTES];
+    BLAKE2B_CTX S;
+    size_t off, n;
+    int i;
+
+    for (i = 0; i < BLAKE2BP_LEAVES; i++) {
+        blake2bp_get_leaf(&S, c, i);
+        /* What is left of the leaf is in the buffer, at most two blocks */
+        for (off = i * BLAKE2B_BLOCKBYTES; off < c->buflen;
+             off += BLAKE2BP_STRIPEBYTES) {
+            n = c->buflen - off;
+            BLAKE2b_Update(&S, c->buf + off,
+                           n < BLAKE2B_BLOCKBYTES ? n : BLAKE2B_BLOCKBYTES);
+        }
+        if (i == BLAKE2BP_LEAVES - 1)
+            S.f[1] = -1;                /* last node, once Update is done */
+        BLAKE2b_Final(hash[i], &S);
+    }
+
+    blake2bp_init_node(&S, 0, 1);
+    BLAKE2b_Update(&S, hash, sizeof(hash));
+    S.f[1] = -1;                /* the root is a last node too */
+    BLAKE2b_Final(md, &S);
+
+    OPENSSL_cleanse(hash, sizeof(hash));
+    OPENSSL_cleanse(c, sizeof(BLAKE2BP_CTX));
+    return 1;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2017 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2016-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -59,7 +59,7 @@ static ossl_inline void blake2s_init0(BLAKE2S_CTX *S)
 }
 
 /* init2 xors IV with input parameter block */
-static void blake2s_init_param(BLAKE2S_CTX *S, const BLAKE2S_PARAM *P)
+void blake2s_init_param(BLAKE2S_CTX *S, const BLAKE2S_PARAM *P)
 {
     const uint8_t *p = (const uint8_t *)(P);
     size_t i;
@@ -94,9 +94,9 @@ int BLAKE2s_Init(BLAKE2S_CTX *c)
 }
 
 /* Permute the state while xoring in the block of data. */
-static void blake2s_compress(BLAKE2S_CTX *S,
-                            const uint8_t *blocks,
-                            size_t len)
+void blake2s_compress(BLAKE2S_CTX *S,
+                     const uint8_t *blocks,
+                     size_t len)
 {
     uint32_t m[16];
     uint32_t v[16];
@@ -115,6 +115,11 @@ static void blake2s_compress(BLAKE2S_CTX *S,
      */
     assert(len < BLAKE2S_BLOCKBYTES || len % BLAKE2S_BLOCKBYTES == 0);
 
+#ifdef BLAKE2_X86_64
+    if (BLAKE2_SSE41_CAPABLE && blake2s_compress_sse41(S, blocks, len))
+        return;
+#endif
+
     /*
      * Since last block is always processed with separate call,
      * |len| not being multiple of complete blocks can be observed
@@ -7,7 +7,9 @@
  * https://www.openssl.org/source/license.html
  */
 
-#include "internal/cryptlib.h"
+#include "internal/cryptlib_int.h"
+#include "internal/thread_once.h"
+#include "internal/bn_int.h"
 #include "bn_lcl.h"
 
 /*-
@@ -45,6 +47,8 @@ typedef struct bignum_pool {
     BN_POOL_ITEM *head, *current, *tail;
     /* Stack depth and allocation size */
     unsigned used, size;
+    /* Most bignums handed out since BN_POOL_init() or bn_ctx_reset() */
+    unsigned dirty;
 } BN_POOL;
 static void BN_POOL_init(BN_POOL *);
 static void BN_POOL_finish(BN_POOL *);
@@ -131,7 +135,69 @@ static void ctxdbg(BN_CTX *ctx)
 #endif
 
 
-BN_CTX *BN_CTX_new(void)
+/*-
+ * Each thread keeps up to BN_CTX_CACHE_NUM of the contexts it frees, with
+ * their bignums and the limbs these have grown to, and BN_CTX_new() hands
+ * them out again.  Public key operations that make a context of their own
+ * every time, as most of them do when passed NULL, then hardly allocate
+ * anything for it.  The limbs are cleansed before a context is kept.
+ * Contexts for the secure heap, and those whose limbs take more than
+ * BN_CTX_CACHE_MAX_BYTES, are freed as they always were.
+ */
+#define BN_CTX_CACHE_NUM        2
+#define BN_CTX_CACHE_MAX_BYTES  (32 * 1024)
+
+typedef struct {
+    int num;
+    BN_CTX *ctxs[BN_CTX_CACHE_NUM];
+} BN_CTX_CACHE;
+
+static CRYPTO_ONCE bn_ctx_cache_init = CRYPTO_ONCE_STATIC_INIT;
+static int bn_ctx_cache_inited = 0;
+static CRYPTO_THREAD_LOCAL bn_ctx_cache;
+
+DEFINE_RUN_ONCE_STATIC(do_bn_ctx_cache_init)
+{
+    /*
+     * ensure that libcrypto is initialized, otherwise the thread local
+     * cache is not cleaned up properly
+     */
+    if (!OPENSSL_init_crypto(OPENSSL_INIT_BASE_ONLY, NULL))
+        return 0;
+
+    bn_ctx_cache_inited = CRYPTO_THREAD_init_local(&bn_ctx_cache, NULL);
+    return bn_ctx_cache_inited;
+}
+
+/*
+ * Return the calling thread's context cache, creating it if |create| is set
+ * and there is none yet.
+ */
+static BN_CTX_CACHE *bn_ctx_get_cache(int create)
+{
+    BN_CTX_CACHE *cache;
+
+    if (!RUN_ONCE(&bn_ctx_cache_init, do_bn_ctx_cache_init)
+            || !bn_ctx_cache_inited)
+        return NULL;
+
+    cache = CRYPTO_THREAD_get_local(&bn_ctx_cache);
+    if (cache == NULL && create) {
+        /* No new caches once OPENSSL_cleanup() has started */
+        if (!OPENSSL_init_crypto(OPENSSL_INIT_BASE_ONLY, NULL)
+                || !ossl_init_thread_start(OPENSSL_INIT_THREAD_BN_CTX))
+            return NULL;
+        if ((cache = OPENSSL_zalloc(sizeof(*cache))) == NULL)
+            return NULL;
+        if (!CRYPTO_THREAD_set_local(&bn_ctx_cache, cache)) {
+            OPENSSL_free(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+static BN_CTX *bn_ctx_new_int(void)
 {
     BN_CTX *ret;
 
@@ -145,19 +211,8 @@ BN_CTX *BN_CTX_new(void)
     return ret;
 }
 
-BN_CTX *BN_CTX_secure_new(void)
-{
-    BN_CTX *ret = BN_CTX_new();
-
-    if (ret != NULL)
-        ret->flags = BN_FLG_SECURE;
-    return ret;
-}
-
-void BN_CTX_free(BN_CTX *ctx)
+static void bn_ctx_free_int(BN_CTX *ctx)
 {
-    if (ctx == NULL)
-        return;
 #ifdef BN_CTX_DEBUG
     {
         BN_POOL_ITEM *pool = ctx->pool.head;
@@ -178,6 +233,109 @@ void BN_CTX_free(BN_CTX *ctx)
     OPENSSL_free(ctx);
 }
 
+/*
+ * Put |ctx| back into the state BN_CTX_new() returns it in, keeping the
+ * limbs of its bignums.  Returns 0, leaving |ctx| alone, if it can't be
+ * kept.
+ */
+static int bn_ctx_reset(BN_CTX *ctx)
+{
+    BN_POOL_ITEM *item;
+    BIGNUM *bn;
+    size_t bytes = 0;
+    unsigned int loop, dirty;
+
+    if ((ctx->flags & BN_FLG_SECURE) != 0)
+        return 0;
+    for (item = ctx->pool.head; item != NULL; item = item->next) {
+        for (loop = 0, bn = item->vals; loop++ < BN_CTX_POOL_SIZE; bn++) {
+            if (BN_get_flags(bn, BN_FLG_STATIC_DATA))
+                return 0;
+            bytes += bn->dmax * sizeof(BN_ULONG);
+        }
+    }
+    if (bytes > BN_CTX_CACHE_MAX_BYTES)
+        return 0;
+
+    /* Only the bignums handed out since the last reset can hold anything */
+    for (item = ctx->pool.head, dirty = ctx->pool.dirty; dirty > 0;
+         item = item->next) {
+        for (loop = 0, bn = item->vals;
+             loop < BN_CTX_POOL_SIZE && dirty > 0; loop++, bn++, dirty--) {
+            if (bn->d != NULL)
+                OPENSSL_cleanse(bn->d, bn->dmax * sizeof(BN_ULONG));
+            bn->top = 0;
+            bn->neg = 0;
+            bn->flags = 0;
+        }
+    }
+    ctx->pool.used = ctx->pool.dirty = 0;
+    ctx->pool.current = ctx->pool.head;
+    ctx->stack.depth = 0;
+    ctx->used = 0;
+    ctx->err_stack = 0;
+    ctx->too_many = 0;
+    return 1;
+}
+
+void bn_ctx_cleanup_int(void)
+{
+    if (bn_ctx_cache_inited) {
+        CRYPTO_THREAD_cleanup_local(&bn_ctx_cache);
+        bn_ctx_cache_inited = 0;
+    }
+}
+
+void bn_ctx_delete_thread_state(void)
+{
+    BN_CTX_CACHE *cache;
+
+    if (!bn_ctx_cache_inited)
+        return;
+
+    cache = CRYPTO_THREAD_get_local(&bn_ctx_cache);
+    CRYPTO_THREAD_set_local(&bn_ctx_cache, NULL);
+    if (cache == NULL)
+        return;
+
+    while (cache->num > 0)
+        bn_ctx_free_int(cache->ctxs[--cache->num]);
+    OPENSSL_free(cache);
+}
+
+BN_CTX *BN_CTX_new(void)
+{
+    BN_CTX_CACHE *cache = bn_ctx_get_cache(0);
+
+    if (cache != NULL && cache->num > 0)
+        return cache->ctxs[--cache->num];
+    return bn_ctx_new_int();
+}
+
+BN_CTX *BN_CTX_secure_new(void)
+{
+    BN_CTX *ret = bn_ctx_new_int();
+
+    if (ret != NULL)
+        ret->flags = BN_FLG_SECURE;
+    return ret;
+}
+
+void BN_CTX_free(BN_CTX *ctx)
+{
+    BN_CTX_CACHE *cache;
+
+    if (ctx == NULL)
+        return;
+    if ((ctx->flags & BN_FLG_SECURE) == 0
+            && (cache = bn_ctx_get_cache(1)) != NULL
+            && cache->num < BN_CTX_CACHE_NUM && bn_ctx_reset(ctx)) {
+        cache->ctxs[cache->num++] = ctx;
+        return;
+    }
+    bn_ctx_free_int(ctx);
+}
+
 void BN_CTX_start(BN_CTX *ctx)
 {
     CTXDBG_ENTRY("BN_CTX_start", ctx);
@@ -283,7 +441,7 @@ static unsigned int BN_STACK_pop(BN_STACK *st)
 static void BN_POOL_init(BN_POOL *p)
 {
     p->head = p->current = p->tail = NULL;
-    p->used = p->size = 0;
+    p->used = p->size = p->dirty = 0;
 }
 
 static void BN_POOL_finish(BN_POOL *p)
@@ -332,6 +490,7 @@ static BIGNUM *BN_POOL_get(BN_POOL *p, int flag)
         }
         p->size += BN_CTX_POOL_SIZE;
         p->used++;
+        p->dirty = p->used;
         /* Return the first bignum from the new pool */
         return item->vals;
     }
@@ -340,6 +499,8 @@ static BIGNUM *BN_POOL_get(BN_POOL *p, int flag)
         p->current = p->head;
     else if ((p->used % BN_CTX_POOL_SIZE) == 0)
         p->current = p->current->next;
+    if (p->used == p->dirty)
+        p->dirty++;
     return p->current->vals + ((p->used++) % BN_CTX_POOL_SIZE);
 }
 
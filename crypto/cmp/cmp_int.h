@@ -697,6 +697,8 @@ X509_EXTENSIONS *CMP_exts_dup(X509_EXTENSIONS *extin);
 
 /* from cmp_lib.c */
 void CMP_add_error_txt(const char *separator, const char *txt);
+void CMP_add_error_name(const char *separator,
+                        OPENSSL_CMP_CONST X509_NAME *name);
 # define CMP_add_error_data(txt) CMP_add_error_txt(":", txt)
 # define CMP_add_error_line(txt) CMP_add_error_txt("\n", txt)
 
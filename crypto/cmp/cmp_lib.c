@@ -45,58 +45,69 @@
 #include "cmp_int.h"
 
 
+static void free_error_arg(void *arg)
+{
+    OPENSSL_free(arg);
+}
+
 /*
  * Appends text to the extra error data field of the last error message in
- * OpenSSL's error queue, after adding the given separator string. Note that,
- * in contrast, ERR_add_error_data() simply overwrites the previous contents
- * of the error data.
+ * OpenSSL's error queue, after adding the given separator string, which must
+ * be a string literal. Note that, in contrast, ERR_add_error_data() simply
+ * overwrites the previous contents of the error data. The data is only put
+ * together if it is ever retrieved, and not at all between
+ * ERR_suppress_start() and ERR_suppress_end().
  */
 void CMP_add_error_txt(const char *separator, const char *txt)
 {
-    const char *file;
-    int line;
-    const char *data;
-    int flags;
-
-    unsigned long err = ERR_peek_last_error();
-    if (!err) {
-        ERR_PUT_error(ERR_LIB_CMP, 0, err, "", 0);
-    }
+    if (ERR_peek_last_error() == 0)
+        ERR_PUT_error(ERR_LIB_CMP, 0, 0, "", 0);
+    ERR_add_error_data_deferred(separator, NULL,
+                                txt != NULL ? OPENSSL_strdup(txt) : NULL,
+                                free_error_arg);
+}
 
-#define MAX_DATA_LEN 4096-100 /* workaround for ERR_print_errors_cb() limit */
-    do {
-        const char *curr, *next;
-        int len;
-        char *tmp;
-        ERR_peek_last_error_line_data(&file, &line, &data, &flags);
-        if (!(flags & ERR_TXT_STRING))
-            data = "";
-        len = (int)strlen(data);
-        curr = next = txt;
-        while (*next && len + strlen(separator) + (next - txt) < MAX_DATA_LEN) {
-            curr = next;
-            if (*separator) {
-                next = strstr(curr, separator);
-                if (next)
-                    next += strlen(separator);
-                else
-                    next = curr + strlen(curr);
-            } else
-                next = curr + 1;
-        }
-        if (*next) { /* split error msg in case error data would get too long */
-            if (curr != txt) {
-                tmp = OPENSSL_strndup(txt, curr - txt);
-                ERR_add_error_data(3, data, separator, tmp);
-                free(tmp);
-            }
-            ERR_PUT_error(ERR_LIB_CMP, 0/* func */, err, file, line);
-            txt = curr;
-        } else {
-            ERR_add_error_data(3, data, separator, txt);
-            txt = next;
-        }
-    } while (*txt);
+/* The DER encoding of a name, which is all that is needed to print it later */
+typedef struct {
+    long len;
+    unsigned char der[1];
+} CMP_ERROR_NAME;
+
+static char *format_error_name(void *arg)
+{
+    CMP_ERROR_NAME *en = arg;
+    const unsigned char *p = en->der;
+    X509_NAME *name = d2i_X509_NAME(NULL, &p, en->len);
+    char *ret = name != NULL ? X509_NAME_oneline(name, NULL, 0) : NULL;
+
+    X509_NAME_free(name);
+    return ret;
+}
+
+/*
+ * Like CMP_add_error_txt() with the text form of |name|, or "(none)", which is
+ * only produced if the error data is ever retrieved.
+ */
+void CMP_add_error_name(const char *separator,
+                        OPENSSL_CMP_CONST X509_NAME *name)
+{
+    CMP_ERROR_NAME *en;
+    unsigned char *p;
+    int len;
+
+    if (name == NULL) {
+        CMP_add_error_txt(separator, "(none)");
+        return;
+    }
+    if (ERR_peek_last_error() == 0)
+        ERR_PUT_error(ERR_LIB_CMP, 0, 0, "", 0);
+    if ((len = i2d_X509_NAME((X509_NAME *)name, NULL)) <= 0
+            || (en = OPENSSL_malloc(sizeof(*en) + len)) == NULL)
+        return;
+    p = en->der;
+    en->len = i2d_X509_NAME((X509_NAME *)name, &p);
+    ERR_add_error_data_deferred(separator, format_error_name, en,
+                                free_error_arg);
 }
 
 /* returns the header of the given CMP message or NULL on error */
@@ -1536,14 +1547,13 @@ STACK_OF(X509) *OSSL_CMP_build_cert_chain(const STACK_OF(X509) *certs,
     if (!X509_STORE_CTX_init(csc, store, (X509 *)cert, NULL))
         goto err;
 
-    (void)ERR_set_mark();
+    /* don't leave any new errors in the queue, nor put their data together */
+    (void)ERR_suppress_start();
     /*
      * ignore return value as it would fail without trust anchor given in store
      */
     (void)X509_verify_cert(csc);
-
-    /* don't leave any new errors in the queue */
-    (void)ERR_pop_to_mark();
+    (void)ERR_suppress_end();
 
     chain = X509_STORE_CTX_get0_chain(csc);
 
@@ -328,14 +328,9 @@ static void add_name_mismatch_data(const char *error_prefix,
                                    OPENSSL_CMP_CONST X509_NAME *actual_name,
                                    OPENSSL_CMP_CONST X509_NAME *expected_name)
 {
-    char *expected = X509_NAME_oneline(expected_name, NULL, 0);
-    char *actual = actual_name ? X509_NAME_oneline(actual_name, NULL, 0)
-                               : "(none)";
     CMP_add_error_txt("", error_prefix);
-    CMP_add_error_txt("\n   actual = ", actual);
-    CMP_add_error_txt("\n expected = ", expected);
-    OPENSSL_free(expected);
-    OPENSSL_free(actual);
+    CMP_add_error_name("\n   actual = ", actual_name);
+    CMP_add_error_name("\n expected = ", expected_name);
 }
 
 /* return 0 if skid != NULL and there is no matching subject key ID in cert */
@@ -435,11 +430,9 @@ static int find_acceptable_certs(STACK_OF(X509) *certs,
 
     for (i = 0; i < sk_X509_num(certs); i++) { /* certs may be NULL */
         X509 *cert = sk_X509_value(certs, i);
-        char *str = X509_NAME_oneline(X509_get_subject_name(cert), NULL, 0);
 
         CMP_add_error_line("  considering cert with subject");
-        CMP_add_error_txt(" = ", str);
-        OPENSSL_free(str);
+        CMP_add_error_name(" = ", X509_get_subject_name(cert));
 
         if (cert_acceptable(cert, msg, ts) &&
             !OSSL_CMP_sk_X509_add1_cert(sk, cert, 1/* no duplicates */))
@@ -551,12 +544,14 @@ static X509 *find_srvcert(OSSL_CMP_CTX *ctx, const OSSL_CMP_MSG *msg)
         STACK_OF(X509) *found_crts = NULL;
         int i;
 
-        /* tentatively set error, which allows accumulating diagnostic info */
-        char *sname = X509_NAME_oneline(sender->d.directoryName, NULL, 0);
+        /*
+         * tentatively set error, which allows accumulating diagnostic info,
+         * which is only formatted if the error is kept and looked at
+         */
         (void)ERR_set_mark();
         CMPerr(CMP_F_FIND_SRVCERT, CMP_R_NO_VALID_SERVER_CERT_FOUND);
-        CMP_add_error_txt("\ntrying to match msg sender name = ", sname);
-        OPENSSL_free(sname);
+        CMP_add_error_name("\ntrying to match msg sender name = ",
+                           sender->d.directoryName);
 
         /* release any cached cert, which is no more acceptable */
         if (ctx->validatedSrvCert)
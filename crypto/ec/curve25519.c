@@ -10,6 +10,7 @@
 #include <string.h>
 #include "ec_lcl.h"
 #include <openssl/sha.h>
+#include <openssl/rand.h>
 
 #if defined(X25519_ASM) && (defined(__x86_64) || defined(__x86_64__) || \
                             defined(_M_AMD64) || defined(_M_X64))
@@ -4425,22 +4426,11 @@ static const ge_precomp Bi[8] = {
     },
 };
 
-/* r = a * A + b * B
- * where a = a[0]+256*a[1]+...+256^31 a[31].
- * and b = b[0]+256*b[1]+...+256^31 b[31].
- * B is the Ed25519 base point (x,4/5) with x positive. */
-static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
-                                         const ge_p3 *A, const uint8_t *b) {
-  signed char aslide[256];
-  signed char bslide[256];
-  ge_cached Ai[8]; /* A,3A,5A,7A,9A,11A,13A,15A */
+/* Ai = A,3A,5A,7A,9A,11A,13A,15A */
+static void ge_precompute_odd_multiples(ge_cached Ai[8], const ge_p3 *A) {
   ge_p1p1 t;
   ge_p3 u;
   ge_p3 A2;
-  int i;
-
-  slide(aslide, a);
-  slide(bslide, b);
 
   ge_p3_to_cached(&Ai[0], A);
   ge_p3_dbl(&t, A);
@@ -4466,6 +4456,24 @@ static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
   ge_add(&t, &A2, &Ai[6]);
   ge_p1p1_to_p3(&u, &t);
   ge_p3_to_cached(&Ai[7], &u);
+}
+
+/* r = a * A + b * B
+ * where a = a[0]+256*a[1]+...+256^31 a[31].
+ * and b = b[0]+256*b[1]+...+256^31 b[31].
+ * B is the Ed25519 base point (x,4/5) with x positive.
+ * Ai are the odd multiples of A from ge_precompute_odd_multiples(). */
+static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
+                                         const ge_cached Ai[8],
+                                         const uint8_t *b) {
+  signed char aslide[256];
+  signed char bslide[256];
+  ge_p1p1 t;
+  ge_p3 u;
+  int i;
+
+  slide(aslide, a);
+  slide(bslide, b);
 
   ge_p2_0(r);
 
@@ -5371,9 +5379,56 @@ int ED25519_sign(uint8_t *out_sig, const uint8_t *message, size_t message_len,
   return 1;
 }
 
-int ED25519_verify(const uint8_t *message, size_t message_len,
-                   const uint8_t signature[64], const uint8_t public_key[32]) {
+struct ed25519_verify_ctx_st {
+  uint8_t public_key[32];
+  /* Odd multiples of the negated public key point */
+  ge_cached Ai[8];
+  /* Whether the public key is a point of small order */
+  int small_order;
+};
+
+/* Returns whether 8 * |P| is the identity. */
+static int ge_p3_has_small_order(const ge_p3 *P) {
+  static const uint8_t kIdentity[32] = {1};
+  uint8_t s[32];
+  ge_p2 q;
+  ge_p1p1 t;
+  int i;
+
+  ge_p3_to_p2(&q, P);
+  for (i = 0; i < 3; i++) {
+    ge_p2_dbl(&t, &q);
+    ge_p1p1_to_p2(&q, &t);
+  }
+  ge_tobytes(s, &q);
+
+  return CRYPTO_memcmp(s, kIdentity, sizeof(s)) == 0;
+}
+
+/* Decodes |public_key| to the odd multiples of its negation. */
+static int ed25519_precompute_public(ge_cached Ai[8], int *small_order,
+                                     const uint8_t public_key[32]) {
   ge_p3 A;
+
+  if (ge_frombytes_vartime(&A, public_key) != 0) {
+    return 0;
+  }
+  if (small_order != NULL) {
+    *small_order = ge_p3_has_small_order(&A);
+  }
+
+  fe_neg(A.X, A.X);
+  fe_neg(A.T, A.T);
+
+  ge_precompute_odd_multiples(Ai, &A);
+  return 1;
+}
+
+static int ed25519_verify_precomputed(const uint8_t *message,
+                                      size_t message_len,
+                                      const uint8_t signature[64],
+                                      const uint8_t public_key[32],
+                                      const ge_cached Ai[8]) {
   uint8_t rcopy[32];
   uint8_t scopy[32];
   SHA512_CTX hash_ctx;
@@ -5381,14 +5436,10 @@ int ED25519_verify(const uint8_t *message, size_t message_len,
   uint8_t rcheck[32];
   uint8_t h[SHA512_DIGEST_LENGTH];
 
-  if ((signature[63] & 224) != 0 ||
-      ge_frombytes_vartime(&A, public_key) != 0) {
+  if ((signature[63] & 224) != 0) {
     return 0;
   }
 
-  fe_neg(A.X, A.X);
-  fe_neg(A.T, A.T);
-
   memcpy(rcopy, signature, 32);
   memcpy(scopy, signature + 32, 32);
 
@@ -5400,13 +5451,255 @@ int ED25519_verify(const uint8_t *message, size_t message_len,
 
   x25519_sc_reduce(h);
 
-  ge_double_scalarmult_vartime(&R, h, &A, scopy);
+  ge_double_scalarmult_vartime(&R, h, Ai, scopy);
 
   ge_tobytes(rcheck, &R);
 
   return CRYPTO_memcmp(rcheck, rcopy, sizeof(rcheck)) == 0;
 }
 
+int ED25519_verify(const uint8_t *message, size_t message_len,
+                   const uint8_t signature[64], const uint8_t public_key[32]) {
+  ge_cached Ai[8];
+
+  if ((signature[63] & 224) != 0 ||
+      !ed25519_precompute_public(Ai, NULL, public_key)) {
+    return 0;
+  }
+
+  return ed25519_verify_precomputed(message, message_len, signature,
+                                    public_key, Ai);
+}
+
+ED25519_VERIFY_CTX *ED25519_verify_ctx_new(const uint8_t public_key[32]) {
+  ED25519_VERIFY_CTX *vctx = OPENSSL_malloc(sizeof(*vctx));
+
+  if (vctx == NULL) {
+    return NULL;
+  }
+  if (!ed25519_precompute_public(vctx->Ai, &vctx->small_order, public_key)) {
+    OPENSSL_free(vctx);
+    return NULL;
+  }
+  memcpy(vctx->public_key, public_key, sizeof(vctx->public_key));
+
+  return vctx;
+}
+
+void ED25519_verify_ctx_free(ED25519_VERIFY_CTX *vctx) {
+  OPENSSL_free(vctx);
+}
+
+int ED25519_verify_ctx(const ED25519_VERIFY_CTX *vctx, const uint8_t *message,
+                       size_t message_len, const uint8_t signature[64]) {
+  return ed25519_verify_precomputed(message, message_len, signature,
+                                    vctx->public_key, vctx->Ai);
+}
+
+/* Returns the |c| bits of the little-endian scalar |s| from bit |pos| on. */
+static unsigned int scalar_window(const uint8_t s[32], int pos, int c) {
+  unsigned int w = s[pos >> 3] >> (pos & 7);
+
+  if ((pos & 7) + c > 8 && (pos >> 3) < 31) {
+    w |= (unsigned int)s[(pos >> 3) + 1] << (8 - (pos & 7));
+  }
+  return w & ((1u << c) - 1);
+}
+
+/* r = scalars[0] * points[0] + ... + scalars[num-1] * points[num-1]
+ * for scalars below 2^253, using Pippenger's bucket method. Returns 0 on
+ * allocation failure. */
+static int ge_multi_scalarmult_vartime(ge_p3 *r, const uint8_t (*scalars)[32],
+                                       const ge_cached *points, size_t num) {
+  ge_p3 *buckets;
+  ge_p3 sum;
+  ge_p3 acc;
+  ge_p2 q;
+  ge_p1p1 t;
+  ge_cached cached;
+  size_t i;
+  unsigned int w;
+  int c = 2;
+  int best;
+  int cost;
+  int pos;
+  int b;
+  int k;
+
+  /* Pick the window size that minimises the number of additions */
+  best = (int)((num + (2u << c)) * ((253 + c - 1) / c));
+  for (k = 3; k <= 8; k++) {
+    cost = (int)((num + (2u << k)) * ((253 + k - 1) / k));
+    if (cost < best) {
+      best = cost;
+      c = k;
+    }
+  }
+
+  buckets = OPENSSL_malloc(((size_t)1 << c) * sizeof(*buckets));
+  if (buckets == NULL) {
+    return 0;
+  }
+
+  ge_p3_0(r);
+  for (pos = ((253 + c - 1) / c - 1) * c; pos >= 0; pos -= c) {
+    /* r = 2^c * r */
+    ge_p3_to_p2(&q, r);
+    for (k = 0; k < c - 1; k++) {
+      ge_p2_dbl(&t, &q);
+      ge_p1p1_to_p2(&q, &t);
+    }
+    ge_p2_dbl(&t, &q);
+    ge_p1p1_to_p3(r, &t);
+
+    for (b = 0; b < (1 << c); b++) {
+      ge_p3_0(&buckets[b]);
+    }
+    for (i = 0; i < num; i++) {
+      w = scalar_window(scalars[i], pos, c);
+      if (w != 0) {
+        ge_add(&t, &buckets[w], &points[i]);
+        ge_p1p1_to_p3(&buckets[w], &t);
+      }
+    }
+
+    /* acc = sum of b * buckets[b], accumulated from the top */
+    ge_p3_0(&sum);
+    ge_p3_0(&acc);
+    for (b = (1 << c) - 1; b > 0; b--) {
+      ge_p3_to_cached(&cached, &buckets[b]);
+      ge_add(&t, &sum, &cached);
+      ge_p1p1_to_p3(&sum, &t);
+      ge_p3_to_cached(&cached, &sum);
+      ge_add(&t, &acc, &cached);
+      ge_p1p1_to_p3(&acc, &t);
+    }
+
+    ge_p3_to_cached(&cached, &acc);
+    ge_add(&t, r, &cached);
+    ge_p1p1_to_p3(r, &t);
+  }
+
+  OPENSSL_free(buckets);
+  return 1;
+}
+
+/* Checks sum(z_i * s_i) * B - sum(z_i * R_i) - sum(z_i * h_i * A_i), with
+ * random 128-bit z_i, is a point of small order, which holds if all the
+ * signatures are valid. This is the cofactored verification equation of
+ * RFC 8032, which also holds for signatures that ED25519_verify() rejects
+ * because R or the public key has a small-order component. So that the
+ * batch never accepts such a signature, it is rejected up front if R is
+ * not canonically encoded, or if R or the public key has small order.
+ * Points that only have a small-order component are not caught: that
+ * takes a full scalar multiplication per point, more than the batch
+ * saves. Returns 1 if the equation holds, 0 if it does not or a signature
+ * was rejected and -1 on error. */
+int ED25519_verify_batch(const uint8_t *const message[],
+                         const size_t message_len[],
+                         const uint8_t *const signature[],
+                         const uint8_t *const public_key[],
+                         const ED25519_VERIFY_CTX *const vctx[], size_t num) {
+  static const uint8_t kZeros[32] = {0};
+  static const uint8_t kIdentity[32] = {1};
+  uint8_t (*scalars)[32] = NULL;
+  ge_cached *points = NULL;
+  uint8_t z[32];
+  uint8_t h[SHA512_DIGEST_LENGTH];
+  uint8_t bscalar[32];
+  uint8_t check[32];
+  SHA512_CTX hash_ctx;
+  ge_p3 P;
+  ge_p3 Q;
+  ge_p2 q;
+  ge_p1p1 t;
+  ge_cached cached;
+  size_t i;
+  int ret = -1;
+
+  scalars = OPENSSL_malloc(2 * num * sizeof(*scalars));
+  points = OPENSSL_malloc(2 * num * sizeof(*points));
+  if (scalars == NULL || points == NULL) {
+    goto err;
+  }
+
+  memset(z, 0, sizeof(z));
+  memset(bscalar, 0, sizeof(bscalar));
+  for (i = 0; i < num; i++) {
+    if ((signature[i][63] & 224) != 0 ||
+        ge_frombytes_vartime(&P, signature[i]) != 0) {
+      ret = 0;
+      goto err;
+    }
+    ge_p3_tobytes(check, &P);
+    if (CRYPTO_memcmp(check, signature[i], sizeof(check)) != 0 ||
+        ge_p3_has_small_order(&P)) {
+      ret = 0;
+      goto err;
+    }
+
+    /* points[2i] = -R_i, points[2i+1] = -A_i */
+    fe_neg(P.X, P.X);
+    fe_neg(P.T, P.T);
+    ge_p3_to_cached(&points[2 * i], &P);
+    if (vctx != NULL && vctx[i] != NULL) {
+      if (vctx[i]->small_order) {
+        ret = 0;
+        goto err;
+      }
+      points[2 * i + 1] = vctx[i]->Ai[0];
+    } else {
+      if (ge_frombytes_vartime(&P, public_key[i]) != 0 ||
+          ge_p3_has_small_order(&P)) {
+        ret = 0;
+        goto err;
+      }
+      fe_neg(P.X, P.X);
+      fe_neg(P.T, P.T);
+      ge_p3_to_cached(&points[2 * i + 1], &P);
+    }
+
+    SHA512_Init(&hash_ctx);
+    SHA512_Update(&hash_ctx, signature[i], 32);
+    SHA512_Update(&hash_ctx, public_key[i], 32);
+    SHA512_Update(&hash_ctx, message[i], message_len[i]);
+    SHA512_Final(h, &hash_ctx);
+    x25519_sc_reduce(h);
+
+    if (RAND_bytes(z, 16) <= 0) {
+      goto err;
+    }
+    memcpy(scalars[2 * i], z, 32);
+    sc_muladd(scalars[2 * i + 1], z, h, kZeros);
+    sc_muladd(bscalar, z, signature[i] + 32, bscalar);
+  }
+
+  if (!ge_multi_scalarmult_vartime(&Q, (const uint8_t (*)[32])scalars,
+                                   points, 2 * num)) {
+    goto err;
+  }
+  ge_scalarmult_base(&P, bscalar);
+  ge_p3_to_cached(&cached, &P);
+  ge_add(&t, &Q, &cached);
+
+  /* Clear the cofactor */
+  ge_p1p1_to_p2(&q, &t);
+  ge_p2_dbl(&t, &q);
+  ge_p1p1_to_p2(&q, &t);
+  ge_p2_dbl(&t, &q);
+  ge_p1p1_to_p2(&q, &t);
+  ge_p2_dbl(&t, &q);
+  ge_p1p1_to_p2(&q, &t);
+
+  ge_tobytes(check, &q);
+  ret = CRYPTO_memcmp(check, kIdentity, sizeof(check)) == 0;
+
+ err:
+  OPENSSL_free(scalars);
+  OPENSSL_free(points);
+  return ret;
+}
+
 void ED25519_public_from_private(uint8_t out_public_key[32],
                                  const uint8_t private_key[32]) {
   uint8_t az[SHA512_DIGEST_LENGTH];
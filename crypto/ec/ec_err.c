@@ -110,6 +110,12 @@ static const ERR_STRING_DATA EC_str_functs[] = {
      "ec_GFp_nistp256_points_mul"},
     {ERR_PACK(ERR_LIB_EC, EC_F_EC_GFP_NISTP256_POINT_GET_AFFINE_COORDINATES, 0),
      "ec_GFp_nistp256_point_get_affine_coordinates"},
+    {ERR_PACK(ERR_LIB_EC, EC_F_EC_GFP_NISTP384_GROUP_SET_CURVE, 0),
+     "ec_GFp_nistp384_group_set_curve"},
+    {ERR_PACK(ERR_LIB_EC, EC_F_EC_GFP_NISTP384_POINTS_MUL, 0),
+     "ec_GFp_nistp384_points_mul"},
+    {ERR_PACK(ERR_LIB_EC, EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES, 0),
+     "ec_GFp_nistp384_point_get_affine_coordinates"},
     {ERR_PACK(ERR_LIB_EC, EC_F_EC_GFP_NISTP521_GROUP_SET_CURVE, 0),
      "ec_GFp_nistp521_group_set_curve"},
     {ERR_PACK(ERR_LIB_EC, EC_F_EC_GFP_NISTP521_POINTS_MUL, 0),
@@ -246,6 +252,8 @@ static const ERR_STRING_DATA EC_str_functs[] = {
      "nistp224_pre_comp_new"},
     {ERR_PACK(ERR_LIB_EC, EC_F_NISTP256_PRE_COMP_NEW, 0),
      "nistp256_pre_comp_new"},
+    {ERR_PACK(ERR_LIB_EC, EC_F_NISTP384_PRE_COMP_NEW, 0),
+     "nistp384_pre_comp_new"},
     {ERR_PACK(ERR_LIB_EC, EC_F_NISTP521_PRE_COMP_NEW, 0),
      "nistp521_pre_comp_new"},
     {ERR_PACK(ERR_LIB_EC, EC_F_O2I_ECPUBLICKEY, 0), "o2i_ECPublicKey"},
@@ -253,6 +261,8 @@ static const ERR_STRING_DATA EC_str_functs[] = {
     {ERR_PACK(ERR_LIB_EC, EC_F_OSSL_ECDH_COMPUTE_KEY, 0),
      "ossl_ecdh_compute_key"},
     {ERR_PACK(ERR_LIB_EC, EC_F_OSSL_ECDSA_SIGN_SIG, 0), "ossl_ecdsa_sign_sig"},
+    {ERR_PACK(ERR_LIB_EC, EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, 0),
+     "ossl_ecdsa_verify_batch_sig"},
     {ERR_PACK(ERR_LIB_EC, EC_F_OSSL_ECDSA_VERIFY_SIG, 0),
      "ossl_ecdsa_verify_sig"},
     {ERR_PACK(ERR_LIB_EC, EC_F_PKEY_ECD_CTRL, 0), "pkey_ecd_ctrl"},
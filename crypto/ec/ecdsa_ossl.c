@@ -317,10 +317,32 @@ int ossl_ecdsa_verify(int type, const unsigned char *dgst, int dgst_len,
     return ret;
 }
 
+/*
+ * Convert the digest |dgst| to the integer |m| used in signature
+ * verification, truncating it to the bit length of |order|.
+ */
+static int ecdsa_digest_to_bn(const BIGNUM *order, const unsigned char *dgst,
+                              int dgst_len, BIGNUM *m)
+{
+    int i = BN_num_bits(order);
+
+    /*
+     * Need to truncate digest if it is too long: first truncate whole bytes.
+     */
+    if (8 * dgst_len > i)
+        dgst_len = (i + 7) / 8;
+    if (!BN_bin2bn(dgst, dgst_len, m))
+        return 0;
+    /* If still too long truncate remaining bits with a shift */
+    if ((8 * dgst_len > i) && !BN_rshift(m, m, 8 - (i & 0x7)))
+        return 0;
+    return 1;
+}
+
 int ossl_ecdsa_verify_sig(const unsigned char *dgst, int dgst_len,
                           const ECDSA_SIG *sig, EC_KEY *eckey)
 {
-    int ret = -1, i;
+    int ret = -1;
     BN_CTX *ctx;
     const BIGNUM *order;
     BIGNUM *u1, *u2, *m, *X;
@@ -374,18 +396,7 @@ int ossl_ecdsa_verify_sig(const unsigned char *dgst, int dgst_len,
         goto err;
     }
     /* digest -> m */
-    i = BN_num_bits(order);
-    /*
-     * Need to truncate digest if it is too long: first truncate whole bytes.
-     */
-    if (8 * dgst_len > i)
-        dgst_len = (i + 7) / 8;
-    if (!BN_bin2bn(dgst, dgst_len, m)) {
-        ECerr(EC_F_OSSL_ECDSA_VERIFY_SIG, ERR_R_BN_LIB);
-        goto err;
-    }
-    /* If still too long truncate remaining bits with a shift */
-    if ((8 * dgst_len > i) && !BN_rshift(m, m, 8 - (i & 0x7))) {
+    if (!ecdsa_digest_to_bn(order, dgst, dgst_len, m)) {
         ECerr(EC_F_OSSL_ECDSA_VERIFY_SIG, ERR_R_BN_LIB);
         goto err;
     }
@@ -436,3 +447,148 @@ int ossl_ecdsa_verify_sig(const unsigned char *dgst, int dgst_len,
     EC_POINT_free(point);
     return ret;
 }
+
+/*
+ * Verify the signatures idx[0], ..., idx[num - 1] of the arrays |dgst|,
+ * |dgst_len|, |sig| and |eckey| and store the outcome, as returned by
+ * ossl_ecdsa_verify_sig(), in |results|. All keys must be on |group|, which
+ * must be over a prime field, and |num| must not exceed
+ * ECDSA_VERIFY_BATCH_MAX. The inverses of all s values modulo the order and
+ * the affine coordinates of all resulting points are obtained with a single
+ * inversion each, using Montgomery's trick.
+ */
+void ossl_ecdsa_verify_batch_sig(const EC_GROUP *group,
+                                 const unsigned char *const dgst[],
+                                 const int dgst_len[],
+                                 const ECDSA_SIG *const sig[],
+                                 EC_KEY *const eckey[], const size_t idx[],
+                                 size_t num, int results[])
+{
+    BN_CTX *ctx = NULL;
+    const BIGNUM *order;
+    BIGNUM *acc[ECDSA_VERIFY_BATCH_MAX];
+    BIGNUM *inv, *w, *u1, *u2, *m, *X;
+    EC_POINT *points[ECDSA_VERIFY_BATCH_MAX];
+    size_t live[ECDSA_VERIFY_BATCH_MAX];
+    const ECDSA_SIG *s;
+    size_t i, n = 0;
+    int ok = 0;
+
+    order = EC_GROUP_get0_order(group);
+    for (i = 0; i < num; i++) {
+        s = sig[idx[i]];
+        if (BN_is_zero(s->r) || BN_is_negative(s->r)
+                || BN_ucmp(s->r, order) >= 0 || BN_is_zero(s->s)
+                || BN_is_negative(s->s) || BN_ucmp(s->s, order) >= 0) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, EC_R_BAD_SIGNATURE);
+            results[idx[i]] = 0;
+            continue;
+        }
+        points[n] = NULL;
+        live[n++] = idx[i];
+    }
+    if (n == 0)
+        return;
+
+    if ((ctx = BN_CTX_new()) == NULL) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+    BN_CTX_start(ctx);
+    for (i = 0; i < n; i++)
+        acc[i] = BN_CTX_get(ctx);
+    inv = BN_CTX_get(ctx);
+    w = BN_CTX_get(ctx);
+    u1 = BN_CTX_get(ctx);
+    u2 = BN_CTX_get(ctx);
+    m = BN_CTX_get(ctx);
+    X = BN_CTX_get(ctx);
+    if (X == NULL) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_BN_LIB);
+        goto err;
+    }
+
+    /* acc[i] = s_0 * ... * s_i mod order */
+    if (!BN_copy(acc[0], sig[live[0]]->s)) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_BN_LIB);
+        goto err;
+    }
+    for (i = 1; i < n; i++) {
+        if (!BN_mod_mul(acc[i], acc[i - 1], sig[live[i]]->s, order, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_BN_LIB);
+            goto err;
+        }
+    }
+    if (!ec_group_do_inverse_ord(group, inv, acc[n - 1], ctx)) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_BN_LIB);
+        goto err;
+    }
+
+    for (i = n; i-- > 0; ) {
+        s = sig[live[i]];
+        /*
+         * inv is the inverse of s_0 * ... * s_i, so w = inv(s_i) is inv
+         * times acc[i - 1], and the inverse of s_0 * ... * s_(i-1) is inv
+         * times s_i.
+         */
+        if (i > 0) {
+            if (!BN_mod_mul(w, inv, acc[i - 1], order, ctx)
+                    || !BN_mod_mul(inv, inv, s->s, order, ctx)) {
+                ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_BN_LIB);
+                goto err;
+            }
+        } else if (!BN_copy(w, inv)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_BN_LIB);
+            goto err;
+        }
+
+        /* u1 = m * w mod order, u2 = r * w mod order */
+        if (!ecdsa_digest_to_bn(order, dgst[live[i]], dgst_len[live[i]], m)
+                || !BN_mod_mul(u1, m, w, order, ctx)
+                || !BN_mod_mul(u2, s->r, w, order, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_BN_LIB);
+            goto err;
+        }
+        if ((points[i] = EC_POINT_new(group)) == NULL) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+        if (!EC_POINT_mul(group, points[i], u1,
+                          EC_KEY_get0_public_key(eckey[live[i]]), u2, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_EC_LIB);
+            goto err;
+        }
+    }
+
+    if (!EC_POINTs_make_affine(group, n, points, ctx)) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_EC_LIB);
+        goto err;
+    }
+    for (i = 0; i < n; i++) {
+        s = sig[live[i]];
+        if (EC_POINT_is_at_infinity(group, points[i])) {
+            results[live[i]] = 0;
+            continue;
+        }
+        if (!EC_POINT_get_affine_coordinates_GFp(group, points[i], X, NULL,
+                                                 ctx)
+                || !BN_nnmod(u1, X, order, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG, ERR_R_EC_LIB);
+            goto err;
+        }
+        /* if the signature is correct u1 is equal to sig->r */
+        results[live[i]] = (BN_ucmp(u1, s->r) == 0);
+    }
+    ok = 1;
+
+ err:
+    for (i = 0; i < n; i++) {
+        if (!ok)
+            results[live[i]] = -1;
+        EC_POINT_free(points[i]);
+    }
+    if (ctx != NULL) {
+        BN_CTX_end(ctx);
+        BN_CTX_free(ctx);
+    }
+}
@@ -26,6 +26,74 @@ int ECDSA_do_verify(const unsigned char *dgst, int dgst_len,
     return 0;
 }
 
+/*
+ * Whether the signature of |eckey| can be verified in a batch with the
+ * built-in implementation.
+ */
+static int ecdsa_can_batch(const ECDSA_SIG *sig, const EC_KEY *eckey)
+{
+    const EC_GROUP *group;
+
+    return sig != NULL && eckey != NULL
+           && eckey->meth->verify_sig == ossl_ecdsa_verify_sig
+           && (group = EC_KEY_get0_group(eckey)) != NULL
+           && EC_KEY_get0_public_key(eckey) != NULL
+           && EC_KEY_can_sign(eckey)
+           && EC_METHOD_get_field_type(EC_GROUP_method_of(group))
+              == NID_X9_62_prime_field;
+}
+
+/*-
+ * returns
+ *      1: all signatures correct
+ *      0: at least one incorrect signature
+ *     -1: error
+ * and stores the ECDSA_do_verify() result of each signature in |results|.
+ */
+int ECDSA_do_verify_batch(const unsigned char *const dgst[],
+                          const int dgst_len[], const ECDSA_SIG *const sig[],
+                          EC_KEY *const eckey[], size_t num, int results[])
+{
+    size_t batch[ECDSA_VERIFY_BATCH_MAX];
+    const EC_GROUP *group;
+    size_t i, j, n;
+    int ret = 1;
+
+    /* 2 marks the signatures still to be verified */
+    for (i = 0; i < num; i++)
+        results[i] = 2;
+
+    for (i = 0; i < num; i++) {
+        if (results[i] != 2)
+            continue;
+        if (!ecdsa_can_batch(sig[i], eckey[i])) {
+            results[i] = ECDSA_do_verify(dgst[i], dgst_len[i], sig[i],
+                                         eckey[i]);
+            continue;
+        }
+
+        /* Collect the following signatures with keys on the same curve */
+        group = EC_KEY_get0_group(eckey[i]);
+        batch[0] = i;
+        for (j = i + 1, n = 1; j < num && n < ECDSA_VERIFY_BATCH_MAX; j++) {
+            if (results[j] == 2 && ecdsa_can_batch(sig[j], eckey[j])
+                    && EC_GROUP_cmp(group, EC_KEY_get0_group(eckey[j]),
+                                    NULL) == 0)
+                batch[n++] = j;
+        }
+        ossl_ecdsa_verify_batch_sig(group, dgst, dgst_len, sig, eckey, batch,
+                                    n, results);
+    }
+
+    for (i = 0; i < num; i++) {
+        if (results[i] < 0)
+            return -1;
+        if (results[i] == 0)
+            ret = 0;
+    }
+    return ret;
+}
+
 /*-
  * returns
  *      1: correct signature
@@ -0,0 +1,1554 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * A 64-bit constant-time implementation of the NIST P-384 elliptic curve
+ * point multiplication
+ *
+ * The point operations, the precomputation and the scalar multiplication
+ * follow ecp_nistp224.c; the field arithmetic uses Montgomery multiplication
+ * on fully reduced elements.
+ */
+
+#include <openssl/opensslconf.h>
+#ifdef OPENSSL_NO_EC_NISTP_64_GCC_128
+NON_EMPTY_TRANSLATION_UNIT
+#else
+
+# include <stdint.h>
+# include <string.h>
+# include <openssl/err.h>
+# include "ec_lcl.h"
+
+# if defined(__SIZEOF_INT128__) && __SIZEOF_INT128__==16
+  /* even with gcc, the typedef won't work for 32-bit platforms */
+typedef __uint128_t uint128_t;  /* nonstandard; implemented by gcc on 64-bit
+                                 * platforms */
+typedef __int128_t int128_t;
+# else
+#  error "Your compiler doesn't appear to support 128-bit integer types"
+# endif
+
+typedef uint8_t u8;
+typedef uint64_t u64;
+
+/******************************************************************************/
+/*-
+ * INTERNAL REPRESENTATION OF FIELD ELEMENTS
+ *
+ * Field elements are represented as a_0 + 2^64*a_1 + ... + 2^320*a_5 using
+ * 64-bit 'limbs', in the Montgomery domain: the element x is stored as
+ * x*2^384 mod p. Unlike the other nistp implementations, every field
+ * operation returns its result fully reduced, i.e. less than p, so there is
+ * no bookkeeping of limb bounds and felem_contract is a plain copy.
+ */
+
+# define NLIMBS 6
+
+typedef uint64_t limb;
+typedef limb felem[NLIMBS];
+typedef limb widefelem[2 * NLIMBS];
+
+/*
+ * Field element represented as a byte array. 48*8 = 384 bits is also the
+ * group order size for the elliptic curve, and we also use this type for
+ * scalars for point multiplication.
+ */
+typedef u8 felem_bytearray[48];
+
+static const felem_bytearray nistp384_curve_params[5] = {
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, /* p */
+     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+     0xFF, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, /* a */
+     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+     0xFF, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFC},
+    {0xB3, 0x31, 0x2F, 0xA7, 0xE2, 0x3E, 0xE7, 0xE4, 0x98, 0x8E, /* b */
+     0x05, 0x6B, 0xE3, 0xF8, 0x2D, 0x19, 0x18, 0x1D, 0x9C, 0x6E,
+     0xFE, 0x81, 0x41, 0x12, 0x03, 0x14, 0x08, 0x8F, 0x50, 0x13,
+     0x87, 0x5A, 0xC6, 0x56, 0x39, 0x8D, 0x8A, 0x2E, 0xD1, 0x9D,
+     0x2A, 0x85, 0xC8, 0xED, 0xD3, 0xEC, 0x2A, 0xEF},
+    {0xAA, 0x87, 0xCA, 0x22, 0xBE, 0x8B, 0x05, 0x37, 0x8E, 0xB1, /* x */
+     0xC7, 0x1E, 0xF3, 0x20, 0xAD, 0x74, 0x6E, 0x1D, 0x3B, 0x62,
+     0x8B, 0xA7, 0x9B, 0x98, 0x59, 0xF7, 0x41, 0xE0, 0x82, 0x54,
+     0x2A, 0x38, 0x55, 0x02, 0xF2, 0x5D, 0xBF, 0x55, 0x29, 0x6C,
+     0x3A, 0x54, 0x5E, 0x38, 0x72, 0x76, 0x0A, 0xB7},
+    {0x36, 0x17, 0xDE, 0x4A, 0x96, 0x26, 0x2C, 0x6F, 0x5D, 0x9E, /* y */
+     0x98, 0xBF, 0x92, 0x92, 0xDC, 0x29, 0xF8, 0xF4, 0x1D, 0xBD,
+     0x28, 0x9A, 0x14, 0x7C, 0xE9, 0xDA, 0x31, 0x13, 0xB5, 0xF0,
+     0xB8, 0xC0, 0x0A, 0x60, 0xB1, 0xCE, 0x1D, 0x7E, 0x81, 0x9D,
+     0x7A, 0x43, 0x1D, 0x7C, 0x90, 0xEA, 0x0E, 0x5F}
+};
+
+/* p = 2^384 - 2^128 - 2^96 + 2^32 - 1 */
+static const felem kPrime = {
+    0x00000000ffffffff, 0xffffffff00000000, 0xfffffffffffffffe,
+    0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff
+};
+
+/* -p^-1 mod 2^64 */
+static const limb kPrimeN0 = 0x0000000100000001;
+
+/* 2^768 mod p, to convert into the Montgomery domain */
+static const felem kRR = {
+    0xfffffffe00000001, 0x0000000200000000, 0xfffffffe00000000,
+    0x0000000200000000, 0x0000000000000001, 0x0000000000000000
+};
+
+/* 1 in the Montgomery domain, i.e. 2^384 mod p */
+static const felem kOne = {
+    0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000
+};
+
+/*-
+ * Precomputed multiples of the standard generator
+ * Points are given in coordinates (X, Y, Z) where Z normally is 1
+ * (0 for the point at infinity), all in the Montgomery domain.
+ * For each field element, slice a_0 is word 0, etc.
+ *
+ * The table has 2 * 16 elements, starting with the following:
+ * index | bits    | point
+ * ------+---------+------------------------------
+ *     0 | 0 0 0 0 | 0G
+ *     1 | 0 0 0 1 | 1G
+ *     2 | 0 0 1 0 | 2^96G
+ *     3 | 0 0 1 1 | (2^96 + 1)G
+ *     4 | 0 1 0 0 | 2^192G
+ *     5 | 0 1 0 1 | (2^192 + 1)G
+ *     6 | 0 1 1 0 | (2^192 + 2^96)G
+ *     7 | 0 1 1 1 | (2^192 + 2^96 + 1)G
+ *     8 | 1 0 0 0 | 2^288G
+ *     9 | 1 0 0 1 | (2^288 + 1)G
+ *    10 | 1 0 1 0 | (2^288 + 2^96)G
+ *    11 | 1 0 1 1 | (2^288 + 2^96 + 1)G
+ *    12 | 1 1 0 0 | (2^288 + 2^192)G
+ *    13 | 1 1 0 1 | (2^288 + 2^192 + 1)G
+ *    14 | 1 1 1 0 | (2^288 + 2^192 + 2^96)G
+ *    15 | 1 1 1 1 | (2^288 + 2^192 + 2^96 + 1)G
+ * followed by a copy of this with each element multiplied by 2^48.
+ *
+ * The reason for this is so that we can clock bits into four different
+ * locations when doing simple scalar multiplies against the base point,
+ * and then another four locations using the second 16 elements.
+ */
+static const felem gmul[2][16][3] = {
+{{{0, 0, 0, 0, 0, 0},
+  {0, 0, 0, 0, 0, 0},
+  {0, 0, 0, 0, 0, 0}},
+ {{0x3dd0756649c0b528, 0x20e378e2a0d6ce38, 0x879c3afc541b4d6e,
+   0x6454868459a30eff, 0x812ff723614ede2b, 0x4d3aadc2299e1513},
+  {0x23043dad4b03a4fe, 0xa1bfa8bf7bb4a9ac, 0x8bade7562e83b050,
+   0xc6c3521968f4ffd9, 0xdd8002263969a840, 0x2b78abc25a15c5e9},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x24480c57f26feef9, 0xc31a26943a0e1240, 0x735002c3273e2bc7,
+   0x8c42e9c53ef1ed4c, 0x028babf67f4948e8, 0x6a502f438a978632},
+  {0xf5f13a46b74536fe, 0x1d218babd8a9f0eb, 0x30f36bcc37232768,
+   0xc5317b31576e8c18, 0xef1d57a69bbcb766, 0x917c4930b3e3d4dc},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x11426e2ee349ddd0, 0x9f117ef99b2fc250, 0xff36b480ec0174a6,
+   0x4f4bde7618458466, 0x2f2edb6d05806049, 0x8adc75d119dfca92},
+  {0xa619d097b7d5a7ce, 0x874275e5a34411e9, 0x5403e0470da4b4ef,
+   0x2ebaafd977901d8f, 0x5e63ebcea747170f, 0x12a369447f9d8036},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x378205de2f9fbe67, 0xc4afcb837f728e44, 0xdbcec06c682e00f1,
+   0xf2a145c3114d5423, 0xa01d98747a52463e, 0xfc0935b17d717b0a},
+  {0x9653bc4fd4d01f95, 0x9aa83ea89560ad34, 0xf77943dcaf8e3f3f,
+   0x70774a10e86fe16e, 0x6b62e6f1bf9ffdcf, 0x8a72f39e588745c9},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x73ade4da2341c342, 0xdd326e54ea704422, 0x336c7d983741cef3,
+   0x1eafa00d59e61549, 0xcd3ed892bd9a3efd, 0x03faf26cc5c6c7e4},
+  {0x087e2fcf3045f8ac, 0x14a65532174f1e73, 0x2cf84f28fe0af9a7,
+   0xddfd7a842cdc935b, 0x4c0f117b6929c895, 0x356572d64c8bcfcc},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xfab086073f3b236f, 0x19e9d41d81e221da, 0xf3f6571e3927b428,
+   0x4348a9337550f1f6, 0x7167b996a85e62f0, 0x62d437597f5452bf},
+  {0xd85feb9ef2955926, 0x440a561f6df78353, 0x389668ec9ca36b59,
+   0x052bf1a1a22da016, 0xbdfbff72f6093254, 0x94e50f28e22209f3},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x90b2e5b33062e8af, 0xa8572375e8a3d369, 0x3fe1b00b201db7b1,
+   0xe926def0ee651aa2, 0x6542c9beb9b10ad7, 0x098e309ba2fcbe74},
+  {0x779deeb3fff1d63f, 0x23d0e80a20bfd374, 0x8452bb3b8768f797,
+   0xcf75bb4d1f952856, 0x8fe6b40029ea3faa, 0x12bd3e4081373a53},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x070d34e116973cf4, 0x20aee08b7e4f34f7, 0x269af9b95eb8ad29,
+   0xdde0a036a6a45dda, 0xa18b528e63df41e0, 0x03cc71b2a260df2a},
+  {0x24a6770aa06b1dd7, 0x5bfa9c119d2675d3, 0x73c1e2a196844432,
+   0x3660558d131a6cf0, 0xb0289c832ee79454, 0xa6aefb01c6d8ddcd},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xba1464b401ab5245, 0x9b8d0b6dc48d93ff, 0x939867dc93ad272c,
+   0xbebe085eae9fdc77, 0x73ae5103894ea8bd, 0x740fc89a39ac22e1},
+  {0x5e28b0a328e23b23, 0x2352722ee13104d0, 0xf4667a18b0a2640d,
+   0xac74a72e49bb37c3, 0x79f734f0e81e183a, 0xbffe5b6c3fd9c0eb},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x03cf292200623f3b, 0x095c71115f29ebff, 0x42d7224780aa6823,
+   0x044c7ba17458c0b0, 0xca62f7ef0959ec20, 0x40ae2ab7f8ca929f},
+  {0xb8c5377aa927b102, 0x398a86a0dc031771, 0x04908f9dc216a406,
+   0xb423a73a918d3300, 0x634b0ff1e0b94739, 0xe29de7252d69f697},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x744d14008435af04, 0x5f255b1dfec192da, 0x1f17dc12336dc542,
+   0x5c90c2a7636a68a8, 0x960c9eb77704ca1e, 0x9de8cf1e6fb3d65a},
+  {0xc60fee0d511d3d06, 0x466e2313f9eb52c7, 0x743c0f5f206b0914,
+   0x42f55bac2191aa4d, 0xcefc7c8fffebdbc2, 0xd4fa6081e6e8ed1c},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x867db63998683186, 0xfb5cf424ddcc4ea9, 0xcc9a7ffed4f0e7bd,
+   0x7c57f71c7a779f7e, 0x90774079d6b25ef2, 0x90eae903b4081680},
+  {0xdf2aae5e0ee1fceb, 0x3ff1da24e86c1a1f, 0x80f587d6ca193edf,
+   0xa5695523dc9b9d6a, 0x7b84090085920303, 0x1efa4dfcba6dbdef},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xfbd838f9e0540015, 0x2c323946c39077dc, 0x8b1fb9e6ad619124,
+   0x9612440c0ca62ea8, 0x9ad9b52c2dbe00ff, 0xf52abaa1ae197643},
+  {0xd0e898942cac32ad, 0xdfb79e4262a98f91, 0x65452ecf276f55cb,
+   0xdb1ac0d27ad23e12, 0xf68c5f6ade4986f0, 0x389ac37b82ce327d},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xcd96866db8a9e8c9, 0xa11963b85bb8091e, 0xc7f90d53045b3cd2,
+   0x755a72b580f36504, 0x46f8b39921d3751c, 0x4bffdc9153c193de},
+  {0xcd15c049b89554e7, 0x353c6754f7a26be6, 0x79602370bd41d970,
+   0xde16470b12b176c0, 0x56ba117540c8809d, 0xe2db35c3e435fb1e},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xd71e4aab6328e33f, 0x5486782baf8136d1, 0x07a4995f86d57231,
+   0xf1f0a5bd1651a968, 0xa5dc5b2476803b6d, 0x5c587cbc42dda935},
+  {0x2b6cdb32bae8b4c0, 0x66d1598bb1331138, 0x4a23b2d25d7e9614,
+   0x93e402a674a8c05d, 0x45ac94e6da7ce82e, 0xeb9f8281e463d465},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}}},
+{{{0, 0, 0, 0, 0, 0},
+  {0, 0, 0, 0, 0, 0},
+  {0, 0, 0, 0, 0, 0}},
+ {{0x298647532b0c535b, 0x90dd695370506296, 0x038cd6b4216ab9ac,
+   0x3df9b7b7be12d76a, 0x13f4d9785f347bdb, 0x222c5c9c13e94489},
+  {0x5f8e796f2680dc64, 0x120e7cb758352417, 0x254b5d8ad10740b8,
+   0xc38b8efb5337dee6, 0xf688c2e194f02247, 0x7b5c75f36c25bc4c},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x5584cbb3893b9a2d, 0x820c660b00850c5d, 0x4126d8267df2d43d,
+   0xdd5bbbf00109e801, 0x85b92ee338172f1c, 0x609d4f93f31430d9},
+  {0x1e059a07eadaf9d6, 0x70e6536c0f125fb0, 0xd6220751560f20e7,
+   0xa59489ae7aaf3a9a, 0x7b70e2f664bae14e, 0x0dd0370176d08249},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xc07611f4df5bdf53, 0x45d331a758b11a6d, 0x58965daf1c4ee394,
+   0xba8bebe75a5878d1, 0xaecc0a1882dd3025, 0xcf2a3899a923eb8b},
+  {0xf98c9281d24fd048, 0x841bfb598bbb025d, 0xb8ddf8cec9ab9d53,
+   0x538a4cb67fef044e, 0x092ac21f23236662, 0xa919d3850b66f065},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xc0426b775e3c647b, 0xbfcbd9398cf05348, 0x31d312e3172c0d3d,
+   0x5f49fde6ee754737, 0x895530f06da7ee61, 0xcf281b0ae8b3a5fb},
+  {0xfd14973541b8a543, 0x41a625a73080dd30, 0xe2baae07653908cf,
+   0xc3d01436ba02a278, 0xa0d0222e7b21b8f8, 0xfdc270e9d7ec1297},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x4e50430efc14ab48, 0x195b7f4f26706a74, 0x2fe8a228cc881ff6,
+   0xb1b968e2d945013d, 0x936aa5794b92162b, 0x4fb766b7364e754a},
+  {0x13f93bca31e1ff7f, 0x696eb5cace4f2691, 0xff754bf8a2b09e02,
+   0x58f13c9ce58e3ff8, 0xb757346f1678c0b0, 0xd54200dba86692b3},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x5cd9f5a87237cac0, 0x93f0b59d43586794, 0x4384a764e94f6c4e,
+   0x8304ed2bb62782d3, 0x0b8db8b3cde06015, 0x4336dd535dbe190f},
+  {0x5744355392ab473a, 0x031c7275be5ed046, 0x3e78678c21909aa4,
+   0x4ab7e04f99202ddb, 0x2648d2066977e635, 0xd427d184093198be},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x8e74dc3579efdc58, 0x456bd3694ff68ddb, 0x724e74ccd32096a5,
+   0xe41cff42386783d0, 0xa04c7f217c70d8a4, 0x41199d2fe61a19a2},
+  {0xd389a3e029c05dd2, 0x535f2a6be7e3fda9, 0x26ecf72d7c2b4df8,
+   0x678275f4fe745294, 0x6319c9cc9d23f519, 0x1e05a02d88048fc4},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x87c7dd7d139b3239, 0x8b57824e4d833bae, 0xbcbc48789fff0015,
+   0x8ffcef8b909eaf1a, 0x9905f4eef1443a78, 0x020dd4a2e15cbfed},
+  {0xca2969eca306d695, 0xdf940cadb93caf60, 0x67f7fab787ea6e39,
+   0x0d0ee10ff98c4fe5, 0xc646879ac19cb91e, 0x4b4ea50c7d1d7ab4},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xd6d9aec823e4712c, 0x7ca8376cc3c198ee, 0xe6d8318731bebd8a,
+   0xed57aff3d88bfef3, 0x72a645eecf44edc7, 0xd4e63d0b5cbb1517},
+  {0x98ce7a1cceee0ecf, 0x8f0126335383ee8e, 0x3b879078a6b455e8,
+   0xcbcd3d96c7658c06, 0x721d6fe70783336a, 0xf21a72635a677136},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x18482cec9b3f5034, 0x962d445acd9e68fd, 0x266fb1d695746f23,
+   0xc66ade5a58c94a4b, 0xdbbda826ed68a5b6, 0x05664a4d7ab0d6ae},
+  {0xbcd4fe51025e32fc, 0x61a5aebfa96df252, 0xd88a07e231592a31,
+   0x5d9d94de98905517, 0x96bb40105fd440e7, 0x1b0c47a2e807db4c},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xc1004cff44b2e045, 0x91b5e1364b1c05d4, 0x53ae409088a48a07,
+   0x73fb2995ea11bb1a, 0x320485703d93a4ea, 0xcce45de83bfc8a5f},
+  {0xaff4a97ec2b3106e, 0x9069c630b6848b4f, 0xeda837a6ed76241c,
+   0x8a0daf136cc3f6cf, 0x199d049d3da018a8, 0xf867c6b1d9093ba3},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x5285d116141d161c, 0x67cd2e0e93c4ed17, 0x12c62a647c36187e,
+   0xf5329539ed2584ca, 0xc4c777c442fbbd69, 0x107de7761bdfc50a},
+  {0x9976dcc5e96beebd, 0xbe2aff95a865a151, 0x0e0a9da19d8872af,
+   0x5e357a3da63c17cc, 0xd31fdfd8e15cc67c, 0xc44bbefd7970c6d8},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0x1a60d1522ca8f2fe, 0x61640948491bd41f, 0x6dae29a558dfe035,
+   0x9a615bea278e4863, 0xbbdb44779ad7c8e5, 0x1c7066302ceac2fc},
+  {0x5e2b54c699699b4b, 0xb509ca6d239e17e8, 0x728165feea063a82,
+   0x6b5e609db6a22e02, 0x12813905b26ee1df, 0x07b9f722439491fa},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xaa9da167b8153a9d, 0xa49fe3ac9e83ecf0, 0x14c18f8e1b661384,
+   0x61c24dab38434de1, 0x3d973c3a283dae96, 0xc99baa0182754fc9},
+  {0x477d198f4c26b1e3, 0x12e8e186a7516202, 0x386e52f6362addfa,
+   0x31e8f695c3962853, 0xdec2af136aaedb60, 0xfcfdb4c629cf74ac},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+ {{0xe361a1987ffa0a5f, 0xf4b26102c63fe109, 0x264acbc56c74e111,
+   0x4af445fa77abebaf, 0x448c4fdd24cddb75, 0x0b13157d44506eea},
+  {0x22a6b15972e9993d, 0x2c3c57e485e5ecbe, 0xa673560bfd83e1a1,
+   0x6be23f82c3b8c83b, 0x40b13a9640bbe38e, 0x66eea033ad17399b},
+  {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+   0x0000000000000000, 0x0000000000000000, 0x0000000000000000}}}
+};
+
+/* Precomputation for the group generator. */
+struct nistp384_pre_comp_st {
+    felem g_pre_comp[2][16][3];
+    CRYPTO_REF_COUNT references;
+    CRYPTO_RWLOCK *lock;
+};
+
+const EC_METHOD *EC_GFp_nistp384_method(void)
+{
+    static const EC_METHOD ret = {
+        EC_FLAGS_DEFAULT_OCT,
+        NID_X9_62_prime_field,
+        ec_GFp_nistp384_group_init,
+        ec_GFp_simple_group_finish,
+        ec_GFp_simple_group_clear_finish,
+        ec_GFp_nist_group_copy,
+        ec_GFp_nistp384_group_set_curve,
+        ec_GFp_simple_group_get_curve,
+        ec_GFp_simple_group_get_degree,
+        ec_group_simple_order_bits,
+        ec_GFp_simple_group_check_discriminant,
+        ec_GFp_simple_point_init,
+        ec_GFp_simple_point_finish,
+        ec_GFp_simple_point_clear_finish,
+        ec_GFp_simple_point_copy,
+        ec_GFp_simple_point_set_to_infinity,
+        ec_GFp_simple_set_Jprojective_coordinates_GFp,
+        ec_GFp_simple_get_Jprojective_coordinates_GFp,
+        ec_GFp_simple_point_set_affine_coordinates,
+        ec_GFp_nistp384_point_get_affine_coordinates,
+        0 /* point_set_compressed_coordinates */ ,
+        0 /* point2oct */ ,
+        0 /* oct2point */ ,
+        ec_GFp_simple_add,
+        ec_GFp_simple_dbl,
+        ec_GFp_simple_invert,
+        ec_GFp_simple_is_at_infinity,
+        ec_GFp_simple_is_on_curve,
+        ec_GFp_simple_cmp,
+        ec_GFp_simple_make_affine,
+        ec_GFp_simple_points_make_affine,
+        ec_GFp_nistp384_points_mul,
+        ec_GFp_nistp384_precompute_mult,
+        ec_GFp_nistp384_have_precompute_mult,
+        ec_GFp_nist_field_mul,
+        ec_GFp_nist_field_sqr,
+        0 /* field_div */ ,
+        0 /* field_encode */ ,
+        0 /* field_decode */ ,
+        0,                      /* field_set_to_one */
+        ec_key_simple_priv2oct,
+        ec_key_simple_oct2priv,
+        0, /* set private */
+        ec_key_simple_generate_key,
+        ec_key_simple_check_key,
+        ec_key_simple_generate_public_key,
+        0, /* keycopy */
+        0, /* keyfinish */
+        ecdh_simple_compute_key,
+        0, /* field_inverse_mod_ord */
+        0, /* blind_coordinates */
+        0, /* ladder_pre */
+        0, /* ladder_step */
+        0  /* ladder_post */
+    };
+
+    return &ret;
+}
+
+/******************************************************************************/
+/*-
+ *                              FIELD OPERATIONS
+ *
+ * All operations run in constant time and return fully reduced results.
+ */
+
+static void felem_assign(felem out, const felem in)
+{
+    memcpy(out, in, sizeof(felem));
+}
+
+static void felem_one(felem out)
+{
+    felem_assign(out, kOne);
+}
+
+/*
+ * Given the value |t| + 2^384*|carry| < 2*p, writes |t| mod p to |out|
+ */
+static void felem_reduce_once(felem out, const limb t[NLIMBS], limb carry)
+{
+    felem s;
+    uint128_t d;
+    limb borrow = 0, mask;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        d = (uint128_t)t[i] - kPrime[i] - borrow;
+        s[i] = (limb)d;
+        borrow = (limb)(d >> 64) & 1;
+    }
+    /* keep t iff the subtraction borrowed beyond the carry limb */
+    mask = 0 - (borrow & ~carry & 1);
+    for (i = 0; i < NLIMBS; i++)
+        out[i] = (t[i] & mask) | (s[i] & ~mask);
+}
+
+/* out = in1 + in2 mod p */
+static void felem_add(felem out, const felem in1, const felem in2)
+{
+    limb t[NLIMBS];
+    uint128_t c = 0;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        c += (uint128_t)in1[i] + in2[i];
+        t[i] = (limb)c;
+        c >>= 64;
+    }
+    felem_reduce_once(out, t, (limb)c);
+}
+
+/* out = in1 - in2 mod p */
+static void felem_sub(felem out, const felem in1, const felem in2)
+{
+    limb t[NLIMBS], mask;
+    uint128_t d, c = 0;
+    limb borrow = 0;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        d = (uint128_t)in1[i] - in2[i] - borrow;
+        t[i] = (limb)d;
+        borrow = (limb)(d >> 64) & 1;
+    }
+    /* add p back if the subtraction borrowed */
+    mask = 0 - borrow;
+    for (i = 0; i < NLIMBS; i++) {
+        c += (uint128_t)t[i] + (kPrime[i] & mask);
+        out[i] = (limb)c;
+        c >>= 64;
+    }
+}
+
+/* out = -in mod p */
+static void felem_neg(felem out, const felem in)
+{
+    static const felem zero = { 0 };
+
+    felem_sub(out, zero, in);
+}
+
+/* out = scalar * in mod p, for a small |scalar| */
+static void felem_scalar(felem out, const felem in, unsigned scalar)
+{
+    felem acc;
+
+    felem_assign(acc, in);
+    while (--scalar > 0)
+        felem_add(acc, acc, in);
+    felem_assign(out, acc);
+}
+
+/* out = in1 * in2, as a 12-limb integer */
+static void felem_mul_wide(widefelem out, const felem in1, const felem in2)
+{
+    uint128_t c;
+    unsigned i, j;
+
+    memset(out, 0, sizeof(widefelem));
+    for (i = 0; i < NLIMBS; i++) {
+        c = 0;
+        for (j = 0; j < NLIMBS; j++) {
+            c += (uint128_t)in1[i] * in2[j] + out[i + j];
+            out[i + j] = (limb)c;
+            c >>= 64;
+        }
+        out[i + NLIMBS] = (limb)c;
+    }
+}
+
+/*-
+ * Montgomery reduction: out = in / 2^384 mod p, for in < p * 2^384
+ * Each round adds the multiple m*p of p that clears the lowest limb, where
+ * m*p = m*2^384 - m*2^128 - m*2^96 + m*2^32 - m is formed with shifts
+ * rather than multiplications.
+ */
+static void felem_reduce(felem out, const widefelem in)
+{
+    limb t[2 * NLIMBS], m, carry = 0;
+    int128_t acc;
+    unsigned i;
+
+    memcpy(t, in, sizeof(t));
+    for (i = 0; i < NLIMBS; i++) {
+        m = t[i] * kPrimeN0;
+        /* the low limb cancels by the choice of m */
+        acc = (int128_t)t[i] + (limb)(m << 32) - m;
+        acc >>= 64;
+        acc += (int128_t)t[i + 1] + (m >> 32) - (limb)(m << 32);
+        t[i + 1] = (limb)acc;
+        acc >>= 64;
+        acc += (int128_t)t[i + 2] - (m >> 32) - m;
+        t[i + 2] = (limb)acc;
+        acc >>= 64;
+        acc += t[i + 3];
+        t[i + 3] = (limb)acc;
+        acc >>= 64;
+        acc += t[i + 4];
+        t[i + 4] = (limb)acc;
+        acc >>= 64;
+        acc += t[i + 5];
+        t[i + 5] = (limb)acc;
+        acc >>= 64;
+        acc += (int128_t)t[i + 6] + m + carry;
+        t[i + 6] = (limb)acc;
+        carry = (limb)(acc >> 64);
+    }
+    felem_reduce_once(out, t + NLIMBS, carry);
+}
+
+/* Montgomery multiplication: out = in1 * in2 / 2^384 mod p */
+static void felem_mul(felem out, const felem in1, const felem in2)
+{
+    widefelem tmp;
+
+    felem_mul_wide(tmp, in1, in2);
+    felem_reduce(out, tmp);
+}
+
+static void felem_square(felem out, const felem in)
+{
+    widefelem tmp;
+
+    felem_mul_wide(tmp, in, in);
+    felem_reduce(out, tmp);
+}
+
+/* Reduce to unique minimal representation: already the case for all felems */
+static void felem_contract(felem out, const felem in)
+{
+    felem_assign(out, in);
+}
+
+/*
+ * Zero-check: returns 1 if input is 0, and 0 otherwise.
+ */
+static limb felem_is_zero(const felem in)
+{
+    limb zero = in[0] | in[1] | in[2] | in[3] | in[4] | in[5];
+
+    return ((zero | (0 - zero)) >> 63) ^ 1;
+}
+
+static int felem_is_zero_int(const void *in)
+{
+    return (int)(felem_is_zero(in) & ((limb) 1));
+}
+
+/* out = in^(2^n) */
+static void felem_square_times(felem out, const felem in, unsigned n)
+{
+    felem_square(out, in);
+    while (--n > 0)
+        felem_square(out, out);
+}
+
+/*-
+ * Invert a field element, computing in^(p - 2). In binary p - 2 is
+ * 1{255} 0 1{32} 0{64} 1{30} 0 1, which is assembled from the powers
+ * x_k = in^(2^k - 1).
+ */
+static void felem_inv(felem out, const felem in)
+{
+    felem x2, x3, x6, x12, x15, x30, x32, x60, x120, ftmp;
+
+    felem_square(ftmp, in);
+    felem_mul(x2, ftmp, in);            /* 2^2 - 1 */
+    felem_square(ftmp, x2);
+    felem_mul(x3, ftmp, in);            /* 2^3 - 1 */
+    felem_square_times(ftmp, x3, 3);
+    felem_mul(x6, ftmp, x3);            /* 2^6 - 1 */
+    felem_square_times(ftmp, x6, 6);
+    felem_mul(x12, ftmp, x6);           /* 2^12 - 1 */
+    felem_square_times(ftmp, x12, 3);
+    felem_mul(x15, ftmp, x3);           /* 2^15 - 1 */
+    felem_square_times(ftmp, x15, 15);
+    felem_mul(x30, ftmp, x15);          /* 2^30 - 1 */
+    felem_square_times(ftmp, x30, 2);
+    felem_mul(x32, ftmp, x2);           /* 2^32 - 1 */
+    felem_square_times(ftmp, x30, 30);
+    felem_mul(x60, ftmp, x30);          /* 2^60 - 1 */
+    felem_square_times(ftmp, x60, 60);
+    felem_mul(x120, ftmp, x60);         /* 2^120 - 1 */
+    felem_square_times(ftmp, x120, 120);
+    felem_mul(ftmp, ftmp, x120);        /* 2^240 - 1 */
+    felem_square_times(ftmp, ftmp, 15);
+    felem_mul(ftmp, ftmp, x15);         /* 2^255 - 1 */
+    felem_square_times(ftmp, ftmp, 33);
+    felem_mul(ftmp, ftmp, x32);         /* 2^288 - 2^32 - 1 */
+    felem_square_times(ftmp, ftmp, 94);
+    felem_mul(ftmp, ftmp, x30);         /* 2^382 - 2^126 - 2^94 + 2^30 - 1 */
+    felem_square_times(ftmp, ftmp, 2);
+    felem_mul(out, ftmp, in);           /* 2^384 - 2^128 - 2^96 + 2^32 - 3 */
+}
+
+/*
+ * Copy in constant time: if icopy == 1, copy in to out, if icopy == 0, copy
+ * out to itself.
+ */
+static void copy_conditional(felem out, const felem in, limb icopy)
+{
+    unsigned i;
+    /*
+     * icopy is a (64-bit) 0 or 1, so copy is either all-zero or all-one
+     */
+    const limb copy = -icopy;
+    for (i = 0; i < NLIMBS; ++i) {
+        const limb tmp = copy & (in[i] ^ out[i]);
+        out[i] ^= tmp;
+    }
+}
+
+/*
+ * Helper functions to convert field elements to/from internal representation
+ */
+static void bin48_to_felem(felem out, const u8 in[48])
+{
+    felem tmp;
+    unsigned i, j;
+
+    for (i = 0; i < NLIMBS; ++i) {
+        tmp[i] = 0;
+        for (j = 0; j < 8; ++j)
+            tmp[i] |= (limb)in[8 * i + j] << (8 * j);
+    }
+    /* tmp < 2^384 and kRR < p, so the product is fully reduced */
+    felem_mul(out, tmp, kRR);
+}
+
+static void felem_to_bin48(u8 out[48], const felem in)
+{
+    static const felem one = { 1 };
+    felem tmp;
+    unsigned i, j;
+
+    felem_mul(tmp, in, one);
+    for (i = 0; i < NLIMBS; ++i)
+        for (j = 0; j < 8; ++j)
+            out[8 * i + j] = (u8)(tmp[i] >> (8 * j));
+}
+
+/* To preserve endianness when using BN_bn2bin and BN_bin2bn */
+static void flip_endian(u8 *out, const u8 *in, unsigned len)
+{
+    unsigned i;
+    for (i = 0; i < len; ++i)
+        out[i] = in[len - 1 - i];
+}
+
+/* From OpenSSL BIGNUM to internal representation */
+static int BN_to_felem(felem out, const BIGNUM *bn)
+{
+    felem_bytearray b_in;
+    felem_bytearray b_out;
+    unsigned num_bytes;
+
+    /* BN_bn2bin eats leading zeroes */
+    memset(b_out, 0, sizeof(b_out));
+    num_bytes = BN_num_bytes(bn);
+    if (num_bytes > sizeof(b_out)) {
+        ECerr(EC_F_BN_TO_FELEM, EC_R_BIGNUM_OUT_OF_RANGE);
+        return 0;
+    }
+    if (BN_is_negative(bn)) {
+        ECerr(EC_F_BN_TO_FELEM, EC_R_BIGNUM_OUT_OF_RANGE);
+        return 0;
+    }
+    num_bytes = BN_bn2bin(bn, b_in);
+    flip_endian(b_out, b_in, num_bytes);
+    bin48_to_felem(out, b_out);
+    return 1;
+}
+
+/* From internal representation to OpenSSL BIGNUM */
+static BIGNUM *felem_to_BN(BIGNUM *out, const felem in)
+{
+    felem_bytearray b_in, b_out;
+    felem_to_bin48(b_in, in);
+    flip_endian(b_out, b_in, sizeof(b_out));
+    return BN_bin2bn(b_out, sizeof(b_out), out);
+}
+
+/******************************************************************************/
+/*-
+ *                       ELLIPTIC CURVE POINT OPERATIONS
+ *
+ * Points are represented in Jacobian projective coordinates:
+ * (X, Y, Z) corresponds to the affine point (X/Z^2, Y/Z^3),
+ * or to the point at infinity if Z == 0.
+ *
+ */
+
+/*-
+ * Double an elliptic curve point:
+ * (X', Y', Z') = 2 * (X, Y, Z), where
+ * X' = (3 * (X - Z^2) * (X + Z^2))^2 - 8 * X * Y^2
+ * Y' = 3 * (X - Z^2) * (X + Z^2) * (4 * X * Y^2 - X') - 8 * Y^4
+ * Z' = (Y + Z)^2 - Y^2 - Z^2 = 2 * Y * Z
+ * Outputs can equal corresponding inputs, i.e., x_out == x_in is allowed,
+ * while x_out == y_in is not (maybe this works, but it's not tested).
+ */
+static void
+point_double(felem x_out, felem y_out, felem z_out,
+             const felem x_in, const felem y_in, const felem z_in)
+{
+    felem delta, gamma, beta, alpha, ftmp, ftmp2;
+
+    /* delta = z^2 */
+    felem_square(delta, z_in);
+
+    /* gamma = y^2 */
+    felem_square(gamma, y_in);
+
+    /* beta = x*gamma */
+    felem_mul(beta, x_in, gamma);
+
+    /* alpha = 3*(x-delta)*(x+delta) */
+    felem_sub(ftmp, x_in, delta);
+    felem_add(ftmp2, x_in, delta);
+    felem_scalar(ftmp2, ftmp2, 3);
+    felem_mul(alpha, ftmp, ftmp2);
+
+    /* x' = alpha^2 - 8*beta */
+    felem_square(x_out, alpha);
+    felem_scalar(ftmp, beta, 8);
+    felem_sub(x_out, x_out, ftmp);
+
+    /* z' = (y + z)^2 - gamma - delta */
+    felem_add(delta, gamma, delta);
+    felem_add(ftmp, y_in, z_in);
+    felem_square(z_out, ftmp);
+    felem_sub(z_out, z_out, delta);
+
+    /* y' = alpha*(4*beta - x') - 8*gamma^2 */
+    felem_scalar(beta, beta, 4);
+    felem_sub(beta, beta, x_out);
+    felem_mul(y_out, alpha, beta);
+    felem_square(gamma, gamma);
+    felem_scalar(gamma, gamma, 8);
+    felem_sub(y_out, y_out, gamma);
+}
+
+/*-
+ * Add two elliptic curve points:
+ * (X_1, Y_1, Z_1) + (X_2, Y_2, Z_2) = (X_3, Y_3, Z_3), where
+ * X_3 = (Z_1^3 * Y_2 - Z_2^3 * Y_1)^2 - (Z_1^2 * X_2 - Z_2^2 * X_1)^3 -
+ * 2 * Z_2^2 * X_1 * (Z_1^2 * X_2 - Z_2^2 * X_1)^2
+ * Y_3 = (Z_1^3 * Y_2 - Z_2^3 * Y_1) * (Z_2^2 * X_1 * (Z_1^2 * X_2 - Z_2^2 * X_1)^2 - X_3) -
+ *        Z_2^3 * Y_1 * (Z_1^2 * X_2 - Z_2^2 * X_1)^3
+ * Z_3 = (Z_1^2 * X_2 - Z_2^2 * X_1) * (Z_1 * Z_2)
+ *
+ * This runs faster if 'mixed' is set, which requires Z_2 = 1 or Z_2 = 0.
+ */
+
+/*
+ * This function is not entirely constant-time: it includes a branch for
+ * checking whether the two input points are equal, (while not equal to the
+ * point at infinity). This case never happens during single point
+ * multiplication, so there is no timing leak for ECDH or ECDSA signing.
+ */
+static void point_add(felem x3, felem y3, felem z3,
+                      const felem x1, const felem y1, const felem z1,
+                      const int mixed, const felem x2, const felem y2,
+                      const felem z2)
+{
+    felem ftmp, ftmp2, ftmp3, ftmp4, ftmp5, ftmp6, x_out, y_out, z_out;
+    limb z1_is_zero, z2_is_zero, x_equal, y_equal;
+
+    if (!mixed) {
+        /* ftmp2 = z2^2 */
+        felem_square(ftmp2, z2);
+
+        /* ftmp4 = z2^3 */
+        felem_mul(ftmp4, ftmp2, z2);
+
+        /* ftmp4 = z2^3*y1 */
+        felem_mul(ftmp4, ftmp4, y1);
+
+        /* ftmp2 = z2^2*x1 */
+        felem_mul(ftmp2, ftmp2, x1);
+    } else {
+        /*
+         * We'll assume z2 = 1 (special case z2 = 0 is handled later)
+         */
+
+        /* ftmp4 = z2^3*y1 */
+        felem_assign(ftmp4, y1);
+
+        /* ftmp2 = z2^2*x1 */
+        felem_assign(ftmp2, x1);
+    }
+
+    /* ftmp = z1^2 */
+    felem_square(ftmp, z1);
+
+    /* ftmp3 = z1^3 */
+    felem_mul(ftmp3, ftmp, z1);
+
+    /* ftmp3 = z1^3*y2 - z2^3*y1 */
+    felem_mul(ftmp3, ftmp3, y2);
+    felem_sub(ftmp3, ftmp3, ftmp4);
+
+    /* ftmp = z1^2*x2 - z2^2*x1 */
+    felem_mul(ftmp, ftmp, x2);
+    felem_sub(ftmp, ftmp, ftmp2);
+
+    /*
+     * the formulae are incorrect if the points are equal so we check for
+     * this and do doubling if this happens
+     */
+    x_equal = felem_is_zero(ftmp);
+    y_equal = felem_is_zero(ftmp3);
+    z1_is_zero = felem_is_zero(z1);
+    z2_is_zero = felem_is_zero(z2);
+    /* In affine coordinates, (X_1, Y_1) == (X_2, Y_2) */
+    if (x_equal && y_equal && !z1_is_zero && !z2_is_zero) {
+        point_double(x3, y3, z3, x1, y1, z1);
+        return;
+    }
+
+    /* ftmp5 = z1*z2 */
+    if (!mixed) {
+        felem_mul(ftmp5, z1, z2);
+    } else {
+        /* special case z2 = 0 is handled later */
+        felem_assign(ftmp5, z1);
+    }
+
+    /* z_out = (z1^2*x2 - z2^2*x1)*(z1*z2) */
+    felem_mul(z_out, ftmp, ftmp5);
+
+    /* ftmp5 = (z1^2*x2 - z2^2*x1)^2 */
+    felem_square(ftmp5, ftmp);
+
+    /* ftmp6 = (z1^2*x2 - z2^2*x1)^3 */
+    felem_mul(ftmp6, ftmp5, ftmp);
+
+    /* ftmp2 = z2^2*x1*(z1^2*x2 - z2^2*x1)^2 */
+    felem_mul(ftmp2, ftmp2, ftmp5);
+
+    /* ftmp4 = z2^3*y1*(z1^2*x2 - z2^2*x1)^3 */
+    felem_mul(ftmp4, ftmp4, ftmp6);
+
+    /*-
+     * x_out = (z1^3*y2 - z2^3*y1)^2 - (z1^2*x2 - z2^2*x1)^3 -
+     *  2*z2^2*x1*(z1^2*x2 - z2^2*x1)^2
+     */
+    felem_square(x_out, ftmp3);
+    felem_sub(x_out, x_out, ftmp6);
+    felem_add(ftmp5, ftmp2, ftmp2);
+    felem_sub(x_out, x_out, ftmp5);
+
+    /*-
+     * y_out = (z1^3*y2 - z2^3*y1)*(z2^2*x1*(z1^2*x2 - z2^2*x1)^2 - x_out) -
+     *  z2^3*y1*(z1^2*x2 - z2^2*x1)^3
+     */
+    felem_sub(ftmp2, ftmp2, x_out);
+    felem_mul(y_out, ftmp3, ftmp2);
+    felem_sub(y_out, y_out, ftmp4);
+
+    /*
+     * the result (x_out, y_out, z_out) is incorrect if one of the inputs is
+     * the point at infinity, so we need to check for this separately
+     */
+
+    /*
+     * if point 1 is at infinity, copy point 2 to output, and vice versa
+     */
+    copy_conditional(x_out, x2, z1_is_zero);
+    copy_conditional(x_out, x1, z2_is_zero);
+    copy_conditional(y_out, y2, z1_is_zero);
+    copy_conditional(y_out, y1, z2_is_zero);
+    copy_conditional(z_out, z2, z1_is_zero);
+    copy_conditional(z_out, z1, z2_is_zero);
+    felem_assign(x3, x_out);
+    felem_assign(y3, y_out);
+    felem_assign(z3, z_out);
+}
+
+/*
+ * select_point selects the |idx|th point from a precomputation table and
+ * copies it to out.
+ * The pre_comp array argument should be size of |size| argument
+ */
+static void select_point(const u64 idx, unsigned int size,
+                         const felem pre_comp[][3], felem out[3])
+{
+    unsigned i, j;
+    limb *outlimbs = &out[0][0];
+
+    memset(out, 0, sizeof(*out) * 3);
+    for (i = 0; i < size; i++) {
+        const limb *inlimbs = &pre_comp[i][0][0];
+        u64 mask = i ^ idx;
+        mask |= mask >> 4;
+        mask |= mask >> 2;
+        mask |= mask >> 1;
+        mask &= 1;
+        mask--;
+        for (j = 0; j < NLIMBS * 3; j++)
+            outlimbs[j] |= inlimbs[j] & mask;
+    }
+}
+
+/* get_bit returns the |i|th bit in |in| */
+static char get_bit(const felem_bytearray in, unsigned i)
+{
+    if (i >= 384)
+        return 0;
+    return (in[i >> 3] >> (i & 7)) & 1;
+}
+
+/*
+ * Interleaved point multiplication using precomputed point multiples: The
+ * small point multiples 0*P, 1*P, ..., 16*P are in pre_comp[], the scalars
+ * in scalars[]. If g_scalar is non-NULL, we also add this multiple of the
+ * generator, using certain (large) precomputed multiples in g_pre_comp.
+ * Output point (X, Y, Z) is stored in x_out, y_out, z_out
+ */
+static void batch_mul(felem x_out, felem y_out, felem z_out,
+                      const felem_bytearray scalars[],
+                      const unsigned num_points, const u8 *g_scalar,
+                      const int mixed, const felem pre_comp[][17][3],
+                      const felem g_pre_comp[2][16][3])
+{
+    int i, skip;
+    unsigned num;
+    unsigned gen_mul = (g_scalar != NULL);
+    felem nq[3], tmp[4];
+    u64 bits;
+    u8 sign, digit;
+
+    /* set nq to the point at infinity */
+    memset(nq, 0, sizeof(nq));
+
+    /*
+     * Loop over all scalars msb-to-lsb, interleaving additions of multiples
+     * of the generator (two in each of the last 48 rounds) and additions of
+     * other points multiples (every 5th round).
+     */
+    skip = 1;                   /* save two point operations in the first
+                                 * round */
+    for (i = (num_points ? 380 : 47); i >= 0; --i) {
+        /* double */
+        if (!skip)
+            point_double(nq[0], nq[1], nq[2], nq[0], nq[1], nq[2]);
+
+        /* add multiples of the generator */
+        if (gen_mul && (i <= 47)) {
+            /* first, look 48 bits upwards */
+            bits = get_bit(g_scalar, i + 336) << 3;
+            bits |= get_bit(g_scalar, i + 240) << 2;
+            bits |= get_bit(g_scalar, i + 144) << 1;
+            bits |= get_bit(g_scalar, i + 48);
+            /* select the point to add, in constant time */
+            select_point(bits, 16, g_pre_comp[1], tmp);
+
+            if (!skip) {
+                /* value 1 below is argument for "mixed" */
+                point_add(nq[0], nq[1], nq[2],
+                          nq[0], nq[1], nq[2], 1, tmp[0], tmp[1], tmp[2]);
+            } else {
+                memcpy(nq, tmp, 3 * sizeof(felem));
+                skip = 0;
+            }
+
+            /* second, look at the current position */
+            bits = get_bit(g_scalar, i + 288) << 3;
+            bits |= get_bit(g_scalar, i + 192) << 2;
+            bits |= get_bit(g_scalar, i + 96) << 1;
+            bits |= get_bit(g_scalar, i);
+            /* select the point to add, in constant time */
+            select_point(bits, 16, g_pre_comp[0], tmp);
+            point_add(nq[0], nq[1], nq[2],
+                      nq[0], nq[1], nq[2],
+                      1 /* mixed */ , tmp[0], tmp[1], tmp[2]);
+        }
+
+        /* do other additions every 5 doublings */
+        if (num_points && (i % 5 == 0)) {
+            /* loop over all scalars */
+            for (num = 0; num < num_points; ++num) {
+                bits = get_bit(scalars[num], i + 4) << 5;
+                bits |= get_bit(scalars[num], i + 3) << 4;
+                bits |= get_bit(scalars[num], i + 2) << 3;
+                bits |= get_bit(scalars[num], i + 1) << 2;
+                bits |= get_bit(scalars[num], i) << 1;
+                bits |= get_bit(scalars[num], i - 1);
+                ec_GFp_nistp_recode_scalar_bits(&sign, &digit, bits);
+
+                /* select the point to add or subtract */
+                select_point(digit, 17, pre_comp[num], tmp);
+                felem_neg(tmp[3], tmp[1]); /* (X, -Y, Z) is the negative
+                                            * point */
+                copy_conditional(tmp[1], tmp[3], sign);
+
+                if (!skip) {
+                    point_add(nq[0], nq[1], nq[2],
+                              nq[0], nq[1], nq[2],
+                              mixed, tmp[0], tmp[1], tmp[2]);
+                } else {
+                    memcpy(nq, tmp, 3 * sizeof(felem));
+                    skip = 0;
+                }
+            }
+        }
+    }
+    felem_assign(x_out, nq[0]);
+    felem_assign(y_out, nq[1]);
+    felem_assign(z_out, nq[2]);
+}
+
+/******************************************************************************/
+/*
+ * FUNCTIONS TO MANAGE PRECOMPUTATION
+ */
+
+static NISTP384_PRE_COMP *nistp384_pre_comp_new(void)
+{
+    NISTP384_PRE_COMP *ret = OPENSSL_zalloc(sizeof(*ret));
+
+    if (!ret) {
+        ECerr(EC_F_NISTP384_PRE_COMP_NEW, ERR_R_MALLOC_FAILURE);
+        return ret;
+    }
+
+    ret->references = 1;
+
+    ret->lock = CRYPTO_THREAD_lock_new();
+    if (ret->lock == NULL) {
+        ECerr(EC_F_NISTP384_PRE_COMP_NEW, ERR_R_MALLOC_FAILURE);
+        OPENSSL_free(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+NISTP384_PRE_COMP *EC_nistp384_pre_comp_dup(NISTP384_PRE_COMP *p)
+{
+    int i;
+    if (p != NULL)
+        CRYPTO_UP_REF(&p->references, &i, p->lock);
+    return p;
+}
+
+void EC_nistp384_pre_comp_free(NISTP384_PRE_COMP *p)
+{
+    int i;
+
+    if (p == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&p->references, &i, p->lock);
+    REF_PRINT_COUNT("EC_nistp384", x);
+    if (i > 0)
+        return;
+    REF_ASSERT_ISNT(i < 0);
+
+    CRYPTO_THREAD_lock_free(p->lock);
+    OPENSSL_free(p);
+}
+
+/******************************************************************************/
+/*
+ * OPENSSL EC_METHOD FUNCTIONS
+ */
+
+int ec_GFp_nistp384_group_init(EC_GROUP *group)
+{
+    int ret;
+    ret = ec_GFp_simple_group_init(group);
+    group->a_is_minus3 = 1;
+    return ret;
+}
+
+int ec_GFp_nistp384_group_set_curve(EC_GROUP *group, const BIGNUM *p,
+                                    const BIGNUM *a, const BIGNUM *b,
+                                    BN_CTX *ctx)
+{
+    int ret = 0;
+    BN_CTX *new_ctx = NULL;
+    BIGNUM *curve_p, *curve_a, *curve_b;
+
+    if (ctx == NULL)
+        if ((ctx = new_ctx = BN_CTX_new()) == NULL)
+            return 0;
+    BN_CTX_start(ctx);
+    curve_p = BN_CTX_get(ctx);
+    curve_a = BN_CTX_get(ctx);
+    curve_b = BN_CTX_get(ctx);
+    if (curve_b == NULL)
+        goto err;
+    BN_bin2bn(nistp384_curve_params[0], sizeof(felem_bytearray), curve_p);
+    BN_bin2bn(nistp384_curve_params[1], sizeof(felem_bytearray), curve_a);
+    BN_bin2bn(nistp384_curve_params[2], sizeof(felem_bytearray), curve_b);
+    if ((BN_cmp(curve_p, p)) || (BN_cmp(curve_a, a)) || (BN_cmp(curve_b, b))) {
+        ECerr(EC_F_EC_GFP_NISTP384_GROUP_SET_CURVE,
+              EC_R_WRONG_CURVE_PARAMETERS);
+        goto err;
+    }
+    group->field_mod_func = BN_nist_mod_384;
+    ret = ec_GFp_simple_group_set_curve(group, p, a, b, ctx);
+ err:
+    BN_CTX_end(ctx);
+    BN_CTX_free(new_ctx);
+    return ret;
+}
+
+/*
+ * Takes the Jacobian coordinates (X, Y, Z) of a point and returns (X', Y') =
+ * (X/Z^2, Y/Z^3)
+ */
+int ec_GFp_nistp384_point_get_affine_coordinates(const EC_GROUP *group,
+                                                 const EC_POINT *point,
+                                                 BIGNUM *x, BIGNUM *y,
+                                                 BN_CTX *ctx)
+{
+    felem z1, z2, x_in, y_in, x_out, y_out;
+
+    if (EC_POINT_is_at_infinity(group, point)) {
+        ECerr(EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES,
+              EC_R_POINT_AT_INFINITY);
+        return 0;
+    }
+    if ((!BN_to_felem(x_in, point->X)) || (!BN_to_felem(y_in, point->Y)) ||
+        (!BN_to_felem(z1, point->Z)))
+        return 0;
+    felem_inv(z2, z1);
+    felem_square(z1, z2);
+    felem_mul(x_in, x_in, z1);
+    felem_contract(x_out, x_in);
+    if (x != NULL) {
+        if (!felem_to_BN(x, x_out)) {
+            ECerr(EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES,
+                  ERR_R_BN_LIB);
+            return 0;
+        }
+    }
+    felem_mul(z1, z1, z2);
+    felem_mul(y_in, y_in, z1);
+    felem_contract(y_out, y_in);
+    if (y != NULL) {
+        if (!felem_to_BN(y, y_out)) {
+            ECerr(EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES,
+                  ERR_R_BN_LIB);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void make_points_affine(size_t num, felem points[ /* num */ ][3],
+                               felem tmp_felems[ /* num+1 */ ])
+{
+    /*
+     * Runs in constant time, unless an input is the point at infinity (which
+     * normally shouldn't happen).
+     */
+    ec_GFp_nistp_points_make_affine_internal(num,
+                                             points,
+                                             sizeof(felem),
+                                             tmp_felems,
+                                             (void (*)(void *))felem_one,
+                                             felem_is_zero_int,
+                                             (void (*)(void *, const void *))
+                                             felem_assign,
+                                             (void (*)(void *, const void *))
+                                             felem_square, (void (*)
+                                                                   (void *,
+                                                                    const void
+                                                                    *,
+                                                                    const void
+                                                                    *))
+                                             felem_mul,
+                                             (void (*)(void *, const void *))
+                                             felem_inv,
+                                             (void (*)(void *, const void *))
+                                             felem_contract);
+}
+
+/*
+ * Computes scalar*generator + \sum scalars[i]*points[i], ignoring NULL
+ * values Result is stored in r (r can equal one of the inputs).
+ */
+int ec_GFp_nistp384_points_mul(const EC_GROUP *group, EC_POINT *r,
+                               const BIGNUM *scalar, size_t num,
+                               const EC_POINT *points[],
+                               const BIGNUM *scalars[], BN_CTX *ctx)
+{
+    int ret = 0;
+    int j;
+    unsigned i;
+    int mixed = 0;
+    BIGNUM *x, *y, *z, *tmp_scalar;
+    felem_bytearray g_secret;
+    felem_bytearray *secrets = NULL;
+    felem (*pre_comp)[17][3] = NULL;
+    felem *tmp_felems = NULL;
+    felem_bytearray tmp;
+    unsigned num_bytes;
+    int have_pre_comp = 0;
+    size_t num_points = num;
+    felem x_in, y_in, z_in, x_out, y_out, z_out;
+    NISTP384_PRE_COMP *pre = NULL;
+    const felem(*g_pre_comp)[16][3] = NULL;
+    EC_POINT *generator = NULL;
+    const EC_POINT *p = NULL;
+    const BIGNUM *p_scalar = NULL;
+
+    BN_CTX_start(ctx);
+    x = BN_CTX_get(ctx);
+    y = BN_CTX_get(ctx);
+    z = BN_CTX_get(ctx);
+    tmp_scalar = BN_CTX_get(ctx);
+    if (tmp_scalar == NULL)
+        goto err;
+
+    if (scalar != NULL) {
+        pre = group->pre_comp.nistp384;
+        if (pre)
+            /* we have precomputation, try to use it */
+            g_pre_comp = (const felem(*)[16][3])pre->g_pre_comp;
+        else
+            /* try to use the standard precomputation */
+            g_pre_comp = &gmul[0];
+        generator = EC_POINT_new(group);
+        if (generator == NULL)
+            goto err;
+        /* get the generator from precomputation */
+        if (!felem_to_BN(x, g_pre_comp[0][1][0]) ||
+            !felem_to_BN(y, g_pre_comp[0][1][1]) ||
+            !felem_to_BN(z, g_pre_comp[0][1][2])) {
+            ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_BN_LIB);
+            goto err;
+        }
+        if (!EC_POINT_set_Jprojective_coordinates_GFp(group,
+                                                      generator, x, y, z,
+                                                      ctx))
+            goto err;
+        if (0 == EC_POINT_cmp(group, generator, group->generator, ctx))
+            /* precomputation matches generator */
+            have_pre_comp = 1;
+        else
+            /*
+             * we don't have valid precomputation: treat the generator as a
+             * random point
+             */
+            num_points = num_points + 1;
+    }
+
+    if (num_points > 0) {
+        if (num_points >= 3) {
+            /*
+             * unless we precompute multiples for just one or two points,
+             * converting those into affine form is time well spent
+             */
+            mixed = 1;
+        }
+        secrets = OPENSSL_zalloc(sizeof(*secrets) * num_points);
+        pre_comp = OPENSSL_zalloc(sizeof(*pre_comp) * num_points);
+        if (mixed)
+            tmp_felems =
+                OPENSSL_malloc(sizeof(felem) * (num_points * 17 + 1));
+        if ((secrets == NULL) || (pre_comp == NULL)
+            || (mixed && (tmp_felems == NULL))) {
+            ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+
+        /*
+         * we treat NULL scalars as 0, and NULL points as points at infinity,
+         * i.e., they contribute nothing to the linear combination
+         */
+        for (i = 0; i < num_points; ++i) {
+            if (i == num)
+                /* the generator */
+            {
+                p = EC_GROUP_get0_generator(group);
+                p_scalar = scalar;
+            } else
+                /* the i^th point */
+            {
+                p = points[i];
+                p_scalar = scalars[i];
+            }
+            if ((p_scalar != NULL) && (p != NULL)) {
+                /* reduce scalar to 0 <= scalar < 2^384 */
+                if ((BN_num_bits(p_scalar) > 384)
+                    || (BN_is_negative(p_scalar))) {
+                    /*
+                     * this is an unusual input, and we don't guarantee
+                     * constant-timeness
+                     */
+                    if (!BN_nnmod(tmp_scalar, p_scalar, group->order, ctx)) {
+                        ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_BN_LIB);
+                        goto err;
+                    }
+                    num_bytes = BN_bn2bin(tmp_scalar, tmp);
+                } else
+                    num_bytes = BN_bn2bin(p_scalar, tmp);
+                flip_endian(secrets[i], tmp, num_bytes);
+                /* precompute multiples */
+                if ((!BN_to_felem(x_out, p->X)) ||
+                    (!BN_to_felem(y_out, p->Y)) ||
+                    (!BN_to_felem(z_out, p->Z)))
+                    goto err;
+                felem_assign(pre_comp[i][1][0], x_out);
+                felem_assign(pre_comp[i][1][1], y_out);
+                felem_assign(pre_comp[i][1][2], z_out);
+                for (j = 2; j <= 16; ++j) {
+                    if (j & 1) {
+                        point_add(pre_comp[i][j][0], pre_comp[i][j][1],
+                                  pre_comp[i][j][2], pre_comp[i][1][0],
+                                  pre_comp[i][1][1], pre_comp[i][1][2], 0,
+                                  pre_comp[i][j - 1][0],
+                                  pre_comp[i][j - 1][1],
+                                  pre_comp[i][j - 1][2]);
+                    } else {
+                        point_double(pre_comp[i][j][0], pre_comp[i][j][1],
+                                     pre_comp[i][j][2], pre_comp[i][j / 2][0],
+                                     pre_comp[i][j / 2][1],
+                                     pre_comp[i][j / 2][2]);
+                    }
+                }
+            }
+        }
+        if (mixed)
+            make_points_affine(num_points * 17, pre_comp[0], tmp_felems);
+    }
+
+    /* the scalar for the generator */
+    if ((scalar != NULL) && (have_pre_comp)) {
+        memset(g_secret, 0, sizeof(g_secret));
+        /* reduce scalar to 0 <= scalar < 2^384 */
+        if ((BN_num_bits(scalar) > 384) || (BN_is_negative(scalar))) {
+            /*
+             * this is an unusual input, and we don't guarantee
+             * constant-timeness
+             */
+            if (!BN_nnmod(tmp_scalar, scalar, group->order, ctx)) {
+                ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_BN_LIB);
+                goto err;
+            }
+            num_bytes = BN_bn2bin(tmp_scalar, tmp);
+        } else
+            num_bytes = BN_bn2bin(scalar, tmp);
+        flip_endian(g_secret, tmp, num_bytes);
+        /* do the multiplication with generator precomputation */
+        batch_mul(x_out, y_out, z_out,
+                  (const felem_bytearray(*))secrets, num_points,
+                  g_secret,
+                  mixed, (const felem(*)[17][3])pre_comp, g_pre_comp);
+    } else
+        /* do the multiplication without generator precomputation */
+        batch_mul(x_out, y_out, z_out,
+                  (const felem_bytearray(*))secrets, num_points,
+                  NULL, mixed, (const felem(*)[17][3])pre_comp, NULL);
+    /* reduce the output to its unique minimal representation */
+    felem_contract(x_in, x_out);
+    felem_contract(y_in, y_out);
+    felem_contract(z_in, z_out);
+    if ((!felem_to_BN(x, x_in)) || (!felem_to_BN(y, y_in)) ||
+        (!felem_to_BN(z, z_in))) {
+        ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_BN_LIB);
+        goto err;
+    }
+    ret = EC_POINT_set_Jprojective_coordinates_GFp(group, r, x, y, z, ctx);
+
+ err:
+    BN_CTX_end(ctx);
+    EC_POINT_free(generator);
+    OPENSSL_free(secrets);
+    OPENSSL_free(pre_comp);
+    OPENSSL_free(tmp_felems);
+    return ret;
+}
+
+int ec_GFp_nistp384_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
+{
+    int ret = 0;
+    NISTP384_PRE_COMP *pre = NULL;
+    int i, j;
+    BN_CTX *new_ctx = NULL;
+    BIGNUM *x, *y;
+    EC_POINT *generator = NULL;
+    felem tmp_felems[32];
+
+    /* throw away old precomputation */
+    EC_pre_comp_free(group);
+    if (ctx == NULL)
+        if ((ctx = new_ctx = BN_CTX_new()) == NULL)
+            return 0;
+    BN_CTX_start(ctx);
+    x = BN_CTX_get(ctx);
+    y = BN_CTX_get(ctx);
+    if (y == NULL)
+        goto err;
+    /* get the generator */
+    if (group->generator == NULL)
+        goto err;
+    generator = EC_POINT_new(group);
+    if (generator == NULL)
+        goto err;
+    BN_bin2bn(nistp384_curve_params[3], sizeof(felem_bytearray), x);
+    BN_bin2bn(nistp384_curve_params[4], sizeof(felem_bytearray), y);
+    if (!EC_POINT_set_affine_coordinates_GFp(group, generator, x, y, ctx))
+        goto err;
+    if ((pre = nistp384_pre_comp_new()) == NULL)
+        goto err;
+    /*
+     * if the generator is the standard one, use built-in precomputation
+     */
+    if (0 == EC_POINT_cmp(group, generator, group->generator, ctx)) {
+        memcpy(pre->g_pre_comp, gmul, sizeof(pre->g_pre_comp));
+        goto done;
+    }
+    if ((!BN_to_felem(pre->g_pre_comp[0][1][0], group->generator->X)) ||
+        (!BN_to_felem(pre->g_pre_comp[0][1][1], group->generator->Y)) ||
+        (!BN_to_felem(pre->g_pre_comp[0][1][2], group->generator->Z)))
+        goto err;
+    /*
+     * compute 2^96*G, 2^192*G, 2^288*G for the first table, 2^48*G, 2^144*G,
+     * 2^240*G, 2^336*G for the second one
+     */
+    for (i = 1; i <= 8; i <<= 1) {
+        point_double(pre->g_pre_comp[1][i][0], pre->g_pre_comp[1][i][1],
+                     pre->g_pre_comp[1][i][2], pre->g_pre_comp[0][i][0],
+                     pre->g_pre_comp[0][i][1], pre->g_pre_comp[0][i][2]);
+        for (j = 0; j < 47; ++j) {
+            point_double(pre->g_pre_comp[1][i][0], pre->g_pre_comp[1][i][1],
+                         pre->g_pre_comp[1][i][2], pre->g_pre_comp[1][i][0],
+                         pre->g_pre_comp[1][i][1], pre->g_pre_comp[1][i][2]);
+        }
+        if (i == 8)
+            break;
+        point_double(pre->g_pre_comp[0][2 * i][0],
+                     pre->g_pre_comp[0][2 * i][1],
+                     pre->g_pre_comp[0][2 * i][2], pre->g_pre_comp[1][i][0],
+                     pre->g_pre_comp[1][i][1], pre->g_pre_comp[1][i][2]);
+        for (j = 0; j < 47; ++j) {
+            point_double(pre->g_pre_comp[0][2 * i][0],
+                         pre->g_pre_comp[0][2 * i][1],
+                         pre->g_pre_comp[0][2 * i][2],
+                         pre->g_pre_comp[0][2 * i][0],
+                         pre->g_pre_comp[0][2 * i][1],
+                         pre->g_pre_comp[0][2 * i][2]);
+        }
+    }
+    for (i = 0; i < 2; i++) {
+        /* g_pre_comp[i][0] is the point at infinity */
+        memset(pre->g_pre_comp[i][0], 0, sizeof(pre->g_pre_comp[i][0]));
+        /* the remaining multiples */
+        /* 2^96*G + 2^192*G resp. 2^144*G + 2^240*G */
+        point_add(pre->g_pre_comp[i][6][0], pre->g_pre_comp[i][6][1],
+                  pre->g_pre_comp[i][6][2], pre->g_pre_comp[i][4][0],
+                  pre->g_pre_comp[i][4][1], pre->g_pre_comp[i][4][2],
+                  0, pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        /* 2^96*G + 2^288*G resp. 2^144*G + 2^336*G */
+        point_add(pre->g_pre_comp[i][10][0], pre->g_pre_comp[i][10][1],
+                  pre->g_pre_comp[i][10][2], pre->g_pre_comp[i][8][0],
+                  pre->g_pre_comp[i][8][1], pre->g_pre_comp[i][8][2],
+                  0, pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        /* 2^192*G + 2^288*G resp. 2^240*G + 2^336*G */
+        point_add(pre->g_pre_comp[i][12][0], pre->g_pre_comp[i][12][1],
+                  pre->g_pre_comp[i][12][2], pre->g_pre_comp[i][8][0],
+                  pre->g_pre_comp[i][8][1], pre->g_pre_comp[i][8][2],
+                  0, pre->g_pre_comp[i][4][0], pre->g_pre_comp[i][4][1],
+                  pre->g_pre_comp[i][4][2]);
+        /*
+         * 2^96*G + 2^192*G + 2^288*G resp. 2^144*G + 2^240*G + 2^336*G
+         */
+        point_add(pre->g_pre_comp[i][14][0], pre->g_pre_comp[i][14][1],
+                  pre->g_pre_comp[i][14][2], pre->g_pre_comp[i][12][0],
+                  pre->g_pre_comp[i][12][1], pre->g_pre_comp[i][12][2],
+                  0, pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        for (j = 1; j < 8; ++j) {
+            /* odd multiples: add G resp. 2^48*G */
+            point_add(pre->g_pre_comp[i][2 * j + 1][0],
+                      pre->g_pre_comp[i][2 * j + 1][1],
+                      pre->g_pre_comp[i][2 * j + 1][2],
+                      pre->g_pre_comp[i][2 * j][0],
+                      pre->g_pre_comp[i][2 * j][1],
+                      pre->g_pre_comp[i][2 * j][2], 0,
+                      pre->g_pre_comp[i][1][0], pre->g_pre_comp[i][1][1],
+                      pre->g_pre_comp[i][1][2]);
+        }
+    }
+    make_points_affine(31, &(pre->g_pre_comp[0][1]), tmp_felems);
+
+ done:
+    SETPRECOMP(group, nistp384, pre);
+    pre = NULL;
+    ret = 1;
+ err:
+    BN_CTX_end(ctx);
+    EC_POINT_free(generator);
+    BN_CTX_free(new_ctx);
+    EC_nistp384_pre_comp_free(pre);
+    return ret;
+}
+
+int ec_GFp_nistp384_have_precompute_mult(const EC_GROUP *group)
+{
+    return HAVEPRECOMP(group, nistp384);
+}
+
+#endif
@@ -75,6 +75,12 @@ static int ecx_key_op(EVP_PKEY *pkey, int id, const X509_ALGOR *palg,
 
     if (op == KEY_OP_PUBLIC) {
         memcpy(pubkey, p, plen);
+        /*
+         * Public keys are only used to verify, so decode the point once.
+         * An invalid key is left for verification to reject.
+         */
+        if (id == EVP_PKEY_ED25519)
+            key->ed25519_vctx = ED25519_verify_ctx_new(pubkey);
     } else {
         privkey = key->privkey = OPENSSL_secure_malloc(KEYLENID(id));
         if (privkey == NULL) {
@@ -253,8 +259,10 @@ static int ecx_security_bits(const EVP_PKEY *pkey)
 
 static void ecx_free(EVP_PKEY *pkey)
 {
-    if (pkey->pkey.ecx != NULL)
+    if (pkey->pkey.ecx != NULL) {
         OPENSSL_secure_clear_free(pkey->pkey.ecx->privkey, KEYLEN(pkey));
+        ED25519_verify_ctx_free(pkey->pkey.ecx->ed25519_vctx);
+    }
     OPENSSL_free(pkey->pkey.ecx);
 }
 
@@ -767,16 +775,81 @@ static int pkey_ecd_digestsign448(EVP_MD_CTX *ctx, unsigned char *sig,
     return 1;
 }
 
+static int ed25519_verify_one(const ECX_KEY *edkey, const unsigned char *sig,
+                              size_t siglen, const unsigned char *tbs,
+                              size_t tbslen)
+{
+    if (siglen != ED25519_SIGSIZE)
+        return 0;
+
+    if (edkey->ed25519_vctx != NULL)
+        return ED25519_verify_ctx(edkey->ed25519_vctx, tbs, tbslen, sig);
+    return ED25519_verify(tbs, tbslen, sig, edkey->pubkey);
+}
+
 static int pkey_ecd_digestverify25519(EVP_MD_CTX *ctx, const unsigned char *sig,
                                       size_t siglen, const unsigned char *tbs,
                                       size_t tbslen)
 {
     const ECX_KEY *edkey = EVP_MD_CTX_pkey_ctx(ctx)->pkey->pkey.ecx;
 
-    if (siglen != ED25519_SIGSIZE)
-        return 0;
+    return ed25519_verify_one(edkey, sig, siglen, tbs, tbslen);
+}
 
-    return ED25519_verify(tbs, tbslen, sig, edkey->pubkey);
+/*
+ * Check the signatures in chunks with ED25519_verify_batch(), and only
+ * verify them one by one if a chunk contains an invalid signature.
+ */
+static int pkey_ecd_digestverify_batch25519(EVP_PKEY *const pkey[],
+                                            const unsigned char *const sig[],
+                                            const size_t siglen[],
+                                            const unsigned char *const tbs[],
+                                            const size_t tbslen[],
+                                            const size_t idx[], size_t num,
+                                            int results[])
+{
+    const unsigned char *msgs[ED25519_VERIFY_BATCH_MAX];
+    size_t msglens[ED25519_VERIFY_BATCH_MAX];
+    const unsigned char *sigs[ED25519_VERIFY_BATCH_MAX];
+    const unsigned char *pubs[ED25519_VERIFY_BATCH_MAX];
+    const ED25519_VERIFY_CTX *vctxs[ED25519_VERIFY_BATCH_MAX];
+    size_t live[ED25519_VERIFY_BATCH_MAX];
+    const ECX_KEY *edkey;
+    size_t i = 0, j, n;
+    int ret = 1;
+
+    while (i < num) {
+        for (n = 0; i < num && n < ED25519_VERIFY_BATCH_MAX; i++) {
+            if (siglen[idx[i]] != ED25519_SIGSIZE) {
+                results[idx[i]] = 0;
+                ret = 0;
+                continue;
+            }
+            edkey = pkey[idx[i]]->pkey.ecx;
+            msgs[n] = tbs[idx[i]];
+            msglens[n] = tbslen[idx[i]];
+            sigs[n] = sig[idx[i]];
+            pubs[n] = edkey->pubkey;
+            vctxs[n] = edkey->ed25519_vctx;
+            live[n++] = idx[i];
+        }
+        if (n == 0)
+            continue;
+
+        if (ED25519_verify_batch(msgs, msglens, sigs, pubs, vctxs, n) == 1) {
+            for (j = 0; j < n; j++)
+                results[live[j]] = 1;
+            continue;
+        }
+        for (j = 0; j < n; j++) {
+            results[live[j]] =
+                ed25519_verify_one(pkey[live[j]]->pkey.ecx, sigs[j],
+                                   ED25519_SIGSIZE, msgs[j], msglens[j]);
+            if (results[live[j]] != 1)
+                ret = 0;
+        }
+    }
+    return ret;
 }
 
 static int pkey_ecd_digestverify448(EVP_MD_CTX *ctx, const unsigned char *sig,
@@ -815,7 +888,9 @@ const EVP_PKEY_METHOD ed25519_pkey_meth = {
     pkey_ecd_ctrl,
     0,
     pkey_ecd_digestsign25519,
-    pkey_ecd_digestverify25519
+    pkey_ecd_digestverify25519,
+    0, 0, 0,
+    pkey_ecd_digestverify_batch25519
 };
 
 const EVP_PKEY_METHOD ed448_pkey_meth = {
@@ -166,6 +166,6 @@ struct engine_st {
 
 typedef struct st_engine_pile ENGINE_PILE;
 
-DEFINE_LHASH_OF(ENGINE_PILE);
+DEFINE_OAHASH_OF(ENGINE_PILE);
 
 #endif                          /* HEADER_ENGINE_INT_H */
@@ -157,7 +157,7 @@ static void int_unregister_cb(ENGINE_PILE *pile, ENGINE *e)
     }
 }
 
-IMPLEMENT_LHASH_DOALL_ARG(ENGINE_PILE, ENGINE);
+IMPLEMENT_OAHASH_DOALL_ARG(ENGINE_PILE, ENGINE);
 
 void engine_table_unregister(ENGINE_TABLE **table, ENGINE *e)
 {
@@ -295,7 +295,7 @@ static void int_dall(const ENGINE_PILE *pile, ENGINE_PILE_DOALL *dall)
     dall->cb(pile->nid, pile->sk, pile->funct, dall->arg);
 }
 
-IMPLEMENT_LHASH_DOALL_ARG_CONST(ENGINE_PILE, ENGINE_PILE_DOALL);
+IMPLEMENT_OAHASH_DOALL_ARG_CONST(ENGINE_PILE, ENGINE_PILE_DOALL);
 
 void engine_table_doall(ENGINE_TABLE *table, engine_table_doall_cb *cb,
                         void *arg)
@@ -20,9 +20,35 @@
 #include <openssl/opensslconf.h>
 #include "internal/thread_once.h"
 
+/* The data is still to be formatted, see ERR_add_error_data_deferred() */
+#define ERR_TXT_DEFERRED        0x04
+
+/*
+ * Added to the flags of the error that was on top when ERR_suppress_start()
+ * was called, once per scope, unlike ERR_FLAG_MARK.
+ */
+#define ERR_FLAG_SUPPRESS       0x100
+
 static int err_load_strings(const ERR_STRING_DATA *str);
 
 static void ERR_STATE_free(ERR_STATE *s);
+static ERR_STATE *err_get_state_int(int create);
+
+/*
+ * Error data added with ERR_add_error_data_deferred(), kept newest first
+ * until someone asks for the data of the error.
+ */
+typedef struct err_deferred_st ERR_DEFERRED;
+struct err_deferred_st {
+    ERR_DEFERRED *next;
+    const char *sep;
+    char *(*format)(void *arg);
+    void *arg;
+    void (*free_arg)(void *arg);
+};
+
+static void err_deferred_free(ERR_DEFERRED *d);
+static void err_format_deferred(ERR_STATE *es, int i);
 #ifndef OPENSSL_NO_ERR
 static ERR_STRING_DATA ERR_str_libraries[] = {
     {ERR_PACK(ERR_LIB_NONE, 0, 0), "unknown library"},
@@ -139,6 +165,8 @@ static ERR_STRING_DATA ERR_str_reasons[] = {
 static CRYPTO_ONCE err_init = CRYPTO_ONCE_STATIC_INIT;
 static int set_err_thread_local;
 static CRYPTO_THREAD_LOCAL err_thread_local;
+/* Depth of the ERR_suppress_start() scopes of the thread, kept as a pointer */
+static CRYPTO_THREAD_LOCAL err_suppress_local;
 
 static CRYPTO_ONCE err_string_init = CRYPTO_ONCE_STATIC_INIT;
 static CRYPTO_RWLOCK *err_string_lock;
@@ -239,7 +267,10 @@ static void build_SYS_str_reasons(void)
 
 #define err_clear_data(p, i) \
         do { \
-            if ((p)->err_data_flags[i] & ERR_TXT_MALLOCED) {\
+            if ((p)->err_data_flags[i] & ERR_TXT_DEFERRED) { \
+                err_deferred_free((ERR_DEFERRED *)(p)->err_data[i]); \
+                (p)->err_data[i] = NULL; \
+            } else if ((p)->err_data_flags[i] & ERR_TXT_MALLOCED) { \
                 OPENSSL_free((p)->err_data[i]); \
                 (p)->err_data[i] = NULL; \
             } \
@@ -286,8 +317,10 @@ DEFINE_RUN_ONCE_STATIC(do_err_strings_init)
 
 void err_cleanup(void)
 {
-    if (set_err_thread_local != 0)
+    if (set_err_thread_local != 0) {
         CRYPTO_THREAD_cleanup_local(&err_thread_local);
+        CRYPTO_THREAD_cleanup_local(&err_suppress_local);
+    }
     CRYPTO_THREAD_lock_free(err_string_lock);
     err_string_lock = NULL;
     lh_ERR_STRING_DATA_free(int_error_hash);
@@ -418,7 +451,7 @@ void ERR_clear_error(void)
     int i;
     ERR_STATE *es;
 
-    es = ERR_get_state();
+    es = err_get_state_int(0);
     if (es == NULL)
         return;
 
@@ -484,7 +517,7 @@ static unsigned long get_error_values(int inc, int top, const char **file,
     ERR_STATE *es;
     unsigned long ret;
 
-    es = ERR_get_state();
+    es = err_get_state_int(0);
     if (es == NULL)
         return 0;
 
@@ -529,7 +562,10 @@ static unsigned long get_error_values(int inc, int top, const char **file,
             err_clear_data(es, i);
         }
     } else {
-        if (es->err_data[i] == NULL) {
+        if ((es->err_data_flags[i] & ERR_TXT_DEFERRED) != 0)
+            err_format_deferred(es, i);
+        if (es->err_data[i] == NULL
+                || (es->err_data_flags[i] & ERR_TXT_DEFERRED) != 0) {
             *data = "";
             if (flags != NULL)
                 *flags = 0;
@@ -668,11 +704,32 @@ void ERR_remove_state(unsigned long pid)
 
 DEFINE_RUN_ONCE_STATIC(err_do_init)
 {
+    if (!CRYPTO_THREAD_init_local(&err_thread_local, NULL))
+        return 0;
+    if (!CRYPTO_THREAD_init_local(&err_suppress_local, NULL)) {
+        CRYPTO_THREAD_cleanup_local(&err_thread_local);
+        return 0;
+    }
     set_err_thread_local = 1;
-    return CRYPTO_THREAD_init_local(&err_thread_local, NULL);
+    return 1;
+}
+
+/* Only to be called once err_do_init() has run */
+static size_t err_suppress_depth(void)
+{
+    return (size_t)CRYPTO_THREAD_get_local(&err_suppress_local);
 }
 
 ERR_STATE *ERR_get_state(void)
+{
+    return err_get_state_int(1);
+}
+
+/*
+ * Without |create|, return NULL rather than allocate the state of a thread
+ * that has never raised an error: there is nothing to look at or clear.
+ */
+static ERR_STATE *err_get_state_int(int create)
 {
     ERR_STATE *state;
 
@@ -686,7 +743,7 @@ ERR_STATE *ERR_get_state(void)
     if (state == (ERR_STATE*)-1)
         return NULL;
 
-    if (state == NULL) {
+    if (state == NULL && create) {
         if (!CRYPTO_THREAD_set_local(&err_thread_local, (ERR_STATE*)-1))
             return NULL;
 
@@ -756,9 +813,12 @@ void ERR_set_error_data(char *data, int flags)
     ERR_STATE *es;
     int i;
 
-    es = ERR_get_state();
-    if (es == NULL)
+    es = err_get_state_int(0);
+    if (es == NULL || err_suppress_depth() > 0) {
+        if (flags & ERR_TXT_MALLOCED)
+            OPENSSL_free(data);
         return;
+    }
 
     i = es->top;
 
@@ -779,6 +839,12 @@ void ERR_add_error_vdata(int num, va_list args)
 {
     int i, n, s;
     char *str, *p, *a;
+    ERR_STATE *es;
+
+    /* Nothing will ever see the data, don't bother putting it together */
+    es = err_get_state_int(0);
+    if (es == NULL || err_suppress_depth() > 0)
+        return;
 
     s = 80;
     if ((str = OPENSSL_malloc(s + 1)) == NULL) {
@@ -807,11 +873,128 @@ void ERR_add_error_vdata(int num, va_list args)
     ERR_set_error_data(str, ERR_TXT_MALLOCED | ERR_TXT_STRING);
 }
 
+static void err_free_string(void *str)
+{
+    OPENSSL_free(str);
+}
+
+static void err_deferred_free(ERR_DEFERRED *d)
+{
+    ERR_DEFERRED *next;
+
+    for (; d != NULL; d = next) {
+        next = d->next;
+        if (d->free_arg != NULL)
+            d->free_arg(d->arg);
+        OPENSSL_free(d);
+    }
+}
+
+/*
+ * Replace the deferred data of error |i| with the string it amounts to, or
+ * with no data if that can't be done.  This is called while the queue is
+ * read, so it must leave the queue alone: the error state is shelved while
+ * the callbacks run, and errors they raise are dropped.
+ */
+static void err_format_deferred(ERR_STATE *es, int i)
+{
+    ERR_DEFERRED *d = (ERR_DEFERRED *)es->err_data[i], *prev = NULL, *next;
+    char **parts = NULL, *str = NULL;
+    size_t n = 0, len = 0, k;
+    void *shelved;
+
+    if (!err_shelve_state(&shelved))
+        return;
+    es->err_data[i] = NULL;
+    es->err_data_flags[i] = 0;
+
+    for (; d != NULL; d = next, n++) {
+        next = d->next;
+        d->next = prev;
+        prev = d;
+    }
+    d = prev;
+    if ((parts = OPENSSL_zalloc(n * sizeof(*parts))) == NULL)
+        goto end;
+    for (k = 0, prev = d; prev != NULL; prev = prev->next, k++) {
+        parts[k] = prev->format != NULL ? prev->format(prev->arg)
+                                        : (char *)prev->arg;
+        len += strlen(prev->sep)
+               + (parts[k] != NULL ? strlen(parts[k]) : strlen("<NULL>"));
+    }
+    if ((str = OPENSSL_malloc(len + 1)) == NULL)
+        goto end;
+    str[0] = '\0';
+    for (k = 0, prev = d; prev != NULL; prev = prev->next, k++) {
+        OPENSSL_strlcat(str, prev->sep, len + 1);
+        OPENSSL_strlcat(str, parts[k] != NULL ? parts[k] : "<NULL>", len + 1);
+    }
+
+ end:
+    if (parts != NULL) {
+        for (k = 0, prev = d; prev != NULL; prev = prev->next, k++)
+            if (prev->format != NULL)
+                OPENSSL_free(parts[k]);
+        OPENSSL_free(parts);
+    }
+    err_deferred_free(d);
+    err_unshelve_state(shelved);
+    if (str != NULL) {
+        es->err_data[i] = str;
+        es->err_data_flags[i] = ERR_TXT_MALLOCED | ERR_TXT_STRING;
+    }
+}
+
+void ERR_add_error_data_deferred(const char *sep, char *(*format)(void *arg),
+                                 void *arg, void (*free_arg)(void *arg))
+{
+    ERR_STATE *es;
+    ERR_DEFERRED *d = NULL, *old;
+    int i;
+
+    es = err_get_state_int(0);
+    if (es == NULL || err_suppress_depth() > 0 || es->bottom == es->top)
+        goto err;
+    i = es->top;
+
+    /* Data set before is kept in front of the new one */
+    if ((es->err_data_flags[i] & ERR_TXT_DEFERRED) == 0
+            && es->err_data[i] != NULL) {
+        if ((es->err_data_flags[i] & ERR_TXT_STRING) == 0) {
+            err_clear_data(es, i);
+        } else {
+            if ((old = OPENSSL_zalloc(sizeof(*old))) == NULL)
+                goto err;
+            old->sep = "";
+            old->arg = es->err_data[i];
+            if ((es->err_data_flags[i] & ERR_TXT_MALLOCED) != 0)
+                old->free_arg = err_free_string;
+            es->err_data[i] = (char *)old;
+            es->err_data_flags[i] = ERR_TXT_DEFERRED;
+        }
+    }
+
+    if ((d = OPENSSL_malloc(sizeof(*d))) == NULL)
+        goto err;
+    d->sep = sep != NULL ? sep : "";
+    d->format = format;
+    d->arg = arg;
+    d->free_arg = free_arg;
+    d->next = (ERR_DEFERRED *)es->err_data[i];
+    es->err_data[i] = (char *)d;
+    es->err_data_flags[i] = ERR_TXT_DEFERRED;
+    return;
+
+ err:
+    if (free_arg != NULL)
+        free_arg(arg);
+}
+
 int ERR_set_mark(void)
 {
     ERR_STATE *es;
 
-    es = ERR_get_state();
+    es = err_get_state_int(0);
     if (es == NULL)
         return 0;
 
@@ -825,7 +1008,7 @@ int ERR_pop_to_mark(void)
 {
     ERR_STATE *es;
 
-    es = ERR_get_state();
+    es = err_get_state_int(0);
     if (es == NULL)
         return 0;
 
@@ -846,7 +1029,7 @@ int ERR_clear_last_mark(void)
     ERR_STATE *es;
     int top;
 
-    es = ERR_get_state();
+    es = err_get_state_int(0);
     if (es == NULL)
         return 0;
 
@@ -861,3 +1044,62 @@ int ERR_clear_last_mark(void)
     es->err_flags[top] &= ~ERR_FLAG_MARK;
     return 1;
 }
+
+/*
+ * Errors raised between ERR_suppress_start() and ERR_suppress_end() are
+ * recorded as usual, so that code in between can look at them, but any data
+ * added to them is dropped right away, and they are all removed at the end.
+ */
+int ERR_suppress_start(void)
+{
+    ERR_STATE *es;
+    size_t depth;
+
+    /*
+     * The depth is kept apart from the error state, so that a thread that
+     * raises no error in the scope doesn't allocate one.  Without the state
+     * there is nothing to mark either: there is no error to keep at the end.
+     */
+    if (!OPENSSL_init_crypto(OPENSSL_INIT_BASE_ONLY, NULL)
+            || !RUN_ONCE(&err_init, err_do_init))
+        return 0;
+
+    depth = err_suppress_depth();
+    if (!CRYPTO_THREAD_set_local(&err_suppress_local, (void *)(depth + 1)))
+        return 0;
+
+    es = err_get_state_int(0);
+    if (es != NULL && es->bottom != es->top)
+        es->err_flags[es->top] += ERR_FLAG_SUPPRESS;
+    return 1;
+}
+
+int ERR_suppress_end(void)
+{
+    ERR_STATE *es;
+    size_t depth;
+
+    if (!OPENSSL_init_crypto(OPENSSL_INIT_BASE_ONLY, NULL)
+            || !RUN_ONCE(&err_init, err_do_init))
+        return 0;
+
+    depth = err_suppress_depth();
+    if (depth == 0
+            || !CRYPTO_THREAD_set_local(&err_suppress_local, (void *)(depth - 1)))
+        return 0;
+
+    es = err_get_state_int(0);
+    if (es == NULL)
+        return 1;
+
+    /* Pop back to the error the innermost scope started at */
+    while (es->bottom != es->top
+           && es->err_flags[es->top] < ERR_FLAG_SUPPRESS) {
+        err_clear(es, es->top);
+        es->top = es->top > 0 ? es->top - 1 : ERR_NUM_ERRORS - 1;
+    }
+
+    if (es->bottom != es->top)
+        es->err_flags[es->top] -= ERR_FLAG_SUPPRESS;
+    return 1;
+}
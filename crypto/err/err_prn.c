@@ -18,9 +18,10 @@ void ERR_print_errors_cb(int (*cb) (const char *str, size_t len, void *u),
 {
     unsigned long l;
     char buf[256];
-    char buf2[4096];
+    char buf2[4096], *str;
     const char *file, *data;
-    int line, flags;
+    int line, flags, ret;
+    size_t len;
     /*
      * We don't know what kind of thing CRYPTO_THREAD_ID is. Here is our best
      * attempt to convert it into something we can print.
@@ -35,9 +36,22 @@ void ERR_print_errors_cb(int (*cb) (const char *str, size_t len, void *u),
 
     while ((l = ERR_get_error_line_data(&file, &line, &data, &flags)) != 0) {
         ERR_error_string_n(l, buf, sizeof(buf));
-        BIO_snprintf(buf2, sizeof(buf2), "%lu:%s:%s:%d:%s\n", tid.ltid, buf,
-                     file, line, (flags & ERR_TXT_STRING) ? data : "");
-        if (cb(buf2, strlen(buf2), u) <= 0)
+        if ((flags & ERR_TXT_STRING) == 0)
+            data = "";
+        /* The data may be longer than usual, when it was put together late */
+        str = buf2;
+        len = 2 * 3 * sizeof(unsigned long) + strlen(buf) + strlen(file)
+              + strlen(data) + 6;
+        if (len <= sizeof(buf2) || (str = OPENSSL_malloc(len)) == NULL) {
+            str = buf2;
+            len = sizeof(buf2);
+        }
+        BIO_snprintf(str, len, "%lu:%s:%s:%d:%s\n", tid.ltid, buf,
+                     file, line, data);
+        ret = cb(str, strlen(str), u);
+        if (str != buf2)
+            OPENSSL_free(str);
+        if (ret <= 0)
             break;              /* abort outputting the error report */
     }
 }
@@ -50,6 +50,8 @@ void openssl_add_all_digests_int(void)
 #ifndef OPENSSL_NO_BLAKE2
     EVP_add_digest(EVP_blake2b512());
     EVP_add_digest(EVP_blake2s256());
+    EVP_add_digest(EVP_blake2bp512());
+    EVP_add_digest(EVP_blake2sp256());
 #endif
     EVP_add_digest(EVP_sha3_224());
     EVP_add_digest(EVP_sha3_256());
@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2016 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -278,6 +278,33 @@ int EVP_Digest(const void *data, size_t count,
     return ret;
 }
 
+int EVP_DigestMulti(const EVP_MD *type, const unsigned char *const data[],
+                    const size_t datalen[], unsigned char *const md[],
+                    size_t num)
+{
+    int multi = type->md_multi != NULL;
+    size_t i;
+
+#ifndef OPENSSL_NO_ENGINE
+    /* An ENGINE that is reserved for this digest takes precedence */
+    if (multi) {
+        ENGINE *impl = ENGINE_get_digest_engine(type->type);
+
+        if (impl != NULL) {
+            ENGINE_finish(impl);
+            multi = 0;
+        }
+    }
+#endif
+    if (multi)
+        return type->md_multi(data, datalen, md, num);
+
+    for (i = 0; i < num; i++)
+        if (!EVP_Digest(data[i], datalen[i], md[i], NULL, type, NULL))
+            return 0;
+    return 1;
+}
+
 int EVP_MD_CTX_ctrl(EVP_MD_CTX *ctx, int cmd, int p1, void *p2)
 {
     if (ctx->digest && ctx->digest->md_ctrl) {
@@ -249,18 +249,67 @@ size_t aesni_gcm_encrypt(const unsigned char *in,
                          unsigned char *out,
                          size_t len,
                          const void *key, unsigned char ivec[16], u64 *Xi);
-#  define AES_gcm_encrypt aesni_gcm_encrypt
 size_t aesni_gcm_decrypt(const unsigned char *in,
                          unsigned char *out,
                          size_t len,
                          const void *key, unsigned char ivec[16], u64 *Xi);
-#  define AES_gcm_decrypt aesni_gcm_decrypt
+size_t aesni_gcm_encrypt_avx512(const unsigned char *in,
+                                unsigned char *out,
+                                size_t len,
+                                const void *key, unsigned char ivec[16],
+                                u64 *Xi);
+size_t aesni_gcm_decrypt_avx512(const unsigned char *in,
+                                unsigned char *out,
+                                size_t len,
+                                const void *key, unsigned char ivec[16],
+                                u64 *Xi);
+/* AVX512F+BW+VL, VAES and VPCLMULQDQ */
+#  define AESNI_GCM_AVX512_CAPABLE \
+        ((OPENSSL_ia32cap_P[2] & 0xc0010000) == 0xc0010000 && \
+         (OPENSSL_ia32cap_P[3] & 0x600) == 0x600)
+
+/*
+ * The AVX512 kernels process multiples of 256 bytes, and what is left
+ * is passed on to the AVX ones, which in turn leave a tail to the caller.
+ */
+static size_t aesni_gcm_encrypt_bulk(const unsigned char *in,
+                                     unsigned char *out, size_t len,
+                                     const void *key, unsigned char ivec[16],
+                                     u64 *Xi)
+{
+    size_t bulk = 0;
+
+    if (AESNI_GCM_AVX512_CAPABLE)
+        bulk = aesni_gcm_encrypt_avx512(in, out, len, key, ivec, Xi);
+    return bulk + aesni_gcm_encrypt(in + bulk, out + bulk, len - bulk,
+                                    key, ivec, Xi);
+}
+
+static size_t aesni_gcm_decrypt_bulk(const unsigned char *in,
+                                     unsigned char *out, size_t len,
+                                     const void *key, unsigned char ivec[16],
+                                     u64 *Xi)
+{
+    size_t bulk = 0;
+
+    if (AESNI_GCM_AVX512_CAPABLE)
+        bulk = aesni_gcm_decrypt_avx512(in, out, len, key, ivec, Xi);
+    return bulk + aesni_gcm_decrypt(in + bulk, out + bulk, len - bulk,
+                                    key, ivec, Xi);
+}
+#  define AES_gcm_encrypt aesni_gcm_encrypt_bulk
+#  define AES_gcm_decrypt aesni_gcm_decrypt_bulk
 void gcm_ghash_avx(u64 Xi[2], const u128 Htable[16], const u8 *in,
                    size_t len);
+void gcm_ghash_avx512(u64 Xi[2], const u128 Htable[16], const u8 *in,
+                      size_t len);
+/* Both share the table layout expected by the assembly above */
+#  define AES_GCM_GHASH_AVX(gctx) (gctx->gcm.ghash==gcm_ghash_avx || \
+                                 gctx->gcm.ghash==gcm_ghash_avx512)
 #  define AES_GCM_ASM(gctx)       (gctx->ctr==aesni_ctr32_encrypt_blocks && \
-                                 gctx->gcm.ghash==gcm_ghash_avx)
+                                 AES_GCM_GHASH_AVX(gctx))
 #  define AES_GCM_ASM2(gctx)      (gctx->gcm.block==(block128_f)aesni_encrypt && \
-                                 gctx->gcm.ghash==gcm_ghash_avx)
+                                 AES_GCM_GHASH_AVX(gctx))
 #  undef AES_GCM_ASM2          /* minor size optimization */
 # endif
 
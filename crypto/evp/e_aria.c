@@ -10,6 +10,7 @@
 
 #include "internal/cryptlib.h"
 #ifndef OPENSSL_NO_ARIA
+# include <string.h>
 # include <openssl/evp.h>
 # include <openssl/modes.h>
 # include <openssl/rand.h>
@@ -33,6 +34,7 @@ typedef struct {
     int key_set;                /* Set if key initialised */
     int iv_set;                 /* Set if an iv is set */
     GCM128_CONTEXT gcm;
+    ctr128_f ctr;               /* Parallel CTR, if available */
     unsigned char *iv;          /* Temporary IV store */
     int ivlen;                  /* IV length */
     int taglen;
@@ -56,6 +58,111 @@ typedef struct {
     ccm128_f str;
 } EVP_ARIA_CCM_CTX;
 
+/*
+ * The assembly kernels read the round keys as laid out by the table-based
+ * key schedule, the small footprint one stores them differently.
+ */
+# if defined(ARIA_ASM) && !defined(OPENSSL_SMALL_FOOTPRINT) && \
+     (defined(__x86_64) || defined(_M_AMD64) || defined(_M_X64))
+#  define ARIA_X86_64
+
+extern unsigned int OPENSSL_ia32cap_P[];
+
+int aria_gfni_eligible(void);
+size_t aria_gfni_avx2_encrypt_blocks(const unsigned char *in,
+                                     unsigned char *out, size_t blocks,
+                                     const ARIA_KEY *key);
+size_t aria_gfni_avx512_encrypt_blocks(const unsigned char *in,
+                                       unsigned char *out, size_t blocks,
+                                       const ARIA_KEY *key);
+
+/* AVX, AVX2 and GFNI, and an assembler that could encode them */
+#  define ARIA_GFNI_CAPABLE \
+        ((OPENSSL_ia32cap_P[1] & (1 << 28)) != 0 && \
+         (OPENSSL_ia32cap_P[2] & (1 << 5)) != 0 && \
+         (OPENSSL_ia32cap_P[3] & 0x100) != 0 && \
+         aria_gfni_eligible())
+/* AVX512F+BW in addition */
+#  define ARIA_GFNI_AVX512_CAPABLE \
+        (ARIA_GFNI_CAPABLE && \
+         (OPENSSL_ia32cap_P[2] & 0x40010000) == 0x40010000)
+
+/* Number of counter blocks encrypted at once */
+#  define ARIA_CHUNK_BLOCKS 128
+
+static ossl_inline void aria_xor_block(unsigned char *out,
+                                       const unsigned char *a,
+                                       const unsigned char *b)
+{
+    uint64_t x[2], y[2];
+
+    memcpy(x, a, ARIA_BLOCK_SIZE);
+    memcpy(y, b, ARIA_BLOCK_SIZE);
+    x[0] ^= y[0];
+    x[1] ^= y[1];
+    memcpy(out, x, ARIA_BLOCK_SIZE);
+}
+
+/*
+ * Encrypt |blocks| independent blocks with the widest kernel available.
+ * The kernels work on multiples of 64 and 32 blocks, a tail of at least 4
+ * blocks is padded out to 32 and whatever the kernels leave is done by the
+ * C code.
+ */
+static void aria_x86_64_encrypt_blocks(const unsigned char *in,
+                                       unsigned char *out, size_t blocks,
+                                       const ARIA_KEY *key)
+{
+    unsigned char buf[32 * ARIA_BLOCK_SIZE];
+    size_t done = 0;
+
+    if (ARIA_GFNI_AVX512_CAPABLE)
+        done = aria_gfni_avx512_encrypt_blocks(in, out, blocks, key);
+    done += aria_gfni_avx2_encrypt_blocks(in + done * ARIA_BLOCK_SIZE,
+                                          out + done * ARIA_BLOCK_SIZE,
+                                          blocks - done, key);
+    if (blocks - done >= 4 && blocks - done < 32) {
+        memcpy(buf, in + done * ARIA_BLOCK_SIZE,
+               (blocks - done) * ARIA_BLOCK_SIZE);
+        if (aria_gfni_avx2_encrypt_blocks(buf, buf, 32, key) == 32) {
+            memcpy(out + done * ARIA_BLOCK_SIZE, buf,
+                   (blocks - done) * ARIA_BLOCK_SIZE);
+            done = blocks;
+        }
+        OPENSSL_cleanse(buf, sizeof(buf));
+    }
+    for (; done < blocks; done++)
+        aria_encrypt(in + done * ARIA_BLOCK_SIZE,
+                     out + done * ARIA_BLOCK_SIZE, key);
+}
+
+static void aria_x86_64_ctr32_encrypt_blocks(const unsigned char *in,
+                                             unsigned char *out,
+                                             size_t blocks, const void *key,
+                                             const unsigned char ivec[16])
+{
+    unsigned char buf[ARIA_CHUNK_BLOCKS * ARIA_BLOCK_SIZE];
+    u32 ctr = GETU32(ivec + 12);
+    size_t n, i;
+
+    while (blocks > 0) {
+        n = blocks < ARIA_CHUNK_BLOCKS ? blocks : ARIA_CHUNK_BLOCKS;
+        for (i = 0; i < n; i++, ctr++) {
+            memcpy(buf + i * ARIA_BLOCK_SIZE, ivec, 12);
+            PUTU32(buf + i * ARIA_BLOCK_SIZE + 12, ctr);
+        }
+        aria_x86_64_encrypt_blocks(buf, buf, n, key);
+        for (i = 0; i < n; i++)
+            aria_xor_block(out + i * ARIA_BLOCK_SIZE,
+                           in + i * ARIA_BLOCK_SIZE, buf + i * ARIA_BLOCK_SIZE);
+        in += n * ARIA_BLOCK_SIZE;
+        out += n * ARIA_BLOCK_SIZE;
+        blocks -= n;
+    }
+    OPENSSL_cleanse(buf, sizeof(buf));
+}
+# endif
+
 /* The subkey for ARIA is generated. */
 static int aria_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
                             const unsigned char *iv, int enc)
@@ -174,10 +281,18 @@ static int aria_ctr_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
     unsigned int num = EVP_CIPHER_CTX_num(ctx);
     EVP_ARIA_KEY *dat = EVP_C_DATA(EVP_ARIA_KEY,ctx);
 
-    CRYPTO_ctr128_encrypt(in, out, len, &dat->ks,
-                          EVP_CIPHER_CTX_iv_noconst(ctx),
-                          EVP_CIPHER_CTX_buf_noconst(ctx), &num,
-                          (block128_f) aria_encrypt);
+# ifdef ARIA_X86_64
+    if (ARIA_GFNI_CAPABLE)
+        CRYPTO_ctr128_encrypt_ctr32(in, out, len, &dat->ks,
+                                    EVP_CIPHER_CTX_iv_noconst(ctx),
+                                    EVP_CIPHER_CTX_buf_noconst(ctx), &num,
+                                    aria_x86_64_ctr32_encrypt_blocks);
+    else
+# endif
+        CRYPTO_ctr128_encrypt(in, out, len, &dat->ks,
+                              EVP_CIPHER_CTX_iv_noconst(ctx),
+                              EVP_CIPHER_CTX_buf_noconst(ctx), &num,
+                              (block128_f) aria_encrypt);
     EVP_CIPHER_CTX_set_num(ctx, num);
     return 1;
 }
@@ -217,6 +332,11 @@ static int aria_gcm_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
                                    &gctx->ks.ks);
         CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
                            (block128_f) aria_encrypt);
+        gctx->ctr = NULL;
+# ifdef ARIA_X86_64
+        if (ARIA_GFNI_CAPABLE)
+            gctx->ctr = aria_x86_64_ctr32_encrypt_blocks;
+# endif
         if (ret < 0) {
             EVPerr(EVP_F_ARIA_GCM_INIT_KEY,EVP_R_ARIA_KEY_SETUP_FAILED);
             return 0;
@@ -414,16 +534,26 @@ static int aria_gcm_tls_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
     len -= EVP_GCM_TLS_EXPLICIT_IV_LEN + EVP_GCM_TLS_TAG_LEN;
     if (EVP_CIPHER_CTX_encrypting(ctx)) {
         /* Encrypt payload */
-        if (CRYPTO_gcm128_encrypt(&gctx->gcm, in, out, len))
+        if (gctx->ctr != NULL) {
+            if (CRYPTO_gcm128_encrypt_ctr32(&gctx->gcm, in, out, len,
+                                            gctx->ctr))
+                goto err;
+        } else if (CRYPTO_gcm128_encrypt(&gctx->gcm, in, out, len)) {
             goto err;
+        }
         out += len;
         /* Finally write tag */
         CRYPTO_gcm128_tag(&gctx->gcm, out, EVP_GCM_TLS_TAG_LEN);
         rv = len + EVP_GCM_TLS_EXPLICIT_IV_LEN + EVP_GCM_TLS_TAG_LEN;
     } else {
         /* Decrypt */
-        if (CRYPTO_gcm128_decrypt(&gctx->gcm, in, out, len))
+        if (gctx->ctr != NULL) {
+            if (CRYPTO_gcm128_decrypt_ctr32(&gctx->gcm, in, out, len,
+                                            gctx->ctr))
+                goto err;
+        } else if (CRYPTO_gcm128_decrypt(&gctx->gcm, in, out, len)) {
             goto err;
+        }
         /* Retrieve tag */
         CRYPTO_gcm128_tag(&gctx->gcm, EVP_CIPHER_CTX_buf_noconst(ctx),
                           EVP_GCM_TLS_TAG_LEN);
@@ -461,11 +591,21 @@ static int aria_gcm_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
             if (CRYPTO_gcm128_aad(&gctx->gcm, in, len))
                 return -1;
         } else if (EVP_CIPHER_CTX_encrypting(ctx)) {
-            if (CRYPTO_gcm128_encrypt(&gctx->gcm, in, out, len))
+            if (gctx->ctr != NULL) {
+                if (CRYPTO_gcm128_encrypt_ctr32(&gctx->gcm, in, out, len,
+                                                gctx->ctr))
+                    return -1;
+            } else if (CRYPTO_gcm128_encrypt(&gctx->gcm, in, out, len)) {
                 return -1;
+            }
         } else {
-            if (CRYPTO_gcm128_decrypt(&gctx->gcm, in, out, len))
+            if (gctx->ctr != NULL) {
+                if (CRYPTO_gcm128_decrypt_ctr32(&gctx->gcm, in, out, len,
+                                                gctx->ctr))
+                    return -1;
+            } else if (CRYPTO_gcm128_decrypt(&gctx->gcm, in, out, len)) {
                 return -1;
+            }
         }
         return len;
     }
@@ -1,5 +1,5 @@
 /*
- * Copyright 2017 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2017-2018 The OpenSSL Project Authors. All Rights Reserved.
  * Copyright 2017 Ribose Inc. All Rights Reserved.
  * Ported from Ribose contributions from Botan.
  *
@@ -11,15 +11,149 @@
 
 #include "internal/cryptlib.h"
 #ifndef OPENSSL_NO_SM4
+# include <string.h>
 # include <openssl/evp.h>
 # include <openssl/modes.h>
 # include "internal/sm4.h"
 # include "internal/evp_int.h"
+# include "modes_lcl.h"
 
 typedef struct {
     SM4_KEY ks;
 } EVP_SM4_KEY;
 
+# if defined(SM4_ASM) && (defined(__x86_64) || defined(_M_AMD64) || \
+                          defined(_M_X64))
+#  define SM4_X86_64
+
+extern unsigned int OPENSSL_ia32cap_P[];
+
+int sm4_aesni_avx_eligible(void);
+int sm4_gfni_avx512_eligible(void);
+size_t sm4_aesni_avx_blocks(const unsigned char *in, unsigned char *out,
+                            size_t blocks, const SM4_KEY *key, int enc);
+size_t sm4_gfni_avx512_blocks(const unsigned char *in, unsigned char *out,
+                              size_t blocks, const SM4_KEY *key, int enc);
+
+/* AES-NI and AVX, and an assembler that could encode them */
+#  define SM4_AESNI_CAPABLE \
+        ((OPENSSL_ia32cap_P[1] & 0x12000000) == 0x12000000 && \
+         sm4_aesni_avx_eligible())
+/* AVX512F+BW and GFNI, likewise */
+#  define SM4_GFNI_CAPABLE \
+        ((OPENSSL_ia32cap_P[2] & 0x40010000) == 0x40010000 && \
+         (OPENSSL_ia32cap_P[3] & 0x100) != 0 && \
+         sm4_gfni_avx512_eligible())
+
+/* Number of blocks CTR and CBC decryption pass to the kernels at once */
+#  define SM4_CHUNK_BLOCKS 64
+
+static ossl_inline void sm4_xor_block(unsigned char *out,
+                                      const unsigned char *a,
+                                      const unsigned char *b)
+{
+    uint64_t x[2], y[2];
+
+    memcpy(x, a, SM4_BLOCK_SIZE);
+    memcpy(y, b, SM4_BLOCK_SIZE);
+    x[0] ^= y[0];
+    x[1] ^= y[1];
+    memcpy(out, x, SM4_BLOCK_SIZE);
+}
+
+/*
+ * Encrypt or decrypt |blocks| independent blocks with the widest kernel
+ * available.  The kernels work on multiples of 16 and 4 blocks, so a tail
+ * of 1 to 3 blocks is padded out to 4, and whatever the kernels leave is
+ * done by the C code.
+ */
+static void sm4_x86_64_blocks(const unsigned char *in, unsigned char *out,
+                              size_t blocks, const SM4_KEY *key, int enc)
+{
+    unsigned char buf[4 * SM4_BLOCK_SIZE];
+    size_t done = 0;
+
+    if (SM4_GFNI_CAPABLE)
+        done = sm4_gfni_avx512_blocks(in, out, blocks, key, enc);
+    done += sm4_aesni_avx_blocks(in + done * SM4_BLOCK_SIZE,
+                                 out + done * SM4_BLOCK_SIZE,
+                                 blocks - done, key, enc);
+    if (done < blocks && blocks - done < 4) {
+        memcpy(buf, in + done * SM4_BLOCK_SIZE,
+               (blocks - done) * SM4_BLOCK_SIZE);
+        if (sm4_aesni_avx_blocks(buf, buf, 4, key, enc) == 4) {
+            memcpy(out + done * SM4_BLOCK_SIZE, buf,
+                   (blocks - done) * SM4_BLOCK_SIZE);
+            done = blocks;
+        }
+        OPENSSL_cleanse(buf, sizeof(buf));
+    }
+    for (; done < blocks; done++) {
+        if (enc == SM4_ENCRYPT)
+            SM4_encrypt(in + done * SM4_BLOCK_SIZE,
+                        out + done * SM4_BLOCK_SIZE, key);
+        else
+            SM4_decrypt(in + done * SM4_BLOCK_SIZE,
+                        out + done * SM4_BLOCK_SIZE, key);
+    }
+}
+
+static void sm4_x86_64_ctr32_encrypt_blocks(const unsigned char *in,
+                                            unsigned char *out,
+                                            size_t blocks, const void *key,
+                                            const unsigned char ivec[16])
+{
+    unsigned char buf[SM4_CHUNK_BLOCKS * SM4_BLOCK_SIZE];
+    u32 ctr = GETU32(ivec + 12);
+    size_t n, i;
+
+    while (blocks > 0) {
+        n = blocks < SM4_CHUNK_BLOCKS ? blocks : SM4_CHUNK_BLOCKS;
+        for (i = 0; i < n; i++, ctr++) {
+            memcpy(buf + i * SM4_BLOCK_SIZE, ivec, 12);
+            PUTU32(buf + i * SM4_BLOCK_SIZE + 12, ctr);
+        }
+        sm4_x86_64_blocks(buf, buf, n, key, SM4_ENCRYPT);
+        for (i = 0; i < n; i++)
+            sm4_xor_block(out + i * SM4_BLOCK_SIZE, in + i * SM4_BLOCK_SIZE,
+                          buf + i * SM4_BLOCK_SIZE);
+        in += n * SM4_BLOCK_SIZE;
+        out += n * SM4_BLOCK_SIZE;
+        blocks -= n;
+    }
+    OPENSSL_cleanse(buf, sizeof(buf));
+}
+
+static void sm4_x86_64_cbc_decrypt(const unsigned char *in,
+                                   unsigned char *out, size_t len,
+                                   const SM4_KEY *key, unsigned char *ivec)
+{
+    unsigned char buf[SM4_CHUNK_BLOCKS * SM4_BLOCK_SIZE];
+    unsigned char iv[SM4_BLOCK_SIZE];
+    size_t blocks = len / SM4_BLOCK_SIZE, n, i;
+
+    while (blocks > 0) {
+        n = blocks < SM4_CHUNK_BLOCKS ? blocks : SM4_CHUNK_BLOCKS;
+        sm4_x86_64_blocks(in, buf, n, key, SM4_DECRYPT);
+        memcpy(iv, in + (n - 1) * SM4_BLOCK_SIZE, SM4_BLOCK_SIZE);
+        /* Back to front, so that |out| may be the same as |in| */
+        for (i = n - 1; i > 0; i--)
+            sm4_xor_block(out + i * SM4_BLOCK_SIZE, buf + i * SM4_BLOCK_SIZE,
+                          in + (i - 1) * SM4_BLOCK_SIZE);
+        sm4_xor_block(out, buf, ivec);
+        memcpy(ivec, iv, SM4_BLOCK_SIZE);
+        in += n * SM4_BLOCK_SIZE;
+        out += n * SM4_BLOCK_SIZE;
+        blocks -= n;
+    }
+    OPENSSL_cleanse(buf, sizeof(buf));
+
+    if (len % SM4_BLOCK_SIZE != 0)
+        CRYPTO_cbc128_decrypt(in, out, len % SM4_BLOCK_SIZE, key, ivec,
+                              (block128_f)SM4_decrypt);
+}
+# endif
+
 static int sm4_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
                         const unsigned char *iv, int enc)
 {
@@ -34,6 +168,10 @@ static void sm4_cbc_encrypt(const unsigned char *in, unsigned char *out,
     if (enc)
         CRYPTO_cbc128_encrypt(in, out, len, key, ivec,
                               (block128_f)SM4_encrypt);
+# ifdef SM4_X86_64
+    else if (SM4_AESNI_CAPABLE)
+        sm4_x86_64_cbc_decrypt(in, out, len, key, ivec);
+# endif
     else
         CRYPTO_cbc128_decrypt(in, out, len, key, ivec,
                               (block128_f)SM4_decrypt);
@@ -74,10 +212,18 @@ static int sm4_ctr_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
     unsigned int num = EVP_CIPHER_CTX_num(ctx);
     EVP_SM4_KEY *dat = EVP_C_DATA(EVP_SM4_KEY, ctx);
 
-    CRYPTO_ctr128_encrypt(in, out, len, &dat->ks,
-                          EVP_CIPHER_CTX_iv_noconst(ctx),
-                          EVP_CIPHER_CTX_buf_noconst(ctx), &num,
-                          (block128_f)SM4_encrypt);
+# ifdef SM4_X86_64
+    if (SM4_AESNI_CAPABLE)
+        CRYPTO_ctr128_encrypt_ctr32(in, out, len, &dat->ks,
+                                    EVP_CIPHER_CTX_iv_noconst(ctx),
+                                    EVP_CIPHER_CTX_buf_noconst(ctx), &num,
+                                    sm4_x86_64_ctr32_encrypt_blocks);
+    else
+# endif
+        CRYPTO_ctr128_encrypt(in, out, len, &dat->ks,
+                              EVP_CIPHER_CTX_iv_noconst(ctx),
+                              EVP_CIPHER_CTX_buf_noconst(ctx), &num,
+                              (block128_f)SM4_encrypt);
     EVP_CIPHER_CTX_set_num(ctx, num);
     return 1;
 }
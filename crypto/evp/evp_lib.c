@@ -338,8 +338,11 @@ EVP_MD *EVP_MD_meth_dup(const EVP_MD *md)
 {
     EVP_MD *to = EVP_MD_meth_new(md->type, md->pkey_type);
 
-    if (to != NULL)
+    if (to != NULL) {
         memcpy(to, md, sizeof(*to));
+        /* The multi-buffer routine is only valid for the original method */
+        to->md_multi = NULL;
+    }
     return to;
 }
 void EVP_MD_meth_free(EVP_MD *md)
@@ -369,6 +372,7 @@ int EVP_MD_meth_set_flags(EVP_MD *md, unsigned long flags)
 int EVP_MD_meth_set_init(EVP_MD *md, int (*init)(EVP_MD_CTX *ctx))
 {
     md->init = init;
+    md->md_multi = NULL;
     return 1;
 }
 int EVP_MD_meth_set_update(EVP_MD *md, int (*update)(EVP_MD_CTX *ctx,
@@ -376,12 +380,14 @@ int EVP_MD_meth_set_update(EVP_MD *md, int (*update)(EVP_MD_CTX *ctx,
                                                      size_t count))
 {
     md->update = update;
+    md->md_multi = NULL;
     return 1;
 }
 int EVP_MD_meth_set_final(EVP_MD *md, int (*final)(EVP_MD_CTX *ctx,
                                                    unsigned char *md))
 {
     md->final = final;
+    md->md_multi = NULL;
     return 1;
 }
 int EVP_MD_meth_set_copy(EVP_MD *md, int (*copy)(EVP_MD_CTX *to,
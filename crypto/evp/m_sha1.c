@@ -103,7 +103,8 @@ static const EVP_MD sha1_md = {
     NULL,
     SHA_CBLOCK,
     sizeof(EVP_MD *) + sizeof(SHA_CTX),
-    ctrl
+    ctrl,
+    sha1_multi
 };
 
 const EVP_MD *EVP_sha1(void)
@@ -153,6 +154,8 @@ static const EVP_MD sha224_md = {
     NULL,
     SHA256_CBLOCK,
     sizeof(EVP_MD *) + sizeof(SHA256_CTX),
+    NULL,
+    sha224_multi
 };
 
 const EVP_MD *EVP_sha224(void)
@@ -172,6 +175,8 @@ static const EVP_MD sha256_md = {
     NULL,
     SHA256_CBLOCK,
     sizeof(EVP_MD *) + sizeof(SHA256_CTX),
+    NULL,
+    sha256_multi
 };
 
 const EVP_MD *EVP_sha256(void)
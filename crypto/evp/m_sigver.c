@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2016 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2006-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -209,3 +209,69 @@ int EVP_DigestVerify(EVP_MD_CTX *ctx, const unsigned char *sigret,
         return -1;
     return EVP_DigestVerifyFinal(ctx, sigret, siglen);
 }
+
+/* The ENGINE, if any, whose method an EVP_PKEY_CTX for |pkey| is bound to */
+static ENGINE *sigver_engine(const EVP_PKEY *pkey)
+{
+    return pkey->pmeth_engine != NULL ? pkey->pmeth_engine : pkey->engine;
+}
+
+int EVP_DigestVerifyBatch(EVP_PKEY *const pkey[],
+                          const unsigned char *const sig[],
+                          const size_t siglen[],
+                          const unsigned char *const tbs[],
+                          const size_t tbslen[], size_t num, int results[])
+{
+    EVP_MD_CTX *mctx = NULL;
+    EVP_PKEY_CTX *pctx;
+    size_t *idx = NULL;
+    size_t i, j, n;
+    int ret = 1;
+
+    /* 2 marks the signatures still to be verified */
+    for (i = 0; i < num; i++)
+        results[i] = 2;
+
+    for (i = 0; i < num; i++) {
+        if (results[i] != 2)
+            continue;
+
+        if (mctx == NULL)
+            mctx = EVP_MD_CTX_new();
+        else
+            EVP_MD_CTX_reset(mctx);
+        if (mctx == NULL
+                || EVP_DigestVerifyInit(mctx, &pctx, NULL, NULL,
+                                        pkey[i]) <= 0) {
+            results[i] = -1;
+            continue;
+        }
+
+        if (pctx->pmeth->digestverify_batch != NULL
+                && (idx != NULL
+                    || (idx = OPENSSL_malloc(num * sizeof(*idx))) != NULL)) {
+            /* Verify all the keys handled by the same method together */
+            for (j = i, n = 0; j < num; j++) {
+                if (results[j] == 2
+                        && EVP_PKEY_id(pkey[j]) == EVP_PKEY_id(pkey[i])
+                        && sigver_engine(pkey[j]) == sigver_engine(pkey[i]))
+                    idx[n++] = j;
+            }
+            pctx->pmeth->digestverify_batch(pkey, sig, siglen, tbs, tbslen,
+                                            idx, n, results);
+        } else {
+            results[i] = EVP_DigestVerify(mctx, sig[i], siglen[i], tbs[i],
+                                          tbslen[i]);
+        }
+    }
+    EVP_MD_CTX_free(mctx);
+    OPENSSL_free(idx);
+
+    for (i = 0; i < num; i++) {
+        if (results[i] < 0)
+            ret = -1;
+        else if (results[i] == 0 && ret == 1)
+            ret = 0;
+    }
+    return ret;
+}
@@ -12,11 +12,26 @@
 #include <string.h>
 #include <openssl/evp.h>
 #include <openssl/err.h>
+#include "internal/cryptlib.h"
 #include "internal/numbers.h"
 
 #ifndef OPENSSL_NO_SCRYPT
 
-#define R(a,b) (((a) << (b)) | ((a) >> (32 - (b))))
+#if defined(SCRYPT_ASM) && !defined(__ILP32__) && \
+    (defined(__x86_64) || defined(_M_AMD64) || defined(_M_X64))
+# define SCRYPT_BLOCKMIX_ASM
+int scrypt_blockmix_width(void);
+void scrypt_blockmix_sse2(uint32_t *out, const uint32_t *in, size_t r);
+void scrypt_blockmix_avx2_x2(uint32_t *out0, const uint32_t *in0,
+                             uint32_t *out1, const uint32_t *in1, size_t r);
+/* The assembly wants word 5 * i % 16 of each block at position i */
+# define SCRYPT_POS(k)  ((k) - (k) % 16 + (k) % 16 * 13 % 16)
+#else
+# define SCRYPT_POS(k)  (k)
+#endif
+
+#ifndef SCRYPT_BLOCKMIX_ASM
+# define R(a,b) (((a) << (b)) | ((a) >> (32 - (b))))
 static void salsa208_word_specification(uint32_t inout[16])
 {
     int i;
@@ -76,42 +91,111 @@ static void scryptBlockMix(uint32_t *B_, uint32_t *B, uint64_t r)
     }
     OPENSSL_cleanse(X, sizeof(X));
 }
+#endif
 
-static void scryptROMix(unsigned char *B, uint64_t r, uint64_t N,
-                        uint32_t *X, uint32_t *T, uint32_t *V)
+/* BlockMix |in0| into |out0| and, if |n| is 2, |in1| into |out1| with it */
+static void scryptBlockMixN(int n, uint32_t *out0, uint32_t *in0,
+                            uint32_t *out1, uint32_t *in1, uint64_t r)
+{
+#ifdef SCRYPT_BLOCKMIX_ASM
+    if (n == 2)
+        scrypt_blockmix_avx2_x2(out0, in0, out1, in1, (size_t)r);
+    else
+        scrypt_blockmix_sse2(out0, in0, (size_t)r);
+#else
+    scryptBlockMix(out0, in0, r);
+#endif
+}
+
+/*
+ * ROMix of |n| consecutive lanes of |B| at once, |n| being 1 or 2.  Each
+ * lane has its own X, T and V at |XTV|, 32 * r * (N + 2) words apart.
+ */
+static void scryptROMix(unsigned char *B, uint64_t r, uint64_t N, int n,
+                        uint32_t *XTV)
 {
     unsigned char *pB;
-    uint32_t *pV;
+    uint32_t *X[2], *T[2], *V[2], *pV;
     uint64_t i, k;
+    int l;
+
+    for (l = 0; l < 2; l++) {
+        X[l] = XTV + 32 * r * (N + 2) * (l % n);
+        T[l] = X[l] + 32 * r;
+        V[l] = T[l] + 32 * r;
+    }
 
     /* Convert from little endian input */
-    for (pV = V, i = 0, pB = B; i < 32 * r; i++, pV++) {
-        *pV = *pB++;
-        *pV |= *pB++ << 8;
-        *pV |= *pB++ << 16;
-        *pV |= (uint32_t)*pB++ << 24;
+    for (l = 0, pB = B; l < n; l++) {
+        for (i = 0; i < 32 * r; i++, pB += 4)
+            V[l][SCRYPT_POS(i)] = pB[0] | pB[1] << 8 | pB[2] << 16
+                                  | (uint32_t)pB[3] << 24;
     }
 
-    for (i = 1; i < N; i++, pV += 32 * r)
-        scryptBlockMix(pV, pV - 32 * r, r);
+    for (i = 1; i < N; i++)
+        scryptBlockMixN(n, V[0] + 32 * r * i, V[0] + 32 * r * (i - 1),
+                        V[1] + 32 * r * i, V[1] + 32 * r * (i - 1), r);
 
-    scryptBlockMix(X, V + (N - 1) * 32 * r, r);
+    scryptBlockMixN(n, X[0], V[0] + (N - 1) * 32 * r,
+                    X[1], V[1] + (N - 1) * 32 * r, r);
 
     for (i = 0; i < N; i++) {
-        uint32_t j;
-        j = X[16 * (2 * r - 1)] % N;
-        pV = V + 32 * r * j;
-        for (k = 0; k < 32 * r; k++)
-            T[k] = X[k] ^ *pV++;
-        scryptBlockMix(X, T, r);
+        for (l = 0; l < n; l++) {
+            uint32_t j;
+            j = X[l][16 * (2 * r - 1)] % N;
+            pV = V[l] + 32 * r * j;
+            for (k = 0; k < 32 * r; k++)
+                T[l][k] = X[l][k] ^ pV[k];
+        }
+        scryptBlockMixN(n, X[0], T[0], X[1], T[1], r);
     }
     /* Convert output to little endian */
-    for (i = 0, pB = B; i < 32 * r; i++) {
-        uint32_t xtmp = X[i];
-        *pB++ = xtmp & 0xff;
-        *pB++ = (xtmp >> 8) & 0xff;
-        *pB++ = (xtmp >> 16) & 0xff;
-        *pB++ = (xtmp >> 24) & 0xff;
+    for (l = 0, pB = B; l < n; l++) {
+        for (i = 0; i < 32 * r; i++) {
+            uint32_t xtmp = X[l][SCRYPT_POS(i)];
+            *pB++ = xtmp & 0xff;
+            *pB++ = (xtmp >> 8) & 0xff;
+            *pB++ = (xtmp >> 16) & 0xff;
+            *pB++ = (xtmp >> 24) & 0xff;
+        }
+    }
+}
+
+/*
+ * Lanes are handed out to the threads in groups of |width|, the number
+ * of lanes the BlockMix in use mixes together.
+ */
+typedef struct {
+    unsigned char *B;
+    uint64_t r, N, p;
+    int width;
+    uint32_t *scratch;          /* one area of |scratch_words| per thread */
+    uint64_t scratch_words;
+    CRYPTO_RWLOCK *lock;        /* guards |next| and |started| */
+    uint64_t next;              /* first lane not handed out yet */
+    int started;                /* threads that have taken an area */
+} SCRYPT_JOB;
+
+static void scrypt_worker(void *arg)
+{
+    SCRYPT_JOB *job = arg;
+    uint32_t *XTV;
+    uint64_t i;
+
+    CRYPTO_THREAD_write_lock(job->lock);
+    XTV = job->scratch + job->scratch_words * job->started++;
+    CRYPTO_THREAD_unlock(job->lock);
+
+    for (;;) {
+        CRYPTO_THREAD_write_lock(job->lock);
+        i = job->next;
+        if (i < job->p)
+            job->next += job->width;
+        CRYPTO_THREAD_unlock(job->lock);
+        if (i >= job->p)
+            break;
+        scryptROMix(job->B + 128 * job->r * i, job->r, job->N,
+                    job->p - i < (uint64_t)job->width ? 1 : job->width, XTV);
     }
 }
 
@@ -160,11 +244,19 @@ int EVP_PBE_scrypt(const char *pass, size_t passlen,
                    uint64_t N, uint64_t r, uint64_t p, uint64_t maxmem,
                    unsigned char *key, size_t keylen)
 {
-    int rv = 0;
-    unsigned char *B;
-    uint32_t *X, *V, *T;
-    uint64_t i, Blen, Vlen;
+    return EVP_PBE_scrypt_ex(pass, passlen, salt, saltlen, N, r, p, maxmem,
+                             1, key, keylen);
+}
 
+int EVP_PBE_scrypt_ex(const char *pass, size_t passlen,
+                      const unsigned char *salt, size_t saltlen,
+                      uint64_t N, uint64_t r, uint64_t p, uint64_t maxmem,
+                      unsigned int threads, unsigned char *key, size_t keylen)
+{
+    int rv = 0, width = 1;
+    unsigned char *B;
+    uint64_t i, Blen, Vlen, nV;
+    SCRYPT_JOB job;
     /* Sanity check parameters */
     /* initial check, r,p must be non zero, N >= 2 and a power of 2 */
     if (r == 0 || p == 0 || N < 2 || (N & (N - 1)))
@@ -237,20 +329,49 @@ int EVP_PBE_scrypt(const char *pass, size_t passlen,
     if (key == NULL)
         return 1;
 
-    B = OPENSSL_malloc((size_t)(Blen + Vlen));
+    /*
+     * Every thread, and every lane mixed alongside another, needs its own
+     * V, X and T, so both are limited to what fits in |maxmem|.
+     */
+    nV = (maxmem - Blen) / Vlen;
+#ifdef SCRYPT_BLOCKMIX_ASM
+    if (p > 1 && nV >= 2)
+        width = scrypt_blockmix_width();
+#endif
+    if (threads < 1)
+        threads = 1;
+    if (threads > (p + width - 1) / width)
+        threads = (unsigned int)((p + width - 1) / width);
+    if (threads > nV / width)
+        threads = (unsigned int)(nV / width);
+    nV = (uint64_t)threads * width;
+
+    B = OPENSSL_malloc((size_t)(Blen + Vlen * nV));
     if (B == NULL) {
         EVPerr(EVP_F_EVP_PBE_SCRYPT, ERR_R_MALLOC_FAILURE);
         return 0;
     }
-    X = (uint32_t *)(B + Blen);
-    T = X + 32 * r;
-    V = T + 32 * r;
     if (PKCS5_PBKDF2_HMAC(pass, passlen, salt, saltlen, 1, EVP_sha256(),
                           (int)Blen, B) == 0)
         goto err;
 
-    for (i = 0; i < p; i++)
-        scryptROMix(B + 128 * r * i, r, N, X, T, V);
+    job.B = B;
+    job.r = r;
+    job.N = N;
+    job.p = p;
+    job.width = width;
+    job.scratch = (uint32_t *)(B + Blen);
+    job.scratch_words = Vlen * width / sizeof(uint32_t);
+    job.next = 0;
+    job.started = 0;
+    if (threads > 1 && (job.lock = CRYPTO_THREAD_lock_new()) != NULL) {
+        openssl_run_parallel(scrypt_worker, &job, (int)threads);
+        CRYPTO_THREAD_lock_free(job.lock);
+    } else {
+        for (i = 0; i < p; i += width)
+            scryptROMix(B + 128 * r * i, r, N,
+                        p - i < (uint64_t)width ? 1 : width, job.scratch);
+    }
 
     if (PKCS5_PBKDF2_HMAC(pass, passlen, B, (int)Blen, 1, EVP_sha256(),
                           keylen, key) == 0)
@@ -260,7 +381,7 @@ int EVP_PBE_scrypt(const char *pass, size_t passlen,
     if (rv == 0)
         EVPerr(EVP_F_EVP_PBE_SCRYPT, EVP_R_PBKDF2_ERROR);
 
-    OPENSSL_clear_free(B, (size_t)(Blen + Vlen));
+    OPENSSL_clear_free(B, (size_t)(Blen + Vlen * nV));
     return rv;
 }
 #endif
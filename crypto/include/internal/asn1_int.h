@@ -111,3 +111,8 @@ struct asn1_pctx_st {
 } /* ASN1_PCTX */ ;
 
 int asn1_d2i_read_bio(BIO *in, BUF_MEM **pb);
+/* The ASN1_TLC typedef is in asn1.h, which not every includer has */
+struct ASN1_TLC_st;
+unsigned long asn1_d2i_flags(const struct ASN1_TLC_st *ctx);
+/* For testing only: switch the template decoder's fast paths off and on */
+void asn1_d2i_set_fast_paths(int on);
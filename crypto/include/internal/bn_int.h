@@ -74,4 +74,7 @@ int bn_to_mont_fixed_top(BIGNUM *r, const BIGNUM *a, BN_MONT_CTX *mont,
 int bn_mod_add_fixed_top(BIGNUM *r, const BIGNUM *a, const BIGNUM *b,
                          const BIGNUM *m);
 
+void bn_ctx_cleanup_int(void);
+void bn_ctx_delete_thread_state(void);
+
 #endif
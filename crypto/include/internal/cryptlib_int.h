@@ -15,6 +15,9 @@ struct thread_local_inits_st {
     int async;
     int err_state;
     int rand;
+    int rsa;
+    int secmem;
+    int bn_ctx;
 };
 
 int ossl_init_thread_start(uint64_t opts);
@@ -31,5 +34,11 @@ int ossl_init_thread_start(uint64_t opts);
 # define OPENSSL_INIT_THREAD_ASYNC           0x01
 # define OPENSSL_INIT_THREAD_ERR_STATE       0x02
 # define OPENSSL_INIT_THREAD_RAND            0x04
+# define OPENSSL_INIT_THREAD_RSA             0x08
+# define OPENSSL_INIT_THREAD_SECMEM          0x10
+# define OPENSSL_INIT_THREAD_BN_CTX          0x20
 
 void ossl_malloc_setup_failures(void);
+
+void secure_mem_delete_thread_state(void);
+void secure_mem_cleanup_int(void);
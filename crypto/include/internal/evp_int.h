@@ -79,6 +79,12 @@ struct evp_pkey_method_st {
     int (*check) (EVP_PKEY *pkey);
     int (*public_check) (EVP_PKEY *pkey);
     int (*param_check) (EVP_PKEY *pkey);
+    int (*digestverify_batch) (EVP_PKEY *const pkey[],
+                               const unsigned char *const sig[],
+                               const size_t siglen[],
+                               const unsigned char *const tbs[],
+                               const size_t tbslen[], const size_t idx[],
+                               size_t num, int results[]);
 } /* EVP_PKEY_METHOD */ ;
 
 DEFINE_STACK_OF_CONST(EVP_PKEY_METHOD)
@@ -118,6 +124,9 @@ struct evp_md_st {
     int ctx_size;               /* how big does the ctx->md_data need to be */
     /* control function */
     int (*md_ctrl) (EVP_MD_CTX *ctx, int cmd, int p1, void *p2);
+    /* one-shot digest of several independent messages, may be NULL */
+    int (*md_multi) (const unsigned char *const data[], const size_t len[],
+                     unsigned char *const md[], size_t num);
 } /* EVP_MD */ ;
 
 struct evp_cipher_st {
@@ -376,6 +385,8 @@ const EVP_CIPHER *EVP_##cname##_ecb(void) { return &cname##_ecb; }
 typedef struct {
     unsigned char pubkey[MAX_KEYLEN];
     unsigned char *privkey;
+    /* Precomputed Ed25519 public key for verification, may be NULL */
+    struct ed25519_verify_ctx_st *ed25519_vctx;
 } ECX_KEY;
 
 #endif
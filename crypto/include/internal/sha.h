@@ -16,4 +16,11 @@
 int sha512_224_init(SHA512_CTX *);
 int sha512_256_init(SHA512_CTX *);
 
+int sha1_multi(const unsigned char *const data[], const size_t len[],
+               unsigned char *const md[], size_t num);
+int sha224_multi(const unsigned char *const data[], const size_t len[],
+                 unsigned char *const md[], size_t num);
+int sha256_multi(const unsigned char *const data[], const size_t len[],
+                 unsigned char *const md[], size_t num);
+
 #endif
@@ -22,7 +22,7 @@
  */
 struct X509_name_entry_st {
     ASN1_OBJECT *object;        /* AttributeType */
-    ASN1_STRING *value;         /* AttributeValue */
+    ASN1_STRING value;          /* AttributeValue */
     int set;                    /* index of RDNSequence for this entry */
     int size;                   /* temp variable */
 };
@@ -35,6 +35,7 @@ struct X509_name_st {
     /* canonical encoding used for rapid Name comparison */
     unsigned char *canon_enc;
     int canon_enclen;
+    int canon_lazy;             /* canon_enc not computed yet */
 } /* X509_NAME */ ;
 
 /* Signature info structure */
@@ -283,3 +284,10 @@ int a2i_ipadd(unsigned char *ipout, const char *ipasc);
 int x509_set1_time(ASN1_TIME **ptm, const ASN1_TIME *tm);
 
 void x509_init_sig_info(X509 *x);
+
+int x509_name_lazy_canon(X509_NAME *a);
+int x509_lazy_lock(void);
+void x509_lazy_unlock(void);
+int x509_lazy_pending(const int *pending);
+void x509_lazy_done(int *pending);
+void x509_lazy_cleanup_int(void);
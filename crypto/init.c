@@ -11,6 +11,10 @@
 #include "internal/cryptlib_int.h"
 #include <openssl/err.h>
 #include "internal/rand_int.h"
+#include "internal/rsa_int.h"
+#include "internal/bn_int.h"
+#include <openssl/x509.h>
+#include "internal/x509_int.h"
 #include "internal/bio.h"
 #include <openssl/evp.h>
 #include "internal/evp_int.h"
@@ -404,6 +408,32 @@ static void ossl_init_thread_stop(struct thread_local_inits_st *locals)
         drbg_delete_thread_state();
     }
 
+#ifndef OPENSSL_NO_RSA
+    if (locals->rsa) {
+#ifdef OPENSSL_INIT_DEBUG
+        fprintf(stderr, "OPENSSL_INIT: ossl_init_thread_stop: "
+                        "rsa_blinding_delete_thread_state()\n");
+#endif
+        rsa_blinding_delete_thread_state();
+    }
+#endif
+
+    if (locals->secmem) {
+#ifdef OPENSSL_INIT_DEBUG
+        fprintf(stderr, "OPENSSL_INIT: ossl_init_thread_stop: "
+                        "secure_mem_delete_thread_state()\n");
+#endif
+        secure_mem_delete_thread_state();
+    }
+
+    if (locals->bn_ctx) {
+#ifdef OPENSSL_INIT_DEBUG
+        fprintf(stderr, "OPENSSL_INIT: ossl_init_thread_stop: "
+                        "bn_ctx_delete_thread_state()\n");
+#endif
+        bn_ctx_delete_thread_state();
+    }
+
     OPENSSL_free(locals);
 }
 
@@ -449,6 +479,30 @@ int ossl_init_thread_start(uint64_t opts)
         locals->rand = 1;
     }
 
+    if (opts & OPENSSL_INIT_THREAD_RSA) {
+#ifdef OPENSSL_INIT_DEBUG
+        fprintf(stderr, "OPENSSL_INIT: ossl_init_thread_start: "
+                        "marking thread for rsa\n");
+#endif
+        locals->rsa = 1;
+    }
+
+    if (opts & OPENSSL_INIT_THREAD_SECMEM) {
+#ifdef OPENSSL_INIT_DEBUG
+        fprintf(stderr, "OPENSSL_INIT: ossl_init_thread_start: "
+                        "marking thread for secmem\n");
+#endif
+        locals->secmem = 1;
+    }
+
+    if (opts & OPENSSL_INIT_THREAD_BN_CTX) {
+#ifdef OPENSSL_INIT_DEBUG
+        fprintf(stderr, "OPENSSL_INIT: ossl_init_thread_start: "
+                        "marking thread for bn_ctx\n");
+#endif
+        locals->bn_ctx = 1;
+    }
+
     return 1;
 }
 
@@ -522,6 +576,14 @@ void OPENSSL_cleanup(void)
 #ifdef OPENSSL_INIT_DEBUG
     fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
                     "rand_cleanup_int()\n");
+#ifndef OPENSSL_NO_RSA
+    fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
+                    "rsa_cleanup_int()\n");
+#endif
+    fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
+                    "bn_ctx_cleanup_int()\n");
+    fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
+                    "x509_lazy_cleanup_int()\n");
     fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
                     "conf_modules_free_int()\n");
 #ifndef OPENSSL_NO_ENGINE
@@ -540,6 +602,8 @@ void OPENSSL_cleanup(void)
                     "obj_cleanup_int()\n");
     fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
                     "err_cleanup()\n");
+    fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
+                    "secure_mem_cleanup_int()\n");
 #endif
     /*
      * Note that cleanup order is important:
@@ -554,6 +618,11 @@ void OPENSSL_cleanup(void)
      */
     rand_cleanup_int();
     rand_drbg_cleanup_int();
+#ifndef OPENSSL_NO_RSA
+    rsa_cleanup_int();
+#endif
+    bn_ctx_cleanup_int();
+    x509_lazy_cleanup_int();
     conf_modules_free_int();
 #ifndef OPENSSL_NO_ENGINE
     engine_cleanup_int();
@@ -566,6 +635,7 @@ void OPENSSL_cleanup(void)
     err_cleanup();
 
     CRYPTO_secure_malloc_done();
+    secure_mem_cleanup_int();
 
     base_inited = 0;
 }
@@ -7,6 +7,7 @@
  * https://www.openssl.org/source/license.html
  */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <openssl/hmac.h>
@@ -26,6 +27,7 @@ typedef struct {
     size_t salt_len;
     uint64_t N, r, p;
     uint64_t maxmem_bytes;
+    uint64_t threads;
 } SCRYPT_PKEY_CTX;
 
 /* Custom uint64_t parser since we do not have strtoull */
@@ -71,6 +73,7 @@ static int pkey_scrypt_init(EVP_PKEY_CTX *ctx)
     kctx->r = 8;
     kctx->p = 1;
     kctx->maxmem_bytes = 1025 * 1024 * 1024;
+    kctx->threads = 1;
 
     ctx->data = kctx;
 
@@ -158,6 +161,13 @@ static int pkey_scrypt_ctrl(EVP_PKEY_CTX *ctx, int type, int p1, void *p2)
         kctx->maxmem_bytes = u64_value;
         return 1;
 
+    case EVP_PKEY_CTRL_SCRYPT_THREADS:
+        u64_value = *((uint64_t *)p2);
+        if (u64_value < 1 || u64_value > UINT_MAX)
+            return 0;
+        kctx->threads = u64_value;
+        return 1;
+
     default:
         return -2;
 
@@ -209,6 +219,10 @@ static int pkey_scrypt_ctrl_str(EVP_PKEY_CTX *ctx, const char *type,
         return pkey_scrypt_ctrl_uint64(ctx, EVP_PKEY_CTRL_SCRYPT_MAXMEM_BYTES,
                                        value);
 
+    if (strcmp(type, "threads") == 0)
+        return pkey_scrypt_ctrl_uint64(ctx, EVP_PKEY_CTRL_SCRYPT_THREADS,
+                                       value);
+
     KDFerr(KDF_F_PKEY_SCRYPT_CTRL_STR, KDF_R_UNKNOWN_PARAMETER_TYPE);
     return -2;
 }
@@ -228,9 +242,10 @@ static int pkey_scrypt_derive(EVP_PKEY_CTX *ctx, unsigned char *key,
         return 0;
     }
 
-    return EVP_PBE_scrypt((char *)kctx->pass, kctx->pass_len, kctx->salt,
-                          kctx->salt_len, kctx->N, kctx->r, kctx->p,
-                          kctx->maxmem_bytes, key, *keylen);
+    return EVP_PBE_scrypt_ex((char *)kctx->pass, kctx->pass_len, kctx->salt,
+                             kctx->salt_len, kctx->N, kctx->r, kctx->p,
+                             kctx->maxmem_bytes, (unsigned int)kctx->threads,
+                             key, *keylen);
 }
 
 const EVP_PKEY_METHOD scrypt_pkey_meth = {
@@ -0,0 +1,531 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/lhash.h>
+#include "internal/cryptlib.h"
+
+/*
+ * An open addressing hash table with the interface of OPENSSL_LHASH.
+ *
+ * The slots of a table are kept in three separate arrays: a control byte
+ * per slot, the full hash of each entry and the pointer to the entry
+ * itself.  A control byte holds either OAH_EMPTY, OAH_DELETED or the low
+ * seven bits of the mixed hash of the entry, its fingerprint.  The slots
+ * are probed a group of eight at a time: the eight control bytes of a
+ * group are loaded in a single 64-bit word and compared against the
+ * fingerprint all at once, so that the hashes and entries are only looked
+ * at for the few slots that are likely to match.  Groups are visited in
+ * triangular order, which visits each of them once when their number is
+ * a power of two.
+ *
+ * With OPENSSL_OAH_CONCURRENT the entries are spread over OAH_STRIPES
+ * such tables by their hash, each one with a lock of its own, so that
+ * threads working on different entries seldom wait for each other.  The
+ * error and doall depth, which are shared by all of them, are then read
+ * and written atomically.
+ */
+
+#define OAH_GROUP       8
+#define OAH_MIN_SLOTS   16
+#define OAH_STRIPES     16
+#define OAH_DOWN_LOAD   (LH_LOAD_MULT / 4) /* load times 256 (default 1/4) */
+#define OAH_MAX_DOWN_LOAD (LH_LOAD_MULT * 3 / 8)
+
+#define OAH_EMPTY       0x80
+#define OAH_DELETED     0xfe
+
+#define OAH_LSBS        0x0101010101010101ULL
+#define OAH_MSBS        0x8080808080808080ULL
+
+typedef struct oahash_table_st {
+    unsigned char *ctrl;
+    unsigned long *hashes;
+    void **data;
+    size_t mask;                /* number of slots - 1 */
+    size_t num_items;
+    size_t num_deleted;
+    unsigned long num_expands;
+    unsigned long num_contracts;
+    unsigned long num_rehashes;
+    unsigned long num_insert;
+    unsigned long num_replace;
+    unsigned long num_delete;
+    unsigned long num_no_delete;
+    CRYPTO_RWLOCK *lock;
+} OAH_TABLE;
+
+struct oahash_st {
+    OPENSSL_LH_COMPFUNC comp;
+    OPENSSL_LH_HASHFUNC hash;
+    unsigned long down_load;
+    unsigned int flags;
+    unsigned int num_tables;
+    int doall_depth;
+    int error;
+    OAH_TABLE *tables;
+    CRYPTO_RWLOCK *lock;        /* for the above where there are no atomics */
+};
+
+/*
+ * Spread the bits of a hash, which are often poor in the low ones, over the
+ * fingerprint (bits 0-6), the table (bits 7-10) and the first group to probe
+ * (the rest).
+ */
+static ossl_inline uint64_t oah_mix(unsigned long hash)
+{
+    uint64_t x = (uint64_t)hash;
+
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static ossl_inline uint64_t group_load(const unsigned char *ctrl)
+{
+    uint64_t g;
+
+    memcpy(&g, ctrl, sizeof(g));
+    return g;
+}
+
+/*
+ * The top bit of each byte of |g| set if it is equal to |fp|.  Bytes
+ * following a match may be reported as well, which the callers weed out
+ * by looking at the full hash.
+ */
+static ossl_inline uint64_t group_match(uint64_t g, unsigned int fp)
+{
+    uint64_t x = g ^ (OAH_LSBS * fp);
+
+    return (x - OAH_LSBS) & ~x & OAH_MSBS;
+}
+
+static ossl_inline uint64_t group_match_empty(uint64_t g)
+{
+    return g & ~(g << 1) & OAH_MSBS;
+}
+
+static ossl_inline uint64_t group_match_free(uint64_t g)
+{
+    return g & OAH_MSBS;
+}
+
+/* The index in its group of the byte with the lowest bit set in |m| */
+static ossl_inline size_t group_first(uint64_t m)
+{
+    const union {
+        long one;
+        char little;
+    } is_endian = { 1 };
+    size_t bit;
+
+#if defined(__GNUC__) && __GNUC__ >= 4
+    bit = (size_t)__builtin_ctzll(m);
+#else
+    for (bit = 0; (m & 1) == 0; bit++)
+        m >>= 1;
+#endif
+    return is_endian.little ? bit / 8 : OAH_GROUP - 1 - bit / 8;
+}
+
+static ossl_inline int oah_read(OPENSSL_OAHASH *oh, int *val)
+{
+    int ret;
+
+    if (oh->lock == NULL || !CRYPTO_atomic_read(val, &ret, oh->lock))
+        ret = *val;
+    return ret;
+}
+
+static ossl_inline void oah_write(OPENSSL_OAHASH *oh, int *val, int n)
+{
+    if (oh->lock == NULL || !CRYPTO_atomic_write(val, n, oh->lock))
+        *val = n;
+}
+
+static ossl_inline void oah_add(OPENSSL_OAHASH *oh, int *val, int amount)
+{
+    int ret;
+
+    if (oh->lock == NULL || !CRYPTO_atomic_add(val, amount, &ret, oh->lock))
+        *val += amount;
+}
+
+static ossl_inline OAH_TABLE *table_of(const OPENSSL_OAHASH *oh, uint64_t m)
+{
+    return &oh->tables[(m >> 7) & (oh->num_tables - 1)];
+}
+
+static int table_alloc(OAH_TABLE *t, size_t slots)
+{
+    unsigned char *p;
+
+    p = OPENSSL_malloc(slots * (1 + sizeof(*t->hashes) + sizeof(*t->data)));
+    if (p == NULL)
+        return 0;
+    memset(p, OAH_EMPTY, slots);
+    t->ctrl = p;
+    t->hashes = (unsigned long *)(p + slots);
+    t->data = (void **)(p + slots + slots * sizeof(*t->hashes));
+    t->mask = slots - 1;
+    t->num_items = 0;
+    t->num_deleted = 0;
+    return 1;
+}
+
+/* Find the slot holding |data|, or return -1 */
+static ossl_inline long table_find(const OPENSSL_OAHASH *oh,
+                                   const OAH_TABLE *t, const void *data,
+                                   unsigned long hash, uint64_t m)
+{
+    size_t ngroups = (t->mask + 1) / OAH_GROUP;
+    size_t g = (size_t)(m >> 11) & (ngroups - 1), step = 0, slot;
+    unsigned int fp = (unsigned int)(m & 0x7f);
+    uint64_t grp, match;
+
+    for (;;) {
+        grp = group_load(t->ctrl + g * OAH_GROUP);
+        for (match = group_match(grp, fp); match != 0; match &= match - 1) {
+            slot = g * OAH_GROUP + group_first(match);
+            if (t->hashes[slot] == hash && oh->comp(t->data[slot], data) == 0)
+                return (long)slot;
+        }
+        if (group_match_empty(grp) != 0 || ++step == ngroups)
+            return -1;
+        g = (g + step) & (ngroups - 1);
+    }
+}
+
+/* Find the first empty or deleted slot of the probe sequence for |m| */
+static size_t table_find_free(const OAH_TABLE *t, uint64_t m)
+{
+    size_t ngroups = (t->mask + 1) / OAH_GROUP;
+    size_t g = (size_t)(m >> 11) & (ngroups - 1), step = 0;
+    uint64_t match;
+
+    while ((match = group_match_free(group_load(t->ctrl + g * OAH_GROUP)))
+           == 0)
+        g = (g + ++step) & (ngroups - 1);
+    return g * OAH_GROUP + group_first(match);
+}
+
+static ossl_inline void table_set(OAH_TABLE *t, size_t slot, uint64_t m,
+                                  unsigned long hash, void *data)
+{
+    t->ctrl[slot] = (unsigned char)(m & 0x7f);
+    t->hashes[slot] = hash;
+    t->data[slot] = data;
+}
+
+/* Move the entries of |t| to |slots| new slots, dropping the deleted ones */
+static int table_resize(OAH_TABLE *t, size_t slots)
+{
+    OAH_TABLE old = *t;
+    size_t i, slot;
+    uint64_t m;
+
+    if (!table_alloc(t, slots)) {
+        *t = old;
+        return 0;
+    }
+    for (i = 0; i <= old.mask; i++) {
+        if ((old.ctrl[i] & 0x80) != 0)
+            continue;
+        m = oah_mix(old.hashes[i]);
+        slot = table_find_free(t, m);
+        table_set(t, slot, m, old.hashes[i], old.data[i]);
+    }
+    t->num_items = old.num_items;
+    OPENSSL_free(old.ctrl);
+    return 1;
+}
+
+OPENSSL_OAHASH *OPENSSL_OAH_new(OPENSSL_LH_HASHFUNC h, OPENSSL_LH_COMPFUNC c,
+                                unsigned int flags)
+{
+    OPENSSL_OAHASH *ret;
+    unsigned int i;
+
+    /* Like OPENSSL_LH_new(), no error code to avoid loops with ERR */
+    if ((ret = OPENSSL_zalloc(sizeof(*ret))) == NULL)
+        return NULL;
+    ret->comp = ((c == NULL) ? (OPENSSL_LH_COMPFUNC)strcmp : c);
+    ret->hash = ((h == NULL) ? (OPENSSL_LH_HASHFUNC)OPENSSL_LH_strhash : h);
+    ret->down_load = OAH_DOWN_LOAD;
+    ret->flags = flags;
+    ret->num_tables = (flags & OPENSSL_OAH_CONCURRENT) != 0 ? OAH_STRIPES : 1;
+    ret->tables = OPENSSL_zalloc(ret->num_tables * sizeof(*ret->tables));
+    if (ret->tables == NULL)
+        goto err;
+    if ((flags & OPENSSL_OAH_CONCURRENT) != 0
+            && (ret->lock = CRYPTO_THREAD_lock_new()) == NULL)
+        goto err;
+    for (i = 0; i < ret->num_tables; i++) {
+        if (!table_alloc(&ret->tables[i], OAH_MIN_SLOTS))
+            goto err;
+        if ((flags & OPENSSL_OAH_CONCURRENT) != 0
+                && (ret->tables[i].lock = CRYPTO_THREAD_lock_new()) == NULL)
+            goto err;
+    }
+    return ret;
+
+ err:
+    OPENSSL_OAH_free(ret);
+    return NULL;
+}
+
+void OPENSSL_OAH_free(OPENSSL_OAHASH *oh)
+{
+    unsigned int i;
+
+    if (oh == NULL)
+        return;
+    if (oh->tables != NULL) {
+        for (i = 0; i < oh->num_tables; i++) {
+            OPENSSL_free(oh->tables[i].ctrl);
+            CRYPTO_THREAD_lock_free(oh->tables[i].lock);
+        }
+        OPENSSL_free(oh->tables);
+    }
+    CRYPTO_THREAD_lock_free(oh->lock);
+    OPENSSL_free(oh);
+}
+
+void *OPENSSL_OAH_insert(OPENSSL_OAHASH *oh, void *data)
+{
+    unsigned long hash = oh->hash(data);
+    uint64_t m = oah_mix(hash);
+    OAH_TABLE *t = table_of(oh, m);
+    void *ret = NULL;
+    size_t slots;
+    long slot;
+    int error = 0;
+
+    if (t->lock != NULL)
+        CRYPTO_THREAD_write_lock(t->lock);
+    if ((slot = table_find(oh, t, data, hash, m)) >= 0) {
+        ret = t->data[slot];
+        t->data[slot] = data;
+        t->num_replace++;
+        goto end;
+    }
+
+    /*
+     * Keep at least one slot in eight free, counting the deleted ones as
+     * used so that unsuccessful searches always end.  If many of them are
+     * deleted, it is enough to rehash at the same size.
+     */
+    slots = t->mask + 1;
+    if (t->num_items + t->num_deleted + 1 > slots - slots / 8) {
+        if (t->num_items + 1 > slots / 2) {
+            if (!table_resize(t, slots * 2)) {
+                error = 1;
+                goto end;
+            }
+            t->num_expands++;
+        } else {
+            if (!table_resize(t, slots)) {
+                error = 1;
+                goto end;
+            }
+            t->num_rehashes++;
+        }
+    }
+    slot = (long)table_find_free(t, m);
+    if (t->ctrl[slot] == OAH_DELETED)
+        t->num_deleted--;
+    table_set(t, (size_t)slot, m, hash, data);
+    t->num_items++;
+    t->num_insert++;
+
+ end:
+    if (t->lock != NULL)
+        CRYPTO_THREAD_unlock(t->lock);
+    oah_write(oh, &oh->error, error);
+    return ret;
+}
+
+void *OPENSSL_OAH_delete(OPENSSL_OAHASH *oh, const void *data)
+{
+    unsigned long hash = oh->hash(data);
+    uint64_t m = oah_mix(hash);
+    OAH_TABLE *t = table_of(oh, m);
+    void *ret = NULL;
+    size_t slots, half;
+    long slot;
+
+    oah_write(oh, &oh->error, 0);
+    if (t->lock != NULL)
+        CRYPTO_THREAD_write_lock(t->lock);
+    if ((slot = table_find(oh, t, data, hash, m)) < 0) {
+        t->num_no_delete++;
+        goto end;
+    }
+    ret = t->data[slot];
+    t->num_items--;
+    t->num_delete++;
+
+    /*
+     * A search never goes past a group with an empty slot, so if this one
+     * has got one the slot can be emptied as well.
+     */
+    if (group_match_empty(group_load(t->ctrl + (slot & ~(OAH_GROUP - 1))))
+            != 0) {
+        t->ctrl[slot] = OAH_EMPTY;
+    } else {
+        t->ctrl[slot] = OAH_DELETED;
+        t->num_deleted++;
+    }
+
+    /*
+     * Slots must not move while OPENSSL_OAH_doall() walks through them, and
+     * the smaller table must keep one slot in eight free like insertions do.
+     */
+    slots = t->mask + 1;
+    half = slots / 2;
+    if (slots > OAH_MIN_SLOTS
+            && t->num_items * LH_LOAD_MULT < oh->down_load * slots
+            && t->num_items < half - half / 8
+            && oah_read(oh, &oh->doall_depth) == 0) {
+        if (table_resize(t, half))
+            t->num_contracts++;
+    }
+
+ end:
+    if (t->lock != NULL)
+        CRYPTO_THREAD_unlock(t->lock);
+    return ret;
+}
+
+void *OPENSSL_OAH_retrieve(OPENSSL_OAHASH *oh, const void *data)
+{
+    unsigned long hash = oh->hash(data);
+    uint64_t m = oah_mix(hash);
+    OAH_TABLE *t = table_of(oh, m);
+    void *ret = NULL;
+    long slot;
+
+    if (t->lock != NULL)
+        CRYPTO_THREAD_read_lock(t->lock);
+    if ((slot = table_find(oh, t, data, hash, m)) >= 0)
+        ret = t->data[slot];
+    if (t->lock != NULL)
+        CRYPTO_THREAD_unlock(t->lock);
+    return ret;
+}
+
+static void doall_util_fn(OPENSSL_OAHASH *oh, int use_arg,
+                          OPENSSL_LH_DOALL_FUNC func,
+                          OPENSSL_LH_DOALL_FUNCARG func_arg, void *arg)
+{
+    OAH_TABLE *t;
+    unsigned int i;
+    size_t slot;
+
+    if (oh == NULL)
+        return;
+
+    /*
+     * Entries may be deleted by |func|, which is safe as the slots stay
+     * where they are until the walk is over.
+     */
+    oah_add(oh, &oh->doall_depth, 1);
+    for (i = 0; i < oh->num_tables; i++) {
+        t = &oh->tables[i];
+        for (slot = 0; slot <= t->mask; slot++) {
+            if ((t->ctrl[slot] & 0x80) != 0)
+                continue;
+            if (use_arg)
+                func_arg(t->data[slot], arg);
+            else
+                func(t->data[slot]);
+        }
+    }
+    oah_add(oh, &oh->doall_depth, -1);
+}
+
+void OPENSSL_OAH_doall(OPENSSL_OAHASH *oh, OPENSSL_LH_DOALL_FUNC func)
+{
+    doall_util_fn(oh, 0, func, (OPENSSL_LH_DOALL_FUNCARG)0, NULL);
+}
+
+void OPENSSL_OAH_doall_arg(OPENSSL_OAHASH *oh, OPENSSL_LH_DOALL_FUNCARG func,
+                           void *arg)
+{
+    doall_util_fn(oh, 1, (OPENSSL_LH_DOALL_FUNC)0, func, arg);
+}
+
+unsigned long OPENSSL_OAH_num_items(const OPENSSL_OAHASH *oh)
+{
+    unsigned long ret = 0;
+    unsigned int i;
+
+    if (oh == NULL)
+        return 0;
+    for (i = 0; i < oh->num_tables; i++)
+        ret += (unsigned long)oh->tables[i].num_items;
+    return ret;
+}
+
+unsigned long OPENSSL_OAH_get_down_load(const OPENSSL_OAHASH *oh)
+{
+    return oh->down_load;
+}
+
+/*
+ * Above OAH_MAX_DOWN_LOAD a table halved in size would be left more than
+ * three quarters full, close to where insertions double it again.
+ */
+void OPENSSL_OAH_set_down_load(OPENSSL_OAHASH *oh, unsigned long down_load)
+{
+    oh->down_load = down_load < OAH_MAX_DOWN_LOAD ? down_load
+                                                  : OAH_MAX_DOWN_LOAD;
+}
+
+int OPENSSL_OAH_error(OPENSSL_OAHASH *oh)
+{
+    return oah_read(oh, &oh->error);
+}
+
+void OPENSSL_OAH_stats_bio(const OPENSSL_OAHASH *oh, BIO *out)
+{
+    unsigned long items = 0, slots = 0, deleted = 0, expands = 0;
+    unsigned long contracts = 0, rehashes = 0, insert = 0, replace = 0;
+    unsigned long del = 0, no_delete = 0;
+    const OAH_TABLE *t;
+    unsigned int i;
+
+    for (i = 0; i < oh->num_tables; i++) {
+        t = &oh->tables[i];
+        items += (unsigned long)t->num_items;
+        slots += (unsigned long)t->mask + 1;
+        deleted += (unsigned long)t->num_deleted;
+        expands += t->num_expands;
+        contracts += t->num_contracts;
+        rehashes += t->num_rehashes;
+        insert += t->num_insert;
+        replace += t->num_replace;
+        del += t->num_delete;
+        no_delete += t->num_no_delete;
+    }
+    BIO_printf(out, "num_items             = %lu\n", items);
+    BIO_printf(out, "num_slots             = %lu\n", slots);
+    BIO_printf(out, "num_deleted_slots     = %lu\n", deleted);
+    BIO_printf(out, "num_tables            = %u\n", oh->num_tables);
+    BIO_printf(out, "num_expands           = %lu\n", expands);
+    BIO_printf(out, "num_contracts         = %lu\n", contracts);
+    BIO_printf(out, "num_rehashes          = %lu\n", rehashes);
+    BIO_printf(out, "num_insert            = %lu\n", insert);
+    BIO_printf(out, "num_replace           = %lu\n", replace);
+    BIO_printf(out, "num_delete            = %lu\n", del);
+    BIO_printf(out, "num_no_delete         = %lu\n", no_delete);
+}
@@ -0,0 +1,490 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Accounting of the memory allocated through OPENSSL_malloc() and friends
+ * by subsystem.  CRYPTO_mem_acct_enable() installs the functions below
+ * with CRYPTO_set_mem_functions().  They put a small header in front of
+ * every block, which records its size and the library that allocated it,
+ * so that the block can be accounted for when it is freed.
+ */
+
+#include "e_os.h"
+#include "internal/cryptlib.h"
+#include <stdio.h>
+#ifndef _WIN32
+# include <sys/time.h>
+#endif
+#ifndef OPENSSL_NO_CRYPTO_MDEBUG_BACKTRACE
+# include <execinfo.h>
+#endif
+
+/*
+ * The counters are only ever added to, and read for a report.  Where the
+ * compiler has no atomics they may be a little off if several threads
+ * allocate at the same time.
+ */
+#if !defined(OPENSSL_THREADS) || defined(CRYPTO_TDEBUG)
+# define ACCT_LIB_CACHE
+# define acct_add(p, n)         (*(p) += (n))
+# define acct_sub(p, n)         (*(p) -= (n))
+# define acct_load(p)           (*(p))
+# define acct_store(p, v)       (*(p) = (v))
+# define acct_max(p, v)         do { if (*(p) < (v)) *(p) = (v); } while (0)
+#elif !defined(__GNUC__) || !defined(__ATOMIC_RELAXED)
+# define acct_add(p, n)         (*(p) += (n))
+# define acct_sub(p, n)         (*(p) -= (n))
+# define acct_load(p)           (*(p))
+# define acct_max(p, v)         do { if (*(p) < (v)) *(p) = (v); } while (0)
+#else
+# define ACCT_LIB_CACHE
+# define acct_add(p, n)         __atomic_add_fetch((p), (n), __ATOMIC_RELAXED)
+# define acct_sub(p, n)         __atomic_sub_fetch((p), (n), __ATOMIC_RELAXED)
+# define acct_load(p)           __atomic_load_n((p), __ATOMIC_RELAXED)
+# define acct_store(p, v)       __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+# define acct_max(p, v)                                                     \
+    do {                                                                    \
+        size_t cur_ = acct_load(p);                                         \
+                                                                            \
+        while (cur_ < (v)                                                   \
+               && !__atomic_compare_exchange_n((p), &cur_, (v), 1,          \
+                                               __ATOMIC_RELAXED,            \
+                                               __ATOMIC_RELAXED))           \
+            continue;                                                       \
+    } while (0)
+#endif
+
+/*
+ * The library of a source file is cached by the address of its name, in a
+ * word that holds both, which needs 64 bit pointers.
+ */
+#if defined(ACCT_LIB_CACHE) \
+    && (!defined(__SIZEOF_POINTER__) || __SIZEOF_POINTER__ != 8)
+# undef ACCT_LIB_CACHE
+#endif
+
+#define ACCT_LIBS       (ERR_LIB_USER + 1)
+#define ACCT_CACHE      512
+#define ACCT_SAMPLES    64
+#define ACCT_FRAMES     16
+
+/*
+ * A cache line of counters for each library.  The number of blocks still
+ * allocated is |allocs - frees|, which saves updating a third counter.
+ */
+typedef union {
+    struct {
+        size_t live_bytes;
+        size_t peak_bytes;
+        size_t allocs;
+        size_t frees;
+        size_t reset_allocs;    /* |allocs| at the last reset */
+    } c;
+    unsigned char pad[64];
+} ACCT_COUNTERS;
+
+/* In front of every block, as large as malloc() alignment usually is */
+typedef union {
+    struct {
+        size_t num;
+        int lib;
+        int sample;             /* index in |samples| plus one, or 0 */
+    } h;
+    unsigned char pad[16];
+} ACCT_HEADER;
+
+/*
+ * The last sampled allocations.  The entries aren't locked, so a report
+ * made while other threads allocate may show an entry half written.
+ */
+typedef struct {
+    const void *ptr;            /* NULL once the block is freed */
+    size_t num;
+    const char *file;
+    int line;
+    int lib;
+    int frames;
+    void *addrs[ACCT_FRAMES];
+} ACCT_SAMPLE;
+
+static int acct_enabled = 0;
+static int sample_rate = 0;
+static double start_time;
+static ACCT_COUNTERS counters[ACCT_LIBS];
+static ACCT_SAMPLE samples[ACCT_SAMPLES];
+static size_t next_sample;
+#ifdef ACCT_LIB_CACHE
+static uint64_t lib_cache[ACCT_CACHE];
+#endif
+
+/* The functions that were installed before, NULL for the C library's */
+static void *(*next_malloc)(size_t, const char *, int);
+static void *(*next_realloc)(void *, size_t, const char *, int);
+static void (*next_free)(void *, const char *, int);
+
+/*
+ * The directories below crypto/ with a library of their own, sorted by name.
+ * Everything else in crypto/ is accounted to ERR_LIB_CRYPTO.
+ */
+static const struct {
+    const char *dir;
+    int lib;
+} acct_dirs[] = {
+    { "asn1",   ERR_LIB_ASN1 },
+    { "async",  ERR_LIB_ASYNC },
+    { "bio",    ERR_LIB_BIO },
+    { "bn",     ERR_LIB_BN },
+    { "buffer", ERR_LIB_BUF },
+    { "cmp",    ERR_LIB_CMP },
+    { "cms",    ERR_LIB_CMS },
+    { "comp",   ERR_LIB_COMP },
+    { "conf",   ERR_LIB_CONF },
+    { "crmf",   ERR_LIB_CRMF },
+    { "ct",     ERR_LIB_CT },
+    { "dh",     ERR_LIB_DH },
+    { "dsa",    ERR_LIB_DSA },
+    { "dso",    ERR_LIB_DSO },
+    { "ec",     ERR_LIB_EC },
+    { "engine", ERR_LIB_ENGINE },
+    { "evp",    ERR_LIB_EVP },
+    { "hmac",   ERR_LIB_HMAC },
+    { "kdf",    ERR_LIB_KDF },
+    { "objects", ERR_LIB_OBJ },
+    { "ocsp",   ERR_LIB_OCSP },
+    { "pem",    ERR_LIB_PEM },
+    { "pkcs12", ERR_LIB_PKCS12 },
+    { "pkcs7",  ERR_LIB_PKCS7 },
+    { "rand",   ERR_LIB_RAND },
+    { "rsa",    ERR_LIB_RSA },
+    { "sm2",    ERR_LIB_SM2 },
+    { "store",  ERR_LIB_OSSL_STORE },
+    { "ts",     ERR_LIB_TS },
+    { "ui",     ERR_LIB_UI },
+    { "x509",   ERR_LIB_X509 },
+    { "x509v3", ERR_LIB_X509V3 },
+};
+
+static int is_sep(char c)
+{
+    return c == '/' || c == '\\';
+}
+
+/* Does the path component at |p| equal |name|? */
+static int is_component(const char *p, const char *name, size_t len)
+{
+    return strncmp(p, name, len) == 0 && is_sep(p[len]);
+}
+
+/*
+ * The library that allocates from source file |file|, judged by the last
+ * of the crypto, ssl or engines directories in its path.
+ */
+static int acct_lib(const char *file)
+{
+    const char *p, *comp = NULL, *dir;
+    int lib = ERR_LIB_USER, lo, hi, mid, cmp;
+    size_t len;
+
+    if (file == NULL)
+        return lib;
+    for (p = file; *p != '\0'; p++) {
+        if (p != file && !is_sep(p[-1]))
+            continue;
+        if (is_component(p, "crypto", 6) || is_component(p, "ssl", 3)
+                || is_component(p, "engines", 7))
+            comp = p;
+    }
+    if (comp == NULL)
+        return lib;
+    if (comp[0] == 's')
+        return ERR_LIB_SSL;
+    if (comp[0] == 'e')
+        return ERR_LIB_ENGINE;
+
+    dir = comp + 7;
+    for (len = 0; dir[len] != '\0' && !is_sep(dir[len]); len++)
+        continue;
+    if (dir[len] == '\0')
+        return ERR_LIB_CRYPTO;
+    for (lo = 0, hi = OSSL_NELEM(acct_dirs); lo < hi; ) {
+        mid = lo + (hi - lo) / 2;
+        cmp = strncmp(acct_dirs[mid].dir, dir, len);
+        if (cmp == 0 && acct_dirs[mid].dir[len] != '\0')
+            cmp = 1;
+        if (cmp == 0)
+            return acct_dirs[mid].lib;
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return ERR_LIB_CRYPTO;
+}
+
+#ifdef ACCT_LIB_CACHE
+static int acct_lib_cached(const char *file)
+{
+    uint64_t key = (uint64_t)(uintptr_t)file, v;
+    uint64_t *slot = &lib_cache[(key * 0x9e3779b97f4a7c15U) >> 55];
+    int lib;
+
+    if ((v = acct_load(slot)) >> 8 == key)
+        return (int)(v & 0xff);
+    lib = acct_lib(file);
+    /* The library is 8 bits at most, the address is left 56 */
+    if (key >> 56 == 0)
+        acct_store(slot, key << 8 | lib);
+    return lib;
+}
+#else
+# define acct_lib_cached(file) acct_lib(file)
+#endif
+
+static const char *acct_lib_name(int lib)
+{
+    size_t i;
+
+    switch (lib) {
+    case ERR_LIB_CRYPTO:
+        return "crypto";
+    case ERR_LIB_SSL:
+        return "ssl";
+    case ERR_LIB_USER:
+        return "application";
+    }
+    for (i = 0; i < OSSL_NELEM(acct_dirs); i++)
+        if (acct_dirs[i].lib == lib)
+            return acct_dirs[i].dir;
+    return "?";
+}
+
+static double acct_time(void)
+{
+#ifdef _WIN32
+    return GetTickCount() / 1000.0;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+}
+
+/* Account for |hdr|, a block of |num| bytes just (re)allocated by |lib| */
+static void acct_alloc(ACCT_HEADER *hdr, size_t num, int lib,
+                       const char *file, int line)
+{
+    ACCT_COUNTERS *c = &counters[lib];
+    ACCT_SAMPLE *s;
+    size_t live = acct_add(&c->c.live_bytes, num), allocs, i;
+
+    acct_max(&c->c.peak_bytes, live);
+    hdr->h.num = num;
+    hdr->h.lib = lib;
+    hdr->h.sample = 0;
+    allocs = acct_add(&c->c.allocs, 1);
+    if (sample_rate == 0 || allocs % sample_rate != 0)
+        return;
+
+    i = (acct_add(&next_sample, 1) - 1) % ACCT_SAMPLES;
+    s = &samples[i];
+    s->num = num;
+    s->file = file;
+    s->line = line;
+    s->lib = lib;
+#ifndef OPENSSL_NO_CRYPTO_MDEBUG_BACKTRACE
+    s->frames = backtrace(s->addrs, OSSL_NELEM(s->addrs));
+#else
+    s->frames = 0;
+#endif
+    s->ptr = hdr + 1;
+    hdr->h.sample = (int)i + 1;
+}
+
+/* Account for the release of |str|, which had the header |hdr| */
+static void acct_release(const ACCT_HEADER *hdr, const void *str)
+{
+    ACCT_COUNTERS *c = &counters[hdr->h.lib];
+
+    acct_sub(&c->c.live_bytes, hdr->h.num);
+    acct_add(&c->c.frees, 1);
+    if (hdr->h.sample != 0 && samples[hdr->h.sample - 1].ptr == str)
+        samples[hdr->h.sample - 1].ptr = NULL;
+}
+
+static void *acct_malloc(size_t num, const char *file, int line)
+{
+    ACCT_HEADER *hdr;
+
+    if (num == 0 || num > SIZE_MAX - sizeof(*hdr))
+        return NULL;
+    if (next_malloc != NULL)
+        hdr = next_malloc(num + sizeof(*hdr), file, line);
+    else
+        hdr = malloc(num + sizeof(*hdr));
+    if (hdr == NULL)
+        return NULL;
+    acct_alloc(hdr, num, acct_lib_cached(file), file, line);
+    return hdr + 1;
+}
+
+static void acct_free(void *str, const char *file, int line)
+{
+    ACCT_HEADER *hdr;
+
+    if (str == NULL)
+        return;
+    hdr = (ACCT_HEADER *)str - 1;
+    acct_release(hdr, str);
+    if (next_free != NULL)
+        next_free(hdr, file, line);
+    else
+        free(hdr);
+}
+
+static void *acct_realloc(void *str, size_t num, const char *file, int line)
+{
+    ACCT_HEADER *hdr, old;
+
+    if (str == NULL)
+        return acct_malloc(num, file, line);
+    if (num == 0) {
+        acct_free(str, file, line);
+        return NULL;
+    }
+    if (num > SIZE_MAX - sizeof(*hdr))
+        return NULL;
+
+    hdr = (ACCT_HEADER *)str - 1;
+    old = *hdr;
+    if (next_realloc != NULL)
+        hdr = next_realloc(hdr, num + sizeof(*hdr), file, line);
+    else
+        hdr = realloc(hdr, num + sizeof(*hdr));
+    if (hdr == NULL)
+        return NULL;
+    /* The block is accounted to whoever resized it last */
+    acct_release(&old, str);
+    acct_alloc(hdr, num, acct_lib_cached(file), file, line);
+    return hdr + 1;
+}
+
+int CRYPTO_mem_acct_enable(int rate)
+{
+    void *(*m)(size_t, const char *, int);
+    void *(*r)(void *, size_t, const char *, int);
+    void (*f)(void *, const char *, int);
+
+    if (acct_enabled || rate < 0)
+        return 0;
+    CRYPTO_get_mem_functions(&m, &r, &f);
+    if (!CRYPTO_set_mem_functions(acct_malloc, acct_realloc, acct_free))
+        return 0;
+    next_malloc = m != CRYPTO_malloc ? m : NULL;
+    next_realloc = r != CRYPTO_realloc ? r : NULL;
+    next_free = f != CRYPTO_free ? f : NULL;
+    sample_rate = rate;
+    start_time = acct_time();
+    acct_enabled = 1;
+    return 1;
+}
+
+int CRYPTO_mem_acct_get(int lib, size_t *live_bytes, size_t *live_num,
+                        size_t *peak_bytes, size_t *num_allocs)
+{
+    ACCT_COUNTERS *c;
+    size_t frees;
+
+    if (!acct_enabled || lib < 0 || lib >= ACCT_LIBS)
+        return 0;
+    c = &counters[lib];
+    /* Read the frees first, so that more frees can't seem to have happened */
+    frees = acct_load(&c->c.frees);
+    if (live_num != NULL)
+        *live_num = acct_load(&c->c.allocs) - frees;
+    if (live_bytes != NULL)
+        *live_bytes = acct_load(&c->c.live_bytes);
+    if (peak_bytes != NULL)
+        *peak_bytes = acct_load(&c->c.peak_bytes);
+    if (num_allocs != NULL)
+        *num_allocs = acct_load(&c->c.allocs) - c->c.reset_allocs;
+    return 1;
+}
+
+void CRYPTO_mem_acct_reset(void)
+{
+    int i;
+
+    for (i = 0; i < ACCT_LIBS; i++) {
+        counters[i].c.reset_allocs = acct_load(&counters[i].c.allocs);
+        counters[i].c.peak_bytes = acct_load(&counters[i].c.live_bytes);
+    }
+    for (i = 0; i < ACCT_SAMPLES; i++)
+        samples[i].ptr = NULL;
+    start_time = acct_time();
+}
+
+int CRYPTO_mem_acct_report(BIO *b)
+{
+    size_t live_bytes, live_num, peak_bytes, num_allocs;
+    double secs;
+    const ACCT_SAMPLE *s;
+    int lib, i;
+#ifndef OPENSSL_NO_CRYPTO_MDEBUG_BACKTRACE
+    char **strings;
+    int j;
+#endif
+
+    if (!acct_enabled)
+        return 0;
+
+    secs = acct_time() - start_time;
+    BIO_printf(b, "%-12s %12s %9s %12s %10s %10s\n", "library",
+               "live bytes", "live", "peak bytes", "allocs", "allocs/s");
+    for (lib = 0; lib < ACCT_LIBS; lib++) {
+        CRYPTO_mem_acct_get(lib, &live_bytes, &live_num, &peak_bytes,
+                            &num_allocs);
+        if (live_num == 0 && num_allocs == 0)
+            continue;
+        BIO_printf(b, "%-12s %12zu %9zu %12zu %10zu %10.0f\n",
+                   acct_lib_name(lib), live_bytes, live_num, peak_bytes,
+                   num_allocs, secs > 0 ? num_allocs / secs : 0.0);
+    }
+
+    for (i = 0; i < ACCT_SAMPLES; i++) {
+        s = &samples[i];
+        if (s->ptr == NULL)
+            continue;
+        BIO_printf(b, "sampled %zu bytes at %p, %s, %s:%d\n", s->num, s->ptr,
+                   acct_lib_name(s->lib), s->file, s->line);
+#ifndef OPENSSL_NO_CRYPTO_MDEBUG_BACKTRACE
+        if ((strings = backtrace_symbols(s->addrs, s->frames)) != NULL) {
+            for (j = 0; j < s->frames; j++)
+                BIO_printf(b, "\t%s\n", strings[j]);
+            free(strings);
+        }
+#endif
+    }
+    return 1;
+}
+
+#ifndef OPENSSL_NO_STDIO
+int CRYPTO_mem_acct_report_fp(FILE *fp)
+{
+    BIO *b;
+    int ret;
+
+    if (!acct_enabled || (b = BIO_new(BIO_s_file())) == NULL)
+        return 0;
+    BIO_set_fp(b, fp, BIO_NOCLOSE);
+    ret = CRYPTO_mem_acct_report(b);
+    BIO_free(b);
+    return ret;
+}
+#endif
@@ -17,6 +17,8 @@
  */
 #include "e_os.h"
 #include <openssl/crypto.h>
+#include "internal/cryptlib_int.h"
+#include "internal/thread_once.h"
 
 #include <string.h>
 
@@ -52,41 +54,307 @@
 #endif
 
 #ifdef IMPLEMENTED
-static size_t secure_mem_used;
+typedef struct sh_list_st
+{
+    struct sh_list_st *next;
+    struct sh_list_st **p_next;
+} SH_LIST;
+
+/*
+ * A secure heap (sh) arena.  The secure heap is made of one or more of
+ * these, each with its own lock, so that threads using different arenas
+ * don't wait for each other.
+ */
+typedef struct sh_st
+{
+    char* map_result;
+    size_t map_size;
+    char *arena;
+    size_t arena_size;
+    char **freelist;
+    ossl_ssize_t freelist_size;
+    size_t minsize;
+    unsigned char *bittable;
+    unsigned char *bitmalloc;
+    size_t bittable_size; /* size in bits */
+    unsigned char *chunklist; /* freelist of each allocated chunk */
+    CRYPTO_RWLOCK *lock;
+    size_t used;
+} SH;
+
+# define SEC_MAX_ARENAS 16
+
+static SH sec_arenas[SEC_MAX_ARENAS];
+static int sec_num_arenas;
 
 static int secure_mem_initialized;
 
-static CRYPTO_RWLOCK *sec_malloc_lock = NULL;
+/*
+ * Each thread keeps up to SEC_CACHE_DEPTH of the chunks it frees of each
+ * of the SEC_CACHE_LISTS smallest sizes and hands them out again without
+ * taking a lock.  The chunks are cleansed before they go into the cache,
+ * which only holds pointers to them, so they stay zeroed while they are
+ * there.  Each cache holds at most sec_cache_max bytes, which don't count
+ * towards CRYPTO_secure_used() but still do for the arenas, so that
+ * CRYPTO_secure_malloc_done() fails while any thread has cached chunks.
+ *
+ * All caches are linked together so that CRYPTO_secure_used() can find
+ * them.  Only the owning thread changes a cache, but the number of bytes
+ * in it is also read by others.
+ */
+# define SEC_CACHE_LISTS 6
+# define SEC_CACHE_DEPTH 8
+
+typedef struct sec_cache_st {
+    size_t bytes;
+    int arena;
+    int num[SEC_CACHE_LISTS];
+    char *chunks[SEC_CACHE_LISTS][SEC_CACHE_DEPTH];
+    struct sec_cache_st *next;
+    struct sec_cache_st **p_next;
+} SEC_CACHE;
+
+# if defined(__GNUC__) && defined(__ATOMIC_RELAXED)
+#  define SEC_CACHE_BYTES(c)  __atomic_load_n(&(c)->bytes, __ATOMIC_RELAXED)
+#  define SEC_CACHE_SET_BYTES(c, n) \
+    __atomic_store_n(&(c)->bytes, (n), __ATOMIC_RELAXED)
+# else
+#  define SEC_CACHE_BYTES(c)  ((c)->bytes)
+#  define SEC_CACHE_SET_BYTES(c, n) ((c)->bytes = (n))
+# endif
+
+static CRYPTO_ONCE sec_cache_once = CRYPTO_ONCE_STATIC_INIT;
+static CRYPTO_THREAD_LOCAL sec_cache_key;
+static int sec_cache_key_inited = 0;
+/* Guards sec_caches, and sec_next_arena where there are no atomics */
+static CRYPTO_RWLOCK *sec_cache_lock = NULL;
+static SEC_CACHE *sec_caches = NULL;
+static size_t sec_cache_max;
+static int sec_next_arena;
 
 /*
  * These are the functions that must be implemented by a secure heap (sh).
  */
-static int sh_init(size_t size, int minsize);
-static void *sh_malloc(size_t size);
-static void sh_free(void *ptr);
-static void sh_done(void);
-static size_t sh_actual_size(char *ptr);
-static int sh_allocated(const char *ptr);
+static int sh_init(SH *sh, size_t size, int minsize);
+static void *sh_malloc(SH *sh, size_t size);
+static void sh_free(SH *sh, void *ptr);
+static void sh_done(SH *sh);
+static size_t sh_actual_size(SH *sh, char *ptr);
+static int sh_allocated(SH *sh, const char *ptr);
+
+static SH *sec_arena_of(const void *ptr)
+{
+    int i;
+
+    for (i = 0; i < sec_num_arenas; i++)
+        if (sh_allocated(&sec_arenas[i], ptr))
+            return &sec_arenas[i];
+    return NULL;
+}
+
+static void sec_arenas_done(void)
+{
+    int i;
+
+    for (i = 0; i < sec_num_arenas; i++) {
+        CRYPTO_THREAD_lock_free(sec_arenas[i].lock);
+        sh_done(&sec_arenas[i]);
+    }
+    sec_num_arenas = 0;
+}
+
+static void *sec_arena_malloc(SH *sh, size_t num)
+{
+    void *ret;
+
+    CRYPTO_THREAD_write_lock(sh->lock);
+    ret = sh_malloc(sh, num);
+    if (ret != NULL)
+        sh->used += sh_actual_size(sh, ret);
+    CRYPTO_THREAD_unlock(sh->lock);
+    return ret;
+}
+
+static void sec_arena_free(SH *sh, void *ptr, size_t actual_size)
+{
+    CRYPTO_THREAD_write_lock(sh->lock);
+    sh->used -= actual_size;
+    sh_free(sh, ptr);
+    CRYPTO_THREAD_unlock(sh->lock);
+}
+
+/* The cache list of chunks of |size| bytes, SEC_CACHE_LISTS if none */
+static int sec_cache_list(size_t size)
+{
+    size_t chunk = sec_arenas[0].minsize;
+    int list = 0;
+
+    while (chunk < size && list < SEC_CACHE_LISTS) {
+        chunk <<= 1;
+        list++;
+    }
+    return list;
+}
+
+DEFINE_RUN_ONCE_STATIC(do_sec_cache_init)
+{
+    if (!OPENSSL_init_crypto(0, NULL))
+        return 0;
+    if ((sec_cache_lock = CRYPTO_THREAD_lock_new()) == NULL)
+        return 0;
+    if (!CRYPTO_THREAD_init_local(&sec_cache_key, NULL)) {
+        CRYPTO_THREAD_lock_free(sec_cache_lock);
+        sec_cache_lock = NULL;
+        return 0;
+    }
+    sec_cache_key_inited = 1;
+    return 1;
+}
+
+/* Puts the chunks in |cache| back into their arenas */
+static int sec_cache_flush(SEC_CACHE *cache)
+{
+    int list, ret = 0;
+    size_t actual_size;
+    char *ptr;
+    SH *sh;
+
+    for (list = 0; list < SEC_CACHE_LISTS; list++) {
+        while (cache->num[list] > 0) {
+            ptr = cache->chunks[list][--cache->num[list]];
+            sh = sec_arena_of(ptr);
+            actual_size = sh_actual_size(sh, ptr);
+            SEC_CACHE_SET_BYTES(cache, cache->bytes - actual_size);
+            sec_arena_free(sh, ptr, actual_size);
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+/*
+ * Returns the cache of the calling thread, or NULL if there is none and
+ * one can't be made.
+ */
+static SEC_CACHE *sec_cache_get(void)
+{
+    SEC_CACHE *cache;
+
+    if (!RUN_ONCE(&sec_cache_once, do_sec_cache_init) || !sec_cache_key_inited)
+        return NULL;
+    cache = CRYPTO_THREAD_get_local(&sec_cache_key);
+    if (cache != NULL)
+        return cache;
+
+    /* No new caches once OPENSSL_cleanup() has started */
+    if (!OPENSSL_init_crypto(OPENSSL_INIT_BASE_ONLY, NULL)
+            || !ossl_init_thread_start(OPENSSL_INIT_THREAD_SECMEM)
+            || (cache = OPENSSL_zalloc(sizeof(*cache))) == NULL)
+        return NULL;
+    if (!CRYPTO_atomic_add(&sec_next_arena, 1, &cache->arena, sec_cache_lock)
+            || !CRYPTO_THREAD_set_local(&sec_cache_key, cache)) {
+        OPENSSL_free(cache);
+        return NULL;
+    }
+
+    CRYPTO_THREAD_write_lock(sec_cache_lock);
+    cache->next = sec_caches;
+    cache->p_next = &sec_caches;
+    if (sec_caches != NULL)
+        sec_caches->p_next = &cache->next;
+    sec_caches = cache;
+    CRYPTO_THREAD_unlock(sec_cache_lock);
+    return cache;
+}
+
+static int sec_cache_put(char *ptr, size_t actual_size)
+{
+    SEC_CACHE *cache;
+    int list = sec_cache_list(actual_size);
+
+    if (list == SEC_CACHE_LISTS || (cache = sec_cache_get()) == NULL
+            || cache->num[list] == SEC_CACHE_DEPTH
+            || cache->bytes + actual_size > sec_cache_max)
+        return 0;
+    cache->chunks[list][cache->num[list]++] = ptr;
+    SEC_CACHE_SET_BYTES(cache, cache->bytes + actual_size);
+    return 1;
+}
+
+static void sec_free(void *ptr)
+{
+    SH *sh = sec_arena_of(ptr);
+    size_t actual_size = sh_actual_size(sh, ptr);
+
+    CLEAR(ptr, actual_size);
+    if (!sec_cache_put(ptr, actual_size))
+        sec_arena_free(sh, ptr, actual_size);
+}
 #endif
 
+void secure_mem_delete_thread_state(void)
+{
+#ifdef IMPLEMENTED
+    SEC_CACHE *cache;
+
+    if (!sec_cache_key_inited
+            || (cache = CRYPTO_THREAD_get_local(&sec_cache_key)) == NULL)
+        return;
+    CRYPTO_THREAD_set_local(&sec_cache_key, NULL);
+
+    CRYPTO_THREAD_write_lock(sec_cache_lock);
+    *cache->p_next = cache->next;
+    if (cache->next != NULL)
+        cache->next->p_next = cache->p_next;
+    CRYPTO_THREAD_unlock(sec_cache_lock);
+
+    sec_cache_flush(cache);
+    OPENSSL_free(cache);
+#endif /* IMPLEMENTED */
+}
+
+void secure_mem_cleanup_int(void)
+{
+#ifdef IMPLEMENTED
+    if (sec_cache_key_inited) {
+        CRYPTO_THREAD_cleanup_local(&sec_cache_key);
+        CRYPTO_THREAD_lock_free(sec_cache_lock);
+        sec_cache_lock = NULL;
+        sec_caches = NULL;
+        sec_cache_key_inited = 0;
+    }
+#endif /* IMPLEMENTED */
+}
+
 int CRYPTO_secure_malloc_init(size_t size, int minsize)
+{
+    return CRYPTO_secure_malloc_init_ex(size, minsize, 1);
+}
+
+int CRYPTO_secure_malloc_init_ex(size_t size, int minsize, int arenas)
 {
 #ifdef IMPLEMENTED
-    int ret = 0;
+    int ret = 1, i, r;
 
-    if (!secure_mem_initialized) {
-        sec_malloc_lock = CRYPTO_THREAD_lock_new();
-        if (sec_malloc_lock == NULL)
-            return 0;
-        if ((ret = sh_init(size, minsize)) != 0) {
-            secure_mem_initialized = 1;
-        } else {
-            CRYPTO_THREAD_lock_free(sec_malloc_lock);
-            sec_malloc_lock = NULL;
-        }
+    if (secure_mem_initialized || arenas < 1 || arenas > SEC_MAX_ARENAS)
+        return 0;
+    for (i = 0; i < arenas; i++) {
+        if ((r = sh_init(&sec_arenas[i], size, minsize)) == 0)
+            goto err;
+        sec_num_arenas++;
+        if ((sec_arenas[i].lock = CRYPTO_THREAD_lock_new()) == NULL)
+            goto err;
+        if (r == 2)
+            ret = 2;
     }
 
+    sec_cache_max = size / 16;
+    secure_mem_initialized = 1;
     return ret;
+
+ err:
+    sec_arenas_done();
+    return 0;
 #else
     return 0;
 #endif /* IMPLEMENTED */
@@ -95,11 +363,24 @@ int CRYPTO_secure_malloc_init(size_t size, int minsize)
 int CRYPTO_secure_malloc_done(void)
 {
 #ifdef IMPLEMENTED
-    if (secure_mem_used == 0) {
-        sh_done();
+    SEC_CACHE *cache;
+    size_t used = 0;
+    int i;
+
+    if (!secure_mem_initialized)
+        return 1;
+    if (sec_cache_key_inited
+            && (cache = CRYPTO_THREAD_get_local(&sec_cache_key)) != NULL)
+        sec_cache_flush(cache);
+    /* This includes the chunks in the caches of other threads */
+    for (i = 0; i < sec_num_arenas; i++) {
+        CRYPTO_THREAD_read_lock(sec_arenas[i].lock);
+        used += sec_arenas[i].used;
+        CRYPTO_THREAD_unlock(sec_arenas[i].lock);
+    }
+    if (used == 0) {
         secure_mem_initialized = 0;
-        CRYPTO_THREAD_lock_free(sec_malloc_lock);
-        sec_malloc_lock = NULL;
+        sec_arenas_done();
         return 1;
     }
 #endif /* IMPLEMENTED */
@@ -118,17 +399,32 @@ int CRYPTO_secure_malloc_initialized(void)
 void *CRYPTO_secure_malloc(size_t num, const char *file, int line)
 {
 #ifdef IMPLEMENTED
-    void *ret;
-    size_t actual_size;
+    SEC_CACHE *cache;
+    void *ret = NULL;
+    int list, arena, i;
 
     if (!secure_mem_initialized) {
         return CRYPTO_malloc(num, file, line);
     }
-    CRYPTO_THREAD_write_lock(sec_malloc_lock);
-    ret = sh_malloc(num);
-    actual_size = ret ? sh_actual_size(ret) : 0;
-    secure_mem_used += actual_size;
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
+    cache = sec_cache_get();
+    if (cache != NULL) {
+        list = sec_cache_list(num);
+        if (list < SEC_CACHE_LISTS && cache->num[list] > 0) {
+            ret = cache->chunks[list][--cache->num[list]];
+            SEC_CACHE_SET_BYTES(cache, cache->bytes
+                                       - (sec_arenas[0].minsize << list));
+            return ret;
+        }
+    }
+
+    /* Try the arena of this thread first, then the others */
+    arena = cache != NULL
+            ? (int)((unsigned int)cache->arena % sec_num_arenas) : 0;
+    do {
+        for (i = 0; i < sec_num_arenas && ret == NULL; i++)
+            ret = sec_arena_malloc(&sec_arenas[(arena + i) % sec_num_arenas],
+                                   num);
+    } while (ret == NULL && cache != NULL && sec_cache_flush(cache));
     return ret;
 #else
     return CRYPTO_malloc(num, file, line);
@@ -147,20 +443,13 @@ void *CRYPTO_secure_zalloc(size_t num, const char *file, int line)
 void CRYPTO_secure_free(void *ptr, const char *file, int line)
 {
 #ifdef IMPLEMENTED
-    size_t actual_size;
-
     if (ptr == NULL)
         return;
     if (!CRYPTO_secure_allocated(ptr)) {
         CRYPTO_free(ptr, file, line);
         return;
     }
-    CRYPTO_THREAD_write_lock(sec_malloc_lock);
-    actual_size = sh_actual_size(ptr);
-    CLEAR(ptr, actual_size);
-    secure_mem_used -= actual_size;
-    sh_free(ptr);
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
+    sec_free(ptr);
 #else
     CRYPTO_free(ptr, file, line);
 #endif /* IMPLEMENTED */
@@ -170,8 +459,6 @@ void CRYPTO_secure_clear_free(void *ptr, size_t num,
                               const char *file, int line)
 {
 #ifdef IMPLEMENTED
-    size_t actual_size;
-
     if (ptr == NULL)
         return;
     if (!CRYPTO_secure_allocated(ptr)) {
@@ -179,12 +466,7 @@ void CRYPTO_secure_clear_free(void *ptr, size_t num,
         CRYPTO_free(ptr, file, line);
         return;
     }
-    CRYPTO_THREAD_write_lock(sec_malloc_lock);
-    actual_size = sh_actual_size(ptr);
-    CLEAR(ptr, actual_size);
-    secure_mem_used -= actual_size;
-    sh_free(ptr);
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
+    sec_free(ptr);
 #else
     if (ptr == NULL)
         return;
@@ -196,14 +478,8 @@ void CRYPTO_secure_clear_free(void *ptr, size_t num,
 int CRYPTO_secure_allocated(const void *ptr)
 {
 #ifdef IMPLEMENTED
-    int ret;
-
-    if (!secure_mem_initialized)
-        return 0;
-    CRYPTO_THREAD_write_lock(sec_malloc_lock);
-    ret = sh_allocated(ptr);
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
-    return ret;
+    /* The bounds of the arenas don't change, no lock is needed */
+    return secure_mem_initialized && sec_arena_of(ptr) != NULL;
 #else
     return 0;
 #endif /* IMPLEMENTED */
@@ -212,7 +488,19 @@ int CRYPTO_secure_allocated(const void *ptr)
 size_t CRYPTO_secure_used(void)
 {
 #ifdef IMPLEMENTED
-    return secure_mem_used;
+    size_t used = 0, cached = 0;
+    SEC_CACHE *cache;
+    int i;
+
+    for (i = 0; i < sec_num_arenas; i++)
+        used += sec_arenas[i].used;
+    if (sec_cache_key_inited) {
+        CRYPTO_THREAD_read_lock(sec_cache_lock);
+        for (cache = sec_caches; cache != NULL; cache = cache->next)
+            cached += SEC_CACHE_BYTES(cache);
+        CRYPTO_THREAD_unlock(sec_cache_lock);
+    }
+    return used > cached ? used - cached : 0;
 #else
     return 0;
 #endif /* IMPLEMENTED */
@@ -221,12 +509,9 @@ size_t CRYPTO_secure_used(void)
 size_t CRYPTO_secure_actual_size(void *ptr)
 {
 #ifdef IMPLEMENTED
-    size_t actual_size;
+    SH *sh = sec_arena_of(ptr);
 
-    CRYPTO_THREAD_write_lock(sec_malloc_lock);
-    actual_size = sh_actual_size(ptr);
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
-    return actual_size;
+    return sh != NULL ? sh_actual_size(sh, ptr) : 0;
 #else
     return 0;
 #endif
@@ -249,7 +534,7 @@ size_t CRYPTO_secure_actual_size(void *ptr)
  * Free'd memory is zero'd or otherwise cleansed.
  *
  * This is a pretty standard buddy allocator.  We keep areas in a multiple
- * of "sh.minsize" units.  The freelist and bitmaps are kept separately,
+ * of "sh->minsize" units.  The freelist and bitmaps are kept separately,
  * so all (and only) data is kept in the mmap'd heap.
  *
  * This code assumes eight-bit bytes.  The numbers 3 and 7 are all over the
@@ -262,41 +547,19 @@ size_t CRYPTO_secure_actual_size(void *ptr)
 # define SETBIT(t, b)   (t[(b) >> 3] |= (ONE << ((b) & 7)))
 # define CLEARBIT(t, b) (t[(b) >> 3] &= (0xFF & ~(ONE << ((b) & 7))))
 
-#define WITHIN_ARENA(p) \
-    ((char*)(p) >= sh.arena && (char*)(p) < &sh.arena[sh.arena_size])
-#define WITHIN_FREELIST(p) \
-    ((char*)(p) >= (char*)sh.freelist && (char*)(p) < (char*)&sh.freelist[sh.freelist_size])
+#define WITHIN_ARENA(sh, p) \
+    ((char*)(p) >= (sh)->arena && (char*)(p) < &(sh)->arena[(sh)->arena_size])
+#define WITHIN_FREELIST(sh, p) \
+    ((char*)(p) >= (char*)(sh)->freelist && (char*)(p) < (char*)&(sh)->freelist[(sh)->freelist_size])
 
 
-typedef struct sh_list_st
+static size_t sh_getlist(SH *sh, char *ptr)
 {
-    struct sh_list_st *next;
-    struct sh_list_st **p_next;
-} SH_LIST;
-
-typedef struct sh_st
-{
-    char* map_result;
-    size_t map_size;
-    char *arena;
-    size_t arena_size;
-    char **freelist;
-    ossl_ssize_t freelist_size;
-    size_t minsize;
-    unsigned char *bittable;
-    unsigned char *bitmalloc;
-    size_t bittable_size; /* size in bits */
-} SH;
-
-static SH sh;
-
-static size_t sh_getlist(char *ptr)
-{
-    ossl_ssize_t list = sh.freelist_size - 1;
-    size_t bit = (sh.arena_size + ptr - sh.arena) / sh.minsize;
+    ossl_ssize_t list = sh->freelist_size - 1;
+    size_t bit = (sh->arena_size + ptr - sh->arena) / sh->minsize;
 
     for (; bit; bit >>= 1, list--) {
-        if (TESTBIT(sh.bittable, bit))
+        if (TESTBIT(sh->bittable, bit))
             break;
         OPENSSL_assert((bit & 1) == 0);
     }
@@ -305,51 +568,51 @@ static size_t sh_getlist(char *ptr)
 }
 
 
-static int sh_testbit(char *ptr, int list, unsigned char *table)
+static int sh_testbit(SH *sh, char *ptr, int list, unsigned char *table)
 {
     size_t bit;
 
-    OPENSSL_assert(list >= 0 && list < sh.freelist_size);
-    OPENSSL_assert(((ptr - sh.arena) & ((sh.arena_size >> list) - 1)) == 0);
-    bit = (ONE << list) + ((ptr - sh.arena) / (sh.arena_size >> list));
-    OPENSSL_assert(bit > 0 && bit < sh.bittable_size);
+    OPENSSL_assert(list >= 0 && list < sh->freelist_size);
+    OPENSSL_assert(((ptr - sh->arena) & ((sh->arena_size >> list) - 1)) == 0);
+    bit = (ONE << list) + ((ptr - sh->arena) / (sh->arena_size >> list));
+    OPENSSL_assert(bit > 0 && bit < sh->bittable_size);
     return TESTBIT(table, bit);
 }
 
-static void sh_clearbit(char *ptr, int list, unsigned char *table)
+static void sh_clearbit(SH *sh, char *ptr, int list, unsigned char *table)
 {
     size_t bit;
 
-    OPENSSL_assert(list >= 0 && list < sh.freelist_size);
-    OPENSSL_assert(((ptr - sh.arena) & ((sh.arena_size >> list) - 1)) == 0);
-    bit = (ONE << list) + ((ptr - sh.arena) / (sh.arena_size >> list));
-    OPENSSL_assert(bit > 0 && bit < sh.bittable_size);
+    OPENSSL_assert(list >= 0 && list < sh->freelist_size);
+    OPENSSL_assert(((ptr - sh->arena) & ((sh->arena_size >> list) - 1)) == 0);
+    bit = (ONE << list) + ((ptr - sh->arena) / (sh->arena_size >> list));
+    OPENSSL_assert(bit > 0 && bit < sh->bittable_size);
     OPENSSL_assert(TESTBIT(table, bit));
     CLEARBIT(table, bit);
 }
 
-static void sh_setbit(char *ptr, int list, unsigned char *table)
+static void sh_setbit(SH *sh, char *ptr, int list, unsigned char *table)
 {
     size_t bit;
 
-    OPENSSL_assert(list >= 0 && list < sh.freelist_size);
-    OPENSSL_assert(((ptr - sh.arena) & ((sh.arena_size >> list) - 1)) == 0);
-    bit = (ONE << list) + ((ptr - sh.arena) / (sh.arena_size >> list));
-    OPENSSL_assert(bit > 0 && bit < sh.bittable_size);
+    OPENSSL_assert(list >= 0 && list < sh->freelist_size);
+    OPENSSL_assert(((ptr - sh->arena) & ((sh->arena_size >> list) - 1)) == 0);
+    bit = (ONE << list) + ((ptr - sh->arena) / (sh->arena_size >> list));
+    OPENSSL_assert(bit > 0 && bit < sh->bittable_size);
     OPENSSL_assert(!TESTBIT(table, bit));
     SETBIT(table, bit);
 }
 
-static void sh_add_to_list(char **list, char *ptr)
+static void sh_add_to_list(SH *sh, char **list, char *ptr)
 {
     SH_LIST *temp;
 
-    OPENSSL_assert(WITHIN_FREELIST(list));
-    OPENSSL_assert(WITHIN_ARENA(ptr));
+    OPENSSL_assert(WITHIN_FREELIST(sh, list));
+    OPENSSL_assert(WITHIN_ARENA(sh, ptr));
 
     temp = (SH_LIST *)ptr;
     temp->next = *(SH_LIST **)list;
-    OPENSSL_assert(temp->next == NULL || WITHIN_ARENA(temp->next));
+    OPENSSL_assert(temp->next == NULL || WITHIN_ARENA(sh, temp->next));
     temp->p_next = (SH_LIST **)list;
 
     if (temp->next != NULL) {
@@ -360,7 +623,7 @@ static void sh_add_to_list(char **list, char *ptr)
     *list = ptr;
 }
 
-static void sh_remove_from_list(char *ptr)
+static void sh_remove_from_list(SH *sh, char *ptr)
 {
     SH_LIST *temp, *temp2;
 
@@ -372,18 +635,18 @@ static void sh_remove_from_list(char *ptr)
         return;
 
     temp2 = temp->next;
-    OPENSSL_assert(WITHIN_FREELIST(temp2->p_next) || WITHIN_ARENA(temp2->p_next));
+    OPENSSL_assert(WITHIN_FREELIST(sh, temp2->p_next) || WITHIN_ARENA(sh, temp2->p_next));
 }
 
 
-static int sh_init(size_t size, int minsize)
+static int sh_init(SH *sh, size_t size, int minsize)
 {
     int ret;
     size_t i;
     size_t pgsize;
     size_t aligned;
 
-    memset(&sh, 0, sizeof(sh));
+    memset(sh, 0, sizeof(*sh));
 
     /* make sure size and minsize are powers of 2 */
     OPENSSL_assert(size > 0);
@@ -398,31 +661,36 @@ static int sh_init(size_t size, int minsize)
     while (minsize < (int)sizeof(SH_LIST))
         minsize *= 2;
 
-    sh.arena_size = size;
-    sh.minsize = minsize;
-    sh.bittable_size = (sh.arena_size / sh.minsize) * 2;
+    sh->arena_size = size;
+    sh->minsize = minsize;
+    sh->bittable_size = (sh->arena_size / sh->minsize) * 2;
 
     /* Prevent allocations of size 0 later on */
-    if (sh.bittable_size >> 3 == 0)
+    if (sh->bittable_size >> 3 == 0)
         goto err;
 
-    sh.freelist_size = -1;
-    for (i = sh.bittable_size; i; i >>= 1)
-        sh.freelist_size++;
+    sh->freelist_size = -1;
+    for (i = sh->bittable_size; i; i >>= 1)
+        sh->freelist_size++;
+
+    sh->freelist = OPENSSL_zalloc(sh->freelist_size * sizeof(char *));
+    OPENSSL_assert(sh->freelist != NULL);
+    if (sh->freelist == NULL)
+        goto err;
 
-    sh.freelist = OPENSSL_zalloc(sh.freelist_size * sizeof(char *));
-    OPENSSL_assert(sh.freelist != NULL);
-    if (sh.freelist == NULL)
+    sh->bittable = OPENSSL_zalloc(sh->bittable_size >> 3);
+    OPENSSL_assert(sh->bittable != NULL);
+    if (sh->bittable == NULL)
         goto err;
 
-    sh.bittable = OPENSSL_zalloc(sh.bittable_size >> 3);
-    OPENSSL_assert(sh.bittable != NULL);
-    if (sh.bittable == NULL)
+    sh->bitmalloc = OPENSSL_zalloc(sh->bittable_size >> 3);
+    OPENSSL_assert(sh->bitmalloc != NULL);
+    if (sh->bitmalloc == NULL)
         goto err;
 
-    sh.bitmalloc = OPENSSL_zalloc(sh.bittable_size >> 3);
-    OPENSSL_assert(sh.bitmalloc != NULL);
-    if (sh.bitmalloc == NULL)
+    sh->chunklist = OPENSSL_zalloc(sh->arena_size / sh->minsize);
+    OPENSSL_assert(sh->chunklist != NULL);
+    if (sh->chunklist == NULL)
         goto err;
 
     /* Allocate space for heap, and two extra pages as guards */
@@ -441,204 +709,206 @@ static int sh_init(size_t size, int minsize)
 #else
     pgsize = PAGE_SIZE;
 #endif
-    sh.map_size = pgsize + sh.arena_size + pgsize;
+    sh->map_size = pgsize + sh->arena_size + pgsize;
     if (1) {
 #ifdef MAP_ANON
-        sh.map_result = mmap(NULL, sh.map_size,
+        sh->map_result = mmap(NULL, sh->map_size,
                              PROT_READ|PROT_WRITE, MAP_ANON|MAP_PRIVATE, -1, 0);
     } else {
 #endif
         int fd;
 
-        sh.map_result = MAP_FAILED;
+        sh->map_result = MAP_FAILED;
         if ((fd = open("/dev/zero", O_RDWR)) >= 0) {
-            sh.map_result = mmap(NULL, sh.map_size,
+            sh->map_result = mmap(NULL, sh->map_size,
                                  PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
             close(fd);
         }
     }
-    if (sh.map_result == MAP_FAILED)
+    if (sh->map_result == MAP_FAILED)
         goto err;
-    sh.arena = (char *)(sh.map_result + pgsize);
-    sh_setbit(sh.arena, 0, sh.bittable);
-    sh_add_to_list(&sh.freelist[0], sh.arena);
+    sh->arena = (char *)(sh->map_result + pgsize);
+    sh_setbit(sh, sh->arena, 0, sh->bittable);
+    sh_add_to_list(sh, &sh->freelist[0], sh->arena);
 
     /* Now try to add guard pages and lock into memory. */
     ret = 1;
 
     /* Starting guard is already aligned from mmap. */
-    if (mprotect(sh.map_result, pgsize, PROT_NONE) < 0)
+    if (mprotect(sh->map_result, pgsize, PROT_NONE) < 0)
         ret = 2;
 
     /* Ending guard page - need to round up to page boundary */
-    aligned = (pgsize + sh.arena_size + (pgsize - 1)) & ~(pgsize - 1);
-    if (mprotect(sh.map_result + aligned, pgsize, PROT_NONE) < 0)
+    aligned = (pgsize + sh->arena_size + (pgsize - 1)) & ~(pgsize - 1);
+    if (mprotect(sh->map_result + aligned, pgsize, PROT_NONE) < 0)
         ret = 2;
 
 #if defined(OPENSSL_SYS_LINUX) && defined(MLOCK_ONFAULT) && defined(SYS_mlock2)
-    if (syscall(SYS_mlock2, sh.arena, sh.arena_size, MLOCK_ONFAULT) < 0) {
+    if (syscall(SYS_mlock2, sh->arena, sh->arena_size, MLOCK_ONFAULT) < 0) {
         if (errno == ENOSYS) {
-            if (mlock(sh.arena, sh.arena_size) < 0)
+            if (mlock(sh->arena, sh->arena_size) < 0)
                 ret = 2;
         } else {
             ret = 2;
         }
     }
 #else
-    if (mlock(sh.arena, sh.arena_size) < 0)
+    if (mlock(sh->arena, sh->arena_size) < 0)
         ret = 2;
 #endif
 #ifdef MADV_DONTDUMP
-    if (madvise(sh.arena, sh.arena_size, MADV_DONTDUMP) < 0)
+    if (madvise(sh->arena, sh->arena_size, MADV_DONTDUMP) < 0)
         ret = 2;
 #endif
 
     return ret;
 
  err:
-    sh_done();
+    sh_done(sh);
     return 0;
 }
 
-static void sh_done(void)
+static void sh_done(SH *sh)
 {
-    OPENSSL_free(sh.freelist);
-    OPENSSL_free(sh.bittable);
-    OPENSSL_free(sh.bitmalloc);
-    if (sh.map_result != NULL && sh.map_size)
-        munmap(sh.map_result, sh.map_size);
-    memset(&sh, 0, sizeof(sh));
+    OPENSSL_free(sh->freelist);
+    OPENSSL_free(sh->bittable);
+    OPENSSL_free(sh->bitmalloc);
+    OPENSSL_free(sh->chunklist);
+    if (sh->map_result != NULL && sh->map_size)
+        munmap(sh->map_result, sh->map_size);
+    memset(sh, 0, sizeof(*sh));
 }
 
-static int sh_allocated(const char *ptr)
+static int sh_allocated(SH *sh, const char *ptr)
 {
-    return WITHIN_ARENA(ptr) ? 1 : 0;
+    return WITHIN_ARENA(sh, ptr) ? 1 : 0;
 }
 
-static char *sh_find_my_buddy(char *ptr, int list)
+static char *sh_find_my_buddy(SH *sh, char *ptr, int list)
 {
     size_t bit;
     char *chunk = NULL;
 
-    bit = (ONE << list) + (ptr - sh.arena) / (sh.arena_size >> list);
+    bit = (ONE << list) + (ptr - sh->arena) / (sh->arena_size >> list);
     bit ^= 1;
 
-    if (TESTBIT(sh.bittable, bit) && !TESTBIT(sh.bitmalloc, bit))
-        chunk = sh.arena + ((bit & ((ONE << list) - 1)) * (sh.arena_size >> list));
+    if (TESTBIT(sh->bittable, bit) && !TESTBIT(sh->bitmalloc, bit))
+        chunk = sh->arena + ((bit & ((ONE << list) - 1)) * (sh->arena_size >> list));
 
     return chunk;
 }
 
-static void *sh_malloc(size_t size)
+static void *sh_malloc(SH *sh, size_t size)
 {
     ossl_ssize_t list, slist;
     size_t i;
     char *chunk;
 
-    if (size > sh.arena_size)
+    if (size > sh->arena_size)
         return NULL;
 
-    list = sh.freelist_size - 1;
-    for (i = sh.minsize; i < size; i <<= 1)
+    list = sh->freelist_size - 1;
+    for (i = sh->minsize; i < size; i <<= 1)
         list--;
     if (list < 0)
         return NULL;
 
     /* try to find a larger entry to split */
     for (slist = list; slist >= 0; slist--)
-        if (sh.freelist[slist] != NULL)
+        if (sh->freelist[slist] != NULL)
             break;
     if (slist < 0)
         return NULL;
 
     /* split larger entry */
     while (slist != list) {
-        char *temp = sh.freelist[slist];
+        char *temp = sh->freelist[slist];
 
         /* remove from bigger list */
-        OPENSSL_assert(!sh_testbit(temp, slist, sh.bitmalloc));
-        sh_clearbit(temp, slist, sh.bittable);
-        sh_remove_from_list(temp);
-        OPENSSL_assert(temp != sh.freelist[slist]);
+        OPENSSL_assert(!sh_testbit(sh, temp, slist, sh->bitmalloc));
+        sh_clearbit(sh, temp, slist, sh->bittable);
+        sh_remove_from_list(sh, temp);
+        OPENSSL_assert(temp != sh->freelist[slist]);
 
         /* done with bigger list */
         slist++;
 
         /* add to smaller list */
-        OPENSSL_assert(!sh_testbit(temp, slist, sh.bitmalloc));
-        sh_setbit(temp, slist, sh.bittable);
-        sh_add_to_list(&sh.freelist[slist], temp);
-        OPENSSL_assert(sh.freelist[slist] == temp);
+        OPENSSL_assert(!sh_testbit(sh, temp, slist, sh->bitmalloc));
+        sh_setbit(sh, temp, slist, sh->bittable);
+        sh_add_to_list(sh, &sh->freelist[slist], temp);
+        OPENSSL_assert(sh->freelist[slist] == temp);
 
         /* split in 2 */
-        temp += sh.arena_size >> slist;
-        OPENSSL_assert(!sh_testbit(temp, slist, sh.bitmalloc));
-        sh_setbit(temp, slist, sh.bittable);
-        sh_add_to_list(&sh.freelist[slist], temp);
-        OPENSSL_assert(sh.freelist[slist] == temp);
+        temp += sh->arena_size >> slist;
+        OPENSSL_assert(!sh_testbit(sh, temp, slist, sh->bitmalloc));
+        sh_setbit(sh, temp, slist, sh->bittable);
+        sh_add_to_list(sh, &sh->freelist[slist], temp);
+        OPENSSL_assert(sh->freelist[slist] == temp);
 
-        OPENSSL_assert(temp-(sh.arena_size >> slist) == sh_find_my_buddy(temp, slist));
+        OPENSSL_assert(temp-(sh->arena_size >> slist) == sh_find_my_buddy(sh, temp, slist));
     }
 
     /* peel off memory to hand back */
-    chunk = sh.freelist[list];
-    OPENSSL_assert(sh_testbit(chunk, list, sh.bittable));
-    sh_setbit(chunk, list, sh.bitmalloc);
-    sh_remove_from_list(chunk);
+    chunk = sh->freelist[list];
+    OPENSSL_assert(sh_testbit(sh, chunk, list, sh->bittable));
+    sh_setbit(sh, chunk, list, sh->bitmalloc);
+    sh_remove_from_list(sh, chunk);
+    sh->chunklist[(chunk - sh->arena) / sh->minsize] = (unsigned char)list;
 
-    OPENSSL_assert(WITHIN_ARENA(chunk));
+    OPENSSL_assert(WITHIN_ARENA(sh, chunk));
 
     return chunk;
 }
 
-static void sh_free(void *ptr)
+static void sh_free(SH *sh, void *ptr)
 {
     size_t list;
     void *buddy;
 
     if (ptr == NULL)
         return;
-    OPENSSL_assert(WITHIN_ARENA(ptr));
-    if (!WITHIN_ARENA(ptr))
+    OPENSSL_assert(WITHIN_ARENA(sh, ptr));
+    if (!WITHIN_ARENA(sh, ptr))
         return;
 
-    list = sh_getlist(ptr);
-    OPENSSL_assert(sh_testbit(ptr, list, sh.bittable));
-    sh_clearbit(ptr, list, sh.bitmalloc);
-    sh_add_to_list(&sh.freelist[list], ptr);
+    list = sh_getlist(sh, ptr);
+    OPENSSL_assert(sh_testbit(sh, ptr, list, sh->bittable));
+    sh_clearbit(sh, ptr, list, sh->bitmalloc);
+    sh_add_to_list(sh, &sh->freelist[list], ptr);
 
     /* Try to coalesce two adjacent free areas. */
-    while ((buddy = sh_find_my_buddy(ptr, list)) != NULL) {
-        OPENSSL_assert(ptr == sh_find_my_buddy(buddy, list));
+    while ((buddy = sh_find_my_buddy(sh, ptr, list)) != NULL) {
+        OPENSSL_assert(ptr == sh_find_my_buddy(sh, buddy, list));
         OPENSSL_assert(ptr != NULL);
-        OPENSSL_assert(!sh_testbit(ptr, list, sh.bitmalloc));
-        sh_clearbit(ptr, list, sh.bittable);
-        sh_remove_from_list(ptr);
-        OPENSSL_assert(!sh_testbit(ptr, list, sh.bitmalloc));
-        sh_clearbit(buddy, list, sh.bittable);
-        sh_remove_from_list(buddy);
+        OPENSSL_assert(!sh_testbit(sh, ptr, list, sh->bitmalloc));
+        sh_clearbit(sh, ptr, list, sh->bittable);
+        sh_remove_from_list(sh, ptr);
+        OPENSSL_assert(!sh_testbit(sh, ptr, list, sh->bitmalloc));
+        sh_clearbit(sh, buddy, list, sh->bittable);
+        sh_remove_from_list(sh, buddy);
 
         list--;
 
         if (ptr > buddy)
             ptr = buddy;
 
-        OPENSSL_assert(!sh_testbit(ptr, list, sh.bitmalloc));
-        sh_setbit(ptr, list, sh.bittable);
-        sh_add_to_list(&sh.freelist[list], ptr);
-        OPENSSL_assert(sh.freelist[list] == ptr);
+        OPENSSL_assert(!sh_testbit(sh, ptr, list, sh->bitmalloc));
+        sh_setbit(sh, ptr, list, sh->bittable);
+        sh_add_to_list(sh, &sh->freelist[list], ptr);
+        OPENSSL_assert(sh->freelist[list] == ptr);
     }
 }
 
-static size_t sh_actual_size(char *ptr)
+static size_t sh_actual_size(SH *sh, char *ptr)
 {
     int list;
 
-    OPENSSL_assert(WITHIN_ARENA(ptr));
-    if (!WITHIN_ARENA(ptr))
+    OPENSSL_assert(WITHIN_ARENA(sh, ptr));
+    if (!WITHIN_ARENA(sh, ptr))
         return 0;
-    list = sh_getlist(ptr);
-    OPENSSL_assert(sh_testbit(ptr, list, sh.bittable));
-    return sh.arena_size / (ONE << list);
+    /* Unlike sh_getlist(), this doesn't need the lock */
+    list = sh->chunklist[(ptr - sh->arena) / sh->minsize];
+    return sh->arena_size / (ONE << list);
 }
 #endif /* IMPLEMENTED */
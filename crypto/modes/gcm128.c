@@ -651,6 +651,13 @@ void gcm_init_avx(u128 Htable[16], const u64 Xi[2]);
 void gcm_gmult_avx(u64 Xi[2], const u128 Htable[16]);
 void gcm_ghash_avx(u64 Xi[2], const u128 Htable[16], const u8 *inp,
                    size_t len);
+#   define GHASH_ASM_X86_64_AVX512
+/* AVX512F+BW+VL and VPCLMULQDQ */
+#   define GHASH_AVX512_CAPABLE \
+        ((OPENSSL_ia32cap_P[2] & 0xc0010000) == 0xc0010000 && \
+         (OPENSSL_ia32cap_P[3] & (1 << 10)))
+void gcm_ghash_avx512(u64 Xi[2], const u128 Htable[16], const u8 *inp,
+                      size_t len);
 #  endif
 
 #  if   defined(__i386) || defined(__i386__) || defined(_M_IX86)
@@ -751,7 +758,12 @@ void CRYPTO_gcm128_init(GCM128_CONTEXT *ctx, void *key, block128_f block)
         if (((OPENSSL_ia32cap_P[1] >> 22) & 0x41) == 0x41) { /* AVX+MOVBE */
             gcm_init_avx(ctx->Htable, ctx->H.u);
             ctx->gmult = gcm_gmult_avx;
-            CTX__GHASH(gcm_ghash_avx);
+#   ifdef GHASH_ASM_X86_64_AVX512
+            if (GHASH_AVX512_CAPABLE)
+                CTX__GHASH(gcm_ghash_avx512);
+            else
+#   endif
+                CTX__GHASH(gcm_ghash_avx);
         } else {
             gcm_init_clmul(ctx->Htable, ctx->H.u);
             ctx->gmult = gcm_gmult_clmul;
@@ -42,36 +42,39 @@ static int obj_strcmp(const char *a, const char *b)
 /*
  * I use the ex_data stuff to manage the identifiers for the obj_name_types
  * that applications may define.  I only really use the free function field.
+ *
+ * The types OBJ_NAME_new_index() hands out start at OBJ_NAME_TYPE_NUM, the
+ * built-in ones always using the default functions.  The functions of the
+ * others are kept in |name_funcs_ht|, which, like |names|, is read without
+ * a lock, so that looking up a name takes none.  |obj_lock| only keeps
+ * changes in order.
  */
-static LHASH_OF(OBJ_NAME) *names_lh = NULL;
+static OBJ_HT *names = NULL;
+static OBJ_HT *name_funcs_ht = NULL;
 static int names_type_num = OBJ_NAME_TYPE_NUM;
 static CRYPTO_RWLOCK *obj_lock = NULL;
 
 struct name_funcs_st {
+    int type;
     unsigned long (*hash_func) (const char *name);
     int (*cmp_func) (const char *a, const char *b);
     void (*free_func) (const char *, int, const char *);
 };
 
-static STACK_OF(NAME_FUNCS) *name_funcs_stack;
-
-/*
- * The LHASH callbacks now use the raw "void *" prototypes and do
- * per-variable casting in the functions. This prevents function pointer
- * casting without the need for macro-generated wrapper functions.
- */
-
-static unsigned long obj_name_hash(const OBJ_NAME *a);
-static int obj_name_cmp(const OBJ_NAME *a, const OBJ_NAME *b);
-
 static CRYPTO_ONCE init = CRYPTO_ONCE_STATIC_INIT;
 DEFINE_RUN_ONCE_STATIC(o_names_init)
 {
     CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_DISABLE);
-    names_lh = lh_OBJ_NAME_new(obj_name_hash, obj_name_cmp);
+    names = obj_ht_new();
+    name_funcs_ht = obj_ht_new();
     obj_lock = CRYPTO_THREAD_lock_new();
     CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_ENABLE);
-    return names_lh != NULL && obj_lock != NULL;
+    return names != NULL && name_funcs_ht != NULL && obj_lock != NULL;
+}
+
+static int name_funcs_cmp(const void *item, const void *key)
+{
+    return ((const NAME_FUNCS *)item)->type != *(const int *)key;
 }
 
 int OBJ_NAME_init(void)
@@ -83,71 +86,59 @@ int OBJ_NAME_new_index(unsigned long (*hash_func) (const char *),
                        int (*cmp_func) (const char *, const char *),
                        void (*free_func) (const char *, int, const char *))
 {
-    int ret = 0, i, push;
-    NAME_FUNCS *name_funcs;
+    int ret = 0, insert;
+    NAME_FUNCS *name_funcs, *replaced;
 
     if (!OBJ_NAME_init())
         return 0;
 
+    CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_DISABLE);
+    name_funcs = OPENSSL_zalloc(sizeof(*name_funcs));
+    CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_ENABLE);
+    if (name_funcs == NULL) {
+        OBJerr(OBJ_F_OBJ_NAME_NEW_INDEX, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    name_funcs->hash_func = hash_func != NULL ? hash_func : OPENSSL_LH_strhash;
+    name_funcs->cmp_func = cmp_func != NULL ? cmp_func : obj_strcmp;
+    name_funcs->free_func = free_func;
+
     CRYPTO_THREAD_write_lock(obj_lock);
+    name_funcs->type = names_type_num;
+    CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_DISABLE);
+    insert = obj_ht_insert(name_funcs_ht, (unsigned long)name_funcs->type,
+                           name_funcs, name_funcs_cmp, (void **)&replaced);
+    CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_ENABLE);
+    if (insert)
+        ret = names_type_num++;
+    CRYPTO_THREAD_unlock(obj_lock);
 
-    if (name_funcs_stack == NULL) {
-        CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_DISABLE);
-        name_funcs_stack = sk_NAME_FUNCS_new_null();
-        CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_ENABLE);
-    }
-    if (name_funcs_stack == NULL) {
-        /* ERROR */
-        goto out;
-    }
-    ret = names_type_num;
-    names_type_num++;
-    for (i = sk_NAME_FUNCS_num(name_funcs_stack); i < names_type_num; i++) {
-        CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_DISABLE);
-        name_funcs = OPENSSL_zalloc(sizeof(*name_funcs));
-        CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_ENABLE);
-        if (name_funcs == NULL) {
-            OBJerr(OBJ_F_OBJ_NAME_NEW_INDEX, ERR_R_MALLOC_FAILURE);
-            ret = 0;
-            goto out;
-        }
-        name_funcs->hash_func = OPENSSL_LH_strhash;
-        name_funcs->cmp_func = obj_strcmp;
-        CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_DISABLE);
-
-        push = sk_NAME_FUNCS_push(name_funcs_stack, name_funcs);
-        CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_ENABLE);
-
-        if (!push) {
-            OBJerr(OBJ_F_OBJ_NAME_NEW_INDEX, ERR_R_MALLOC_FAILURE);
-            OPENSSL_free(name_funcs);
-            ret = 0;
-            goto out;
-        }
+    if (!insert) {
+        OBJerr(OBJ_F_OBJ_NAME_NEW_INDEX, ERR_R_MALLOC_FAILURE);
+        OPENSSL_free(name_funcs);
     }
-    name_funcs = sk_NAME_FUNCS_value(name_funcs_stack, ret);
-    if (hash_func != NULL)
-        name_funcs->hash_func = hash_func;
-    if (cmp_func != NULL)
-        name_funcs->cmp_func = cmp_func;
-    if (free_func != NULL)
-        name_funcs->free_func = free_func;
-
-out:
-    CRYPTO_THREAD_unlock(obj_lock);
     return ret;
 }
 
-static int obj_name_cmp(const OBJ_NAME *a, const OBJ_NAME *b)
+/* The functions of custom type |type| */
+static NAME_FUNCS *name_funcs(int type)
+{
+    if (type < OBJ_NAME_TYPE_NUM)
+        return NULL;
+    return obj_ht_get(name_funcs_ht, (unsigned long)type, name_funcs_cmp,
+                      &type);
+}
+
+static int obj_name_cmp(const void *item, const void *key)
 {
+    const OBJ_NAME *a = item, *b = key;
+    NAME_FUNCS *nf;
     int ret;
 
     ret = a->type - b->type;
     if (ret == 0) {
-        if ((name_funcs_stack != NULL)
-            && (sk_NAME_FUNCS_num(name_funcs_stack) > a->type)) {
-            ret = sk_NAME_FUNCS_value(name_funcs_stack,
-                                      a->type)->cmp_func(a->name, b->name);
+        if ((nf = name_funcs(a->type)) != NULL) {
+            ret = nf->cmp_func(a->name, b->name);
         } else
             ret = strcmp(a->name, b->name);
     }
@@ -156,13 +147,11 @@ static int obj_name_cmp(const OBJ_NAME *a, const OBJ_NAME *b)
 
 static unsigned long obj_name_hash(const OBJ_NAME *a)
 {
+    NAME_FUNCS *nf;
     unsigned long ret;
 
-    if ((name_funcs_stack != NULL)
-        && (sk_NAME_FUNCS_num(name_funcs_stack) > a->type)) {
-        ret =
-            sk_NAME_FUNCS_value(name_funcs_stack,
-                                a->type)->hash_func(a->name);
+    if ((nf = name_funcs(a->type)) != NULL) {
+        ret = nf->hash_func(a->name);
     } else {
         ret = OPENSSL_LH_strhash(a->name);
     }
@@ -180,7 +169,6 @@ const char *OBJ_NAME_get(const char *name, int type)
         return NULL;
     if (!OBJ_NAME_init())
         return NULL;
-    CRYPTO_THREAD_read_lock(obj_lock);
 
     alias = type & OBJ_NAME_ALIAS;
     type &= ~OBJ_NAME_ALIAS;
@@ -189,7 +177,7 @@ const char *OBJ_NAME_get(const char *name, int type)
     on.type = type;
 
     for (;;) {
-        ret = lh_OBJ_NAME_retrieve(names_lh, &on);
+        ret = obj_ht_get(names, obj_name_hash(&on), obj_name_cmp, &on);
         if (ret == NULL)
             break;
         if ((ret->alias) && !alias) {
@@ -201,11 +189,23 @@ const char *OBJ_NAME_get(const char *name, int type)
             break;
         }
     }
-
-    CRYPTO_THREAD_unlock(obj_lock);
     return value;
 }
 
+/* Free |onp|, which |names| no longer holds */
+static void obj_name_free(OBJ_NAME *onp)
+{
+    NAME_FUNCS *nf = name_funcs(onp->type);
+
+    /*
+     * XXX: I'm not sure I understand why the free function should
+     * get three arguments... -- Richard Levitte
+     */
+    if (nf != NULL && nf->free_func != NULL)
+        nf->free_func(onp->name, onp->type, onp->data);
+    OPENSSL_free(onp);
+}
+
 int OBJ_NAME_add(const char *name, int type, const char *data)
 {
     OBJ_NAME *onp, *ret;
@@ -230,27 +230,14 @@ int OBJ_NAME_add(const char *name, int type, const char *data)
     onp->type = type;
     onp->data = data;
 
-    ret = lh_OBJ_NAME_insert(names_lh, onp);
-    if (ret != NULL) {
-        /* free things */
-        if ((name_funcs_stack != NULL)
-            && (sk_NAME_FUNCS_num(name_funcs_stack) > ret->type)) {
-            /*
-             * XXX: I'm not sure I understand why the free function should
-             * get three arguments... -- Richard Levitte
-             */
-            sk_NAME_FUNCS_value(name_funcs_stack,
-                                ret->type)->free_func(ret->name, ret->type,
-                                                      ret->data);
-        }
-        OPENSSL_free(ret);
-    } else {
-        if (lh_OBJ_NAME_error(names_lh)) {
-            /* ERROR */
-            OPENSSL_free(onp);
-            goto unlock;
-        }
+    if (!obj_ht_insert(names, obj_name_hash(onp), onp, obj_name_cmp,
+                       (void **)&ret)) {
+        /* ERROR */
+        OPENSSL_free(onp);
+        goto unlock;
     }
+    if (ret != NULL)
+        obj_name_free(ret);
 
     ok = 1;
 
@@ -272,20 +259,9 @@ int OBJ_NAME_remove(const char *name, int type)
     type &= ~OBJ_NAME_ALIAS;
     on.name = name;
     on.type = type;
-    ret = lh_OBJ_NAME_delete(names_lh, &on);
+    ret = obj_ht_delete(names, obj_name_hash(&on), obj_name_cmp, &on);
     if (ret != NULL) {
-        /* free things */
-        if ((name_funcs_stack != NULL)
-            && (sk_NAME_FUNCS_num(name_funcs_stack) > ret->type)) {
-            /*
-             * XXX: I'm not sure I understand why the free function should
-             * get three arguments... -- Richard Levitte
-             */
-            sk_NAME_FUNCS_value(name_funcs_stack,
-                                ret->type)->free_func(ret->name, ret->type,
-                                                      ret->data);
-        }
-        OPENSSL_free(ret);
+        obj_name_free(ret);
         ok = 1;
     }
 
@@ -299,14 +275,15 @@ typedef struct {
     void *arg;
 } OBJ_DOALL;
 
-static void do_all_fn(const OBJ_NAME *name, OBJ_DOALL *d)
+static void do_all_fn(void *item, void *arg)
 {
+    const OBJ_NAME *name = item;
+    OBJ_DOALL *d = arg;
+
     if (name->type == d->type)
         d->fn(name, d->arg);
 }
 
-IMPLEMENT_LHASH_DOALL_ARG_CONST(OBJ_NAME, OBJ_DOALL);
-
 void OBJ_NAME_do_all(int type, void (*fn) (const OBJ_NAME *, void *arg),
                      void *arg)
 {
@@ -316,7 +293,7 @@ void OBJ_NAME_do_all(int type, void (*fn) (const OBJ_NAME *, void *arg),
     d.fn = fn;
     d.arg = arg;
 
-    lh_OBJ_NAME_doall_OBJ_DOALL(names_lh, do_all_fn, &d);
+    obj_ht_doall(names, do_all_fn, &d);
 }
 
 struct doall_sorted {
@@ -352,7 +329,7 @@ void OBJ_NAME_do_all_sorted(int type,
 
     d.type = type;
     d.names =
-        OPENSSL_malloc(sizeof(*d.names) * lh_OBJ_NAME_num_items(names_lh));
+        OPENSSL_malloc(sizeof(*d.names) * obj_ht_num(names));
     /* Really should return an error if !d.names...but its a void function! */
     if (d.names != NULL) {
         d.n = 0;
@@ -369,39 +346,32 @@ void OBJ_NAME_do_all_sorted(int type,
 
 static int free_type;
 
-static void names_lh_free_doall(OBJ_NAME *onp)
+static void names_free_doall(void *item, void *arg)
 {
-    if (onp == NULL)
-        return;
+    OBJ_NAME *onp = item;
 
     if (free_type < 0 || free_type == onp->type)
         OBJ_NAME_remove(onp->name, onp->type);
 }
 
-static void name_funcs_free(NAME_FUNCS *ptr)
+static void name_funcs_free(void *ptr)
 {
     OPENSSL_free(ptr);
 }
 
 void OBJ_NAME_cleanup(int type)
 {
-    unsigned long down_load;
-
-    if (names_lh == NULL)
+    if (names == NULL)
         return;
 
     free_type = type;
-    down_load = lh_OBJ_NAME_get_down_load(names_lh);
-    lh_OBJ_NAME_set_down_load(names_lh, 0);
-
-    lh_OBJ_NAME_doall(names_lh, names_lh_free_doall);
+    obj_ht_doall(names, names_free_doall, NULL);
     if (type < 0) {
-        lh_OBJ_NAME_free(names_lh);
-        sk_NAME_FUNCS_pop_free(name_funcs_stack, name_funcs_free);
+        obj_ht_free(names, NULL);
+        obj_ht_free(name_funcs_ht, name_funcs_free);
         CRYPTO_THREAD_lock_free(obj_lock);
-        names_lh = NULL;
-        name_funcs_stack = NULL;
+        names = NULL;
+        name_funcs_ht = NULL;
         obj_lock = NULL;
-    } else
-        lh_OBJ_NAME_set_down_load(names_lh, down_load);
+    }
 }
@@ -16,14 +16,35 @@
 #include "internal/objects.h"
 #include <openssl/bn.h>
 #include "internal/asn1_int.h"
+#include "internal/nelem.h"
+#include "internal/thread_once.h"
 #include "obj_lcl.h"
 
 /* obj_dat.h is generated from objects.h by obj_dat.pl */
 #include "obj_dat.h"
 
+#ifdef CHARSET_EBCDIC
 DECLARE_OBJ_BSEARCH_CMP_FN(const ASN1_OBJECT *, unsigned int, sn);
 DECLARE_OBJ_BSEARCH_CMP_FN(const ASN1_OBJECT *, unsigned int, ln);
 DECLARE_OBJ_BSEARCH_CMP_FN(const ASN1_OBJECT *, unsigned int, obj);
+#else
+/* FNV-1a, the hash obj_dat.pl built the tables in obj_dat.h with */
+static unsigned long obj_hash(unsigned long h, const unsigned char *p,
+                              size_t len)
+{
+    for (; len > 0; len--) {
+        h ^= *p++;
+        h = (h * 0x01000193) & 0xffffffff;
+    }
+    return h;
+}
+
+/* The NID of hash |h| in table |t|, to be checked against the key */
+# define HASH_NID(t, h) \
+    t##_hash_slot[(((h) >> 16) \
+                   ^ t##_hash_disp[(h) & (OSSL_NELEM(t##_hash_disp) - 1)]) \
+                  & (OSSL_NELEM(t##_hash_slot) - 1)]
+#endif
 
 #define ADDED_DATA      0
 #define ADDED_SNAME     1
@@ -36,8 +57,10 @@ struct added_obj_st {
 };
 
 static int new_nid = NUM_NID;
-static LHASH_OF(ADDED_OBJ) *added = NULL;
+static CRYPTO_ONCE added_init = CRYPTO_ONCE_STATIC_INIT;
+static OBJ_HT *added = NULL;
 
+#ifdef CHARSET_EBCDIC
 static int sn_cmp(const ASN1_OBJECT *const *a, const unsigned int *b)
 {
     return strcmp((*a)->sn, nid_objs[*b].sn);
@@ -51,6 +74,7 @@ static int ln_cmp(const ASN1_OBJECT *const *a, const unsigned int *b)
 }
 
 IMPLEMENT_OBJ_BSEARCH_CMP_FN(const ASN1_OBJECT *, unsigned int, ln);
+#endif
 
 static unsigned long added_obj_hash(const ADDED_OBJ *ca)
 {
@@ -85,8 +109,9 @@ static unsigned long added_obj_hash(const ADDED_OBJ *ca)
     return ret;
 }
 
-static int added_obj_cmp(const ADDED_OBJ *ca, const ADDED_OBJ *cb)
+static int added_obj_cmp(const void *item, const void *key)
 {
+    const ADDED_OBJ *ca = item, *cb = key;
     ASN1_OBJECT *a, *b;
     int i;
 
@@ -123,28 +148,44 @@ static int added_obj_cmp(const ADDED_OBJ *ca, const ADDED_OBJ *cb)
     }
 }
 
-static int init_added(void)
+DEFINE_RUN_ONCE_STATIC(do_added_init)
 {
-    if (added != NULL)
-        return 1;
-    added = lh_ADDED_OBJ_new(added_obj_hash, added_obj_cmp);
-    return added != NULL;
+    OBJ_HT *ht = obj_ht_new();
+
+    obj_store(added, ht);
+    return ht != NULL;
+}
+
+/* Look up an added object without a lock */
+static ADDED_OBJ *added_get(const ADDED_OBJ *ad)
+{
+    OBJ_HT *ht = obj_load(added);
+
+    if (ht == NULL)
+        return NULL;
+    return obj_ht_get(ht, added_obj_hash(ad), added_obj_cmp, ad);
 }
 
-static void cleanup1_doall(ADDED_OBJ *a)
+static void cleanup1_doall(void *item, void *arg)
 {
+    ADDED_OBJ *a = item;
+
     a->obj->nid = 0;
     a->obj->flags |= ASN1_OBJECT_FLAG_DYNAMIC |
         ASN1_OBJECT_FLAG_DYNAMIC_STRINGS | ASN1_OBJECT_FLAG_DYNAMIC_DATA;
 }
 
-static void cleanup2_doall(ADDED_OBJ *a)
+static void cleanup2_doall(void *item, void *arg)
 {
+    ADDED_OBJ *a = item;
+
     a->obj->nid++;
 }
 
-static void cleanup3_doall(ADDED_OBJ *a)
+static void cleanup3_doall(void *item, void *arg)
 {
+    ADDED_OBJ *a = item;
+
     if (--a->obj->nid == 0)
         ASN1_OBJECT_free(a->obj);
     OPENSSL_free(a);
@@ -154,11 +195,10 @@ void obj_cleanup_int(void)
 {
     if (added == NULL)
         return;
-    lh_ADDED_OBJ_set_down_load(added, 0);
-    lh_ADDED_OBJ_doall(added, cleanup1_doall); /* zero counters */
-    lh_ADDED_OBJ_doall(added, cleanup2_doall); /* set counters */
-    lh_ADDED_OBJ_doall(added, cleanup3_doall); /* free objects */
-    lh_ADDED_OBJ_free(added);
+    obj_ht_doall(added, cleanup1_doall, NULL); /* zero counters */
+    obj_ht_doall(added, cleanup2_doall, NULL); /* set counters */
+    obj_ht_doall(added, cleanup3_doall, NULL); /* free objects */
+    obj_ht_free(added, NULL);
     added = NULL;
 }
 
@@ -177,9 +217,8 @@ int OBJ_add_object(const ASN1_OBJECT *obj)
     ADDED_OBJ *ao[4] = { NULL, NULL, NULL, NULL }, *aop;
     int i;
 
-    if (added == NULL)
-        if (!init_added())
-            return 0;
+    if (!RUN_ONCE(&added_init, do_added_init) || added == NULL)
+        return 0;
     if ((o = OBJ_dup(obj)) == NULL)
         goto err;
     if ((ao[ADDED_NID] = OPENSSL_malloc(sizeof(*ao[0]))) == NULL)
@@ -194,18 +233,22 @@ int OBJ_add_object(const ASN1_OBJECT *obj)
         if ((ao[ADDED_LNAME] = OPENSSL_malloc(sizeof(*ao[0]))) == NULL)
             goto err2;
 
+    /* Readers may see |o| as soon as it is inserted */
+    o->flags &=
+        ~(ASN1_OBJECT_FLAG_DYNAMIC | ASN1_OBJECT_FLAG_DYNAMIC_STRINGS |
+          ASN1_OBJECT_FLAG_DYNAMIC_DATA);
     for (i = ADDED_DATA; i <= ADDED_NID; i++) {
         if (ao[i] != NULL) {
             ao[i]->type = i;
             ao[i]->obj = o;
-            aop = lh_ADDED_OBJ_insert(added, ao[i]);
             /* memory leak, but should not normally matter */
-            OPENSSL_free(aop);
+            if (!obj_ht_insert(added, added_obj_hash(ao[i]), ao[i],
+                               added_obj_cmp, (void **)&aop))
+                OPENSSL_free(ao[i]);
+            else
+                OPENSSL_free(aop);
         }
     }
-    o->flags &=
-        ~(ASN1_OBJECT_FLAG_DYNAMIC | ASN1_OBJECT_FLAG_DYNAMIC_STRINGS |
-          ASN1_OBJECT_FLAG_DYNAMIC_DATA);
 
     return o->nid;
  err2:
@@ -228,13 +271,13 @@ ASN1_OBJECT *OBJ_nid2obj(int n)
             return NULL;
         }
         return (ASN1_OBJECT *)&(nid_objs[n]);
-    } else if (added == NULL)
+    } else if (obj_load(added) == NULL)
         return NULL;
     else {
         ad.type = ADDED_NID;
         ad.obj = &ob;
         ob.nid = n;
-        adp = lh_ADDED_OBJ_retrieve(added, &ad);
+        adp = added_get(&ad);
         if (adp != NULL)
             return adp->obj;
         else {
@@ -255,13 +298,13 @@ const char *OBJ_nid2sn(int n)
             return NULL;
         }
         return nid_objs[n].sn;
-    } else if (added == NULL)
+    } else if (obj_load(added) == NULL)
         return NULL;
     else {
         ad.type = ADDED_NID;
         ad.obj = &ob;
         ob.nid = n;
-        adp = lh_ADDED_OBJ_retrieve(added, &ad);
+        adp = added_get(&ad);
         if (adp != NULL)
             return adp->obj->sn;
         else {
@@ -282,13 +325,13 @@ const char *OBJ_nid2ln(int n)
             return NULL;
         }
         return nid_objs[n].ln;
-    } else if (added == NULL)
+    } else if (obj_load(added) == NULL)
         return NULL;
     else {
         ad.type = ADDED_NID;
         ad.obj = &ob;
         ob.nid = n;
-        adp = lh_ADDED_OBJ_retrieve(added, &ad);
+        adp = added_get(&ad);
         if (adp != NULL)
             return adp->obj->ln;
         else {
@@ -298,6 +341,7 @@ const char *OBJ_nid2ln(int n)
     }
 }
 
+#ifdef CHARSET_EBCDIC
 static int obj_cmp(const ASN1_OBJECT *const *ap, const unsigned int *bp)
 {
     int j;
@@ -313,10 +357,16 @@ static int obj_cmp(const ASN1_OBJECT *const *ap, const unsigned int *bp)
 }
 
 IMPLEMENT_OBJ_BSEARCH_CMP_FN(const ASN1_OBJECT *, unsigned int, obj);
+#endif
 
 int OBJ_obj2nid(const ASN1_OBJECT *a)
 {
+#ifdef CHARSET_EBCDIC
     const unsigned int *op;
+#else
+    unsigned long h;
+    const ASN1_OBJECT *b;
+#endif
     ADDED_OBJ ad, *adp;
 
     if (a == NULL)
@@ -327,17 +377,23 @@ int OBJ_obj2nid(const ASN1_OBJECT *a)
     if (a->length == 0)
         return NID_undef;
 
-    if (added != NULL) {
-        ad.type = ADDED_DATA;
-        ad.obj = (ASN1_OBJECT *)a; /* XXX: ugly but harmless */
-        adp = lh_ADDED_OBJ_retrieve(added, &ad);
-        if (adp != NULL)
-            return adp->obj->nid;
-    }
+    ad.type = ADDED_DATA;
+    ad.obj = (ASN1_OBJECT *)a; /* XXX: ugly but harmless */
+    adp = added_get(&ad);
+    if (adp != NULL)
+        return adp->obj->nid;
+#ifdef CHARSET_EBCDIC
     op = OBJ_bsearch_obj(&a, obj_objs, NUM_OBJ);
     if (op == NULL)
         return NID_undef;
     return nid_objs[*op].nid;
+#else
+    h = obj_hash(OBJ_HASH_SEED, a->data, a->length);
+    b = &nid_objs[HASH_NID(obj, h)];
+    if (a->length != b->length || memcmp(a->data, b->data, a->length) != 0)
+        return NID_undef;
+    return b->nid;
+#endif
 }
 
 /*
@@ -540,43 +596,65 @@ int OBJ_txt2nid(const char *s)
 int OBJ_ln2nid(const char *s)
 {
     ASN1_OBJECT o;
+#ifdef CHARSET_EBCDIC
     const ASN1_OBJECT *oo = &o;
-    ADDED_OBJ ad, *adp;
     const unsigned int *op;
+#else
+    unsigned long h;
+    int nid;
+#endif
+    ADDED_OBJ ad, *adp;
 
     o.ln = s;
-    if (added != NULL) {
-        ad.type = ADDED_LNAME;
-        ad.obj = &o;
-        adp = lh_ADDED_OBJ_retrieve(added, &ad);
-        if (adp != NULL)
-            return adp->obj->nid;
-    }
+    ad.type = ADDED_LNAME;
+    ad.obj = &o;
+    adp = added_get(&ad);
+    if (adp != NULL)
+        return adp->obj->nid;
+#ifdef CHARSET_EBCDIC
     op = OBJ_bsearch_ln(&oo, ln_objs, NUM_LN);
     if (op == NULL)
         return NID_undef;
     return nid_objs[*op].nid;
+#else
+    h = obj_hash(LN_HASH_SEED, (const unsigned char *)s, strlen(s));
+    nid = HASH_NID(ln, h);
+    if (strcmp(s, nid_objs[nid].ln) != 0)
+        return NID_undef;
+    return nid_objs[nid].nid;
+#endif
 }
 
 int OBJ_sn2nid(const char *s)
 {
     ASN1_OBJECT o;
+#ifdef CHARSET_EBCDIC
     const ASN1_OBJECT *oo = &o;
-    ADDED_OBJ ad, *adp;
     const unsigned int *op;
+#else
+    unsigned long h;
+    int nid;
+#endif
+    ADDED_OBJ ad, *adp;
 
     o.sn = s;
-    if (added != NULL) {
-        ad.type = ADDED_SNAME;
-        ad.obj = &o;
-        adp = lh_ADDED_OBJ_retrieve(added, &ad);
-        if (adp != NULL)
-            return adp->obj->nid;
-    }
+    ad.type = ADDED_SNAME;
+    ad.obj = &o;
+    adp = added_get(&ad);
+    if (adp != NULL)
+        return adp->obj->nid;
+#ifdef CHARSET_EBCDIC
     op = OBJ_bsearch_sn(&oo, sn_objs, NUM_SN);
     if (op == NULL)
         return NID_undef;
     return nid_objs[*op].nid;
+#else
+    h = obj_hash(SN_HASH_SEED, (const unsigned char *)s, strlen(s));
+    nid = HASH_NID(sn, h);
+    if (strcmp(s, nid_objs[nid].sn) != 0)
+        return NID_undef;
+    return nid_objs[nid].nid;
+#endif
 }
 
 const void *OBJ_bsearch_(const void *key, const void *base, int num, int size,
@@ -1076,7 +1076,7 @@ static const unsigned char so[7746] = {
     0x2A,0x85,0x03,0x07,0x01,0x02,0x01,0x01,0x04,  /* [ 7736] OBJ_id_tc26_gost_3410_2012_256_paramSetD */
 };
 
-#define NUM_NID 1193
+#define NUM_NID 1195
 static const ASN1_OBJECT nid_objs[NUM_NID] = {
     {"UNDEF", "undefined", NID_undef},
     {"rsadsi", "RSA Data Security, Inc.", NID_rsadsi, 6, &so[0]},
@@ -2271,9 +2271,12 @@ static const ASN1_OBJECT nid_objs[NUM_NID] = {
     {"magma-cbc", "magma-cbc", NID_magma_cbc},
     {"magma-cfb", "magma-cfb", NID_magma_cfb},
     {"magma-mac", "magma-mac", NID_magma_mac},
+    {"BLAKE2bp512", "blake2bp512", NID_blake2bp512},
+    {"BLAKE2sp256", "blake2sp256", NID_blake2sp256},
 };
 
-#define NUM_SN 1184
+#ifdef CHARSET_EBCDIC
+#define NUM_SN 1186
 static const unsigned int sn_objs[NUM_SN] = {
      364,    /* "AD_DVCS" */
      419,    /* "AES-128-CBC" */
@@ -2349,7 +2352,9 @@ static const unsigned int sn_objs[NUM_SN] = {
       92,    /* "BF-ECB" */
       94,    /* "BF-OFB" */
     1056,    /* "BLAKE2b512" */
+    1193,    /* "BLAKE2bp512" */
     1057,    /* "BLAKE2s256" */
+    1194,    /* "BLAKE2sp256" */
       14,    /* "C" */
      751,    /* "CAMELLIA-128-CBC" */
      962,    /* "CAMELLIA-128-CCM" */
@@ -3461,7 +3466,7 @@ static const unsigned int sn_objs[NUM_SN] = {
     1093,    /* "x509ExtAdmission" */
 };
 
-#define NUM_LN 1184
+#define NUM_LN 1186
 static const unsigned int ln_objs[NUM_LN] = {
      363,    /* "AD Time Stamping" */
      405,    /* "ANSI X9.62" */
@@ -3760,7 +3765,9 @@ static const unsigned int ln_objs[NUM_LN] = {
       92,    /* "bf-ecb" */
       94,    /* "bf-ofb" */
     1056,    /* "blake2b512" */
+    1193,    /* "blake2bp512" */
     1057,    /* "blake2s256" */
+    1194,    /* "blake2sp256" */
      921,    /* "brainpoolP160r1" */
      922,    /* "brainpoolP160t1" */
      923,    /* "brainpoolP192r1" */
@@ -5721,3 +5728,989 @@ static const unsigned int obj_objs[NUM_OBJ] = {
     1168,    /* OBJ_uacurve8                     1 2 804 2 1 1 1 1 3 1 1 2 8 */
     1169,    /* OBJ_uacurve9                     1 2 804 2 1 1 1 1 3 1 1 2 9 */
 };
+
+#else
+#define SN_HASH_SEED 0x811C9DC5
+#define SN_HASH_BUCKETS 512
+#define SN_HASH_SLOTS 2048
+static const unsigned short sn_hash_disp[SN_HASH_BUCKETS] = {
+       0,    0,    1,    5,    0,    0,    1,    0,
+       1,   11,    0,    0,    1,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    2,
+       0,    6,    0,    0,    0,    0,    5,    0,
+       0,    0,    0,    1,    0,    3,    2,    2,
+       2,    4,    3,    0,    0,    3,    0,    2,
+       0,    0,    0,    1,    0,    0,    4,    0,
+       1,    2,    2,    3,    0,    0,    0,    2,
+       2,    3,    4,    3,    1,    7,    0,    0,
+       1,    0,    0,    0,    1,    0,    1,    3,
+       3,    0,    2,    3,    0,    1,    3,    0,
+       1,    3,    2,    0,    3,    1,    0,    0,
+       2,    0,    0,    1,    0,    0,    0,    1,
+      12,    0,    1,    0,    0,    0,    0,    0,
+       8,    0,    2,    0,    1,    0,    1,    2,
+       0,    0,    3,    4,    0,    2,    0,    1,
+       0,    0,    0,    8,    0,    2,    1,    0,
+       0,    9,    2,    3,    0,    0,    0,    2,
+       0,    5,    2,    0,    0,    0,    1,    1,
+       0,    0,    1,    0,    1,    0,    1,    1,
+       0,    0,    0,    3,    3,    0,    0,    0,
+       0,    1,    4,    0,    1,    3,    1,    0,
+       0,    5,    2,    1,    0,    2,    2,    0,
+       4,    0,    1,    4,    7,    4,    0,    3,
+       3,    3,    0,    0,    1,    0,    0,    2,
+       0,    0,    1,    0,    1,    1,    2,    0,
+       1,    4,    0,    0,    0,    0,    1,    6,
+       0,    0,    4,    0,    0,    0,    3,    1,
+       5,    3,    0,    0,    1,    0,    3,    0,
+       0,    0,    0,    0,    3,    0,    1,    2,
+       1,    6,    2,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    1,    1,    0,    0,
+       0,    7,    6,    0,    0,    0,    1,    2,
+       1,    0,   10,    0,    7,    1,    5,    7,
+       2,    0,    3,    0,    0,    1,    2,    0,
+       0,    1,    4,    0,    2,    0,    0,    1,
+       0,    0,    8,    1,    4,    2,    2,    2,
+       2,    1,    4,    5,    2,    0,    1,    1,
+       2,    0,    0,    1,    0,    0,    0,    1,
+       7,    0,    2,    0,    0,    1,    4,    6,
+       7,    0,    0,    0,    0,    1,    6,    3,
+       3,    4,    1,    0,    0,    6,    4,    4,
+      23,    1,    1,    3,    5,    1,    5,    2,
+       3,    2,    0,    0,    2,    0,    1,    1,
+       1,    1,    1,    2,    1,    0,    1,    1,
+       0,   10,    7,    0,    0,    2,    0,    2,
+       4,    2,    0,    0,    0,    0,    0,    0,
+      16,    0,    1,    2,    1,    0,    2,    1,
+       2,    0,    3,    4,    0,    2,    2,    0,
+       0,    4,    0,    0,    0,    0,   14,    2,
+       0,    1,    0,    2,    0,    1,    0,    1,
+       3,   16,    8,    6,    0,    0,    0,    0,
+       0,    1,    0,   12,    0,   26,    4,    1,
+       0,    0,    1,    6,    3,    2,    2,    0,
+       0,    0,    0,    4,    6,    8,    0,    0,
+       7,    2,    0,    1,    2,    2,    9,    0,
+       2,    0,    6,    0,    2,    9,    0,    0,
+       0,    0,    0,    0,    2,    4,    2,    0,
+      10,    0,    0,    4,    9,    0,    1,    0,
+       1,    3,    8,    2,    9,    2,    0,    0,
+       6,    2,    2,    1,    0,    1,    2,    3,
+       0,    0,    2,    1,    1,    0,    1,    0,
+       4,    0,    0,    0,   13,    1,    0,    2,
+       0,    1,    4,    0,    3,    0,    3,    7,
+};
+static const unsigned short sn_hash_slot[SN_HASH_SLOTS] = {
+       0,  120,  302,  387,    0,  437,  558,  843,
+    1085,    0,  639,  314,  609,    0,   41,  110,
+       0,    0,  575,    0,    0, 1036,    0,   96,
+       0,    0,  200,  721,  733,  380,  743,    0,
+       0,    0,    0,    0,    0,  305,    0,    0,
+       0,    0,    0,  547,    0,  751,    0,    0,
+       0, 1123,  496,  780,  579,  879,  798,    0,
+     812,  914,  885,    0,    0,  741,  271,    0,
+    1007,    0,    0,  541,    0,    0,    0,    0,
+       0,    0,  279,  377,  571,    0,  615,    0,
+       1, 1105,  942,    0,    0,    0,    0,    0,
+       0, 1030,  762, 1151,  282,  261,  172,  402,
+     408,  262,   76,    3,  349,  106,  873,  207,
+     691, 1041,  884, 1109,  968,  996,  649,  669,
+       0,  501,  434,  378,    0, 1025,  363, 1049,
+      84,    0, 1149,    0,  210,    0,    0,    0,
+     415,    0, 1060,  849,    0,  259,  360,   24,
+       0,  986,    0,  136,    0,    0,  510,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,  481,    0,  969,    0, 1164,  230,
+     797,    0,  421, 1042,  786,    0, 1099,  109,
+     339,    0,    0,  814,  176,  869,  252,    0,
+       0,    0,    0,  574,    0,    0,    0,  537,
+     929, 1106,  672,  355,   64,  436, 1140,  128,
+     675, 1142,   63,  150,  904,  453, 1171, 1132,
+     260,    0,  989,   50,    0,    0,    0,    0,
+       0,   99,    0,  113,    0,    0,  293, 1073,
+     472,    0,   13,  755,    0,  870,  815,   23,
+     407,  492,    0,    0,  179,    0,    0,    0,
+       0,    0,    0,    0,   27,    0,    0,    0,
+    1065,  171, 1121,  317,  698,  253,  277,  169,
+       0,    0,    0,    0,    0,    0,    0,  231,
+     867,  228,  100, 1134,  923,    0,    0,    0,
+     795, 1082,  122,   15, 1078,  329,  359,   46,
+       0,    0,    0,    0,  126,    0,    2,  548,
+     201,  405, 1189, 1194,  744,    0,  631,  889,
+       0,    0,  445,  757,    0,  864,  893,  464,
+       0,  160,  523,  369,  247,  386,  560,  311,
+     286,  254,  129,   80,  484,    0,    0,  125,
+       0,  933,    0,    0,    0,  740,    0,    0,
+     850, 1128,  925,  522,   55,  963,  578,    0,
+     480,    0,    0,  651,  278,  446,  956,   73,
+     921,    0,  961,  965,    0,    0,  245,  967,
+       0,  347,    0,    0,  817,  765,    0,  719,
+       0,    0,    0,    0,    0,  192,    0,    0,
+       0,  151,  692,    0,    0,    0,  246,  393,
+       0, 1026,    0,    0,    0,    0,  883,   59,
+       0,    0,    0,    0,    0,    0,  818,  312,
+     338,  272,  319,  495,  758,  920,  475,   66,
+     953,    0,  507,  497,   28,  732,  143,  656,
+       0,  382,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,  554, 1165,    0, 1009,
+       0,    0,  860,  132,  982,  559,  960, 1158,
+       0,    0,  146,  178,  419,    0,  773,    0,
+     944,    0, 1087,    0,  236,  658,  642,    0,
+     754,   95, 1173,  826,    0, 1110, 1092,  629,
+     683,    0,  353,  828,    0,   53,    0,  645,
+       0, 1083,    0,  397,    0,    0,    0,    0,
+       0, 1059,    0,    0,  328,    0, 1069,  681,
+     114, 1008,  469,  145,  365,  898,    0,    0,
+    1152,    0,    0,  214,    0,  296,    0,    0,
+       0,  490,    0,   82,  159,    0,    0,  556,
+       0,  822,    0,    0,  697,    0,  198,  707,
+       0,  149,   98, 1081,  994,   68,  700, 1067,
+    1113,  598,  323, 1037,    0,  857,  838,    0,
+      48, 1137, 1118,  538,   17, 1181,  508,    0,
+       0,    0,  564,   45,    0,  846,    0,  624,
+       0,  917,    0,    0,    0,    0,    0,  606,
+       0,    0, 1058,    0,  221,    0,    0,    0,
+     730,  583,  500,    0,    0,  488,  341,   87,
+     664,  670,    0,    0, 1139,  932,  591,  687,
+     688,  217, 1114,  134,    0,  739,    0,  244,
+     900,   88,  479,  577,    0, 1088,    0,    0,
+     637,    0,    0,    0,  648,  535,  585,  654,
+       0,    0,    0,  384,  156,  163,    0,  890,
+     782,    0,    0,   86,    0,  203,    0,  626,
+     257,  760,    0,  854,   40,    0,    0,    0,
+     712,  280,    0,    0,    0,    0, 1047,    7,
+     381, 1098,    0,  335,  243,    0,    0,  776,
+     945,    0,  297,  752,    0,    0,  325,    0,
+       0,  980,  194,  791,  491,    0,  662,  195,
+     357, 1035,    0,    0,    0,    0,    0,  657,
+       0,    0,  518,    0,    0,    0,    0,  748,
+       0,    0,  790,  993,    0, 1162,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,  954, 1029,  238,    0,    0,
+       0,    0,    0, 1040,  659,  573,  852,  352,
+       0,    0,  204, 1014,  276,  716,  613,    0,
+     119,  536, 1011,  429,  861,    0,    0,  542,
+       0, 1080, 1048,    0,  385,  212,  290,    0,
+       0,    0,  552,  103,    0,  209,    0,  594,
+       0,    0,    0,  972,    0,  452,    0,  477,
+     769, 1017,  718, 1103,  906,  875,  514,    0,
+     255,  726,  186,    0,   47,    0,  710,  988,
+     936,  831, 1102, 1071,  706,    0, 1012,  430,
+    1056,    0,    0, 1084,    0,    0,    0,    0,
+     273,    0,   16,  724,  473,  283, 1053,   94,
+       0,    0,  990,  351, 1066,    0,    0,    0,
+       0,    0,    0,  808, 1144,  467,  604, 1034,
+       0,  420,  764,  877,    0,    0,    0,  779,
+       0,    0,    0,    0,  506,  166,  978,    0,
+       0,  348,    0,    0,    0,    0,  612,    0,
+     676,    0,    0,    0,    0,    0,  997,    0,
+       0,  635,  823,  601,  258, 1127,    0,  738,
+       0,  534,  222,  543,    0,    0,  647,    0,
+    1003,    0,    0,    0,    0,  821,    0,    0,
+     679,    0,    0,  855,    0,  858,  205,  239,
+     474,    0,  586, 1153,   36,  576,  520,  304,
+     763,    4,  494, 1191,    0,    0,  331,    0,
+    1145,    0,  785,  289,    8,  101,    0,  308,
+     551,  388,  680, 1002,    0,    0,  634,    0,
+       0,   31, 1031,    0,  373,  939,    0,    0,
+       0,    0,    0,  135, 1044,    0,    0,    0,
+    1052,  336,    0,  306,    0,  825,   91, 1188,
+       0,    0,    0,  984,    0,  916, 1150,  788,
+    1021,    0,  263,    0, 1163,  974,    0,    0,
+     354,    0,    0, 1136,  603,  611,  344,    0,
+     545,  694,  368,  138,    0,  794,    0,    0,
+      62,    0,    0,  983,    0,  170,    0,    0,
+     644,  275,  793,  320,    0,  188, 1074, 1157,
+     783,    0,    0,    0,    0,    0,  970,    0,
+      21,    0,    0,  104,    0,  427,  161,    0,
+       0,   77, 1170,    0,  322,    0,    0,    0,
+       0,    0,    0,    0,    0,  185,    0,    0,
+       0,  909,    0,    0,   18,    0,   11,  633,
+       0,    0, 1072,    0,    0,  298,  709,    0,
+       0,  704, 1079,    0,    0,    0,  274,    0,
+       0,    0,    0,  800, 1186,  617,    0,  685,
+       0,  750,    0, 1064,  927,    0,    0,  295,
+     416, 1130,  332,    0,    0,  641,    0,    0,
+     827,    0,  595,  832,    0,  777,    0,    0,
+     569,    0,  761,  699,  123,  610, 1077,    0,
+     456,    0,  592,  816,  802,    0,  803,    0,
+       0,    0,    0,    0,  859,    0, 1155,    0,
+       0,  493,  734,  440,    0,  943,  426,    0,
+    1043,  401,  690,   72,  663,    0,    0,  737,
+     895,  643,  376,    0,    0,    0,    0,  799,
+       0,  880,    0,    0,    0,    0,    0,    0,
+     117,  722,  395,  444,    0,    0,    0,  563,
+     908,   58,  196,  703,  310,    0,    0,  720,
+    1068, 1108,  435,  768,  834,  107,  901,  529,
+    1174,  423,  396, 1019,  288, 1190,  307,  251,
+     406,  622,  674,  653,  470,    6,  608,  807,
+    1094,  313,  966,  242, 1095,  623, 1070,  394,
+     152,  847,  270,  602,   30,  345, 1177,  374,
+      93,  157,  410,  399,    0,    0,    0,    0,
+    1116,  460,    0,    0,  770,  327, 1117,    0,
+     454, 1180,    0,  431, 1168, 1160,    0,  459,
+       0,    0, 1131,    0,    0, 1138,    0,    0,
+     820,  137,    0,  695,  842,    0,    0,    0,
+     330,    0,    0,  636,    0,  666,  153,   19,
+       0,  225,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,  455, 1135,  102,  449,
+       0,    0, 1062,    0,  930,  372, 1125,    0,
+       0,  463,    0,    0,    0,    0,  294,    0,
+     116,  840,    0,  728,  358,    0,    0,    0,
+       0,    0,  512,    0,  881, 1097,  105,   12,
+     219,    0,   20,  531,    0,    0,  625,    0,
+       0,  498,    0,  705,  291,  924,   49,   44,
+     111,  946, 1096,  781, 1185,  326,   26,  686,
+       0,    0,    0,    0,    0,  439,    0,    0,
+       0,    0,  941,    0,  987,  958, 1120,  412,
+      71,  503,  234,  285, 1027,  682,   92,  979,
+       0,  810,  206,  891,    0,   42,   79, 1015,
+       0,    0,  593,    0,  482,  462,    0,    0,
+     715, 1076,  766,  903, 1057,    0,  584,    0,
+     655,  544,  926,    0,  213,  565,    0,  938,
+     977,  689,  269,  173,  934,  736,   90, 1086,
+     570,    0,  324,  364,    0,    0,  504,  731,
+       0,    0,  619,    0,    0,  233,    0,    0,
+     184,  232,  835,  527,  299,  265,  723,  922,
+     318,    0,  226,  771,    0,  550,  502,    0,
+       0,    0,  425,  582,    0,  878,    0,  876,
+     443,    0,  533,  975,    0, 1179, 1133,  218,
+       0,    0,    0,  227,  112,    0,    0,  650,
+       0,   39,  919,  540,    0,  361,    0,  767,
+     845,  411,  208,  483,  333,  284,  661,    0,
+     951,  371,  829,  175,  478,  905, 1000,  165,
+       0, 1075, 1104,    0, 1093,  910,    0,  183,
+       0,  287,    0, 1169,  667,    0, 1161,  871,
+       0,    0,    0,    0,    0,    0,  471,  131,
+       0,  627,   81,    0,  784,  696,  747,    0,
+     589,   54,    0, 1038,    0,    0, 1032,    0,
+       0,    0,    0,    0,  340,  468,    0, 1159,
+      74,    0,  216, 1005,  959,    0,  549,    0,
+     753,  343,  391,    0, 1183,  256,  303, 1024,
+     530,    0,    0,  590, 1001,  677,    0,    0,
+       0,    0, 1061,    0,  806,  778, 1193,    0,
+       0,    0,  678,    0, 1023,    0,  346,  403,
+       0,  819,  671,  356,   83,  918,  865,  383,
+       0,  525, 1013,  422, 1112,  985,  668,  193,
+       0,    0,    0,    0,  949,  600,  190, 1184,
+       0,    0,    0,  725,  973,    0,   61,  375,
+       0,    0,    0,   14,    0,  432,  413,  665,
+      65,    0,    0,    0,  729,  673, 1143, 1016,
+     976,    0,  913, 1033,  561,  872,    0,  745,
+       0,  241,   10,    0,    0,   22,    0,  839,
+    1090,  139,  447,  962,    0,    0,  618,   89,
+       0,  652,    0,    0,    0, 1176,    0, 1091,
+     882,    0,  991, 1022,    0,    0,    0,  596,
+       0,  451,  266,  899,  931,    0,    0,    0,
+       0,  442,    0,    0,    0,    0,    0,  476,
+     952,    0,    0,  441,  713,  805,  801,  862,
+     894,  567,    0,  182,    0,  513,    0,    0,
+       0,  155,  995,  433,    0,  660,  981,    0,
+     162,    0,    0,    0,    0,    0,  809,    0,
+    1018,    0,  833,    0,    0,    0,  144,    0,
+       0,  998,    0,  588,    0,  158,    0,  597,
+       9,  337,  555,   37,  947, 1039,    0,    0,
+       0, 1107,  957,    0,  566,    0,    0,  237,
+       0,  197,    0,  309, 1124,  250,    0,    0,
+      70,    0,  240,   56, 1166,    0,    0,    0,
+       0,    0,    0,  887,    0,  911,    0, 1100,
+    1187,  868,    0,   78,    0, 1129,  874,  607,
+     539,    0,    0,    0, 1154,  211,  264,    0,
+       0,  268,  789,  316,  528,  450,    0,    0,
+     438,    0, 1004,   35,    0,  632,    0,    0,
+       0, 1020,    0,  505,    0,    0,  390,    0,
+     759,    0,    0,  950,    0,    0,    0,    0,
+       0,    0,  992,    0,    0,    0,    0,   32,
+    1051,  866,  897,  115,  572,  223,    0,    0,
+     526,   38,    0,  187,    0,   60,    0,    0,
+       0,    0,  417,  935,  971,    0, 1046,  140,
+     379,  321, 1156, 1182, 1148,  684,  191,  856,
+       0, 1063,    0,  749,  824,  487,  787,  229,
+     646, 1175,    0,    0, 1192,    0,  414,  701,
+      25,  892,  620,   67, 1172,  167,  267,    0,
+     108,    0,    0,  199,    0,  888,    0,    0,
+       0,    0,  727,    0,  168,    0, 1119,    0,
+       0,  614, 1122,  948,  811,  147,    0,    0,
+       0,  580,    0,    0,  389,  215,  813,  742,
+     301,  224,  465,    0,   33,  130,  367,  735,
+       0,    0,  177,  562,    0,    0,    0, 1101,
+       0,   69,  517,  148, 1028,  711,  557,  841,
+       0,  746,  300,    0,  640,  141,    0,    0,
+       0,  370,   51,  180,  133,  202,  174,  853,
+       0, 1146,    0,  281,  621,  342,  362,    0,
+       0,  796,    0,  896,    0,  848,    0,    0,
+     519,  249,    0,    0,    0, 1010,    0,  702,
+     248,    0,  999,  398,    0,    0,  863,    0,
+     844,  581,    0,  409,  485,  121,    0,   97,
+    1111,  955,  334,   52,  902,  220,  235,  886,
+     714,    0,    0,  392,    0,    0,    0, 1006,
+       0,    0,  127,  418, 1167, 1045, 1089,    0,
+     837,  458,  489,  851,    0,  964,  628,  587,
+       0,    0, 1147,    0,    0,    0,  428,  524,
+     708,  599,  553,  605,  461,    0,  630,    0,
+     830,    0,   34,  616,    0,    0,    0,  315,
+       0,  546,    0,   57,  568,  515,  189,  756,
+       0,  516,    0,    0,  457,    0,  792,  693,
+       0,    0,  509,  940,  424,    0, 1141,    0,
+       0,    0,    0,  804,  907,  164,    5, 1050,
+     486,  717,  912,  181,   43,  915,  836, 1115,
+       0,    0,   29,  638,    0,    0,  937, 1126,
+     499,  521,  366,   75,  154,   85,  928,  532,
+       0,  400,  292,    0,  466, 1178,  448,  142,
+};
+
+#define LN_HASH_SEED 0x811C9DC5
+#define LN_HASH_BUCKETS 512
+#define LN_HASH_SLOTS 2048
+static const unsigned short ln_hash_disp[LN_HASH_BUCKETS] = {
+       5,    0,    2,    0,    2,    0,    1,    0,
+       0,    0,    0,    1,    3,    4,    1,    9,
+       0,    2,    1,   10,    0,    0,    0,    2,
+       4,    6,    3,    3,    2,    1,    1,    2,
+       1,    0,    0,    0,    0,    0,    7,    0,
+       3,    0,    0,    0,    0,    0,    2,    2,
+       3,    0,    0,    0,    4,    0,    0,    0,
+       3,    1,    2,    2,    0,    1,    0,    1,
+       0,    1,    0,    4,    0,    4,    5,    2,
+       0,    0,    8,    7,    3,    0,    1,    0,
+       3,    0,    0,    2,    1,    5,    1,    0,
+       0,    2,   25,    1,    1,    5,    0,    0,
+       0,    3,    0,    8,    0,    0,    2,    1,
+       7,    0,    1,    3,    0,    0,    3,    1,
+       2,    0,    1,    0,    2,    0,    1,    0,
+       0,    1,    2,    3,    2,    0,    0,    0,
+       0,    3,    0,    0,    7,    0,    2,    0,
+       0,   11,    1,    1,    0,    0,    0,   10,
+       0,    4,    7,    2,    1,    1,    1,    1,
+       0,    0,    1,    1,    4,    0,    4,    1,
+       0,    6,    1,    0,    1,    0,    2,    1,
+      16,    0,    0,    0,    3,    0,    0,    0,
+       2,    0,    6,    0,    0,    0,    2,    5,
+       4,    2,    6,    0,    1,    7,    0,    5,
+       0,    0,    0,    0,    0,    2,   14,    2,
+       3,    0,    0,    0,    5,    0,    0,    3,
+       2,    0,    0,    4,    0,    0,   12,    0,
+       6,    3,    2,    0,    1,    0,    1,   13,
+       1,    3,    6,    0,    0,    0,    1,    0,
+       4,    1,    1,    4,    0,    1,    2,   14,
+       1,   16,    0,    6,    0,    0,    1,    4,
+       0,    2,    2,    3,    7,    0,    0,    0,
+       0,    5,    0,    1,    2,    2,    2,    4,
+       0,    1,    3,    0,    1,   17,    5,    2,
+       6,    2,    0,    0,    4,    0,    0,    0,
+       1,    1,    0,    2,    1,    3,    1,    0,
+       0,    1,    1,    1,   11,    2,    0,    0,
+       1,    1,    5,   16,    2,    7,    4,    1,
+       0,    4,    0,    0,    0,    2,    1,    0,
+       2,    2,    2,    0,   13,    1,    5,    1,
+       4,    1,    2,    8,    0,    1,    1,    0,
+       0,    4,    1,    0,   16,    0,    1,    6,
+       4,    0,    0,    0,    3,   16,    8,    0,
+       0,    4,    1,    2,    0,    0,    1,    7,
+       7,    0,    0,    1,    1,    0,    3,    0,
+       0,   13,    0,    0,    0,    1,    5,    0,
+       1,    0,    0,    2,    0,    1,    1,    0,
+       0,    1,    0,   13,    2,    0,    1,    0,
+       3,    0,    0,    4,    2,    0,    2,    1,
+       0,    3,    2,    4,    0,    6,    0,    1,
+       0,    0,    0,   12,    0,    0,    0,    3,
+       2,    1,    3,    3,    1,    0,   26,    0,
+       0,    0,    2,    2,    0,    5,    0,    6,
+       1,    2,    9,    5,    0,    0,    2,    0,
+       1,    0,    0,   18,   13,    4,    0,    0,
+       6,    2,    0,    1,    0,    5,    1,    0,
+      10,    0,    4,    2,    0,    0,    0,    0,
+       1,    0,    2,    7,    3,    2,    2,    0,
+      15,    0,    0,    0,   10,    4,    4,    0,
+      10,    3,    5,    3,    9,    2,    2,    4,
+      15,    0,    1,    1,    1,    1,    1,    4,
+       0,    2,    3,    3,   10,    1,    2,    0,
+       0,    1,    1,    0,    0,    1,    0,    1,
+       0,    0,    0,   40,    0,    0,    1,    0,
+};
+static const unsigned short ln_hash_slot[LN_HASH_SLOTS] = {
+      70,  609,  302, 1171,  558,  437,   72,  843,
+     109,  427, 1154,  314,  130,  751,  639,  780,
+       0,   29,    0,  575,    0, 1169,    0,    0,
+     721,    0,  200,    0,  385,  743,  763,  733,
+     753,    0,    0,    0,    0,  305,    0,   46,
+    1148,    0,  547,  885,    0,    0,    0,    9,
+     579,  798,  496,  979, 1122,  879,  417,  854,
+    1091,    0,  635, 1132, 1161,  741, 1083,  271,
+       0,    0,    0,  541,  756,  115,    0,    0,
+     764, 1113,  615,  279,  571,  377, 1138,  643,
+       0,  942,    0,  145,    0,    0,    0,    0,
+       0,  102, 1151, 1112,  282,  261,    0,    0,
+     501,  262,  408,  349,  106,  873,    0,    0,
+     996,  894,    0,  884,    0,    0,  207,  691,
+     645,    0,  434,    0,    0,    0,    0,    0,
+     815,    0,  811,  954,  969,  210,  748,  166,
+      24,  259, 1060,  415,    0,  360, 1106,    7,
+       0,   90,    0,    0,    0,    0, 1097,  510,
+     674,    0,    0,    0,   17,    0,    0,    0,
+     363,    0,  481,    0,    0, 1096,  230,   95,
+     797,    0,   11, 1050,  786, 1134,  959,   39,
+     814,  663,    0,  339,  252,  869,  176,    0,
+    1140,    0,  574, 1064,  952,  122,  777,  537,
+       0,  929,  436,  355,    0,  128,    0,    0,
+     150,  260,    0, 1142,    0,    0,  453,    0,
+       0,    0,    0,   50,    0,    0,    0,    0,
+       0,    0,    0,    0,  293,    0,    0,    0,
+       0, 1046,  870,   23,    0,  472,    0,    0,
+     492, 1116,  407,  634,  807,    0,    0,    0,
+      27, 1117,    0,    0,    0,    0,    0,    0,
+     253,  317,    0,    0,  698,  785,  277,  857,
+     850,  673,    0,    0,    0, 1018,    0,  231,
+     512,  867,  757,    0,  923,    0,    0,    0,
+     795,  170,  359,  228,  329,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,  548,
+     201, 1189, 1144,  986,    0,  744,    0,  889,
+     670,    0,    0,  311,  851,  864,  963,  464,
+     247,  160,  759, 1037,  523,  560,  893,  445,
+       0,  254,  286,    0,  484,    0,    0, 1080,
+       0,   79,  933,    0, 1162,  740,  371,    0,
+     925, 1128,  522,    0,    0,  113, 1030,  578,
+     761,   83,  971,  480,   55,  278,  655,  446,
+       0,   18,  167,  668,  921, 1029,  245,  295,
+     755,  347,    0,    0, 1193,  179,  143,  719,
+     366,    0,    0,    0,    0,    0,    0,  192,
+       0,  151,  692,   63,  649,    0,  246,  393,
+       0,    0,  428,    0,  390,  883, 1078,    0,
+       0,    0,    0,  955,  312,   38,    0,    0,
+     495,   28,  338,  475,    0,  272,  319,    0,
+     504,    0,  602,  497,  507,  147,  732,    0,
+       0,    0,    0,    0,    0,    0,  754,    0,
+       0,  989, 1081,    0,    0,  554, 1057, 1009,
+     860,    0,    0,  632,    0,  559,  746, 1051,
+       0,    0,  178,    0,    0,    0, 1069,    0,
+    1137,  944,  236, 1087,  858,   37,  642,    0,
+     896,  916,  826,   78,  816, 1173, 1092,  629,
+       0,  683, 1111,  828,  116,   53,    0,  353,
+       0,    0,  397,    0,    0,    0,    0,   75,
+       0,    0,  965, 1059,  328,  967,    0,  681,
+       0,  469, 1067,    0,    0, 1139,    0,   19,
+       0,    0,   80,  214,    0,    0,  111,    0,
+       0,  490,    0,  391,  159,  556,    0,    0,
+       0,  822,    0,    0,  697,  198,    0,  707,
+    1159,  964,  114, 1158, 1027,  458,  700,  994,
+     598,  323,   86,  514,    0,  758,  838,    0,
+      48,  538,    0,    0, 1181,  902,  508,    0,
+       0,  846,    0,    0,    0,    0,  624,    0,
+       0,    0,    0,    0,  783,    0,    0,  564,
+       0,    0, 1058, 1036,    0,  221,   60,    0,
+     583,  488,  500,  730, 1131,  138,    0,  341,
+       0,    0,    0,  688,  932,  687, 1163,  591,
+     810,  217,   16,  997,   73, 1047,  244,  739,
+     479,    0,  900,  577, 1088,  980,  535,    0,
+       0,  637, 1038,    0,    0,    0,  652,  585,
+       0,  890,  646,  156,  809,  163, 1105,    0,
+       0,    0,    0,    0,    0,  626,    0,  203,
+       0,    0,    0,    0,    0, 1052,    0,    0,
+     658,  280,  712,    0,    0,    0,    0,    0,
+     335,    0,   96,  325,    0,    0,  243,    0,
+       0,    0,    0,  945,    0,    0,    0,    0,
+     491,  194,  791,  357,  662, 1021,    0,  195,
+     852,  749, 1123,  919,  367,  165, 1073,  135,
+       0,  633,    0,  518, 1084,    0,    0,    0,
+       0, 1035,    0,  790,  988,   67,  383,  621,
+       0,    0,    0,    0,    0,    0,    0,  137,
+       0,    0,    0,    0,  238,    0, 1065,    0,
+       0,  424,  276,  993,    0,    0,  573,  352,
+    1014,  204,  613,    0,    0,  716,    0, 1033,
+     973,    0, 1011,  536,    0,  542,    0,  861,
+       0,  212,  653,  899,    0,    0,    0,  290,
+     209,    0,  552,  432,    0,    0,  808,  594,
+       0,    0,    0,    0,    0,  477,  452,    0,
+     718, 1017,    0,    0,  171,  125, 1066,  875,
+     186,  710,  255,  726,   47,    0,    0,    0,
+    1012,  398,  831,   31,  936,  706,  752,  396,
+       0,    0,    0,    0,    0,  386,    0,  950,
+     273,    0,    0,    0,    0,  283,  724,    0,
+     917,   13,  473,  351,  911, 1145,    0,  990,
+     104,    0,    0,  188,  467,    8,  604, 1034,
+     877,   40,  778,  103,   43,    0,    0,  182,
+       0,    0,  978,    0,    0,  506,    0,    0,
+       0,  348,    0,    0,    0,  144,  612,    0,
+       0, 1186,  676,    0,    0,   85,    0,    0,
+     823, 1143,  738,    0, 1127, 1090,  258, 1164,
+       0,  534,  222,  543,    0,  671,    0,    0,
+    1121,    0,    0,    0,    0,    0,  821,    0,
+     679,    0,    0,    0,    0, 1024,  205,    0,
+       0, 1125,  239,  474,  520,  576,  586,  304,
+    1191,   42,  494,   35,    0, 1063,  331, 1040,
+     960,    0,   64,  380,  101,  949,  659,  308,
+     551,  388,  680,   65, 1045,    0,   94, 1002,
+       0,    0,    0, 1031,  373,  289,    0,  939,
+       0,    0,    0,    0,    0,    0,    0, 1118,
+     306,  336,  747,    0,    0,  149,  825, 1188,
+       0,    0,  984,  788,    0, 1110,  985, 1150,
+       0,    0,  263,  420, 1032,  974,    0,    0,
+     354,    0,    0,    0,  603,  849,  611,  344,
+     545,  794,    3,    0,  961,    0,    0,    0,
+       0,    0,    0,    0,  133,    0,    0,    0,
+     320,  275,    0,  644,    0,  793,    0,  694,
+     368,    0, 1194,    0,    0,  856,    0,    0,
+      21,    0, 1157,    0,    0,  161,  650,  762,
+      68,    0, 1170,    0,    0,  322,    0,    0,
+       0,  667,    0,    0,    0,  953,   87,    0,
+    1085,  909,    0,    0,    0,    0,    0,    0,
+       0,    0,  177,  951,  709,  298,    0,    0,
+       0,    0,  704,    0,    0,    0,    0,  274,
+     998,    0,    0,  800,  617,   30,  623,  685,
+       0,    0,    0,    0,    0,  927,    0,    0,
+    1115,  416,  332, 1130,  641,    0,    0,    0,
+       0,    0,   84,  827,    0,    0,  595,  832,
+     168,  569,    0,  699, 1104,  610,    0,  379,
+     592,  382,  456,  803,  802, 1049,  913,    0,
+       0,    0,    0,    0,    0,    0,  859,    0,
+       0,    0,  734,    0,  943,  493,    0,    0,
+       0,  690, 1172,  440, 1153, 1165,  370,  737,
+       0,    0,    0,    0,  119,  376,  799,    0,
+       0,  880,    0,  935,    0, 1099,    0,    0,
+     395,  563, 1146,  444, 1019,    0,   33,   34,
+     703,  196,  908,  310,  720,    0,  722,    0,
+       0, 1174,  107,    0,  834,    0,    0,  529,
+     307,    0,    0,   58,  288, 1190,   59,   10,
+     460,    0,  622,    0,    6,    0,  914,    0,
+     608,  631,  242,  406,  251,  435,  313,  470,
+     381,  152,  157,  270, 1177,  345,  374,  664,
+     847,  399,  410,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,  327,    0,    0,    0,
+     454, 1180,  172,    0,    0,    0,    0,  459,
+       0,    0,  842,    0,  660,    0,    0,    0,
+     820,    0,    0,    0,  695,    0,    0,  433,
+     636,  153,    0,  330,    0,  225,    0,    0,
+       0,  131,    0,  126,    0,    0,    0,    0,
+       0,    0,    0,    0,  455,    0,  449,    0,
+       0,    0,  185,  930,    0,    0,  765,  423,
+       0,    0,    0,  463,  672,    0,    0,    0,
+       0, 1098,  768,  728,  840,  358,    0,    0,
+     219,    0,  531,   12,  105,  881, 1079,  675,
+    1094, 1120, 1082, 1039,   20,  647,  625,  946,
+    1095,  498,  705,  375,  291,  129,  924,  948,
+     665,   57,  966,   49,   26,  326,   66,  686,
+       0,    5,    0,  987,  439,    0, 1062,   44,
+     941,    0,    0, 1135,  181,    0,  412,    0,
+     234,    0,    0,    0,  682,  503,    0,    0,
+     206,    0,  891,    0,    0,    0,    0, 1015,
+    1042,  430,    0,  482,  910,  462,  593,  934,
+    1077,  903,  100, 1119,  584,  736,   41,  715,
+     926,  544,  565,  269,  901,  938,  213,  912,
+     173,  689, 1086, 1184,  982,  401,  977, 1166,
+       0,  570,  324,  817,    0,    0,  517,  731,
+     619,    0,    0, 1071,    0,  233,    0,  183,
+     265,  232,  117,  527,  389,  299,  723,  922,
+     318,  835,  226,  405,  767,  426,  550,  502,
+       0,  582,    0,    0,    0,    0,  878,  876,
+     134,  533, 1026,  975, 1179,  443,    0,  218,
+     361, 1061,    0,  227,    0,    0,  112,    0,
+       0,    0,    0,  540,    0,    0,    0,    0,
+     845,  208,  483,  411,  661,  284,    0,  333,
+       0,  750,    0,  829,  478,  175, 1000,    0,
+       0,    0,  958,    0,    0,    0,    0,   76,
+     918,  769,  968,    2,  812,  871,    0,  287,
+       0,    0,    0,    0,    0,  139,  471,  766,
+       0,    0, 1114,   81,  627,  257,  696,  784,
+      54,    0,    0,  589, 1133,    0,    0,    0,
+       0,    0,    0,  340,  468,    0,    0,    0,
+     216, 1005,    0,    0,    0,  549,  425,    0,
+       0,    0,    0,   71,  303,  256, 1183,  343,
+     530,    0, 1093,  590,  983, 1001,  677,   89,
+       0,   91,    0,    0, 1007,    0,  806,    0,
+       0,    0,  678,    0,    0,    0,    0,  346,
+     905,  356,  819,    0,    0,    0,  865,    0,
+     193, 1043, 1013,    0,    0,  190,    0,  525,
+     782, 1075,    0,    0,  600,  387, 1149,    0,
+     855,    0,    0,    0,    0,    0,    0,  725,
+     394,  962,    0,    0,  413,    0,   99,   77,
+       0,   61, 1074,    0,  561,  729, 1016,    0,
+     976, 1008,  970,    0,  745,  872,  392,    0,
+       0,    0,    0,  241,   22,    0,    0,  839,
+     771,  447,    0, 1025, 1068, 1048,  618,    0,
+       0,  648, 1156, 1076,  142, 1070,    0, 1176,
+     882,  596,  991,  656,  123, 1167,  853, 1185,
+     451,    0,  266,    0,  931, 1072,    0,    0,
+     442,  476,  920,   98,    0, 1028,  384,    0,
+       0,    0,  862,  441,  713,  805,  801,  140,
+       0,  148,  567,  422,    0,    0,    0,  364,
+       0,  155,    0,  995,  981,    0,    0,    0,
+     162,    0,    0,    0,    0,    0,    0,    0,
+     833,    0,    0, 1124,    0,    0,    0,    0,
+     588,    0,    0,    0,    0,  597,  108,  158,
+     337,  555, 1100,    0,  606,    0,    0,   88,
+     947,    0,    0,  132,    0,  566,    0,  237,
+     898,    0,  197,  309,    0, 1103,  250,    0,
+       0,    0,  240,   56,    0,    0,    0, 1053,
+       0,  887,    0,  184,    0,  874,    0, 1102,
+       0, 1187,  868,  421,    4,    0, 1129,  607,
+     539,    0,    0,  264,    0,  211,    0,    0,
+     789,    0, 1107,  316,  528,  378,  268,  450,
+       0,    0, 1004,  438,  431, 1023,    0,    0,
+       0, 1041,    0,  505,    0,    0,    0,    0,
+      93,    0,  904,    0,    0,    0,    0,    0,
+       0,    0,  992,    0,    0,    0,  651,    0,
+       0,  866,  897,    0,  297,  572,    0,  223,
+     187,    0,   62,  972,    0,  526,    0,    0,
+       0,  956,    1,    0,   32,  141,  285,    0,
+       0,    0,    0, 1182,  999,  321,  191,  684,
+     429,    0,    0,  229,  824,    0,  787,  487,
+       0,    0,    0, 1175, 1192,    0,  414,  701,
+     892,   25,    0,  620,  776,    0,  267,  888,
+       0,    0,    0,    0,  601,  666,  199,  760,
+       0,  906,  727, 1101,    0,    0,    0,    0,
+       0,  614,    0,    0,    0,    0,    0,   97,
+       0,  580, 1160, 1108, 1109,  301,  215,    0,
+     465,  513, 1168,  224,  735,  657,  742,  781,
+       0,  562,   15,    0,    0,    0,    0,    0,
+       0,   14, 1155,   69,  711,    0,  557,  841,
+       0,    0,    0,    0,  957,  640,  294,  369,
+      51, 1136,  818,    0,  300,  895,  174,  202,
+       0,    0,    0,  281,  342,  362, 1152,    0,
+       0,   92,    0,  796,  848,  669, 1056,    0,
+     519,  249,  915,  110, 1010,    0,    0,    0,
+     248,    0,    0,    0,    0,  863,  702,    0,
+     296,  418,  409,    0,    0,  485,  844,  581,
+       0,   52,  334, 1044,  220,    0,    0,  886,
+       0,    0,    0,    0,  402,  714,   74, 1006,
+     127,    0, 1020,  235,    0,    0, 1022, 1089,
+     628,    0,  837,  489,    0,  372,  120,  587,
+     419,    0, 1147,    0,    0,  770,  524,    0,
+     708,  605,   45,  553,  630,  599,  461,  136,
+     830,  616,  813,  169,    0,  180,  365,  315,
+     779,    0,    0,  546,  189,  515,  403,  568,
+     457,    0,    0,  121,  792,  693,    0,    0,
+    1003,    0,  940,  509,    0,    0,  164, 1141,
+       0,  516,    0,  804,  654,    0,    0,  907,
+       0,  486,  717,    0,    0,    0,    0,  836,
+     638,    0,  146,    0,    0,    0,  937, 1126,
+     521,    0,  499,  773,  928,    0,  154,  532,
+     292,  400,   82,   36, 1178,    0,  466,  448,
+};
+
+#define OBJ_HASH_SEED 0x811C9DC5
+#define OBJ_HASH_BUCKETS 512
+#define OBJ_HASH_SLOTS 2048
+static const unsigned short obj_hash_disp[OBJ_HASH_BUCKETS] = {
+      10,    4,    0,    0,    1,    0,    4,    4,
+       2,    0,    0,    0,    0,    0,    1,    0,
+       0,    3,    3,    0,    2,   15,    2,    3,
+       1,    8,    0,    2,    2,    1,    3,    0,
+       3,    0,    0,    0,    1,    2,    0,    5,
+       3,    0,    1,    1,    0,   16,    0,    0,
+       2,    2,    5,    1,    2,    1,    1,    8,
+       0,    1,    0,   26,   12,   13,    3,    8,
+       0,    3,    0,    3,    0,    0,    0,    2,
+       4,    0,    1,    2,    1,   17,   16,    9,
+       0,    1,   12,    0,    1,    1,    2,    0,
+       2,    1,    0,    1,    7,   18,    8,    0,
+       1,    2,    0,    0,    0,    0,    0,    5,
+       2,    2,    1,    3,    3,    0,   14,    7,
+       0,    2,    1,    0,    5,    4,    0,    0,
+       6,    2,    0,    3,    1,   12,    6,    4,
+       0,    2,    9,    1,    2,    3,   17,    0,
+       5,    0,    1,    2,    0,    5,    0,    6,
+       5,    3,    0,    0,    1,    6,    0,    0,
+       1,   15,    3,    0,    3,    1,   12,   19,
+       4,    1,    2,   16,    1,    4,    0,    1,
+      10,    5,   17,    2,    4,    0,    4,    0,
+      10,    0,    0,    3,    4,    0,    0,    2,
+       0,   12,    4,   17,    4,    3,    1,    0,
+       2,    3,    0,    3,    0,    0,    1,    1,
+       1,    3,    8,    4,    3,    0,    0,    1,
+       0,   13,    0,    2,    0,    2,    2,    1,
+       1,    0,    3,   12,    9,    1,    3,    2,
+       0,    8,    0,    8,    9,    1,    3,    0,
+       1,    2,   12,    8,    8,    3,    1,    5,
+       7,    4,    3,    0,   15,    5,    0,    2,
+      10,    0,    5,    0,    5,    0,    0,    0,
+       0,    1,    6,    0,    4,   10,   16,    3,
+       0,    0,    0,   16,    9,    3,    1,    0,
+      12,    1,    6,    4,    1,    4,    2,   17,
+       6,    5,    0,    4,    0,    4,    0,    0,
+       4,    3,    0,    3,    4,    0,    0,    3,
+       1,    0,    1,    1,    0,    9,    6,    2,
+       3,    0,    1,    0,    0,    0,    4,    2,
+       2,    2,    0,    0,    2,    2,    2,    0,
+       0,   10,   11,    0,    1,    1,    0,    0,
+       2,    0,    1,    5,    0,    5,   10,    8,
+       0,   16,    1,    2,    0,    0,    4,   14,
+       8,    4,    1,    1,   15,    3,    8,    1,
+       8,    0,   12,    0,    2,   10,    0,    2,
+       0,    5,    0,    3,    4,    1,    4,   10,
+       0,    1,    2,    0,    3,    0,    0,    1,
+       0,    1,    8,    8,    2,    0,    1,    4,
+       0,    0,    2,   10,    3,    4,   17,    0,
+       5,    0,    0,    1,    3,   11,    2,    1,
+       7,    1,    2,    8,    0,   18,    0,   15,
+       1,    0,    9,    2,    4,    8,    2,    0,
+       4,    2,    1,    2,   16,   10,    2,    3,
+      17,    0,    3,    8,    0,    0,    4,    0,
+       0,    9,    8,    3,    0,   19,    8,    0,
+      12,    0,    4,   15,    2,    7,    1,    7,
+       0,    0,    2,    0,   11,    2,    5,    1,
+       0,    1,   11,    5,    0,    0,    0,    8,
+       0,   11,   24,   22,    0,    0,    6,    0,
+       3,    4,    2,    4,    7,    5,    2,   16,
+       2,   16,    0,    1,    2,    0,    5,    1,
+       2,    0,    0,    0,    5,    1,    1,    4,
+      13,   23,    5,    5,    0,    2,    0,    0,
+      15,    1,    4,    0,    3,   17,    1,    4,
+};
+static const unsigned short obj_hash_slot[OBJ_HASH_SLOTS] = {
+      65,    0, 1003,   21,    0,  431,  670,    0,
+       0,    0,    0,    0,   11,  902,  896,  161,
+    1104,  736, 1118,  744,  157, 1096, 1110,   52,
+       0,  108,    0,    0,    0,    0,  424,  936,
+     804,  978,    0,    0,  184,  369,    0,    0,
+       0,    0,    0,    0,    0,  778,    0,    0,
+     282, 1028, 1078,  133,  287,  303,  274, 1070,
+     146,  794,  334,  339,  995, 1121,  346,  311,
+       0, 1175,    0,    0,    0,  399,    0,    0,
+     815,  352,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,  926,  193,    0,    0,  934,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,  961,    0,  968,  969,
+       0,    0,  951,    0,    0,  791,  847,  437,
+       0,    0,  387,  642,    0,    0,    0,    0,
+       0,  712,    0,  729,  515,  682,    0,    0,
+     709, 1165,  724,   29,  851,    0,   72,  826,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,  496,    0,    0,  459,  478,  489,  467,
+       0,    0,    0,    0,    0,  265,  175,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+     137,    0,    0,    0,    0,    0,    0,    0,
+     587,    0,    0,    0,  547,  613,  524,  571,
+     595,  539,  555,  579, 1142,  563,  601,  532,
+       0,  154,    0,    0,    0,    0, 1006,    0,
+       0,    0,    0,  641,    0,    0,    0,    0,
+       0,    0,  245,  842,    0,  833,   86,  838,
+     786,  220,  228,  212,  200,  236,  414,  204,
+     703,  687,  100,  251, 1092,  872,  880,  509,
+     695,    4,  106,  890,  187,  249, 1035,  864,
+     669,    0,  634,    8,    0,  156,    0,    0,
+       0,  168,  504,  895,  423,    0,  901,   69,
+     389, 1101, 1117,  741, 1181,   51,  417, 1109,
+     675,    0,    0,    0,    0,  390,    0,    0,
+       0,    0, 1135,  368,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+    1027, 1079,  296,  275, 1071,  290,  283, 1122,
+     145,  793,  338,  304,  345,  981,  333,  312,
+       0,    0,    0,  913,    0,    0,    0,    0,
+       0,  809,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,  927,    0,  192,  315,    0,    0,
+       0,    0,    0,    0,  321, 1186,    0,  756,
+       0,  999,  963,    0,    0,    0,  971,  754,
+       0,    0,    0,    0,    0,  792,  846,    0,
+       0,    0,  386,  628,  805,    0,    0,    0,
+       0,    0,  716,    0, 1171,    0,   71,    0,
+      32,   30, 1166,  728,    0,  683,    0,  823,
+       0,    0,    0,    0,    0,  499,    0,    0,
+     481,  491,  727,  854,  474,  470,  462,  484,
+       0,    0,    0,    0,  262,  452,  449,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,  138,    0,    0,    0,    0,    0,
+     607,    0,  572,  183,  612,  548,  525,  533,
+     580,  540,  606,  556,  441,  596,  588,    0,
+       0,    0,    0,    0,    0,    0,    0,  380,
+     153,  564,    0,  637,    0,    0,    0,    0,
+       0,  832,  199,  769,  246,  839,  747,   85,
+     227,  219,  235,  209,    0,    0,    0,  415,
+     698,  690,  891,  113,  881,  105,  503,  873,
+     643,   37,  942,  257, 1151,  107, 1034,  865,
+     633,    0, 1145,  919,  433,    0,  422,    0,
+     647,    0,  788,    0,  790,    0,    0,    0,
+     742, 1102,  735,  802, 1094, 1112,  167,   54,
+       0,  117, 1156,    0, 1147,    0,    0,    0,
+     371,    0,    0,    0,    0,    0, 1002,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+    1026,  295, 1068,  984,  289,  663, 1076,  272,
+     344,  148,  280, 1125,  301, 1134,  332,  309,
+       0, 1178,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,  191,  316,    0,  928,
+       0,    0,    0,    0,    0,    0,    0, 1185,
+    1149,  435,  159,    0,    0,    0,  758,  506,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,  385,  627,    0,    0,  845,
+       0,  407,  715,    0,  714,   76,  516,  679,
+     726,  974, 1167,  722,    0,    0,   45,  824,
+       0,    0,    0,    0,  461,    0,    0,    0,
+       0,  498,    0,    0,  473,  469,  480,  102,
+       0,    0,    0,    0,  263,  457,  447,  450,
+     381,  364,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+     573,  557,    0,    0,  439,  615,    0,  549,
+     581,  597,  541,  589,    0,  565,  605,  909,
+     152,    0,    0, 1005, 1154,    0,    0,  526,
+       0,    0,    0,    0, 1170,    0,    0,    0,
+     689,  403,  247,  840,  781,  142,   84,   89,
+     218,  226,  234,  210,  202, 1086,  412,  844,
+       0,  866,  874,   14,  892,  859,  882,  174,
+     994,  378,  943,  801,  697, 1059,   27, 1088,
+       0,  644,  773,  671,  432,  421, 1158,    0,
+       0,    0,  169,   26,  900,  996,  429,  162,
+     739, 1111,  673, 1119,   53, 1099,  172,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+     405, 1069,  370, 1077,    0,  281,    0,    0,
+       0,    0,    0,    0,  310,  776,  302,  164,
+     294, 1025, 1136, 1031,  177,  292,  273,  323,
+     185,  343,  987,  147, 1000, 1120,  331,  313,
+       0, 1174, 1177,  354,    0,    0,    0,    0,
+     811,  818,    0,  348,  807,    0,    0,  143,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,  317,    0,  921,    0,    0,  190,  929,
+       0,    0,    0,    0,    0,    0,  665, 1184,
+     160,  505,  997,  768,  966,    0,    0,  766,
+       0,    0,    0,    0,  988,  416,    0,  625,
+       0,    0,  384, 1180,    0,    0, 1141,    0,
+     852,  718,  732,  707,    0,  681,   75,    0,
+     377,    0,   70,  104,  829, 1160,  850, 1168,
+       0,    0,    0,    0,  476,  472,  486,    0,
+       0,    0,    0,    0,  464,  483,  501,  493,
+       0,    0,    0,    0,  451,  260,  448,    0,
+       0,  785,    0,    0,    0,    0,    0,  268,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,  590,    0,    0,  614,  542,  527, 1140,
+     598,  550,  534,  908,  558,  566,  519,  574,
+       0,    0, 1008,    0, 1153,    0,  752,  151,
+     582,    0,    0,    0,    0,    0,    0,    0,
+     225,  831,    0,   83,  103,  402,  430,    0,
+     217,  233, 1060,  207,  125,  843,  201,  413,
+     256,  692,  860,  700,  867,  883,  875,  885,
+       5,  684,  944,    3,  800,   15,  116, 1087,
+       6,    0,  935,  635,    0,    0,    0,    0,
+     955,   25,    0,  420,  899,  434,  428,    9,
+    1114, 1106,  740,  674, 1100,   56,   48,    0,
+       0,  783,    0,    0,    0,    0,    0,    0,
+     365,    0,  373,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,  165,    0,    0,
+    1074,  278,  132, 1132,  291, 1137, 1020,  324,
+    1066,  299,  270,  330, 1001,  307, 1123,  990,
+       0,    0,    0,  914,    0,  355,    0,    0,
+     810,  817,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,  361,    0,    0,    0,    0,
+       0,    0,    0,  922,  318,  930,  189,    0,
+       0,    0,    0,    0,  322,  972,  664, 1148,
+       0,    0,  998,    0,  964,    0,  965,  982,
+       0,    0,    0,    0,  989,    0,    0,  624,
+       0,    0,  383,  993,    0, 1004,    0,    0,
+    1161,    0,   57,  731,  853,    0,  517,  706,
+     171,   41,  135,   64,    0,  717, 1169,  830,
+       0,    0, 1159,    0,    0,    0,    0,  500,
+     463,  482,    0,    0,  492,  475,  471,  485,
+     455,    0,    0,    0,  261,  445,  662,    0,
+       0,    0,  179,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+     559,  438,  575,    0,  609,  617,  907,  520,
+     543,  551,  583,  535,  567,  599,  604,  621,
+       0,    0,    0, 1007, 1155,  751,    0,  528,
+       0,  508,    0,  591,  636,    0,    0,  150,
+     691,  196,   82,  224,  241,  748,  666,  861,
+     232,  216,  945,  208,  240,   34,  857,  410,
+     631,  255,  699,  940,  884,  400,  886,  876,
+     248,    0,  799,   16,  893,   47,  868,  186,
+    1146,    0,  632,   24,    0,    0,    0,    0,
+     956,    0,  911,    0,  419,    0,  898,  427,
+     737,  803,  745, 1105,   55, 1157, 1097,    0,
+    1113, 1152,    0,  782,    0,  188,    0,    0,
+     372,  512, 1124,  279,    0,    0,    0,    0,
+       0,    0,    0,    0,  293,  308,  779,    0,
+    1024, 1067, 1131, 1139,  286,  398,  271,  131,
+     342,  337,  149,  329,  300,  991, 1075,  325,
+       0,    0,    0,    0,    0,    0,    0,  858,
+     813,    0,  376,  356,    0,  351,    0,    0,
+       0, 1056,    0,  362,    0,  319,    0,    0,
+       0,    0,    0,    0,    0,  931,  923,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,  649,    0,    0,  983,    0,  967,  755,
+     954,    0,  986,    0,    0,    0,    0,    0,
+       0,  139,    0,  382,    0,    0,    0,    0,
+      78,  720,  723,  734,  513,  518, 1033,  849,
+     705,   66,  115,   79, 1162,    0,  827,    0,
+       0,    0,    0,  711,    0,    0,    0,    0,
+       0,  495,    0,  443,  458,  391,  466,  488,
+     392,  456,    0,    0,  259,  446,  266,    0,
+       0,  363,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+     584,  568, 1150, 1093,  616,  529,  608,  521,
+     536,  552,  544,  603,  600,  592,  576,  620,
+     560,    0,    0,    0,    0,    0,    0,    0,
+     638,    0,    0,    0,    0,    0,    0,    0,
+     780,    0,  242,    0,  869,  141,  126,  771,
+     215,  205,  231,  223,  239,  411,  203,    0,
+     686,  702,  694, 1089,  510,  661,  877,  173,
+     887,  254,  798,  939,  394,  250,    0,  660,
+     746,    0,  668,  396,    0,    0,    0,   23,
+     957,    0,  418,  789,   10,   68,  426,  379,
+    1108, 1116,  672,  738, 1098,  856,    0,   50,
+       0,    0,  119,  112,    0,    0,    0,    0,
+       0,  678,  367,  276,    0,    0,    0,  375,
+       0,  777,  796,    0,  305,  784,    0,    0,
+    1030,  130, 1023, 1138,  297,  397,  326,  285,
+     341,  284,  144,  336, 1072, 1179,  314,  328,
+       0,  357,    0,    0,    0,    0,    0,    0,
+     808,  973,  812,  349,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,  395,  932,  195,  924,  320,
+     648,    0,    0,    0,    0, 1144,  667,    0,
+       0,    0,    0,  757,  980,  677,  759,    0,
+     953,    0,  985,    0,    0,    0,    0, 1176,
+       0,    0, 1182,  629,    0,  806,    0,    0,
+     733,    0, 1032,    0,  514,   77,   74,  710,
+       0,   67,  704,  719, 1163,    0,   58,  828,
+     822,    0,  920,    0,    0,    0,    0,    0,
+       0,  502,    0,  442,  494,  487,  465,  477,
+     453,    0,    0,    0,  267,   19,  128,    0,
+      95,    0,    0,    0,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+       0,  819,  136,    0,    0,    0,    0,    0,
+       0,  569,  561,    0,  611,  619,    0,  623,
+     537,  545,  593,  602,    0,  530,  577,  522,
+       0,    0,    0,    0,  753,    0,    0,    0,
+     639,  553,  585,    0,    0,    0,    0,    0,
+       0,  836,    0,  206,   88,  243,  401,  770,
+     214,  787,  222, 1058,  238,   20,  198,  230,
+     253,  701,  870,  938,   12,   99,  888,  878,
+     685,   44,  693,   17,  835,  163, 1090,  862,
+       0,    0,  912,    7,   22,    0,    0,    0,
+       0,    0,    0,  897,  903,  170,  182,  425,
+    1095, 1115,  743, 1107, 1103,   49,    0,    0,
+       0,    0,    0,    0,  941,    0,    0,    0,
+     366,    0,    0,    0,    0,  127,    0,  374,
+       0,    0,    0,    0,  306,    0,    0,    0,
+    1133, 1029,  129, 1022,  180,  288, 1073, 1065,
+     269,  795,  335,  340,  298,    0,  327,  277,
+       0,    0,   91,    0,  358,  347,    0,    0,
+     353,  816,  436,    0,  359,    0,    0,    0,
+       0,    0,    0,  360,    0,    0,    0,    0,
+       0,    2,  925, 1057,  194,    0,  933,    0,
+       0,    0,    0,    0,    0,    0, 1143,    0,
+    1172,    0,  158,  970,  979,  962,  992,  767,
+     952,    0,    0,    0,  848,    0, 1173,    0,
+       0,    0,  388,  408,  626,  630,    0,    0,
+     713,  406,    0,  730,   73,  708,  725,  721,
+      31,    0,   42,  134,    0, 1164,   59,  825,
+       0,    0,    0,  821,    0,    0,    0,    0,
+     497,    0,  468,    0,  460,  479,    0,  490,
+     454,    0,    0,    0,  176,  264,  444,  258,
+       0,  178,    0,   96,    0,    0,    0,    0,
+       0,    0,    0,    0,    0,    0,    0,    0,
+     820,    0,    0,    0,    0,    0,    0,    0,
+     586,  680,  554,    1,  546,  618,  523,  610,
+     538,  562,  594,  570,  440,  531,  622,  578,
+       0,    0,    0,    0,    0,  155,    0,    0,
+       0,  640,    0,  507,    0,    0,    0,    0,
+     841,  244,   90,  211,  837,  863,   87,  140,
+     221,  229,  213,  977,  409,  237,  834,  197,
+     252,  688,   18,  937,  889,  871,  879,  101,
+     120,  910,  696,  797,   13,   81, 1091,   28,
+};
+#endif
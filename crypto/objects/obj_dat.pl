@@ -36,6 +36,84 @@ sub der_it
     return $ret;
 }
 
+# FNV-1a, the same as obj_hash() in obj_dat.c
+sub fnv_hash
+{
+    my ($h, $s) = @_;
+
+    foreach (unpack("C*", $s)) {
+        $h ^= $_;
+        $h = ($h * 0x01000193) & 0xffffffff;
+    }
+    return $h;
+}
+
+# Print a perfect hash of the keys in %$keys to the NIDs they map to.
+# Bucket h & (BUCKETS - 1) of a key hash h holds a displacement d so that
+# slot ((h >> 16) ^ d) & (SLOTS - 1) is that key's and no other's. The
+# buckets with the most keys are placed first, and if two keys of a bucket
+# can't be separated the hash is tried again with another seed.
+sub perfect_hash
+{
+    my ($name, $keys) = @_;
+    my @k = sort keys %$keys;
+    my $slots = 1;
+    my $buckets = 1;
+
+    $slots <<= 1 while $slots < @k;
+    $buckets <<= 1 while $buckets * 4 < @k;
+
+    for (my $seed = 0x811C9DC5; ; $seed++) {
+        my %hash = map { $_ => fnv_hash($seed, $_) } @k;
+        my @bkt;
+        my @disp = (0) x $buckets;
+        my @slot;
+        my $ok = 1;
+
+        push(@{$bkt[$hash{$_} & ($buckets - 1)]}, $_) foreach @k;
+        foreach my $b (sort { @{$bkt[$b]} <=> @{$bkt[$a]} || $a <=> $b }
+                       grep { defined $bkt[$_] } 0 .. $buckets - 1) {
+            my $d;
+
+            for ($d = 0; $d < $slots; $d++) {
+                my %used;
+
+                last if !grep {
+                    my $s = (($hash{$_} >> 16) ^ $d) & ($slots - 1);
+                    defined $slot[$s] || $used{$s}++;
+                } @{$bkt[$b]};
+            }
+            if ($d == $slots) {
+                $ok = 0;
+                last;
+            }
+            $disp[$b] = $d;
+            $slot[(($hash{$_} >> 16) ^ $d) & ($slots - 1)] = $keys->{$_}
+                foreach @{$bkt[$b]};
+        }
+        next unless $ok;
+
+        printf "#define %s_HASH_SEED 0x%08X\n", uc($name), $seed;
+        printf "#define %s_HASH_BUCKETS %d\n", uc($name), $buckets;
+        printf "#define %s_HASH_SLOTS %d\n", uc($name), $slots;
+        printf "static const unsigned short %s_hash_disp[%s_HASH_BUCKETS] = {\n",
+            $name, uc($name);
+        for (my $i = 0; $i < $buckets; $i += 8) {
+            my $e = $i + 7 < $buckets ? $i + 7 : $buckets - 1;
+            print "   ", (map { sprintf(" %4d,", $_) } @disp[$i .. $e]), "\n";
+        }
+        print "};\n";
+        printf "static const unsigned short %s_hash_slot[%s_HASH_SLOTS] = {\n",
+            $name, uc($name);
+        for (my $i = 0; $i < $slots; $i += 8) {
+            print "   ", (map { sprintf(" %4d,", defined $_ ? $_ : 0) }
+                        @slot[$i .. $i + 7]), "\n";
+        }
+        print "};\n";
+        return;
+    }
+}
+
 # Output year depends on the year of the script and the input file.
 my $YEAR = [localtime([stat($0)]->[9])]->[5] + 1900;
 my $iYEAR = [localtime([stat($ARGV[0])]->[9])]->[5] + 1900;
@@ -108,6 +186,7 @@ my $lvalues = 0;
 my @out;
 my %obj_der;
 my %obj_len;
+my %obj_raw;
 for (my $i = 0; $i < $n; $i++) {
     if (!defined $nid{$i}) {
         push(@out, "    { NULL, NULL, NID_undef },\n");
@@ -139,6 +218,7 @@ for (my $i = 0; $i < $n; $i++) {
             $length++;
         }
         $obj_der{$obj{$nid{$i}}} = $z;
+        $obj_raw{$obj{$nid{$i}}} = $r;
         $obj_len{$obj{$nid{$i}}} = $length;
 
         push(@lvalues,
@@ -176,6 +256,9 @@ printf "static const ASN1_OBJECT nid_objs[NUM_NID] = {\n";
 print @out;
 print  "};\n\n";
 
+# EBCDIC builds binary search these, the perfect hashes further down being
+# of ASCII strings.
+print "#ifdef CHARSET_EBCDIC\n";
 {
     no warnings "uninitialized";
     @a = grep(defined $sn{$nid{$_}}, 0 .. $n);
@@ -226,3 +309,20 @@ foreach (sort obj_cmp @a) {
     printf "    %4d,    /* %-32s %s */\n", $_, $m, $v;
 }
 print  "};\n";
+
+# The same three indexes as perfect hashes; nid_objs[0] fills the holes.
+# Where several NIDs share a key, the lowest one is taken.
+my %keys;
+foreach (reverse 0 .. $n - 1) {
+    next unless defined $nid{$_};
+    $keys{sn}{$sn{$nid{$_}}} = $_ if defined $sn{$nid{$_}};
+    $keys{ln}{$ln{$nid{$_}}} = $_ if defined $ln{$nid{$_}};
+    $keys{obj}{$obj_raw{$obj{$nid{$_}}}} = $_
+        if defined $obj{$nid{$_}} && defined $obj_raw{$obj{$nid{$_}}};
+}
+print "\n#else\n";
+foreach (qw(sn ln obj)) {
+    print "\n" unless $_ eq "sn";
+    perfect_hash($_, $keys{$_});
+}
+print "#endif\n";
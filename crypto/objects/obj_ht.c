@@ -0,0 +1,301 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/cryptlib.h"
+#include <openssl/objects.h>
+#include <openssl/safestack.h>
+#include "obj_lcl.h"
+
+/*
+ * A chained hash table for the objects and names added at run time.
+ *
+ * Changes are made under the table's lock and published with a release
+ * store of a single pointer, so that obj_ht_get() can walk the chains
+ * without any lock: a reader sees each cell either before or after a
+ * change, never half way.
+ *
+ * Readers do announce themselves, in one of two counters picked by the
+ * current phase.  A change that unlinks something flips the phase and
+ * waits for the readers of the old phase to leave, after which no reader
+ * can still be looking at what was unlinked, and it is freed.  Changes
+ * are rare, and readers never wait for anything.
+ */
+
+/*
+ * Where obj_ht_get() takes no lock and other threads may run it, readers
+ * have to be counted.
+ */
+#if defined(OBJ_LOCKFREE) && defined(OPENSSL_THREADS) \
+    && !defined(CRYPTO_TDEBUG)
+# define OBJ_HT_GRACE
+#endif
+
+#define OBJ_HT_MIN_BUCKETS      64
+
+typedef struct obj_ht_cell_st OBJ_HT_CELL;
+typedef struct obj_ht_buckets_st OBJ_HT_BUCKETS;
+
+struct obj_ht_cell_st {
+    OBJ_HT_CELL *next;
+    unsigned long hash;
+    void *item;
+};
+
+struct obj_ht_buckets_st {
+    size_t mask;
+    OBJ_HT_CELL **b;
+};
+
+struct obj_ht_st {
+    OBJ_HT_BUCKETS *cur;
+    size_t num;
+    CRYPTO_RWLOCK *lock;
+#ifdef OBJ_HT_GRACE
+    unsigned int phase;
+    unsigned int readers[2];
+#endif
+};
+
+static OBJ_HT_BUCKETS *buckets_new(size_t n)
+{
+    OBJ_HT_BUCKETS *bk = OPENSSL_zalloc(sizeof(*bk));
+
+    if (bk == NULL)
+        return NULL;
+    if ((bk->b = OPENSSL_zalloc(n * sizeof(*bk->b))) == NULL) {
+        OPENSSL_free(bk);
+        return NULL;
+    }
+    bk->mask = n - 1;
+    return bk;
+}
+
+/* Free the cells of |bk| and, with |item_free|, what they point to */
+static void buckets_free(OBJ_HT_BUCKETS *bk, void (*item_free)(void *))
+{
+    OBJ_HT_CELL *c, *next;
+    size_t i;
+
+    for (i = 0; i <= bk->mask; i++) {
+        for (c = bk->b[i]; c != NULL; c = next) {
+            next = c->next;
+            if (item_free != NULL)
+                item_free(c->item);
+            OPENSSL_free(c);
+        }
+    }
+    OPENSSL_free(bk->b);
+    OPENSSL_free(bk);
+}
+
+OBJ_HT *obj_ht_new(void)
+{
+    OBJ_HT *ht = OPENSSL_zalloc(sizeof(*ht));
+
+    if (ht == NULL)
+        return NULL;
+    if ((ht->cur = buckets_new(OBJ_HT_MIN_BUCKETS)) == NULL
+            || (ht->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        if (ht->cur != NULL)
+            buckets_free(ht->cur, NULL);
+        OPENSSL_free(ht);
+        return NULL;
+    }
+    return ht;
+}
+
+void obj_ht_free(OBJ_HT *ht, void (*item_free)(void *))
+{
+    if (ht == NULL)
+        return;
+    buckets_free(ht->cur, item_free);
+    CRYPTO_THREAD_lock_free(ht->lock);
+    OPENSSL_free(ht);
+}
+
+size_t obj_ht_num(const OBJ_HT *ht)
+{
+    return ht->num;
+}
+
+/* Returns the phase the reader entered in, for read_end() */
+static unsigned int read_begin(OBJ_HT *ht)
+{
+#if defined(OBJ_HT_GRACE)
+    unsigned int phase;
+
+    for (;;) {
+        phase = __atomic_load_n(&ht->phase, __ATOMIC_SEQ_CST) & 1;
+        __atomic_add_fetch(&ht->readers[phase], 1, __ATOMIC_SEQ_CST);
+        /* Counted in the old phase after it was flipped, try again */
+        if ((__atomic_load_n(&ht->phase, __ATOMIC_SEQ_CST) & 1) == phase)
+            return phase;
+        __atomic_sub_fetch(&ht->readers[phase], 1, __ATOMIC_RELEASE);
+    }
+#elif !defined(OBJ_LOCKFREE)
+    CRYPTO_THREAD_read_lock(ht->lock);
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+static void read_end(OBJ_HT *ht, unsigned int phase)
+{
+#if defined(OBJ_HT_GRACE)
+    __atomic_sub_fetch(&ht->readers[phase], 1, __ATOMIC_RELEASE);
+#elif !defined(OBJ_LOCKFREE)
+    CRYPTO_THREAD_unlock(ht->lock);
+#endif
+}
+
+/*
+ * Wait until no reader can see what was unlinked before, to be called with
+ * the lock held.  Without OBJ_HT_GRACE readers are kept out by the lock or
+ * there are no others.
+ */
+static void synchronize(OBJ_HT *ht)
+{
+#ifdef OBJ_HT_GRACE
+    unsigned int old = __atomic_fetch_add(&ht->phase, 1, __ATOMIC_SEQ_CST) & 1;
+
+    while (__atomic_load_n(&ht->readers[old], __ATOMIC_ACQUIRE) != 0)
+        continue;
+#endif
+}
+
+void *obj_ht_get(OBJ_HT *ht, unsigned long hash, OBJ_HT_CMP *cmp,
+                 const void *key)
+{
+    OBJ_HT_BUCKETS *bk;
+    OBJ_HT_CELL *c;
+    void *ret = NULL;
+    unsigned int phase = read_begin(ht);
+
+    bk = obj_load(ht->cur);
+    for (c = obj_load(bk->b[hash & bk->mask]); c != NULL;
+         c = obj_load(c->next)) {
+        if (c->hash == hash && cmp(c->item, key) == 0) {
+            ret = c->item;
+            break;
+        }
+    }
+    read_end(ht, phase);
+    return ret;
+}
+
+/* Find the link to the cell matching |key|, or the link ending its chain */
+static OBJ_HT_CELL **cell_find(OBJ_HT_BUCKETS *bk, unsigned long hash,
+                               OBJ_HT_CMP *cmp, const void *key)
+{
+    OBJ_HT_CELL **pc = &bk->b[hash & bk->mask];
+
+    while (*pc != NULL
+           && ((*pc)->hash != hash || cmp((*pc)->item, key) != 0))
+        pc = &(*pc)->next;
+    return pc;
+}
+
+/*
+ * Move to buckets twice as many, with cells of their own, and free the old
+ * ones once nobody looks at them
+ */
+static int grow(OBJ_HT *ht)
+{
+    OBJ_HT_BUCKETS *bk = ht->cur, *nbk;
+    OBJ_HT_CELL *c, *nc;
+    size_t i;
+
+    if ((nbk = buckets_new(2 * (bk->mask + 1))) == NULL)
+        return 0;
+    for (i = 0; i <= bk->mask; i++) {
+        for (c = bk->b[i]; c != NULL; c = c->next) {
+            if ((nc = OPENSSL_malloc(sizeof(*nc))) == NULL) {
+                buckets_free(nbk, NULL);
+                return 0;
+            }
+            nc->hash = c->hash;
+            nc->item = c->item;
+            nc->next = nbk->b[c->hash & nbk->mask];
+            nbk->b[c->hash & nbk->mask] = nc;
+        }
+    }
+    obj_store(ht->cur, nbk);
+    synchronize(ht);
+    buckets_free(bk, NULL);
+    return 1;
+}
+
+int obj_ht_insert(OBJ_HT *ht, unsigned long hash, void *item,
+                  OBJ_HT_CMP *cmp, void **replaced)
+{
+    OBJ_HT_CELL **pc, *c, *old;
+
+    *replaced = NULL;
+    if ((c = OPENSSL_malloc(sizeof(*c))) == NULL)
+        return 0;
+    c->hash = hash;
+    c->item = item;
+
+    CRYPTO_THREAD_write_lock(ht->lock);
+    pc = cell_find(ht->cur, hash, cmp, item);
+    if ((old = *pc) != NULL) {
+        c->next = old->next;
+        obj_store(*pc, c);
+        synchronize(ht);
+        *replaced = old->item;
+        OPENSSL_free(old);
+    } else {
+        if (ht->num > ht->cur->mask && grow(ht))
+            pc = cell_find(ht->cur, hash, cmp, item);
+        c->next = NULL;
+        obj_store(*pc, c);
+        ht->num++;
+    }
+    CRYPTO_THREAD_unlock(ht->lock);
+    return 1;
+}
+
+void *obj_ht_delete(OBJ_HT *ht, unsigned long hash, OBJ_HT_CMP *cmp,
+                    const void *key)
+{
+    OBJ_HT_CELL **pc, *c;
+    void *ret = NULL;
+
+    CRYPTO_THREAD_write_lock(ht->lock);
+    pc = cell_find(ht->cur, hash, cmp, key);
+    if ((c = *pc) != NULL) {
+        obj_store(*pc, c->next);
+        synchronize(ht);
+        ht->num--;
+        ret = c->item;
+        OPENSSL_free(c);
+    }
+    CRYPTO_THREAD_unlock(ht->lock);
+    return ret;
+}
+
+/*
+ * |fn| may delete the item it is given, but the table must not change
+ * otherwise while this runs.  This is not a reader, as deleting would then
+ * wait for itself.
+ */
+void obj_ht_doall(OBJ_HT *ht, void (*fn)(void *item, void *arg), void *arg)
+{
+    OBJ_HT_BUCKETS *bk = obj_load(ht->cur);
+    OBJ_HT_CELL *c, *next;
+    size_t i;
+
+    for (i = 0; i <= bk->mask; i++) {
+        for (c = obj_load(bk->b[i]); c != NULL; c = next) {
+            next = obj_load(c->next);
+            fn(c->item, arg);
+        }
+    }
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2016-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -8,7 +8,41 @@
  */
 
 typedef struct name_funcs_st NAME_FUNCS;
-DEFINE_STACK_OF(NAME_FUNCS)
-DEFINE_LHASH_OF(OBJ_NAME);
 typedef struct added_obj_st ADDED_OBJ;
-DEFINE_LHASH_OF(ADDED_OBJ);
+
+/*
+ * Loads and stores of pointers that readers follow without a lock.  Where
+ * the compiler can't order them, obj_ht_get() takes the table's lock.
+ */
+#if !defined(OPENSSL_THREADS) || defined(CRYPTO_TDEBUG)
+# define OBJ_LOCKFREE
+# define obj_load(p)            (p)
+# define obj_store(p, v)        ((p) = (v))
+#elif defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+# define OBJ_LOCKFREE
+# define obj_load(p)            __atomic_load_n(&(p), __ATOMIC_ACQUIRE)
+# define obj_store(p, v)        __atomic_store_n(&(p), (v), __ATOMIC_RELEASE)
+#else
+# define obj_load(p)            (p)
+# define obj_store(p, v)        ((p) = (v))
+#endif
+
+/*
+ * Hash table of the objects and names added at run time, see obj_ht.c.
+ * obj_ht_get() and obj_ht_doall() take no lock.  The items obj_ht_insert()
+ * replaces and obj_ht_delete() removes are returned once no obj_ht_get()
+ * can still find them, for the caller to free.
+ */
+typedef struct obj_ht_st OBJ_HT;
+typedef int OBJ_HT_CMP(const void *item, const void *key);
+
+OBJ_HT *obj_ht_new(void);
+void obj_ht_free(OBJ_HT *ht, void (*item_free)(void *));
+size_t obj_ht_num(const OBJ_HT *ht);
+void *obj_ht_get(OBJ_HT *ht, unsigned long hash, OBJ_HT_CMP *cmp,
+                 const void *key);
+int obj_ht_insert(OBJ_HT *ht, unsigned long hash, void *item,
+                  OBJ_HT_CMP *cmp, void **replaced);
+void *obj_ht_delete(OBJ_HT *ht, unsigned long hash, OBJ_HT_CMP *cmp,
+                    const void *key);
+void obj_ht_doall(OBJ_HT *ht, void (*fn)(void *item, void *arg), void *arg);
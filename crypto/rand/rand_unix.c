@@ -267,9 +267,9 @@ int syscall_random(void *buf, size_t buflen)
      * We could cache the result of the lookup, but we normally don't
      * call this function often.
      */
-    ERR_set_mark();
+    ERR_suppress_start();
     p_getentropy.p = DSO_global_lookup("getentropy");
-    ERR_pop_to_mark();
+    ERR_suppress_end();
     if (p_getentropy.p != NULL)
         return p_getentropy.f(buf, buflen) == 0 ? buflen : 0;
 #  endif
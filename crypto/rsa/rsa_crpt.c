@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2017 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -9,8 +9,10 @@
 
 #include <stdio.h>
 #include <openssl/crypto.h>
-#include "internal/cryptlib.h"
+#include "internal/cryptlib_int.h"
+#include "internal/thread_once.h"
 #include "internal/bn_int.h"
+#include "internal/rsa_int.h"
 #include <openssl/rand.h>
 #include "rsa_locl.h"
 
@@ -167,3 +169,203 @@ BN_BLINDING *RSA_setup_blinding(RSA *rsa, BN_CTX *in_ctx)
 
     return ret;
 }
+
+/*
+ * Per-thread blinding.
+ *
+ * Each thread keeps a small cache of BN_BLINDING objects keyed by the
+ * blinding id of the RSA key they were created for, so that private key
+ * operations on a key shared between threads need no locking.  Entries are
+ * created lazily and evicted round-robin.
+ *
+ * Entries are reference counted: the cache holds one reference, and every
+ * operation between rsa_get_thread_blinding() and rsa_put_thread_blinding()
+ * holds another.  An ASYNC job paused in between, possibly to be resumed on
+ * another thread, therefore keeps its blinding even when it is evicted or
+ * the thread's cache is freed at thread stop.  Such a job only ever calls
+ * BN_BLINDING_invert_ex() with its own unblinding factor, which reads
+ * nothing that later conversions on the owning thread change.
+ */
+
+#define RSA_BLINDING_CACHE_SIZE 8
+
+struct rsa_blinding_cache_entry_st {
+    uint64_t id;
+    BN_BLINDING *blinding;
+    CRYPTO_REF_COUNT references;
+};
+
+typedef struct {
+    RSA_BLINDING_CACHE_ENTRY *entries[RSA_BLINDING_CACHE_SIZE];
+    size_t next;
+} RSA_BLINDING_CACHE;
+
+static CRYPTO_ONCE rsa_blinding_init = CRYPTO_ONCE_STATIC_INIT;
+static int rsa_blinding_inited = 0;
+static CRYPTO_THREAD_LOCAL rsa_blinding_cache;
+/* Guards the id counter and the entry references without atomics */
+static CRYPTO_RWLOCK *rsa_blinding_lock = NULL;
+static uint64_t rsa_blinding_last_id = 0;
+
+DEFINE_RUN_ONCE_STATIC(do_rsa_blinding_init)
+{
+    /*
+     * ensure that libcrypto is initialized, otherwise the thread local
+     * cache is not cleaned up properly
+     */
+    if (!OPENSSL_init_crypto(0, NULL))
+        return 0;
+
+    rsa_blinding_lock = CRYPTO_THREAD_lock_new();
+    if (rsa_blinding_lock == NULL)
+        return 0;
+
+    if (!CRYPTO_THREAD_init_local(&rsa_blinding_cache, NULL)) {
+        CRYPTO_THREAD_lock_free(rsa_blinding_lock);
+        rsa_blinding_lock = NULL;
+        return 0;
+    }
+
+    rsa_blinding_inited = 1;
+    return 1;
+}
+
+void rsa_cleanup_int(void)
+{
+    if (rsa_blinding_inited) {
+        CRYPTO_THREAD_cleanup_local(&rsa_blinding_cache);
+        CRYPTO_THREAD_lock_free(rsa_blinding_lock);
+        rsa_blinding_lock = NULL;
+        rsa_blinding_inited = 0;
+    }
+}
+
+static void rsa_blinding_entry_free(RSA_BLINDING_CACHE_ENTRY *entry)
+{
+    int i;
+
+    if (entry == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&entry->references, &i, rsa_blinding_lock);
+    REF_ASSERT_ISNT(i < 0);
+    if (i > 0)
+        return;
+
+    BN_BLINDING_free(entry->blinding);
+    OPENSSL_free(entry);
+}
+
+void rsa_blinding_delete_thread_state(void)
+{
+    RSA_BLINDING_CACHE *cache;
+    size_t i;
+
+    if (!rsa_blinding_inited)
+        return;
+
+    cache = CRYPTO_THREAD_get_local(&rsa_blinding_cache);
+    CRYPTO_THREAD_set_local(&rsa_blinding_cache, NULL);
+    if (cache == NULL)
+        return;
+
+    for (i = 0; i < RSA_BLINDING_CACHE_SIZE; i++)
+        rsa_blinding_entry_free(cache->entries[i]);
+    OPENSSL_free(cache);
+}
+
+/*
+ * Give |rsa| a new blinding id, invalidating any blinding cached for it.
+ * Ids are never reused, and 0 is never assigned.  This runs for every new
+ * key, so the lock is only taken where there is no 64-bit atomic add.
+ */
+int rsa_blinding_new_id(RSA *rsa)
+{
+    if (!RUN_ONCE(&rsa_blinding_init, do_rsa_blinding_init))
+        return 0;
+
+#if defined(__GNUC__) && defined(__ATOMIC_RELAXED)
+    if (__atomic_is_lock_free(sizeof(rsa_blinding_last_id),
+                              &rsa_blinding_last_id)) {
+        rsa->blinding_id = __atomic_add_fetch(&rsa_blinding_last_id, 1,
+                                              __ATOMIC_RELAXED);
+        return 1;
+    }
+#endif
+    if (!CRYPTO_THREAD_write_lock(rsa_blinding_lock))
+        return 0;
+    rsa->blinding_id = ++rsa_blinding_last_id;
+    CRYPTO_THREAD_unlock(rsa_blinding_lock);
+    return 1;
+}
+
+/*
+ * Return the blinding to use for one private key operation with |rsa|.
+ * This is the key's own blinding if one was set with RSA_blinding_on(),
+ * in which case |*entry| is set to NULL and the blinding is shared, so
+ * that conversions must be done under BN_BLINDING_lock().  Otherwise it
+ * is the calling thread's blinding for |rsa|, created if needed, and
+ * |*entry| must be handed back with rsa_put_thread_blinding() once the
+ * result has been unblinded.
+ */
+BN_BLINDING *rsa_get_thread_blinding(RSA *rsa, BN_CTX *ctx,
+                                     RSA_BLINDING_CACHE_ENTRY **entry)
+{
+    RSA_BLINDING_CACHE *cache;
+    RSA_BLINDING_CACHE_ENTRY *e;
+    size_t i;
+    int refs;
+
+    *entry = NULL;
+    if (rsa->blinding != NULL)
+        return rsa->blinding;
+
+    if (!RUN_ONCE(&rsa_blinding_init, do_rsa_blinding_init))
+        return NULL;
+
+    cache = CRYPTO_THREAD_get_local(&rsa_blinding_cache);
+    if (cache == NULL) {
+        if (!ossl_init_thread_start(OPENSSL_INIT_THREAD_RSA))
+            return NULL;
+        if ((cache = OPENSSL_zalloc(sizeof(*cache))) == NULL)
+            return NULL;
+        if (!CRYPTO_THREAD_set_local(&rsa_blinding_cache, cache)) {
+            OPENSSL_free(cache);
+            return NULL;
+        }
+    }
+
+    for (i = 0; i < RSA_BLINDING_CACHE_SIZE; i++) {
+        e = cache->entries[i];
+        if (e != NULL && e->id == rsa->blinding_id) {
+            CRYPTO_UP_REF(&e->references, &refs, rsa_blinding_lock);
+            *entry = e;
+            return e->blinding;
+        }
+    }
+
+    if ((e = OPENSSL_zalloc(sizeof(*e))) == NULL)
+        return NULL;
+    if ((e->blinding = RSA_setup_blinding(rsa, ctx)) == NULL) {
+        OPENSSL_free(e);
+        return NULL;
+    }
+    e->id = rsa->blinding_id;
+    /* One for the cache, one for the caller */
+    e->references = 2;
+
+    rsa_blinding_entry_free(cache->entries[cache->next]);
+    cache->entries[cache->next] = e;
+    cache->next = (cache->next + 1) % RSA_BLINDING_CACHE_SIZE;
+    *entry = e;
+    return e->blinding;
+}
+
+/*
+ * Release an |entry| returned by rsa_get_thread_blinding().  This need not
+ * happen on the thread that got it.
+ */
+void rsa_put_thread_blinding(RSA_BLINDING_CACHE_ENTRY *entry)
+{
+    rsa_blinding_entry_free(entry);
+}
@@ -64,6 +64,13 @@ RSA *RSA_new_method(ENGINE *engine)
         return NULL;
     }
 
+    if (!rsa_blinding_new_id(ret)) {
+        RSAerr(RSA_F_RSA_NEW_METHOD, ERR_R_INIT_FAIL);
+        CRYPTO_THREAD_lock_free(ret->lock);
+        OPENSSL_free(ret);
+        return NULL;
+    }
+
     ret->meth = RSA_get_default_method();
 #ifndef OPENSSL_NO_ENGINE
     ret->flags = ret->meth->flags & ~RSA_FLAG_NON_FIPS_ALLOW;
@@ -136,7 +143,6 @@ void RSA_free(RSA *r)
     RSA_PSS_PARAMS_free(r->pss);
     sk_RSA_PRIME_INFO_pop_free(r->prime_infos, rsa_multip_info_free);
     BN_BLINDING_free(r->blinding);
-    BN_BLINDING_free(r->mt_blinding);
     OPENSSL_free(r->bignum_data);
     OPENSSL_free(r);
 }
@@ -187,6 +193,9 @@ int RSA_set0_key(RSA *r, BIGNUM *n, BIGNUM *e, BIGNUM *d)
         || (r->e == NULL && e == NULL))
         return 0;
 
+    if ((n != NULL || e != NULL) && !rsa_blinding_new_id(r))
+        return 0;
+
     if (n != NULL) {
         BN_free(r->n);
         r->n = n;
@@ -61,7 +61,12 @@ struct rsa_st {
      */
     char *bignum_data;
     BN_BLINDING *blinding;
-    BN_BLINDING *mt_blinding;
+    /*
+     * Identifies this key in the per-thread blinding caches. A new value is
+     * assigned whenever the public key changes, so that cached blindings
+     * for the old key (or for a freed key at the same address) are not used.
+     */
+    uint64_t blinding_id;
     CRYPTO_RWLOCK *lock;
 };
 
@@ -130,3 +135,9 @@ void rsa_multip_info_free(RSA_PRIME_INFO *pinfo);
 RSA_PRIME_INFO *rsa_multip_info_new(void);
 int rsa_multip_calc_product(RSA *rsa);
 int rsa_multip_cap(int bits);
+
+int rsa_blinding_new_id(RSA *rsa);
+typedef struct rsa_blinding_cache_entry_st RSA_BLINDING_CACHE_ENTRY;
+BN_BLINDING *rsa_get_thread_blinding(RSA *rsa, BN_CTX *ctx,
+                                     RSA_BLINDING_CACHE_ENTRY **entry);
+void rsa_put_thread_blinding(RSA_BLINDING_CACHE_ENTRY *entry);
@@ -154,81 +154,25 @@ static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
     return r;
 }
 
-static BN_BLINDING *rsa_get_blinding(RSA *rsa, int *local, BN_CTX *ctx)
+/*
+ * A blinding set with RSA_blinding_on() is shared by every thread using the
+ * key, so its conversions have to be serialised.  A per-thread one is not.
+ */
+static int rsa_blinding_convert(BN_BLINDING *b, int shared, BIGNUM *f,
+                                BIGNUM *unblind, BN_CTX *ctx)
 {
-    BN_BLINDING *ret;
-
-    CRYPTO_THREAD_write_lock(rsa->lock);
-
-    if (rsa->blinding == NULL) {
-        rsa->blinding = RSA_setup_blinding(rsa, ctx);
-    }
-
-    ret = rsa->blinding;
-    if (ret == NULL)
-        goto err;
-
-    if (BN_BLINDING_is_current_thread(ret)) {
-        /* rsa->blinding is ours! */
-
-        *local = 1;
-    } else {
-        /* resort to rsa->mt_blinding instead */
+    int ret;
 
-        /*
-         * instructs rsa_blinding_convert(), rsa_blinding_invert() that the
-         * BN_BLINDING is shared, meaning that accesses require locks, and
-         * that the blinding factor must be stored outside the BN_BLINDING
-         */
-        *local = 0;
+    if (!shared)
+        return BN_BLINDING_convert_ex(f, unblind, b, ctx);
 
-        if (rsa->mt_blinding == NULL) {
-            rsa->mt_blinding = RSA_setup_blinding(rsa, ctx);
-        }
-        ret = rsa->mt_blinding;
-    }
+    BN_BLINDING_lock(b);
+    ret = BN_BLINDING_convert_ex(f, unblind, b, ctx);
+    BN_BLINDING_unlock(b);
 
- err:
-    CRYPTO_THREAD_unlock(rsa->lock);
     return ret;
 }
 
-static int rsa_blinding_convert(BN_BLINDING *b, BIGNUM *f, BIGNUM *unblind,
-                                BN_CTX *ctx)
-{
-    if (unblind == NULL) {
-        /*
-         * Local blinding: store the unblinding factor in BN_BLINDING.
-         */
-        return BN_BLINDING_convert_ex(f, NULL, b, ctx);
-    } else {
-        /*
-         * Shared blinding: store the unblinding factor outside BN_BLINDING.
-         */
-        int ret;
-
-        BN_BLINDING_lock(b);
-        ret = BN_BLINDING_convert_ex(f, unblind, b, ctx);
-        BN_BLINDING_unlock(b);
-
-        return ret;
-    }
-}
-
-static int rsa_blinding_invert(BN_BLINDING *b, BIGNUM *f, BIGNUM *unblind,
-                               BN_CTX *ctx)
-{
-    /*
-     * For local blinding, unblind is set to NULL, and BN_BLINDING_invert_ex
-     * will use the unblinding factor stored in BN_BLINDING. If BN_BLINDING
-     * is shared between threads, unblind must be non-null:
-     * BN_BLINDING_invert_ex will then use the local unblinding factor, and
-     * will only read the modulus from BN_BLINDING. In both cases it's safe
-     * to access the blinding without a lock.
-     */
-    return BN_BLINDING_invert_ex(f, unblind, b, ctx);
-}
-
 /* signing */
 static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
                                    unsigned char *to, RSA *rsa, int padding)
@@ -237,14 +181,15 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
     int i, num = 0, r = -1;
     unsigned char *buf = NULL;
     BN_CTX *ctx = NULL;
-    int local_blinding = 0;
     /*
-     * Used only if the blinding structure is shared. A non-NULL unblind
-     * instructs rsa_blinding_convert() and rsa_blinding_invert() to store
-     * the unblinding factor outside the blinding structure.
+     * The blinding normally belongs to the calling thread, so it is used
+     * without locking.  The unblinding factor is still kept outside of it, in
+     * |unblind|, so that it cannot be replaced by another operation run on
+     * this thread while an ASYNC job is paused.
      */
     BIGNUM *unblind = NULL;
     BN_BLINDING *blinding = NULL;
+    RSA_BLINDING_CACHE_ENTRY *entry = NULL;
 
     if ((ctx = BN_CTX_new()) == NULL)
         goto err;
@@ -287,19 +232,16 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
     }
 
     if (!(rsa->flags & RSA_FLAG_NO_BLINDING)) {
-        blinding = rsa_get_blinding(rsa, &local_blinding, ctx);
+        blinding = rsa_get_thread_blinding(rsa, ctx, &entry);
         if (blinding == NULL) {
             RSAerr(RSA_F_RSA_OSSL_PRIVATE_ENCRYPT, ERR_R_INTERNAL_ERROR);
             goto err;
         }
-    }
-
-    if (blinding != NULL) {
-        if (!local_blinding && ((unblind = BN_CTX_get(ctx)) == NULL)) {
+        if ((unblind = BN_CTX_get(ctx)) == NULL) {
             RSAerr(RSA_F_RSA_OSSL_PRIVATE_ENCRYPT, ERR_R_MALLOC_FAILURE);
             goto err;
         }
-        if (!rsa_blinding_convert(blinding, f, unblind, ctx))
+        if (!rsa_blinding_convert(blinding, entry == NULL, f, unblind, ctx))
             goto err;
     }
 
@@ -335,7 +277,7 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
     }
 
     if (blinding)
-        if (!rsa_blinding_invert(blinding, ret, unblind, ctx))
+        if (!BN_BLINDING_invert_ex(ret, unblind, blinding, ctx))
             goto err;
 
     if (padding == RSA_X931_PADDING) {
@@ -354,6 +296,7 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
      */
     r = BN_bn2binpad(res, to, num);
  err:
+    rsa_put_thread_blinding(entry);
     if (ctx != NULL)
         BN_CTX_end(ctx);
     BN_CTX_free(ctx);
@@ -368,14 +311,15 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
     int j, num = 0, r = -1;
     unsigned char *buf = NULL;
     BN_CTX *ctx = NULL;
-    int local_blinding = 0;
     /*
-     * Used only if the blinding structure is shared. A non-NULL unblind
-     * instructs rsa_blinding_convert() and rsa_blinding_invert() to store
-     * the unblinding factor outside the blinding structure.
+     * The blinding normally belongs to the calling thread, so it is used
+     * without locking.  The unblinding factor is still kept outside of it, in
+     * |unblind|, so that it cannot be replaced by another operation run on
+     * this thread while an ASYNC job is paused.
      */
     BIGNUM *unblind = NULL;
     BN_BLINDING *blinding = NULL;
+    RSA_BLINDING_CACHE_ENTRY *entry = NULL;
 
     if ((ctx = BN_CTX_new()) == NULL)
         goto err;
@@ -410,19 +354,16 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
     }
 
     if (!(rsa->flags & RSA_FLAG_NO_BLINDING)) {
-        blinding = rsa_get_blinding(rsa, &local_blinding, ctx);
+        blinding = rsa_get_thread_blinding(rsa, ctx, &entry);
         if (blinding == NULL) {
             RSAerr(RSA_F_RSA_OSSL_PRIVATE_DECRYPT, ERR_R_INTERNAL_ERROR);
             goto err;
         }
-    }
-
-    if (blinding != NULL) {
-        if (!local_blinding && ((unblind = BN_CTX_get(ctx)) == NULL)) {
+        if ((unblind = BN_CTX_get(ctx)) == NULL) {
             RSAerr(RSA_F_RSA_OSSL_PRIVATE_DECRYPT, ERR_R_MALLOC_FAILURE);
             goto err;
         }
-        if (!rsa_blinding_convert(blinding, f, unblind, ctx))
+        if (!rsa_blinding_convert(blinding, entry == NULL, f, unblind, ctx))
             goto err;
     }
 
@@ -458,7 +399,7 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
     }
 
     if (blinding)
-        if (!rsa_blinding_invert(blinding, ret, unblind, ctx))
+        if (!BN_BLINDING_invert_ex(ret, unblind, blinding, ctx))
             goto err;
 
     j = BN_bn2binpad(ret, buf, num);
@@ -484,6 +425,7 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
         RSAerr(RSA_F_RSA_OSSL_PRIVATE_DECRYPT, RSA_R_PADDING_CHECK_FAILED);
 
  err:
+    rsa_put_thread_blinding(entry);
     if (ctx != NULL)
         BN_CTX_end(ctx);
     BN_CTX_free(ctx);
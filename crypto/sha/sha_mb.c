@@ -0,0 +1,247 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * One-shot hashing of many independent messages.  Where the multi-block
+ * SHA-1 and SHA-256 assembly modules are available, the messages are
+ * scheduled across their 8 lanes; otherwise they are hashed one at a time.
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+#include "internal/nelem.h"
+#include "internal/sha.h"
+
+#if defined(SHA1_ASM) && defined(SHA256_ASM) && !defined(__ILP32__) && \
+    (defined(__x86_64) || defined(_M_AMD64) || defined(_M_X64))
+# define SHA_MULTI_BLOCK_ASM
+#endif
+
+#ifdef SHA_MULTI_BLOCK_ASM
+
+# define SHA_MB_LANES   8
+/* Upper bound on the number of blocks passed in one call */
+# define SHA_MB_CHUNK   (1 << 16)
+
+/*
+ * The assembly modules keep the state of lane i in word i of each of
+ * their A[8], B[8], ... rows, so both contexts are simply arrays of rows.
+ */
+typedef unsigned int SHA_MB_ROW[SHA_MB_LANES];
+
+typedef struct {
+    const unsigned char *ptr;
+    int blocks;
+} HASH_DESC;
+
+void sha1_multi_block(SHA_MB_ROW *ctx, const HASH_DESC *desc, int n4x);
+void sha256_multi_block(SHA_MB_ROW *ctx, const HASH_DESC *desc, int n4x);
+
+typedef void (*sha_mb_block_fn) (SHA_MB_ROW *ctx, const HASH_DESC *desc,
+                                 int n4x);
+
+typedef struct {
+    size_t msg;                 /* index of the message in this lane */
+    const unsigned char *ptr;   /* next block to hash */
+    size_t blocks;              /* blocks left at |ptr| */
+    int tail_pending;           /* |tail| is still to be hashed */
+    size_t tail_blocks;
+    unsigned char tail[2 * SHA_CBLOCK];
+} SHA_MB_LANE;
+
+static const unsigned int sha1_iv[] = {
+    0x67452301U, 0xefcdab89U, 0x98badcfeU, 0x10325476U, 0xc3d2e1f0U
+};
+
+static const unsigned int sha224_iv[] = {
+    0xc1059ed8U, 0x367cd507U, 0x3070dd17U, 0xf70e5939U,
+    0xffc00b31U, 0x68581511U, 0x64f98fa7U, 0xbefa4fa4U
+};
+
+static const unsigned int sha256_iv[] = {
+    0x6a09e667U, 0xbb67ae85U, 0x3c6ef372U, 0xa54ff53aU,
+    0x510e527fU, 0x9b05688cU, 0x1f83d9abU, 0x5be0cd19U
+};
+
+static void sha_mb_lane_start(SHA_MB_LANE *lane, SHA_MB_ROW *ctx, int i,
+                              const unsigned int *iv, size_t nwords,
+                              size_t msg, const unsigned char *data,
+                              size_t len)
+{
+    size_t full = len / SHA_CBLOCK, rem = len % SHA_CBLOCK, w;
+    unsigned char *p;
+    uint64_t bits = (uint64_t)len << 3;
+
+    for (w = 0; w < nwords; w++)
+        ctx[w][i] = iv[w];
+
+    memset(lane->tail, 0, sizeof(lane->tail));
+    if (rem > 0)
+        memcpy(lane->tail, data + full * SHA_CBLOCK, rem);
+    lane->tail[rem] = 0x80;
+    lane->tail_blocks = rem < SHA_CBLOCK - 8 ? 1 : 2;
+    p = lane->tail + lane->tail_blocks * SHA_CBLOCK - 8;
+    for (w = 0; w < 8; w++)
+        p[w] = (unsigned char)(bits >> (56 - 8 * w));
+
+    lane->msg = msg;
+    if (full > 0) {
+        lane->ptr = data;
+        lane->blocks = full;
+        lane->tail_pending = 1;
+    } else {
+        lane->ptr = lane->tail;
+        lane->blocks = lane->tail_blocks;
+        lane->tail_pending = 0;
+    }
+}
+
+/*
+ * The assembly processes the lanes in groups of two (SHA extensions) or
+ * four and stops at the first group that has no work, so busy lanes are
+ * always kept packed at the bottom.
+ */
+static void sha_mb_lane_move(SHA_MB_LANE *lane, SHA_MB_ROW *ctx,
+                             size_t nwords, int to, int from)
+{
+    size_t w;
+
+    for (w = 0; w < nwords; w++)
+        ctx[w][to] = ctx[w][from];
+    /* Once the tail is being hashed |ptr| points into the lane itself */
+    if (!lane[from].tail_pending)
+        lane[from].ptr = lane[to].tail + (lane[from].ptr - lane[from].tail);
+    lane[to] = lane[from];
+}
+
+static void sha_mb_digest(sha_mb_block_fn block, const unsigned int *iv,
+                          size_t nwords, size_t mdlen,
+                          const unsigned char *const data[],
+                          const size_t len[], unsigned char *const md[],
+                          size_t num)
+{
+    unsigned char storage[sizeof(SHA_MB_ROW) * 8 + 32];
+    SHA_MB_ROW *ctx;
+    HASH_DESC desc[SHA_MB_LANES];
+    SHA_MB_LANE lane[SHA_MB_LANES];
+    size_t next = 0, chunk, w;
+    int busy = 0, i;
+
+    ctx = (SHA_MB_ROW *)(storage + 32 - ((size_t)storage % 32)); /* align */
+    memset(desc, 0, sizeof(desc));
+
+    for (;;) {
+        /* Refill idle lanes and find how far all busy lanes can advance */
+        for (; busy < SHA_MB_LANES && next < num; busy++, next++)
+            sha_mb_lane_start(&lane[busy], ctx, busy, iv, nwords, next,
+                              data[next], len[next]);
+        if (busy == 0)
+            break;
+
+        chunk = SHA_MB_CHUNK;
+        for (i = 0; i < busy; i++)
+            if (lane[i].blocks < chunk)
+                chunk = lane[i].blocks;
+        for (i = 0; i < SHA_MB_LANES; i++) {
+            desc[i].ptr = i < busy ? lane[i].ptr : NULL;
+            desc[i].blocks = i < busy ? (int)chunk : 0;
+        }
+        block(ctx, desc, busy > 4 ? 2 : 1);
+
+        for (i = 0; i < busy; ) {
+            lane[i].ptr += chunk * SHA_CBLOCK;
+            lane[i].blocks -= chunk;
+            if (lane[i].blocks > 0) {
+                i++;
+                continue;
+            }
+            if (lane[i].tail_pending) {
+                lane[i].ptr = lane[i].tail;
+                lane[i].blocks = lane[i].tail_blocks;
+                lane[i].tail_pending = 0;
+                i++;
+                continue;
+            }
+            for (w = 0; w < mdlen / 4; w++) {
+                unsigned char *out = md[lane[i].msg] + 4 * w;
+                unsigned int v = ctx[w][i];
+
+                out[0] = (unsigned char)(v >> 24);
+                out[1] = (unsigned char)(v >> 16);
+                out[2] = (unsigned char)(v >> 8);
+                out[3] = (unsigned char)(v);
+            }
+            /* The last busy lane, not yet advanced, takes this one's place */
+            if (i != --busy)
+                sha_mb_lane_move(lane, ctx, nwords, i, busy);
+        }
+    }
+
+    OPENSSL_cleanse(lane, sizeof(lane));
+    OPENSSL_cleanse(storage, sizeof(storage));
+}
+
+int sha1_multi(const unsigned char *const data[], const size_t len[],
+               unsigned char *const md[], size_t num)
+{
+    sha_mb_digest(sha1_multi_block, sha1_iv, OSSL_NELEM(sha1_iv),
+                  SHA_DIGEST_LENGTH, data, len, md, num);
+    return 1;
+}
+
+int sha224_multi(const unsigned char *const data[], const size_t len[],
+                 unsigned char *const md[], size_t num)
+{
+    sha_mb_digest(sha256_multi_block, sha224_iv, OSSL_NELEM(sha224_iv),
+                  SHA224_DIGEST_LENGTH, data, len, md, num);
+    return 1;
+}
+
+int sha256_multi(const unsigned char *const data[], const size_t len[],
+                 unsigned char *const md[], size_t num)
+{
+    sha_mb_digest(sha256_multi_block, sha256_iv, OSSL_NELEM(sha256_iv),
+                  SHA256_DIGEST_LENGTH, data, len, md, num);
+    return 1;
+}
+
+#else
+
+int sha1_multi(const unsigned char *const data[], const size_t len[],
+               unsigned char *const md[], size_t num)
+{
+    size_t i;
+
+    for (i = 0; i < num; i++)
+        SHA1(data[i], len[i], md[i]);
+    return 1;
+}
+
+int sha224_multi(const unsigned char *const data[], const size_t len[],
+                 unsigned char *const md[], size_t num)
+{
+    size_t i;
+
+    for (i = 0; i < num; i++)
+        SHA224(data[i], len[i], md[i]);
+    return 1;
+}
+
+int sha256_multi(const unsigned char *const data[], const size_t len[],
+                 unsigned char *const md[], size_t num)
+{
+    size_t i;
+
+    for (i = 0; i < num; i++)
+        SHA256(data[i], len[i], md[i]);
+    return 1;
+}
+
+#endif
@@ -16,32 +16,53 @@
 #include <openssl/e_os2.h>      /* For ossl_inline */
 
 /*
- * The initial number of nodes in the array.
+ * The initial number of nodes in the array, which is part of the stack
+ * itself, so that most stacks are a single allocation.
  */
-static const int min_nodes = 4;
+#define SK_SMALL_NODES  4
+
+static const int min_nodes = SK_SMALL_NODES;
 static const int max_nodes = SIZE_MAX / sizeof(void *) < INT_MAX
                              ? (int)(SIZE_MAX / sizeof(void *))
                              : INT_MAX;
 
+/*
+ * Up to this many nodes added after the sorted ones are put in place one by
+ * one, more are sorted on their own and merged with the sorted ones.
+ */
+#define SK_INSERT_NODES 8
+
 struct stack_st {
     int num;
     const void **data;
     int sorted;
+    int num_sorted;             /* |data[0 .. num_sorted - 1]| are in order */
     int num_alloc;
     OPENSSL_sk_compfunc comp;
+    const void *small[SK_SMALL_NODES];
 };
 
 OPENSSL_sk_compfunc OPENSSL_sk_set_cmp_func(OPENSSL_STACK *sk, OPENSSL_sk_compfunc c)
 {
     OPENSSL_sk_compfunc old = sk->comp;
 
-    if (sk->comp != c)
+    if (sk->comp != c) {
         sk->sorted = 0;
+        sk->num_sorted = 0;
+    }
     sk->comp = c;
 
     return old;
 }
 
+/* Point |st->data| at the nodes within |st|, which must be unused */
+static ossl_inline void sk_use_small(OPENSSL_STACK *st)
+{
+    memset(st->small, 0, sizeof(st->small));
+    st->data = st->small;
+    st->num_alloc = SK_SMALL_NODES;
+}
+
 OPENSSL_STACK *OPENSSL_sk_dup(const OPENSSL_STACK *sk)
 {
     OPENSSL_STACK *ret;
@@ -54,10 +75,9 @@ OPENSSL_STACK *OPENSSL_sk_dup(const OPENSSL_STACK *sk)
     /* direct structure assignment */
     *ret = *sk;
 
-    if (sk->num == 0) {
-        /* postpone |ret->data| allocation */
-        ret->data = NULL;
-        ret->num_alloc = 0;
+    if (sk->num <= SK_SMALL_NODES) {
+        sk_use_small(ret);
+        memcpy(ret->small, sk->data, sizeof(void *) * sk->num);
         return ret;
     }
     /* duplicate |sk->data| content */
@@ -66,6 +86,7 @@ OPENSSL_STACK *OPENSSL_sk_dup(const OPENSSL_STACK *sk)
     memcpy(ret->data, sk->data, sizeof(void *) * sk->num);
     return ret;
  err:
+    sk_use_small(ret);
     OPENSSL_sk_free(ret);
     return NULL;
 }
@@ -85,18 +106,14 @@ OPENSSL_STACK *OPENSSL_sk_deep_copy(const OPENSSL_STACK *sk,
     /* direct structure assignment */
     *ret = *sk;
 
-    if (sk->num == 0) {
-        /* postpone |ret| data allocation */
-        ret->data = NULL;
-        ret->num_alloc = 0;
-        return ret;
-    }
-
-    ret->num_alloc = sk->num > min_nodes ? sk->num : min_nodes;
-    ret->data = OPENSSL_zalloc(sizeof(*ret->data) * ret->num_alloc);
-    if (ret->data == NULL) {
-        OPENSSL_free(ret);
-        return NULL;
+    sk_use_small(ret);
+    if (sk->num > SK_SMALL_NODES) {
+        ret->num_alloc = sk->num;
+        ret->data = OPENSSL_zalloc(sizeof(*ret->data) * ret->num_alloc);
+        if (ret->data == NULL) {
+            OPENSSL_free(ret);
+            return NULL;
+        }
     }
 
     for (i = 0; i < ret->num; ++i) {
@@ -171,16 +188,20 @@ static int sk_reserve(OPENSSL_STACK *st, int n, int exact)
     if (num_alloc < min_nodes)
         num_alloc = min_nodes;
 
-    /* If |st->data| allocation was postponed */
-    if (st->data == NULL) {
-        /*
-         * At this point, |st->num_alloc| and |st->num| are 0;
-         * so |num_alloc| value is |n| or |min_nodes| if greater than |n|.
-         */
-        if ((st->data = OPENSSL_zalloc(sizeof(void *) * num_alloc)) == NULL) {
+    /* If the nodes within |st| are still used, they can't be resized */
+    if (st->data == st->small) {
+        if (num_alloc <= SK_SMALL_NODES)
+            return 1;
+        if (!exact)
+            num_alloc = compute_growth(num_alloc, st->num_alloc);
+        if (num_alloc == 0
+                || (tmpdata = OPENSSL_malloc(sizeof(void *) * num_alloc))
+                   == NULL) {
             CRYPTOerr(CRYPTO_F_SK_RESERVE, ERR_R_MALLOC_FAILURE);
             return 0;
         }
+        memcpy(tmpdata, st->small, sizeof(void *) * st->num);
+        st->data = tmpdata;
         st->num_alloc = num_alloc;
         return 1;
     }
@@ -212,6 +233,8 @@ OPENSSL_STACK *OPENSSL_sk_new_reserve(OPENSSL_sk_compfunc c, int n)
         return NULL;
 
     st->comp = c;
+    st->data = st->small;
+    st->num_alloc = SK_SMALL_NODES;
 
     if (n <= 0)
         return st;
@@ -248,6 +271,9 @@ int OPENSSL_sk_insert(OPENSSL_STACK *st, const void *data, int loc)
         memmove(&st->data[loc + 1], &st->data[loc],
                 sizeof(st->data[0]) * (st->num - loc));
         st->data[loc] = data;
+        /* The nodes before |loc| are still in order */
+        if (st->num_sorted > loc)
+            st->num_sorted = loc;
     }
     st->num++;
     st->sorted = 0;
@@ -262,10 +288,58 @@ static ossl_inline void *internal_delete(OPENSSL_STACK *st, int loc)
          memmove(&st->data[loc], &st->data[loc + 1],
                  sizeof(st->data[0]) * (st->num - loc - 1));
     st->num--;
+    if (loc < st->num_sorted)
+        st->num_sorted--;
 
     return (void *)ret;
 }
 
+/* Put the nodes after the first |st->num_sorted| in order with them */
+static void sk_sort_int(OPENSSL_STACK *st)
+{
+    const void **data = st->data, *tmp, **tail;
+    int n = st->num_sorted, k = st->num - n, lo, hi, mid, i, j;
+
+    /*
+     * If there are too few nodes in order to make a difference, or no room
+     * for merging, sort the whole stack.
+     */
+    if (k > SK_INSERT_NODES
+            && (k > n || (tail = OPENSSL_malloc(sizeof(*tail) * k)) == NULL)) {
+        qsort(data, st->num, sizeof(void *), st->comp);
+    } else if (k > SK_INSERT_NODES) {
+        /* Sort the new ones and merge from the end, where there is room */
+        qsort(data + n, k, sizeof(void *), st->comp);
+        memcpy(tail, data + n, sizeof(*tail) * k);
+        for (i = n - 1, j = k - 1; j >= 0; ) {
+            if (i >= 0 && st->comp(&data[i], &tail[j]) > 0) {
+                data[i + j + 1] = data[i];
+                i--;
+            } else {
+                data[i + j + 1] = tail[j];
+                j--;
+            }
+        }
+        OPENSSL_free(tail);
+    } else {
+        /* Binary insertion of each new one after those that compare equal */
+        for (; n < st->num; n++) {
+            tmp = data[n];
+            for (lo = 0, hi = n; lo < hi; ) {
+                mid = lo + (hi - lo) / 2;
+                if (st->comp(&data[mid], &tmp) > 0)
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            memmove(&data[lo + 1], &data[lo], sizeof(void *) * (n - lo));
+            data[lo] = tmp;
+        }
+    }
+    st->num_sorted = st->num;
+    st->sorted = 1;
+}
+
 void *OPENSSL_sk_delete_ptr(OPENSSL_STACK *st, const void *p)
 {
     int i;
@@ -300,11 +374,8 @@ static int internal_find(OPENSSL_STACK *st, const void *data,
         return -1;
     }
 
-    if (!st->sorted) {
-        if (st->num > 1)
-            qsort(st->data, st->num, sizeof(void *), st->comp);
-        st->sorted = 1; /* empty or single-element stack is considered sorted */
-    }
+    if (!st->sorted)
+        sk_sort_int(st);
     if (data == NULL)
         return -1;
     r = OBJ_bsearch_ex_(&data, st->data, st->num, sizeof(void *), st->comp,
@@ -355,6 +426,7 @@ void OPENSSL_sk_zero(OPENSSL_STACK *st)
         return;
     memset(st->data, 0, sizeof(*st->data) * st->num);
     st->num = 0;
+    st->num_sorted = 0;
 }
 
 void OPENSSL_sk_pop_free(OPENSSL_STACK *st, OPENSSL_sk_freefunc func)
@@ -373,7 +445,8 @@ void OPENSSL_sk_free(OPENSSL_STACK *st)
 {
     if (st == NULL)
         return;
-    OPENSSL_free(st->data);
+    if (st->data != st->small)
+        OPENSSL_free(st->data);
     OPENSSL_free(st);
 }
 
@@ -395,16 +468,15 @@ void *OPENSSL_sk_set(OPENSSL_STACK *st, int i, const void *data)
         return NULL;
     st->data[i] = data;
     st->sorted = 0;
+    if (st->num_sorted > i)
+        st->num_sorted = i;
     return (void *)st->data[i];
 }
 
 void OPENSSL_sk_sort(OPENSSL_STACK *st)
 {
-    if (st != NULL && !st->sorted && st->comp != NULL) {
-        if (st->num > 1)
-            qsort(st->data, st->num, sizeof(void *), st->comp);
-        st->sorted = 1; /* empty or single-element stack is considered sorted */
-    }
+    if (st != NULL && !st->sorted && st->comp != NULL)
+        sk_sort_int(st);
 }
 
 int OPENSSL_sk_is_sorted(const OPENSSL_STACK *st)
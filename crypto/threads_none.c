@@ -145,4 +145,10 @@ int openssl_init_fork_handlers(void)
     return 0;
 }
 
+int openssl_run_parallel(void (*worker)(void *), void *arg, int nthreads)
+{
+    worker(arg);
+    return 1;
+}
+
 #endif
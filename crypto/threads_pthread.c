@@ -231,4 +231,44 @@ int openssl_init_fork_handlers(void)
 # endif
     return 0;
 }
+
+typedef struct {
+    void (*worker)(void *);
+    void *arg;
+} PARALLEL_JOB;
+
+static void *parallel_start(void *job)
+{
+    ((PARALLEL_JOB *)job)->worker(((PARALLEL_JOB *)job)->arg);
+    return NULL;
+}
+
+/*
+ * Run |worker| on up to |nthreads| threads, the calling one included, and
+ * wait for all of them to return.  Threads that can't be created are
+ * simply not used, so the worker must pull its work from |arg| rather
+ * than assume a fixed share.  Returns the number of threads that ran.
+ */
+int openssl_run_parallel(void (*worker)(void *), void *arg, int nthreads)
+{
+    PARALLEL_JOB job;
+    pthread_t *tid = NULL;
+    int i, started = 0;
+
+    job.worker = worker;
+    job.arg = arg;
+    if (nthreads > 1
+            && (tid = OPENSSL_malloc(sizeof(*tid) * (nthreads - 1))) != NULL) {
+        for (; started < nthreads - 1; started++)
+            if (pthread_create(&tid[started], NULL, parallel_start, &job) != 0)
+                break;
+    }
+
+    worker(arg);
+
+    for (i = 0; i < started; i++)
+        pthread_join(tid[i], NULL);
+    OPENSSL_free(tid);
+    return started + 1;
+}
 #endif
@@ -172,4 +172,41 @@ int openssl_init_fork_handlers(void)
     return 0;
 }
 
+typedef struct {
+    void (*worker)(void *);
+    void *arg;
+} PARALLEL_JOB;
+
+static DWORD WINAPI parallel_start(LPVOID job)
+{
+    ((PARALLEL_JOB *)job)->worker(((PARALLEL_JOB *)job)->arg);
+    return 0;
+}
+
+int openssl_run_parallel(void (*worker)(void *), void *arg, int nthreads)
+{
+    PARALLEL_JOB job;
+    HANDLE *thr = NULL;
+    int i, started = 0;
+
+    job.worker = worker;
+    job.arg = arg;
+    if (nthreads > 1
+            && (thr = OPENSSL_malloc(sizeof(*thr) * (nthreads - 1))) != NULL) {
+        for (; started < nthreads - 1; started++)
+            if ((thr[started] = CreateThread(NULL, 0, parallel_start, &job,
+                                             0, NULL)) == NULL)
+                break;
+    }
+
+    worker(arg);
+
+    for (i = 0; i < started; i++) {
+        WaitForSingleObject(thr[i], INFINITE);
+        CloseHandle(thr[i]);
+    }
+    OPENSSL_free(thr);
+    return started + 1;
+}
+
 #endif
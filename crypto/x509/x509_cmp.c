@@ -171,6 +171,10 @@ int X509_NAME_cmp(const X509_NAME *a, const X509_NAME *b)
             return -2;
     }
 
+    if (!x509_name_lazy_canon((X509_NAME *)a)
+            || !x509_name_lazy_canon((X509_NAME *)b))
+        return -2;
+
     ret = a->canon_enclen - b->canon_enclen;
 
     if (ret != 0 || a->canon_enclen == 0)
@@ -187,6 +191,8 @@ unsigned long X509_NAME_hash(X509_NAME *x)
 
     /* Make sure X509_NAME structure contains valid cached encoding */
     i2d_X509_NAME(x, NULL);
+    if (!x509_name_lazy_canon(x))
+        return 0;
     if (!EVP_Digest(x->canon_enc, x->canon_enclen, md, NULL, EVP_sha1(),
                     NULL))
         return 0;
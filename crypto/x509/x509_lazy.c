@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/cryptlib.h"
+#include "internal/thread_once.h"
+#include <openssl/x509.h>
+#include "internal/x509_int.h"
+
+/*
+ * Parts of a structure decoded with ASN1_D2I_LAZY are filled in on first
+ * use, possibly by several threads at once. Each of them computes the value
+ * without any lock held and the first one to take this lock stores it, the
+ * others discarding their copy. One lock is shared by all structures: it is
+ * only held for a couple of stores and taken at most once per field.
+ *
+ * Each such field comes with a flag that is set while the field is still
+ * to be filled in. The flag is cleared after the field is stored, and read
+ * with acquire semantics before the field is, so that a thread that finds
+ * it cleared also sees the stored field. Where there are no atomics the
+ * flag is read under the lock instead.
+ */
+
+static CRYPTO_ONCE x509_lazy_init = CRYPTO_ONCE_STATIC_INIT;
+static CRYPTO_RWLOCK *x509_lazy_lck = NULL;
+
+DEFINE_RUN_ONCE_STATIC(do_x509_lazy_init)
+{
+    x509_lazy_lck = CRYPTO_THREAD_lock_new();
+    return x509_lazy_lck != NULL;
+}
+
+int x509_lazy_lock(void)
+{
+    if (!RUN_ONCE(&x509_lazy_init, do_x509_lazy_init))
+        return 0;
+    return CRYPTO_THREAD_write_lock(x509_lazy_lck);
+}
+
+void x509_lazy_unlock(void)
+{
+    CRYPTO_THREAD_unlock(x509_lazy_lck);
+}
+
+/* Whether the field that |*pending| belongs to is still to be filled in */
+int x509_lazy_pending(const int *pending)
+{
+#if defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+    return __atomic_load_n(pending, __ATOMIC_ACQUIRE);
+#else
+    int ret;
+
+    if (!RUN_ONCE(&x509_lazy_init, do_x509_lazy_init)
+            || !CRYPTO_THREAD_read_lock(x509_lazy_lck))
+        return 1;
+    ret = *pending;
+    CRYPTO_THREAD_unlock(x509_lazy_lck);
+    return ret;
+#endif
+}
+
+/* Mark the field filled in, must be called with the lock held */
+void x509_lazy_done(int *pending)
+{
+#if defined(__GNUC__) && defined(__ATOMIC_RELEASE)
+    __atomic_store_n(pending, 0, __ATOMIC_RELEASE);
+#else
+    *pending = 0;
+#endif
+}
+
+void x509_lazy_cleanup_int(void)
+{
+    CRYPTO_THREAD_lock_free(x509_lazy_lck);
+    x509_lazy_lck = NULL;
+}
@@ -68,13 +68,13 @@ char *X509_NAME_oneline(const X509_NAME *a, char *buf, int len)
         }
         l1 = strlen(s);
 
-        type = ne->value->type;
-        num = ne->value->length;
+        type = ne->value.type;
+        num = ne->value.length;
         if (num > NAME_ONELINE_MAX) {
             X509err(X509_F_X509_NAME_ONELINE, X509_R_NAME_TOO_LONG);
             goto end;
         }
-        q = ne->value->data;
+        q = ne->value.data;
 #ifdef CHARSET_EBCDIC
         if (type == V_ASN1_GENERALSTRING ||
             type == V_ASN1_VISIBLESTRING ||
@@ -137,7 +137,7 @@ char *X509_NAME_oneline(const X509_NAME *a, char *buf, int len)
         *(p++) = '=';
 
 #ifndef CHARSET_EBCDIC          /* q was assigned above already. */
-        q = ne->value->data;
+        q = ne->value.data;
 #endif
 
         for (j = 0; j < num; j++) {
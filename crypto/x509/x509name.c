@@ -316,24 +316,26 @@ int X509_NAME_ENTRY_set_object(X509_NAME_ENTRY *ne, const ASN1_OBJECT *obj)
 int X509_NAME_ENTRY_set_data(X509_NAME_ENTRY *ne, int type,
                              const unsigned char *bytes, int len)
 {
+    ASN1_STRING *value;
     int i;
 
     if ((ne == NULL) || ((bytes == NULL) && (len != 0)))
         return 0;
+    value = &ne->value;
     if ((type > 0) && (type & MBSTRING_FLAG))
-        return ASN1_STRING_set_by_NID(&ne->value, bytes,
+        return ASN1_STRING_set_by_NID(&value, bytes,
                                       len, type,
                                       OBJ_obj2nid(ne->object)) ? 1 : 0;
     if (len < 0)
         len = strlen((const char *)bytes);
-    i = ASN1_STRING_set(ne->value, bytes, len);
+    i = ASN1_STRING_set(value, bytes, len);
     if (!i)
         return 0;
     if (type != V_ASN1_UNDEF) {
         if (type == V_ASN1_APP_CHOOSE)
-            ne->value->type = ASN1_PRINTABLE_type(bytes, len);
+            value->type = ASN1_PRINTABLE_type(bytes, len);
         else
-            ne->value->type = type;
+            value->type = type;
     }
     return 1;
 }
@@ -349,7 +351,7 @@ ASN1_STRING *X509_NAME_ENTRY_get_data(const X509_NAME_ENTRY *ne)
 {
     if (ne == NULL)
         return NULL;
-    return ne->value;
+    return (ASN1_STRING *)&ne->value;
 }
 
 int X509_NAME_ENTRY_set(const X509_NAME_ENTRY *ne)
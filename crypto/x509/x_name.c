@@ -45,7 +45,7 @@ static int x509_name_ex_print(BIO *out, ASN1_VALUE **pval,
 
 ASN1_SEQUENCE(X509_NAME_ENTRY) = {
         ASN1_SIMPLE(X509_NAME_ENTRY, object, ASN1_OBJECT),
-        ASN1_SIMPLE(X509_NAME_ENTRY, value, ASN1_PRINTABLE)
+        ASN1_EMBED(X509_NAME_ENTRY, value, ASN1_PRINTABLE)
 } ASN1_SEQUENCE_END(X509_NAME_ENTRY)
 
 IMPLEMENT_ASN1_FUNCTIONS(X509_NAME_ENTRY)
@@ -168,10 +168,23 @@ static int x509_name_ex_d2i(ASN1_VALUE **val,
     if (ret <= 0)
         return ret;
 
-    if (*val)
-        x509_name_ex_free(val, NULL);
-    if (!x509_name_ex_new(&nm.a, NULL))
+    if (*val != NULL) {
+        /*
+         * Decode into the name created along with the parent structure
+         * rather than freeing it and allocating another one.
+         */
+        nm.a = *val;
+        *val = NULL;
+        while ((entry = sk_X509_NAME_ENTRY_pop(nm.x->entries)) != NULL)
+            X509_NAME_ENTRY_free(entry);
+        OPENSSL_free(nm.x->canon_enc);
+        nm.x->canon_enc = NULL;
+        nm.x->canon_enclen = 0;
+        nm.x->canon_lazy = 0;
+        nm.x->modified = 1;
+    } else if (!x509_name_ex_new(&nm.a, NULL)) {
         goto err;
+    }
     /* We've decoded it: now cache encoding */
     if (!BUF_MEM_grow(nm.x->bytes, p - q))
         goto err;
@@ -188,9 +201,15 @@ static int x509_name_ex_d2i(ASN1_VALUE **val,
             sk_X509_NAME_ENTRY_set(entries, j, NULL);
         }
     }
-    ret = x509_name_canon(nm.x);
-    if (!ret)
-        goto err;
+    if ((asn1_d2i_flags(ctx) & ASN1_D2I_LAZY) != 0) {
+        /* Left to x509_name_lazy_canon() */
+        nm.x->canon_lazy = 1;
+        ret = 1;
+    } else {
+        ret = x509_name_canon(nm.x);
+        if (!ret)
+            goto err;
+    }
     sk_STACK_OF_X509_NAME_ENTRY_pop_free(intname.s,
                                          local_sk_X509_NAME_ENTRY_free);
     nm.x->modified = 0;
@@ -297,7 +316,8 @@ static int x509_name_ex_print(BIO *out, ASN1_VALUE **pval,
  * constraints of type dirName can also be checked with a simple memcmp().
  */
 
-static int x509_name_canon(X509_NAME *a)
+static int x509_name_canon_enc(const X509_NAME *a, unsigned char **penc,
+                               int *plen)
 {
     unsigned char *p;
     STACK_OF(STACK_OF_X509_NAME_ENTRY) *intname;
@@ -305,11 +325,9 @@ static int x509_name_canon(X509_NAME *a)
     X509_NAME_ENTRY *entry, *tmpentry = NULL;
     int i, set = -1, ret = 0, len;
 
-    OPENSSL_free(a->canon_enc);
-    a->canon_enc = NULL;
     /* Special case: empty X509_NAME => null encoding */
     if (sk_X509_NAME_ENTRY_num(a->entries) == 0) {
-        a->canon_enclen = 0;
+        *plen = 0;
         return 1;
     }
     intname = sk_STACK_OF_X509_NAME_ENTRY_new_null();
@@ -340,7 +358,7 @@ static int x509_name_canon(X509_NAME *a)
             X509err(X509_F_X509_NAME_CANON, ERR_R_MALLOC_FAILURE);
             goto err;
         }
-        if (!asn1_string_canon(tmpentry->value, entry->value))
+        if (!asn1_string_canon(&tmpentry->value, &entry->value))
             goto err;
         if (!sk_X509_NAME_ENTRY_push(entries, tmpentry)) {
             X509err(X509_F_X509_NAME_CANON, ERR_R_MALLOC_FAILURE);
@@ -353,15 +371,15 @@ static int x509_name_canon(X509_NAME *a)
     len = i2d_name_canon(intname, NULL);
     if (len < 0)
         goto err;
-    a->canon_enclen = len;
+    *plen = len;
 
-    p = OPENSSL_malloc(a->canon_enclen);
+    p = OPENSSL_malloc(len);
     if (p == NULL) {
         X509err(X509_F_X509_NAME_CANON, ERR_R_MALLOC_FAILURE);
         goto err;
     }
 
-    a->canon_enc = p;
+    *penc = p;
 
     i2d_name_canon(intname, &p);
 
@@ -374,6 +392,45 @@ static int x509_name_canon(X509_NAME *a)
     return ret;
 }
 
+static int x509_name_canon(X509_NAME *a)
+{
+    OPENSSL_free(a->canon_enc);
+    a->canon_enc = NULL;
+    a->canon_lazy = 0;
+    return x509_name_canon_enc(a, &a->canon_enc, &a->canon_enclen);
+}
+
+/*
+ * Names decoded with ASN1_D2I_LAZY get their canonical encoding on first
+ * use. It is computed outside any lock, concurrent callers racing to store
+ * it under the lock, and |canon_lazy| is only cleared once it is stored.
+ */
+
+int x509_name_lazy_canon(X509_NAME *a)
+{
+    unsigned char *enc = NULL;
+    int enclen;
+
+    if (!x509_lazy_pending(&a->canon_lazy))
+        return 1;
+    if (!x509_name_canon_enc(a, &enc, &enclen))
+        return 0;
+    if (!x509_lazy_lock()) {
+        X509err(X509_F_X509_NAME_CANON, ERR_R_MALLOC_FAILURE);
+        OPENSSL_free(enc);
+        return 0;
+    }
+    if (a->canon_lazy) {
+        a->canon_enc = enc;
+        a->canon_enclen = enclen;
+        x509_lazy_done(&a->canon_lazy);
+        enc = NULL;
+    }
+    x509_lazy_unlock();
+    OPENSSL_free(enc);
+    return 1;
+}
+
 /* Bitmap of all the types of string that will be canonicalized. */
 
 #define ASN1_MASK_CANON \
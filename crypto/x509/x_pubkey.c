@@ -18,9 +18,10 @@
 #include <openssl/dsa.h>
 
 struct X509_pubkey_st {
-    X509_ALGOR *algor;
-    ASN1_BIT_STRING *public_key;
+    X509_ALGOR algor;
+    ASN1_BIT_STRING public_key;
     EVP_PKEY *pkey;
+    int lazy;                   /* pkey not decoded yet */
 };
 
 static int x509_pubkey_decode(EVP_PKEY **pk, X509_PUBKEY *key);
@@ -36,6 +37,11 @@ static int pubkey_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         /* Attempt to decode public key and cache in pubkey structure. */
         X509_PUBKEY *pubkey = (X509_PUBKEY *)*pval;
         EVP_PKEY_free(pubkey->pkey);
+        pubkey->pkey = NULL;
+        /* Leave it to X509_PUBKEY_get0() if the caller asked for that */
+        pubkey->lazy = (asn1_d2i_flags(exarg) & ASN1_D2I_LAZY) != 0;
+        if (pubkey->lazy)
+            return 1;
         /*
          * Opportunistically decode the key but remove any non fatal errors
          * from the queue. Subsequent explicit attempts to decode/use the key
@@ -50,8 +56,8 @@ static int pubkey_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
 }
 
 ASN1_SEQUENCE_cb(X509_PUBKEY, pubkey_cb) = {
-        ASN1_SIMPLE(X509_PUBKEY, algor, X509_ALGOR),
-        ASN1_SIMPLE(X509_PUBKEY, public_key, ASN1_BIT_STRING)
+        ASN1_EMBED(X509_PUBKEY, algor, X509_ALGOR),
+        ASN1_EMBED(X509_PUBKEY, public_key, ASN1_BIT_STRING)
 } ASN1_SEQUENCE_END_cb(X509_PUBKEY, X509_PUBKEY)
 
 IMPLEMENT_ASN1_FUNCTIONS(X509_PUBKEY)
@@ -109,7 +115,7 @@ static int x509_pubkey_decode(EVP_PKEY **ppkey, X509_PUBKEY *key)
         return -1;
     }
 
-    if (!EVP_PKEY_set_type(pkey, OBJ_obj2nid(key->algor->algorithm))) {
+    if (!EVP_PKEY_set_type(pkey, OBJ_obj2nid(key->algor.algorithm))) {
         X509err(X509_F_X509_PUBKEY_DECODE, X509_R_UNSUPPORTED_ALGORITHM);
         goto error;
     }
@@ -141,9 +147,32 @@ EVP_PKEY *X509_PUBKEY_get0(X509_PUBKEY *key)
 {
     EVP_PKEY *ret = NULL;
 
-    if (key == NULL || key->public_key == NULL)
+    if (key == NULL)
         return NULL;
 
+    /*
+     * A key decoded with ASN1_D2I_LAZY is decoded here the first time it
+     * is asked for, and cached if no other thread did so meanwhile.
+     * |key->pkey| may only be looked at once |key->lazy| reads as 0.
+     */
+    if (x509_lazy_pending(&key->lazy)) {
+        if (x509_pubkey_decode(&ret, key) <= 0)
+            return NULL;
+        if (!x509_lazy_lock()) {
+            X509err(X509_F_X509_PUBKEY_GET0, ERR_R_MALLOC_FAILURE);
+            EVP_PKEY_free(ret);
+            return NULL;
+        }
+        if (key->lazy) {
+            key->pkey = ret;
+            ret = NULL;
+            x509_lazy_done(&key->lazy);
+        }
+        x509_lazy_unlock();
+        EVP_PKEY_free(ret);
+        return key->pkey;
+    }
+
     if (key->pkey != NULL)
         return key->pkey;
 
@@ -338,15 +367,15 @@ int X509_PUBKEY_set0_param(X509_PUBKEY *pub, ASN1_OBJECT *aobj,
                            int ptype, void *pval,
                            unsigned char *penc, int penclen)
 {
-    if (!X509_ALGOR_set0(pub->algor, aobj, ptype, pval))
+    if (!X509_ALGOR_set0(&pub->algor, aobj, ptype, pval))
         return 0;
     if (penc) {
-        OPENSSL_free(pub->public_key->data);
-        pub->public_key->data = penc;
-        pub->public_key->length = penclen;
+        OPENSSL_free(pub->public_key.data);
+        pub->public_key.data = penc;
+        pub->public_key.length = penclen;
         /* Set number of unused bits to zero */
-        pub->public_key->flags &= ~(ASN1_STRING_FLAG_BITS_LEFT | 0x07);
-        pub->public_key->flags |= ASN1_STRING_FLAG_BITS_LEFT;
+        pub->public_key.flags &= ~(ASN1_STRING_FLAG_BITS_LEFT | 0x07);
+        pub->public_key.flags |= ASN1_STRING_FLAG_BITS_LEFT;
     }
     return 1;
 }
@@ -356,13 +385,13 @@ int X509_PUBKEY_get0_param(ASN1_OBJECT **ppkalg,
                            X509_ALGOR **pa, X509_PUBKEY *pub)
 {
     if (ppkalg)
-        *ppkalg = pub->algor->algorithm;
+        *ppkalg = pub->algor.algorithm;
     if (pk) {
-        *pk = pub->public_key->data;
-        *ppklen = pub->public_key->length;
+        *pk = pub->public_key.data;
+        *ppklen = pub->public_key.length;
     }
     if (pa)
-        *pa = pub->algor;
+        *pa = &pub->algor;
     return 1;
 }
 
@@ -370,5 +399,5 @@ ASN1_BIT_STRING *X509_get0_pubkey_bitstr(const X509 *x)
 {
     if (x == NULL)
         return NULL;
-    return x->cert_info.key->public_key;
+    return &x->cert_info.key->public_key;
 }
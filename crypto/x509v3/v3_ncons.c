@@ -525,6 +525,8 @@ static int nc_dn(X509_NAME *nm, X509_NAME *base)
         return X509_V_ERR_OUT_OF_MEM;
     if (base->modified && i2d_X509_NAME(base, NULL) < 0)
         return X509_V_ERR_OUT_OF_MEM;
+    if (!x509_name_lazy_canon(nm) || !x509_name_lazy_canon(base))
+        return X509_V_ERR_UNSPECIFIED;
     if (base->canon_enclen > nm->canon_enclen)
         return X509_V_ERR_PERMITTED_VIOLATION;
     if (memcmp(base->canon_enc, nm->canon_enc, base->canon_enclen))
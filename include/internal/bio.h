@@ -22,6 +22,7 @@ struct bio_method_st {
     int (*create) (BIO *);
     int (*destroy) (BIO *);
     long (*callback_ctrl) (BIO *, int, BIO_info_cb *);
+    int (*bwritev) (BIO *, const BIO_IOVEC *, size_t, size_t *);
 };
 
 void bio_free_ex_data(BIO *bio);
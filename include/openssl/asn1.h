@@ -807,6 +807,13 @@ ASN1_VALUE *ASN1_item_new(const ASN1_ITEM *it);
 void ASN1_item_free(ASN1_VALUE *val, const ASN1_ITEM *it);
 ASN1_VALUE *ASN1_item_d2i(ASN1_VALUE **val, const unsigned char **in,
                           long len, const ASN1_ITEM *it);
+
+/* Defer decoding of public keys and canonical names until first use */
+# define ASN1_D2I_LAZY           0x1
+
+ASN1_VALUE *ASN1_item_d2i_flags(ASN1_VALUE **val, const unsigned char **in,
+                                long len, const ASN1_ITEM *it,
+                                unsigned long flags);
 int ASN1_item_i2d(ASN1_VALUE *val, unsigned char **out, const ASN1_ITEM *it);
 int ASN1_item_ndef_i2d(ASN1_VALUE *val, unsigned char **out,
                        const ASN1_ITEM *it);
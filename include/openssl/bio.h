@@ -252,6 +252,12 @@ void BIO_set_callback_arg(BIO *b, char *arg);
 
 typedef struct bio_method_st BIO_METHOD;
 
+/* One element of a gathered write, see BIO_writev() */
+typedef struct bio_iovec_st {
+    const void *base;
+    size_t len;
+} BIO_IOVEC;
+
 const char *BIO_method_name(const BIO *b);
 int BIO_method_type(const BIO *b);
 
@@ -564,6 +570,7 @@ int BIO_read_ex(BIO *b, void *data, size_t dlen, size_t *readbytes);
 int BIO_gets(BIO *bp, char *buf, int size);
 int BIO_write(BIO *b, const void *data, int dlen);
 int BIO_write_ex(BIO *b, const void *data, size_t dlen, size_t *written);
+int BIO_writev(BIO *b, const BIO_IOVEC *iov, size_t iovcnt, size_t *written);
 int BIO_puts(BIO *bp, const char *buf);
 int BIO_indent(BIO *b, int indent, int max);
 long BIO_ctrl(BIO *bp, int cmd, long larg, void *parg);
@@ -773,6 +780,11 @@ int BIO_meth_set_write(BIO_METHOD *biom,
                        int (*write) (BIO *, const char *, int));
 int BIO_meth_set_write_ex(BIO_METHOD *biom,
                        int (*bwrite) (BIO *, const char *, size_t, size_t *));
+int (*BIO_meth_get_writev(const BIO_METHOD *biom)) (BIO *, const BIO_IOVEC *,
+                                                     size_t, size_t *);
+int BIO_meth_set_writev(BIO_METHOD *biom,
+                        int (*bwritev) (BIO *, const BIO_IOVEC *, size_t,
+                                        size_t *));
 int (*BIO_meth_get_read(const BIO_METHOD *biom)) (BIO *, char *, int);
 int (*BIO_meth_get_read_ex(const BIO_METHOD *biom)) (BIO *, char *, size_t, size_t *);
 int BIO_meth_set_read(BIO_METHOD *biom,
@@ -282,6 +282,7 @@ void *CRYPTO_clear_realloc(void *addr, size_t old_num, size_t num,
                            const char *file, int line);
 
 int CRYPTO_secure_malloc_init(size_t sz, int minsize);
+int CRYPTO_secure_malloc_init_ex(size_t sz, int minsize, int arenas);
 int CRYPTO_secure_malloc_done(void);
 void *CRYPTO_secure_malloc(size_t num, const char *file, int line);
 void *CRYPTO_secure_zalloc(size_t num, const char *file, int line);
@@ -295,6 +296,15 @@ size_t CRYPTO_secure_used(void);
 
 void OPENSSL_cleanse(void *ptr, size_t len);
 
+int CRYPTO_mem_acct_enable(int sample_rate);
+int CRYPTO_mem_acct_get(int lib, size_t *live_bytes, size_t *live_num,
+                        size_t *peak_bytes, size_t *num_allocs);
+void CRYPTO_mem_acct_reset(void);
+int CRYPTO_mem_acct_report(BIO *b);
+# ifndef OPENSSL_NO_STDIO
+int CRYPTO_mem_acct_report_fp(FILE *fp);
+# endif
+
 # ifndef OPENSSL_NO_CRYPTO_MDEBUG
 #  define OPENSSL_mem_debug_push(info) \
         CRYPTO_mem_debug_push(info, OPENSSL_FILE, OPENSSL_LINE)
@@ -78,6 +78,11 @@ const EC_METHOD *EC_GFp_nistp224_method(void);
  */
 const EC_METHOD *EC_GFp_nistp256_method(void);
 
+/** Returns 64-bit optimized methods for nistp384
+ *  \return  EC_METHOD object
+ */
+const EC_METHOD *EC_GFp_nistp384_method(void);
+
 /** Returns 64-bit optimized methods for nistp521
  *  \return  EC_METHOD object
  */
@@ -1119,6 +1124,22 @@ ECDSA_SIG *ECDSA_do_sign_ex(const unsigned char *dgst, int dgstlen,
 int ECDSA_do_verify(const unsigned char *dgst, int dgst_len,
                     const ECDSA_SIG *sig, EC_KEY *eckey);
 
+/** Verifies a number of ECDSA signatures, sharing the work of verifying
+ *  signatures with keys on the same curve.
+ *  \param  dgst      array of pointers to the hash values
+ *  \param  dgst_len  array of the lengths of the hash values
+ *  \param  sig       array of ECDSA_SIG structures
+ *  \param  eckey     array of EC_KEY objects containing public EC keys
+ *  \param  num       number of signatures
+ *  \param  results   array receiving the result of ECDSA_do_verify for each
+ *                    signature
+ *  \return 1 if all signatures are valid, 0 if a signature is invalid
+ *          and -1 on error
+ */
+int ECDSA_do_verify_batch(const unsigned char *const dgst[],
+                          const int dgst_len[], const ECDSA_SIG *const sig[],
+                          EC_KEY *const eckey[], size_t num, int results[]);
+
 /** Precompute parts of the signing operation
  *  \param  eckey  EC_KEY object containing a private EC key
  *  \param  ctx    BN_CTX object (optional)
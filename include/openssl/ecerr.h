@@ -84,6 +84,9 @@ int ERR_load_EC_strings(void);
 #  define EC_F_EC_GFP_NISTP256_GROUP_SET_CURVE             230
 #  define EC_F_EC_GFP_NISTP256_POINTS_MUL                  231
 #  define EC_F_EC_GFP_NISTP256_POINT_GET_AFFINE_COORDINATES 232
+#  define EC_F_EC_GFP_NISTP384_GROUP_SET_CURVE             292
+#  define EC_F_EC_GFP_NISTP384_POINTS_MUL                  293
+#  define EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES 294
 #  define EC_F_EC_GFP_NISTP521_GROUP_SET_CURVE             233
 #  define EC_F_EC_GFP_NISTP521_POINTS_MUL                  234
 #  define EC_F_EC_GFP_NISTP521_POINT_GET_AFFINE_COORDINATES 235
@@ -169,11 +172,13 @@ int ERR_load_EC_strings(void);
 #  define EC_F_I2O_ECPUBLICKEY                             151
 #  define EC_F_NISTP224_PRE_COMP_NEW                       227
 #  define EC_F_NISTP256_PRE_COMP_NEW                       236
+#  define EC_F_NISTP384_PRE_COMP_NEW                       295
 #  define EC_F_NISTP521_PRE_COMP_NEW                       237
 #  define EC_F_O2I_ECPUBLICKEY                             152
 #  define EC_F_OLD_EC_PRIV_DECODE                          222
 #  define EC_F_OSSL_ECDH_COMPUTE_KEY                       247
 #  define EC_F_OSSL_ECDSA_SIGN_SIG                         249
+#  define EC_F_OSSL_ECDSA_VERIFY_BATCH_SIG                 291
 #  define EC_F_OSSL_ECDSA_VERIFY_SIG                       250
 #  define EC_F_PKEY_ECD_CTRL                               271
 #  define EC_F_PKEY_ECD_DIGESTSIGN                         272
@@ -252,6 +252,8 @@ void ERR_print_errors_fp(FILE *fp);
 void ERR_print_errors(BIO *bp);
 void ERR_add_error_data(int num, ...);
 void ERR_add_error_vdata(int num, va_list args);
+void ERR_add_error_data_deferred(const char *sep, char *(*format)(void *arg),
+                                 void *arg, void (*free_arg)(void *arg));
 int ERR_load_strings(int lib, ERR_STRING_DATA *str);
 int ERR_load_strings_const(const ERR_STRING_DATA *str);
 int ERR_unload_strings(int lib, ERR_STRING_DATA *str);
@@ -272,6 +274,8 @@ int ERR_get_next_error_library(void);
 int ERR_set_mark(void);
 int ERR_pop_to_mark(void);
 int ERR_clear_last_mark(void);
+int ERR_suppress_start(void);
+int ERR_suppress_end(void);
 
 #ifdef  __cplusplus
 }
@@ -194,6 +194,108 @@ void OPENSSL_LH_node_usage_stats_bio(const OPENSSL_LHASH *lh, BIO *out);
     } \
     LHASH_OF(type)
 
+/*
+ * An open addressing hash table with the same interface.  Declaring a
+ * type with DEFINE_OAHASH_OF() rather than DEFINE_LHASH_OF() moves its
+ * lh_<type>_* functions to it, callers are left as they are.
+ */
+
+typedef struct oahash_st OPENSSL_OAHASH;
+
+/* Spread the entries over tables with locks of their own */
+# define OPENSSL_OAH_CONCURRENT  0x1
+
+OPENSSL_OAHASH *OPENSSL_OAH_new(OPENSSL_LH_HASHFUNC h, OPENSSL_LH_COMPFUNC c,
+                                unsigned int flags);
+void OPENSSL_OAH_free(OPENSSL_OAHASH *oh);
+void *OPENSSL_OAH_insert(OPENSSL_OAHASH *oh, void *data);
+void *OPENSSL_OAH_delete(OPENSSL_OAHASH *oh, const void *data);
+void *OPENSSL_OAH_retrieve(OPENSSL_OAHASH *oh, const void *data);
+void OPENSSL_OAH_doall(OPENSSL_OAHASH *oh, OPENSSL_LH_DOALL_FUNC func);
+void OPENSSL_OAH_doall_arg(OPENSSL_OAHASH *oh, OPENSSL_LH_DOALL_FUNCARG func,
+                           void *arg);
+int OPENSSL_OAH_error(OPENSSL_OAHASH *oh);
+unsigned long OPENSSL_OAH_num_items(const OPENSSL_OAHASH *oh);
+unsigned long OPENSSL_OAH_get_down_load(const OPENSSL_OAHASH *oh);
+void OPENSSL_OAH_set_down_load(OPENSSL_OAHASH *oh, unsigned long down_load);
+void OPENSSL_OAH_stats_bio(const OPENSSL_OAHASH *oh, BIO *out);
+
+# define DEFINE_OAHASH_OF(type) \
+    LHASH_OF(type) { union lh_##type##_dummy { void* d1; unsigned long d2; int d3; } dummy; }; \
+    static ossl_inline LHASH_OF(type) * \
+        lh_##type##_new(unsigned long (*hfn)(const type *), \
+                        int (*cfn)(const type *, const type *)) \
+    { \
+        return (LHASH_OF(type) *) \
+            OPENSSL_OAH_new((OPENSSL_LH_HASHFUNC)hfn, (OPENSSL_LH_COMPFUNC)cfn, 0); \
+    } \
+    static ossl_inline LHASH_OF(type) * \
+        lh_##type##_new_concurrent(unsigned long (*hfn)(const type *), \
+                                   int (*cfn)(const type *, const type *)) \
+    { \
+        return (LHASH_OF(type) *) \
+            OPENSSL_OAH_new((OPENSSL_LH_HASHFUNC)hfn, (OPENSSL_LH_COMPFUNC)cfn, \
+                            OPENSSL_OAH_CONCURRENT); \
+    } \
+    static ossl_inline void lh_##type##_free(LHASH_OF(type) *lh) \
+    { \
+        OPENSSL_OAH_free((OPENSSL_OAHASH *)lh); \
+    } \
+    static ossl_inline type *lh_##type##_insert(LHASH_OF(type) *lh, type *d) \
+    { \
+        return (type *)OPENSSL_OAH_insert((OPENSSL_OAHASH *)lh, d); \
+    } \
+    static ossl_inline type *lh_##type##_delete(LHASH_OF(type) *lh, const type *d) \
+    { \
+        return (type *)OPENSSL_OAH_delete((OPENSSL_OAHASH *)lh, d); \
+    } \
+    static ossl_inline type *lh_##type##_retrieve(LHASH_OF(type) *lh, const type *d) \
+    { \
+        return (type *)OPENSSL_OAH_retrieve((OPENSSL_OAHASH *)lh, d); \
+    } \
+    static ossl_inline int lh_##type##_error(LHASH_OF(type) *lh) \
+    { \
+        return OPENSSL_OAH_error((OPENSSL_OAHASH *)lh); \
+    } \
+    static ossl_inline unsigned long lh_##type##_num_items(LHASH_OF(type) *lh) \
+    { \
+        return OPENSSL_OAH_num_items((OPENSSL_OAHASH *)lh); \
+    } \
+    static ossl_inline void lh_##type##_stats_bio(const LHASH_OF(type) *lh, BIO *out) \
+    { \
+        OPENSSL_OAH_stats_bio((const OPENSSL_OAHASH *)lh, out); \
+    } \
+    static ossl_inline unsigned long lh_##type##_get_down_load(LHASH_OF(type) *lh) \
+    { \
+        return OPENSSL_OAH_get_down_load((OPENSSL_OAHASH *)lh); \
+    } \
+    static ossl_inline void lh_##type##_set_down_load(LHASH_OF(type) *lh, unsigned long dl) \
+    { \
+        OPENSSL_OAH_set_down_load((OPENSSL_OAHASH *)lh, dl); \
+    } \
+    static ossl_inline void lh_##type##_doall(LHASH_OF(type) *lh, \
+                                         void (*doall)(type *)) \
+    { \
+        OPENSSL_OAH_doall((OPENSSL_OAHASH *)lh, (OPENSSL_LH_DOALL_FUNC)doall); \
+    } \
+    LHASH_OF(type)
+
+#define IMPLEMENT_OAHASH_DOALL_ARG_CONST(type, argtype) \
+    int_implement_oahash_doall(type, argtype, const type)
+
+#define IMPLEMENT_OAHASH_DOALL_ARG(type, argtype) \
+    int_implement_oahash_doall(type, argtype, type)
+
+#define int_implement_oahash_doall(type, argtype, cbargtype) \
+    static ossl_inline void \
+        lh_##type##_doall_##argtype(LHASH_OF(type) *lh, \
+                                   void (*fn)(cbargtype *, argtype *), \
+                                   argtype *arg) \
+    { \
+        OPENSSL_OAH_doall_arg((OPENSSL_OAHASH *)lh, (OPENSSL_LH_DOALL_FUNCARG)fn, (void *)arg); \
+    } \
+    LHASH_OF(type)
+
 DEFINE_LHASH_OF(OPENSSL_STRING);
 # ifdef _MSC_VER
 /*
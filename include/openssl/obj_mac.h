@@ -2115,6 +2115,14 @@
 #define NID_blake2s256          1057
 #define OBJ_blake2s256          1L,3L,6L,1L,4L,1L,1722L,12L,2L,2L,8L
 
+#define SN_blake2bp512          "BLAKE2bp512"
+#define LN_blake2bp512          "blake2bp512"
+#define NID_blake2bp512         1193
+
+#define SN_blake2sp256          "BLAKE2sp256"
+#define LN_blake2sp256          "blake2sp256"
+#define NID_blake2sp256         1194
+
 #define SN_sxnet                "SXNetID"
 #define LN_sxnet                "Strong Extranet ID"
 #define NID_sxnet               143
@@ -214,6 +214,7 @@ typedef struct ssl_session_st SSL_SESSION;
 typedef struct tls_sigalgs_st TLS_SIGALGS;
 typedef struct ssl_conf_ctx_st SSL_CONF_CTX;
 typedef struct ssl_comp_st SSL_COMP;
+typedef struct ssl_ticket_key_ring_st SSL_TICKET_KEY_RING;
 
 STACK_OF(SSL_CIPHER);
 STACK_OF(SSL_COMP);
@@ -493,6 +494,12 @@ typedef int (*SSL_verify_cb)(int preverify_ok, X509_STORE_CTX *x509_ctx);
  * Support Asynchronous operation
  */
 # define SSL_MODE_ASYNC 0x00000100U
+/*
+ * Lay out several application data records per SSL_write() call even when
+ * the cipher cannot encrypt them in parallel, and flush them to the
+ * transport with a single gathered write (see BIO_writev()).
+ */
+# define SSL_MODE_BATCH_WRITES 0x00000200U
 
 /* Cert related flags */
 /*
@@ -883,6 +890,7 @@ __owur int SSL_extension_supported(unsigned int ext_type);
 # define SSL_ASYNC_PAUSED       5
 # define SSL_ASYNC_NO_JOBS      6
 # define SSL_CLIENT_HELLO_CB    7
+# define SSL_PRIVATE_KEY_OPERATION 8
 
 /* These will only be used when doing non-blocking IO */
 # define SSL_want_nothing(s)         (SSL_want(s) == SSL_NOTHING)
@@ -892,6 +900,8 @@ __owur int SSL_extension_supported(unsigned int ext_type);
 # define SSL_want_async(s)           (SSL_want(s) == SSL_ASYNC_PAUSED)
 # define SSL_want_async_job(s)       (SSL_want(s) == SSL_ASYNC_NO_JOBS)
 # define SSL_want_client_hello_cb(s) (SSL_want(s) == SSL_CLIENT_HELLO_CB)
+# define SSL_want_private_key_operation(s) \
+        (SSL_want(s) == SSL_PRIVATE_KEY_OPERATION)
 
 # define SSL_MAC_FLAG_READ_MAC_STREAM 1
 # define SSL_MAC_FLAG_WRITE_MAC_STREAM 2
@@ -1177,6 +1187,7 @@ DECLARE_PEM_rw(SSL_SESSION, SSL_SESSION)
 # define SSL_ERROR_WANT_ASYNC            9
 # define SSL_ERROR_WANT_ASYNC_JOB       10
 # define SSL_ERROR_WANT_CLIENT_HELLO_CB 11
+# define SSL_ERROR_WANT_PRIVATE_KEY_OPERATION 12
 # define SSL_CTRL_SET_TMP_DH                     3
 # define SSL_CTRL_SET_TMP_ECDH                   4
 # define SSL_CTRL_SET_TMP_DH_CB                  6
@@ -1786,6 +1797,33 @@ int SSL_client_hello_get1_extensions_present(SSL *s, int **out, size_t *outlen);
 int SSL_client_hello_get0_ext(SSL *s, unsigned int type,
                               const unsigned char **out, size_t *outlen);
 
+/*
+ * Private key method: callbacks performing the operations with the private
+ * key of the certificate in use, possibly asynchronously.
+ */
+
+# define SSL_PRIVATE_KEY_SUCCESS 1
+# define SSL_PRIVATE_KEY_FAILURE 0
+# define SSL_PRIVATE_KEY_RETRY   (-1)
+
+typedef int (*SSL_private_key_sign_cb_fn) (SSL *s, unsigned char *out,
+                                           size_t *outlen, size_t maxout,
+                                           unsigned int sigalg,
+                                           const unsigned char *in,
+                                           size_t inlen, void *arg);
+typedef int (*SSL_private_key_decrypt_cb_fn) (SSL *s, unsigned char *out,
+                                              size_t *outlen, size_t maxout,
+                                              const unsigned char *in,
+                                              size_t inlen, void *arg);
+typedef int (*SSL_private_key_complete_cb_fn) (SSL *s, unsigned char *out,
+                                               size_t *outlen, size_t maxout,
+                                               void *arg);
+void SSL_CTX_set_private_key_method(SSL_CTX *ctx,
+                                    SSL_private_key_sign_cb_fn sign_cb,
+                                    SSL_private_key_decrypt_cb_fn decrypt_cb,
+                                    SSL_private_key_complete_cb_fn complete_cb,
+                                    void *arg);
+
 void SSL_certs_clear(SSL *s);
 void SSL_free(SSL *ssl);
 # ifdef OSSL_ASYNC_FD
@@ -2391,6 +2429,13 @@ int SSL_CTX_set_session_ticket_cb(SSL_CTX *ctx,
 int SSL_SESSION_set1_ticket_appdata(SSL_SESSION *ss, const void *data, size_t len);
 int SSL_SESSION_get0_ticket_appdata(SSL_SESSION *ss, void **data, size_t *len);
 
+SSL_TICKET_KEY_RING *SSL_TICKET_KEY_RING_new(size_t num_keys, long lifetime);
+int SSL_TICKET_KEY_RING_up_ref(SSL_TICKET_KEY_RING *ring);
+void SSL_TICKET_KEY_RING_free(SSL_TICKET_KEY_RING *ring);
+int SSL_TICKET_KEY_RING_rotate(SSL_TICKET_KEY_RING *ring);
+int SSL_CTX_set1_ticket_key_ring(SSL_CTX *ctx, SSL_TICKET_KEY_RING *ring);
+SSL_TICKET_KEY_RING *SSL_CTX_get0_ticket_key_ring(const SSL_CTX *ctx);
+
 extern const char SSL_version_str[];
 
 typedef unsigned int (*DTLS_timer_cb)(SSL *s, unsigned int timer_us);
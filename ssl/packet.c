@@ -87,14 +87,41 @@ static size_t maxmaxsize(size_t lenbytes)
     return ((size_t)1 << (lenbytes * 8)) - 1 + lenbytes;
 }
 
+/*
+ * Get a zeroed sub-packet to nest in the current one: the next one of the
+ * pool while the nesting is shallow enough, else an allocated one.
+ */
+static WPACKET_SUB *wpacket_sub_new(WPACKET *pkt)
+{
+    WPACKET_SUB *sub = pkt->subs;
+
+    if (sub == NULL)
+        sub = pkt->subpool;
+    else if (sub >= pkt->subpool
+             && sub < pkt->subpool + WPACKET_SUBPOOL_SIZE - 1)
+        sub++;
+    else
+        return OPENSSL_zalloc(sizeof(*sub));
+
+    memset(sub, 0, sizeof(*sub));
+    return sub;
+}
+
+static void wpacket_sub_free(WPACKET *pkt, WPACKET_SUB *sub)
+{
+    if (sub < pkt->subpool || sub >= pkt->subpool + WPACKET_SUBPOOL_SIZE)
+        OPENSSL_free(sub);
+}
+
 static int wpacket_intern_init_len(WPACKET *pkt, size_t lenbytes)
 {
     unsigned char *lenchars;
 
     pkt->curr = 0;
     pkt->written = 0;
+    pkt->subs = NULL;
 
-    if ((pkt->subs = OPENSSL_zalloc(sizeof(*pkt->subs))) == NULL) {
+    if ((pkt->subs = wpacket_sub_new(pkt)) == NULL) {
         SSLerr(SSL_F_WPACKET_INTERN_INIT_LEN, ERR_R_MALLOC_FAILURE);
         return 0;
     }
@@ -106,7 +133,7 @@ static int wpacket_intern_init_len(WPACKET *pkt, size_t lenbytes)
     pkt->subs->lenbytes = lenbytes;
 
     if (!WPACKET_allocate_bytes(pkt, lenbytes, &lenchars)) {
-        OPENSSL_free(pkt->subs);
+        wpacket_sub_free(pkt, pkt->subs);
         pkt->subs = NULL;
         return 0;
     }
@@ -216,7 +243,7 @@ static int wpacket_intern_close(WPACKET *pkt, WPACKET_SUB *sub, int doclose)
 
     if (doclose) {
         pkt->subs = sub->parent;
-        OPENSSL_free(sub);
+        wpacket_sub_free(pkt, sub);
     }
 
     return 1;
@@ -262,7 +289,7 @@ int WPACKET_finish(WPACKET *pkt)
 
     ret = wpacket_intern_close(pkt, pkt->subs, 1);
     if (ret) {
-        OPENSSL_free(pkt->subs);
+        wpacket_sub_free(pkt, pkt->subs);
         pkt->subs = NULL;
     }
 
@@ -278,7 +305,7 @@ int WPACKET_start_sub_packet_len__(WPACKET *pkt, size_t lenbytes)
     if (!ossl_assert(pkt->subs != NULL))
         return 0;
 
-    if ((sub = OPENSSL_zalloc(sizeof(*sub))) == NULL) {
+    if ((sub = wpacket_sub_new(pkt)) == NULL) {
         SSLerr(SSL_F_WPACKET_START_SUB_PACKET_LEN__, ERR_R_MALLOC_FAILURE);
         return 0;
     }
@@ -418,7 +445,7 @@ void WPACKET_cleanup(WPACKET *pkt)
 
     for (sub = pkt->subs; sub != NULL; sub = parent) {
         parent = sub->parent;
-        OPENSSL_free(sub);
+        wpacket_sub_free(pkt, sub);
     }
     pkt->subs = NULL;
 }
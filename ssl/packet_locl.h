@@ -616,6 +616,9 @@ struct wpacket_sub {
     unsigned int flags;
 };
 
+/* Enough for the nesting of all the handshake messages we construct */
+#define WPACKET_SUBPOOL_SIZE    8
+
 typedef struct wpacket_st WPACKET;
 struct wpacket_st {
     /* The buffer where we store the output data */
@@ -638,6 +641,12 @@ struct wpacket_st {
 
     /* Our sub-packets (always at least one if not finished) */
     WPACKET_SUB *subs;
+
+    /*
+     * The sub-packets nested no deeper than WPACKET_SUBPOOL_SIZE live here,
+     * so that they need no allocation of their own
+     */
+    WPACKET_SUB subpool[WPACKET_SUBPOOL_SIZE];
 };
 
 /* Flags */
@@ -94,8 +94,16 @@ int RECORD_LAYER_processed_read_pending(const RECORD_LAYER *rl)
 
 int RECORD_LAYER_write_pending(const RECORD_LAYER *rl)
 {
-    return (rl->numwpipes > 0)
-        && SSL3_BUFFER_get_left(&rl->wbuf[rl->numwpipes - 1]) != 0;
+    size_t i;
+
+    /*
+     * numwpipes is the most buffers ever set up, a write may have used
+     * fewer of them: any one of them can still hold data
+     */
+    for (i = 0; i < rl->numwpipes; i++)
+        if (SSL3_BUFFER_get_left(&rl->wbuf[i]) != 0)
+            return 1;
+    return 0;
 }
 
 void RECORD_LAYER_reset_read_sequence(RECORD_LAYER *rl)
@@ -567,8 +575,22 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, size_t len,
         || s->enc_write_ctx == NULL
         || !(EVP_CIPHER_flags(EVP_CIPHER_CTX_cipher(s->enc_write_ctx))
              & EVP_CIPH_FLAG_PIPELINE)
-        || !SSL_USE_EXPLICIT_IV(s))
-        maxpipes = 1;
+        || !SSL_USE_EXPLICIT_IV(s)) {
+        /*
+         * In batch mode we still lay out several records per call; they are
+         * encrypted one after the other in do_ssl3_write() and flushed
+         * together.
+         */
+        if ((s->mode & SSL_MODE_BATCH_WRITES) != 0
+                && type == SSL3_RT_APPLICATION_DATA
+                && s->enc_write_ctx != NULL
+                && n > max_send_fragment) {
+            if (maxpipes <= 1)
+                maxpipes = SSL3_DEFAULT_BATCH_RECORDS;
+        } else {
+            maxpipes = 1;
+        }
+    }
     if (max_send_fragment == 0 || split_send_fragment == 0
         || split_send_fragment > max_send_fragment) {
         /*
@@ -657,7 +679,7 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
     SSL3_BUFFER *wb;
     SSL_SESSION *sess;
     size_t totlen = 0, len, wpinited = 0;
-    size_t j;
+    size_t j, encpipes;
 
     for (j = 0; j < numpipes; j++)
         totlen += pipelens[j];
@@ -763,20 +785,23 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
             goto err;
         }
         wpinited = 1;
-    } else if (prefix_len) {
-        wb = &s->rlayer.wbuf[0];
-        if (!WPACKET_init_static_len(&pkt[0],
-                                     SSL3_BUFFER_get_buf(wb),
-                                     SSL3_BUFFER_get_len(wb), 0)
-                || !WPACKET_allocate_bytes(&pkt[0], SSL3_BUFFER_get_offset(wb)
-                                                    + prefix_len, NULL)) {
-            SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
-                     ERR_R_INTERNAL_ERROR);
-            goto err;
-        }
-        wpinited = 1;
     } else {
-        for (j = 0; j < numpipes; j++) {
+        if (prefix_len) {
+            /* The empty fragment is already in the first buffer */
+            wb = &s->rlayer.wbuf[0];
+            if (!WPACKET_init_static_len(&pkt[0],
+                                         SSL3_BUFFER_get_buf(wb),
+                                         SSL3_BUFFER_get_len(wb), 0)
+                    || !WPACKET_allocate_bytes(&pkt[0],
+                                               SSL3_BUFFER_get_offset(wb)
+                                               + prefix_len, NULL)) {
+                SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
+                         ERR_R_INTERNAL_ERROR);
+                goto err;
+            }
+            wpinited = 1;
+        }
+        for (j = wpinited; j < numpipes; j++) {
             thispkt = &pkt[j];
 
             wb = &s->rlayer.wbuf[j];
@@ -981,26 +1006,40 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
         SSL3_RECORD_set_length(thiswr, len);
     }
 
-    if (s->early_data_state == SSL_EARLY_DATA_WRITING
-            || s->early_data_state == SSL_EARLY_DATA_WRITE_RETRY) {
-        /*
-         * We haven't actually negotiated the version yet, but we're trying to
-         * send early data - so we need to use the tls13enc function.
-         */
-        if (tls13_enc(s, wr, numpipes, 1) < 1) {
-            if (!ossl_statem_in_error(s)) {
-                SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
-                         ERR_R_INTERNAL_ERROR);
+    /*
+     * Batched records for a cipher without pipeline support are encrypted one
+     * at a time, in order, so that sequence numbers and chained IVs are
+     * consumed exactly as for separate writes.
+     */
+    encpipes = numpipes;
+    if (numpipes > 1
+            && !(EVP_CIPHER_flags(EVP_CIPHER_CTX_cipher(s->enc_write_ctx))
+                 & EVP_CIPH_FLAG_PIPELINE))
+        encpipes = 1;
+
+    for (j = 0; j < numpipes; j += encpipes) {
+        if (s->early_data_state == SSL_EARLY_DATA_WRITING
+                || s->early_data_state == SSL_EARLY_DATA_WRITE_RETRY) {
+            /*
+             * We haven't actually negotiated the version yet, but we're
+             * trying to send early data - so we need to use the tls13enc
+             * function.
+             */
+            if (tls13_enc(s, &wr[j], encpipes, 1) < 1) {
+                if (!ossl_statem_in_error(s)) {
+                    SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
+                             ERR_R_INTERNAL_ERROR);
+                }
+                goto err;
             }
-            goto err;
-        }
-    } else {
-        if (s->method->ssl3_enc->enc(s, wr, numpipes, 1) < 1) {
-            if (!ossl_statem_in_error(s)) {
-                SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
-                         ERR_R_INTERNAL_ERROR);
+        } else {
+            if (s->method->ssl3_enc->enc(s, &wr[j], encpipes, 1) < 1) {
+                if (!ossl_statem_in_error(s)) {
+                    SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
+                             ERR_R_INTERNAL_ERROR);
+                }
+                goto err;
             }
-            goto err;
         }
     }
 
@@ -1086,7 +1125,8 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
 
         /* now let's set up wb */
         SSL3_BUFFER_set_left(&s->rlayer.wbuf[j],
-                             prefix_len + SSL3_RECORD_get_length(thiswr));
+                             (j == 0 ? prefix_len : 0)
+                             + SSL3_RECORD_get_length(thiswr));
     }
 
     /*
@@ -1128,13 +1168,50 @@ int ssl3_write_pending(SSL *s, int type, const unsigned char *buf, size_t len,
     }
 
     for (;;) {
-        /* Loop until we find a buffer we haven't written out yet */
-        if (SSL3_BUFFER_get_left(&wb[currbuf]) == 0
-            && currbuf < s->rlayer.numwpipes - 1) {
+        /*
+         * Loop until we find a buffer we haven't written out yet; we are done
+         * once every buffer is empty, however many this write used
+         */
+        while (currbuf < s->rlayer.numwpipes
+               && SSL3_BUFFER_get_left(&wb[currbuf]) == 0)
             currbuf++;
-            continue;
+        if (currbuf == s->rlayer.numwpipes) {
+            s->rwstate = SSL_NOTHING;
+            *written = s->rlayer.wpend_ret;
+            return 1;
         }
         clear_sys_error();
+        if (s->wbio != NULL && currbuf + 1 < s->rlayer.numwpipes) {
+            /*
+             * Several records are pending: hand them all to the BIO at once
+             * and account for however much of them got written.
+             */
+            BIO_IOVEC iov[SSL_MAX_PIPELINES];
+            size_t niov = 0, k;
+
+            for (k = currbuf; k < s->rlayer.numwpipes; k++) {
+                if (SSL3_BUFFER_get_left(&wb[k]) == 0)
+                    continue;
+                iov[niov].base = &(SSL3_BUFFER_get_buf(&wb[k])
+                                   [SSL3_BUFFER_get_offset(&wb[k])]);
+                iov[niov].len = SSL3_BUFFER_get_left(&wb[k]);
+                niov++;
+            }
+            s->rwstate = SSL_WRITING;
+            i = BIO_writev(s->wbio, iov, niov, &tmpwrit);
+            if (i <= 0)
+                return i;
+            for (k = currbuf; k < s->rlayer.numwpipes && tmpwrit > 0; k++) {
+                size_t left = SSL3_BUFFER_get_left(&wb[k]);
+
+                if (left > tmpwrit)
+                    left = tmpwrit;
+                SSL3_BUFFER_add_offset(&wb[k], left);
+                SSL3_BUFFER_sub_left(&wb[k], left);
+                tmpwrit -= left;
+            }
+            continue;
+        }
         if (s->wbio != NULL) {
             s->rwstate = SSL_WRITING;
             /* TODO(size_t): Convert this call */
@@ -1152,11 +1229,7 @@ int ssl3_write_pending(SSL *s, int type, const unsigned char *buf, size_t len,
         if (i > 0 && tmpwrit == SSL3_BUFFER_get_left(&wb[currbuf])) {
             SSL3_BUFFER_set_left(&wb[currbuf], 0);
             SSL3_BUFFER_add_offset(&wb[currbuf], tmpwrit);
-            if (currbuf + 1 < s->rlayer.numwpipes)
-                continue;
-            s->rwstate = SSL_NOTHING;
-            *written = s->rlayer.wpend_ret;
-            return 1;
+            continue;
         } else if (i <= 0) {
             if (SSL_IS_DTLS(s)) {
                 /*
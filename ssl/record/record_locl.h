@@ -16,6 +16,12 @@
 
 #define MAX_WARN_ALERT_COUNT    5
 
+/*
+ * Number of records laid out per flush with SSL_MODE_BATCH_WRITES when
+ * max_pipelines has not been set
+ */
+#define SSL3_DEFAULT_BATCH_RECORDS  8
+
 /* Functions/macros provided by the RECORD_LAYER component */
 
 #define RECORD_LAYER_get_rbuf(rl)               (&(rl)->rbuf)
@@ -3330,6 +3330,11 @@ void ssl3_free(SSL *s)
     OPENSSL_clear_free(s->s3->tmp.pms, s->s3->tmp.pmslen);
     OPENSSL_free(s->s3->tmp.peer_sigalgs);
     OPENSSL_free(s->s3->tmp.peer_cert_sigalgs);
+    OPENSSL_free(s->s3->tmp.ske_params);
+    OPENSSL_free(s->s3->tmp.enc_premaster);
+#ifndef OPENSSL_NO_PSK
+    OPENSSL_clear_free(s->s3->tmp.psk, s->s3->tmp.psklen);
+#endif
     ssl3_free_digest_list(s);
     OPENSSL_free(s->s3->alpn_selected);
     OPENSSL_free(s->s3->alpn_proposed);
@@ -3350,6 +3355,11 @@ int ssl3_clear(SSL *s)
     OPENSSL_clear_free(s->s3->tmp.pms, s->s3->tmp.pmslen);
     OPENSSL_free(s->s3->tmp.peer_sigalgs);
     OPENSSL_free(s->s3->tmp.peer_cert_sigalgs);
+    OPENSSL_free(s->s3->tmp.ske_params);
+    OPENSSL_free(s->s3->tmp.enc_premaster);
+#ifndef OPENSSL_NO_PSK
+    OPENSSL_clear_free(s->s3->tmp.psk, s->s3->tmp.psklen);
+#endif
 
 #if !defined(OPENSSL_NO_EC) || !defined(OPENSSL_NO_DH)
     EVP_PKEY_free(s->s3->tmp.pkey);
@@ -3806,37 +3816,34 @@ long ssl3_ctx_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
     case SSL_CTRL_GET_TLSEXT_TICKET_KEYS:
         {
             unsigned char *keys = parg;
-            long tick_keylen = (sizeof(ctx->ext.tick_key_name) +
+            long tick_keylen = (TLSEXT_KEYNAME_LENGTH +
                                 sizeof(ctx->ext.secure->tick_hmac_key) +
-                                sizeof(ctx->ext.secure->tick_aes_key));
+                                TLSEXT_TICK_KEY_LENGTH);
             if (keys == NULL)
                 return tick_keylen;
             if (larg != tick_keylen) {
                 SSLerr(SSL_F_SSL3_CTX_CTRL, SSL_R_INVALID_TICKET_KEYS_LENGTH);
                 return 0;
             }
+            /*
+             * The name and AES key become the current key of the key ring,
+             * which is copied first if other contexts share it; the HMAC key
+             * is not needed for AEAD protected tickets.
+             */
             if (cmd == SSL_CTRL_SET_TLSEXT_TICKET_KEYS) {
-                memcpy(ctx->ext.tick_key_name, keys,
-                       sizeof(ctx->ext.tick_key_name));
                 memcpy(ctx->ext.secure->tick_hmac_key,
-                       keys + sizeof(ctx->ext.tick_key_name),
+                       keys + TLSEXT_KEYNAME_LENGTH,
                        sizeof(ctx->ext.secure->tick_hmac_key));
-                memcpy(ctx->ext.secure->tick_aes_key,
-                       keys + sizeof(ctx->ext.tick_key_name) +
-                       sizeof(ctx->ext.secure->tick_hmac_key),
-                       sizeof(ctx->ext.secure->tick_aes_key));
-            } else {
-                memcpy(keys, ctx->ext.tick_key_name,
-                       sizeof(ctx->ext.tick_key_name));
-                memcpy(keys + sizeof(ctx->ext.tick_key_name),
-                       ctx->ext.secure->tick_hmac_key,
-                       sizeof(ctx->ext.secure->tick_hmac_key));
-                memcpy(keys + sizeof(ctx->ext.tick_key_name) +
-                       sizeof(ctx->ext.secure->tick_hmac_key),
-                       ctx->ext.secure->tick_aes_key,
-                       sizeof(ctx->ext.secure->tick_aes_key));
+                return ssl_ticket_key_ring_set_current(&ctx->ext.ticket_keys,
+                           keys, keys + TLSEXT_KEYNAME_LENGTH
+                                 + sizeof(ctx->ext.secure->tick_hmac_key));
             }
-            return 1;
+            memcpy(keys + TLSEXT_KEYNAME_LENGTH,
+                   ctx->ext.secure->tick_hmac_key,
+                   sizeof(ctx->ext.secure->tick_hmac_key));
+            return ssl_ticket_key_ring_get_current(ctx->ext.ticket_keys,
+                       keys, keys + TLSEXT_KEYNAME_LENGTH
+                             + sizeof(ctx->ext.secure->tick_hmac_key));
         }
 
     case SSL_CTRL_GET_TLSEXT_STATUS_REQ_TYPE:
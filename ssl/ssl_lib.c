@@ -1186,7 +1186,7 @@ void SSL_free(SSL *s)
     OPENSSL_free(s->ext.ocsp.resp);
     OPENSSL_free(s->ext.alpn);
     OPENSSL_free(s->ext.tls13_cookie);
-    OPENSSL_free(s->clienthello);
+    ossl_statem_arena_release(s);
     OPENSSL_free(s->pha_context);
     EVP_MD_CTX_free(s->pha_dgst);
 
@@ -2981,13 +2981,10 @@ SSL_CTX *SSL_CTX_new(const SSL_METHOD *meth)
     ret->max_send_fragment = SSL3_RT_MAX_PLAIN_LENGTH;
     ret->split_send_fragment = SSL3_RT_MAX_PLAIN_LENGTH;
 
-    /* Setup RFC5077 ticket keys */
-    if ((RAND_bytes(ret->ext.tick_key_name,
-                    sizeof(ret->ext.tick_key_name)) <= 0)
+    /* Setup RFC5077 ticket keys: a private ring holding a single key */
+    if ((ret->ext.ticket_keys = SSL_TICKET_KEY_RING_new(1, 0)) == NULL
         || (RAND_priv_bytes(ret->ext.secure->tick_hmac_key,
-                       sizeof(ret->ext.secure->tick_hmac_key)) <= 0)
-        || (RAND_priv_bytes(ret->ext.secure->tick_aes_key,
-                       sizeof(ret->ext.secure->tick_aes_key)) <= 0))
+                       sizeof(ret->ext.secure->tick_hmac_key)) <= 0))
         ret->options |= SSL_OP_NO_TICKET;
 
     if (RAND_priv_bytes(ret->ext.cookie_hmac_key,
@@ -3142,6 +3139,7 @@ void SSL_CTX_free(SSL_CTX *a)
     OPENSSL_free(a->ext.supportedgroups);
 #endif
     OPENSSL_free(a->ext.alpn);
+    SSL_TICKET_KEY_RING_free(a->ext.ticket_keys);
     OPENSSL_secure_free(a->ext.secure);
 
     CRYPTO_THREAD_lock_free(a->lock);
@@ -3545,6 +3543,8 @@ int SSL_get_error(const SSL *s, int i)
         return SSL_ERROR_WANT_ASYNC_JOB;
     if (SSL_want_client_hello_cb(s))
         return SSL_ERROR_WANT_CLIENT_HELLO_CB;
+    if (SSL_want_private_key_operation(s))
+        return SSL_ERROR_WANT_PRIVATE_KEY_OPERATION;
 
     if ((s->shutdown & SSL_RECEIVED_SHUTDOWN) &&
         (s->s3->warn_alert == SSL_AD_CLOSE_NOTIFY))
@@ -4982,6 +4982,18 @@ void SSL_CTX_set_client_hello_cb(SSL_CTX *c, SSL_client_hello_cb_fn cb,
     c->client_hello_cb_arg = arg;
 }
 
+void SSL_CTX_set_private_key_method(SSL_CTX *ctx,
+                                    SSL_private_key_sign_cb_fn sign_cb,
+                                    SSL_private_key_decrypt_cb_fn decrypt_cb,
+                                    SSL_private_key_complete_cb_fn complete_cb,
+                                    void *arg)
+{
+    ctx->private_key_sign_cb = sign_cb;
+    ctx->private_key_decrypt_cb = decrypt_cb;
+    ctx->private_key_complete_cb = complete_cb;
+    ctx->private_key_cb_arg = arg;
+}
+
 int SSL_client_hello_isv2(SSL *s)
 {
     if (s->clienthello == NULL)
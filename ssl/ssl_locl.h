@@ -730,10 +730,16 @@ DEFINE_LHASH_OF(X509_NAME);
 
 # define TLSEXT_KEYNAME_LENGTH  16
 # define TLSEXT_TICK_KEY_LENGTH 32
+/* Nonce and tag lengths of the built-in AES-256-GCM ticket protection */
+# define TLSEXT_TICK_IV_LENGTH  12
+# define TLSEXT_TICK_TAG_LENGTH 16
 
 typedef struct ssl_ctx_ext_secure_st {
+    /*
+     * Tickets are protected with AEAD; this is only kept so that
+     * SSL_CTX_get_tlsext_ticket_keys() returns what was set.
+     */
     unsigned char tick_hmac_key[TLSEXT_TICK_KEY_LENGTH];
-    unsigned char tick_aes_key[TLSEXT_TICK_KEY_LENGTH];
 } SSL_CTX_EXT_SECURE;
 
 struct ssl_ctx_st {
@@ -921,13 +927,19 @@ struct ssl_ctx_st {
     SSL_client_hello_cb_fn client_hello_cb;
     void *client_hello_cb_arg;
 
+    /* Private key method callbacks */
+    SSL_private_key_sign_cb_fn private_key_sign_cb;
+    SSL_private_key_decrypt_cb_fn private_key_decrypt_cb;
+    SSL_private_key_complete_cb_fn private_key_complete_cb;
+    void *private_key_cb_arg;
+
     /* TLS extensions. */
     struct {
         /* TLS extensions servername callback */
         int (*servername_cb) (SSL *, int *, void *);
         void *servername_arg;
         /* RFC 4507 session ticket keys */
-        unsigned char tick_key_name[TLSEXT_KEYNAME_LENGTH];
+        SSL_TICKET_KEY_RING *ticket_keys;
         SSL_CTX_EXT_SECURE *secure;
         /* Callback to support customisation of ticket key setting */
         int (*ticket_key_cb) (SSL *ssl,
@@ -1619,6 +1631,14 @@ typedef struct ssl3_state_st {
          */
         int min_ver;
         int max_ver;
+        /* Set while an operation of the private key method is pending */
+        int private_key_op_pending;
+        /* ServerKeyExchange parameters signed by a pending operation */
+        unsigned char *ske_params;
+        size_t ske_params_len;
+        /* Encrypted premaster secret awaiting the private key method */
+        unsigned char *enc_premaster;
+        size_t enc_premaster_len;
     } tmp;
 
     /* Connection binding to prevent renegotiation attacks */
@@ -2521,6 +2541,21 @@ __owur SSL_TICKET_STATUS tls_decrypt_ticket(SSL *s, const unsigned char *etick,
 
 __owur int tls_use_ticket(SSL *s);
 
+__owur int ssl_ticket_key_ring_set_current(SSL_TICKET_KEY_RING **pring,
+                                           const unsigned char *name,
+                                           const unsigned char *aes_key);
+__owur int ssl_ticket_key_ring_get_current(SSL_TICKET_KEY_RING *ring,
+                                           unsigned char *name,
+                                           unsigned char *aes_key);
+__owur int ssl_ticket_key_ring_encrypt_init(SSL_TICKET_KEY_RING *ring,
+                                            unsigned char *name,
+                                            unsigned char *iv,
+                                            EVP_CIPHER_CTX *ctx);
+__owur int ssl_ticket_key_ring_decrypt_init(SSL_TICKET_KEY_RING *ring,
+                                            const unsigned char *name,
+                                            const unsigned char *iv,
+                                            EVP_CIPHER_CTX *ctx, int *renew);
+
 void ssl_set_sig_mask(uint32_t *pmask_a, SSL *s, int op);
 
 __owur int tls1_set_sigalgs_list(CERT *c, const char *str, int client);
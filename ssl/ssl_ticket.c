@@ -0,0 +1,383 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <time.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include "ssl_locl.h"
+#include "internal/refcount.h"
+
+/* Upper bound on the number of keys a ring may retain */
+#define TICKET_KEY_RING_MAX_KEYS    64
+
+typedef struct ssl_ticket_key_st {
+    unsigned char name[TLSEXT_KEYNAME_LENGTH];
+    unsigned char aes_key[TLSEXT_TICK_KEY_LENGTH];
+    /* Keyed AES-256-GCM context, copied for every ticket */
+    EVP_CIPHER_CTX *ctx;
+    time_t created;
+} SSL_TICKET_KEY;
+
+struct ssl_ticket_key_ring_st {
+    /* keys[0] is the current key, older keys follow in order of age */
+    SSL_TICKET_KEY *keys;
+    size_t num_keys;
+    size_t max_keys;
+    /* Seconds after which the current key is replaced, 0 for never */
+    long lifetime;
+    CRYPTO_REF_COUNT references;
+    CRYPTO_RWLOCK *lock;
+};
+
+/*
+ * Install |name| and |aes_key| as the current key, dropping the oldest key if
+ * the ring is full. Must be called with the write lock held.
+ */
+static int ticket_key_ring_push(SSL_TICKET_KEY_RING *ring,
+                                const unsigned char *name,
+                                const unsigned char *aes_key)
+{
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    SSL_TICKET_KEY *key;
+
+    if (ctx == NULL
+            || !EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, aes_key,
+                                   NULL)) {
+        EVP_CIPHER_CTX_free(ctx);
+        return 0;
+    }
+
+    if (ring->num_keys == ring->max_keys) {
+        ring->num_keys--;
+        key = &ring->keys[ring->num_keys];
+        EVP_CIPHER_CTX_free(key->ctx);
+        OPENSSL_cleanse(key, sizeof(*key));
+    }
+    memmove(&ring->keys[1], &ring->keys[0],
+            ring->num_keys * sizeof(*ring->keys));
+    ring->num_keys++;
+
+    key = &ring->keys[0];
+    memcpy(key->name, name, sizeof(key->name));
+    memcpy(key->aes_key, aes_key, sizeof(key->aes_key));
+    key->ctx = ctx;
+    key->created = time(NULL);
+
+    return 1;
+}
+
+/* Must be called with the write lock held */
+static int ticket_key_ring_rotate(SSL_TICKET_KEY_RING *ring)
+{
+    unsigned char name[TLSEXT_KEYNAME_LENGTH];
+    unsigned char aes_key[TLSEXT_TICK_KEY_LENGTH];
+    int ret = 0;
+
+    if (RAND_bytes(name, sizeof(name)) > 0
+            && RAND_priv_bytes(aes_key, sizeof(aes_key)) > 0)
+        ret = ticket_key_ring_push(ring, name, aes_key);
+    OPENSSL_cleanse(aes_key, sizeof(aes_key));
+
+    return ret;
+}
+
+/* Allocate a ring for up to |num_keys| keys, without any key in it yet */
+static SSL_TICKET_KEY_RING *ticket_key_ring_alloc(size_t num_keys,
+                                                  long lifetime)
+{
+    SSL_TICKET_KEY_RING *ring;
+
+    if (num_keys == 0 || num_keys > TICKET_KEY_RING_MAX_KEYS
+            || lifetime < 0) {
+        SSLerr(SSL_F_SSL_TICKET_KEY_RING_NEW, SSL_R_BAD_VALUE);
+        return NULL;
+    }
+
+    ring = OPENSSL_zalloc(sizeof(*ring));
+    if (ring == NULL) {
+        SSLerr(SSL_F_SSL_TICKET_KEY_RING_NEW, ERR_R_MALLOC_FAILURE);
+        return NULL;
+    }
+
+    ring->keys = OPENSSL_secure_zalloc(num_keys * sizeof(*ring->keys));
+    ring->lock = CRYPTO_THREAD_lock_new();
+    if (ring->keys == NULL || ring->lock == NULL) {
+        SSLerr(SSL_F_SSL_TICKET_KEY_RING_NEW, ERR_R_MALLOC_FAILURE);
+        OPENSSL_secure_free(ring->keys);
+        CRYPTO_THREAD_lock_free(ring->lock);
+        OPENSSL_free(ring);
+        return NULL;
+    }
+    ring->max_keys = num_keys;
+    ring->lifetime = lifetime;
+    ring->references = 1;
+
+    return ring;
+}
+
+SSL_TICKET_KEY_RING *SSL_TICKET_KEY_RING_new(size_t num_keys, long lifetime)
+{
+    SSL_TICKET_KEY_RING *ring = ticket_key_ring_alloc(num_keys, lifetime);
+
+    if (ring == NULL)
+        return NULL;
+
+    if (!ticket_key_ring_rotate(ring)) {
+        SSLerr(SSL_F_SSL_TICKET_KEY_RING_NEW, ERR_R_INTERNAL_ERROR);
+        SSL_TICKET_KEY_RING_free(ring);
+        return NULL;
+    }
+
+    return ring;
+}
+
+int SSL_TICKET_KEY_RING_up_ref(SSL_TICKET_KEY_RING *ring)
+{
+    int i;
+
+    if (CRYPTO_UP_REF(&ring->references, &i, ring->lock) <= 0)
+        return 0;
+
+    REF_PRINT_COUNT("SSL_TICKET_KEY_RING", ring);
+    REF_ASSERT_ISNT(i < 2);
+    return ((i > 1) ? 1 : 0);
+}
+
+void SSL_TICKET_KEY_RING_free(SSL_TICKET_KEY_RING *ring)
+{
+    size_t i;
+    int r;
+
+    if (ring == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&ring->references, &r, ring->lock);
+    REF_PRINT_COUNT("SSL_TICKET_KEY_RING", ring);
+    if (r > 0)
+        return;
+    REF_ASSERT_ISNT(r < 0);
+
+    for (i = 0; i < ring->num_keys; i++)
+        EVP_CIPHER_CTX_free(ring->keys[i].ctx);
+    OPENSSL_secure_clear_free(ring->keys,
+                              ring->max_keys * sizeof(*ring->keys));
+    CRYPTO_THREAD_lock_free(ring->lock);
+    OPENSSL_free(ring);
+}
+
+/* Whether a new current key is due. Must be called with a lock held. */
+static int ticket_key_ring_stale(const SSL_TICKET_KEY_RING *ring)
+{
+    return ring->lifetime > 0
+           && time(NULL) - ring->keys[0].created >= ring->lifetime;
+}
+
+/*
+ * Take the read lock on |ring|, first rotating the current key if it is due.
+ */
+static int ticket_key_ring_lock_current(SSL_TICKET_KEY_RING *ring)
+{
+    if (!CRYPTO_THREAD_read_lock(ring->lock))
+        return 0;
+    if (!ticket_key_ring_stale(ring))
+        return 1;
+
+    /* Another thread may rotate in between, so check again */
+    CRYPTO_THREAD_unlock(ring->lock);
+    if (!CRYPTO_THREAD_write_lock(ring->lock))
+        return 0;
+    if (ticket_key_ring_stale(ring) && !ticket_key_ring_rotate(ring)) {
+        CRYPTO_THREAD_unlock(ring->lock);
+        return 0;
+    }
+
+    return 1;
+}
+
+int SSL_TICKET_KEY_RING_rotate(SSL_TICKET_KEY_RING *ring)
+{
+    int ret;
+
+    if (!CRYPTO_THREAD_write_lock(ring->lock))
+        return 0;
+    ret = ticket_key_ring_rotate(ring);
+    CRYPTO_THREAD_unlock(ring->lock);
+
+    return ret;
+}
+
+int SSL_CTX_set1_ticket_key_ring(SSL_CTX *ctx, SSL_TICKET_KEY_RING *ring)
+{
+    if (ring == NULL || !SSL_TICKET_KEY_RING_up_ref(ring))
+        return 0;
+
+    SSL_TICKET_KEY_RING_free(ctx->ext.ticket_keys);
+    ctx->ext.ticket_keys = ring;
+
+    return 1;
+}
+
+SSL_TICKET_KEY_RING *SSL_CTX_get0_ticket_key_ring(const SSL_CTX *ctx)
+{
+    return ctx->ext.ticket_keys;
+}
+
+/* Whether anyone but the caller holds a reference to |ring| */
+static int ticket_key_ring_shared(SSL_TICKET_KEY_RING *ring)
+{
+    int i;
+
+    if (CRYPTO_UP_REF(&ring->references, &i, ring->lock) <= 0)
+        return -1;
+    CRYPTO_DOWN_REF(&ring->references, &i, ring->lock);
+
+    return i > 1;
+}
+
+/* A private copy of |ring|, with the same keys, size and lifetime */
+static SSL_TICKET_KEY_RING *ticket_key_ring_dup(SSL_TICKET_KEY_RING *ring)
+{
+    SSL_TICKET_KEY_RING *dup;
+    size_t i;
+
+    if ((dup = ticket_key_ring_alloc(ring->max_keys, ring->lifetime)) == NULL)
+        return NULL;
+    if (!CRYPTO_THREAD_read_lock(ring->lock)) {
+        SSL_TICKET_KEY_RING_free(dup);
+        return NULL;
+    }
+    for (i = ring->num_keys; i-- > 0; ) {
+        if (!ticket_key_ring_push(dup, ring->keys[i].name,
+                                  ring->keys[i].aes_key)) {
+            CRYPTO_THREAD_unlock(ring->lock);
+            SSL_TICKET_KEY_RING_free(dup);
+            return NULL;
+        }
+        dup->keys[0].created = ring->keys[i].created;
+    }
+    CRYPTO_THREAD_unlock(ring->lock);
+
+    return dup;
+}
+
+/*
+ * Install |name| and |aes_key| as the current key of the ring in |*pring|.
+ * A ring shared with others is copied first, so that they are unaffected, and
+ * a context that has no ring, as it failed to create one, is given one.
+ */
+int ssl_ticket_key_ring_set_current(SSL_TICKET_KEY_RING **pring,
+                                    const unsigned char *name,
+                                    const unsigned char *aes_key)
+{
+    SSL_TICKET_KEY_RING *ring = *pring;
+    int ret;
+
+    if (ring != NULL) {
+        if ((ret = ticket_key_ring_shared(ring)) < 0)
+            return 0;
+        if (ret == 0) {
+            if (!CRYPTO_THREAD_write_lock(ring->lock))
+                return 0;
+            ret = ticket_key_ring_push(ring, name, aes_key);
+            CRYPTO_THREAD_unlock(ring->lock);
+            return ret;
+        }
+        ring = ticket_key_ring_dup(ring);
+    } else {
+        ring = ticket_key_ring_alloc(1, 0);
+    }
+
+    /* No one else has |ring| yet, so it needs no lock */
+    if (ring == NULL || !ticket_key_ring_push(ring, name, aes_key)) {
+        SSL_TICKET_KEY_RING_free(ring);
+        return 0;
+    }
+    SSL_TICKET_KEY_RING_free(*pring);
+    *pring = ring;
+
+    return 1;
+}
+
+int ssl_ticket_key_ring_get_current(SSL_TICKET_KEY_RING *ring,
+                                    unsigned char *name,
+                                    unsigned char *aes_key)
+{
+    if (ring == NULL || !ticket_key_ring_lock_current(ring))
+        return 0;
+    memcpy(name, ring->keys[0].name, sizeof(ring->keys[0].name));
+    memcpy(aes_key, ring->keys[0].aes_key, sizeof(ring->keys[0].aes_key));
+    CRYPTO_THREAD_unlock(ring->lock);
+
+    return 1;
+}
+
+/*
+ * Set up |ctx| to encrypt a ticket under the current key, whose name is
+ * written to |name|, with a freshly generated |iv| of TLSEXT_TICK_IV_LENGTH
+ * bytes. Only the prepared context of the key is copied, so the AES key
+ * schedule and GHASH tables are not recomputed per ticket.
+ */
+int ssl_ticket_key_ring_encrypt_init(SSL_TICKET_KEY_RING *ring,
+                                     unsigned char *name, unsigned char *iv,
+                                     EVP_CIPHER_CTX *ctx)
+{
+    int ret;
+
+    if (ring == NULL
+            || RAND_bytes(iv, TLSEXT_TICK_IV_LENGTH) <= 0
+            || !ticket_key_ring_lock_current(ring))
+        return 0;
+
+    ret = EVP_CIPHER_CTX_copy(ctx, ring->keys[0].ctx)
+          && EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, iv);
+    if (ret)
+        memcpy(name, ring->keys[0].name, sizeof(ring->keys[0].name));
+    CRYPTO_THREAD_unlock(ring->lock);
+
+    return ret;
+}
+
+/*
+ * Set up |ctx| to decrypt a ticket protected with the key called |name|.
+ * Returns 1 on success, 0 if there is no such key, or no ring, and -1 on
+ * error. On
+ * success |*renew| is set if the ticket should be replaced by one under the
+ * current key.
+ */
+int ssl_ticket_key_ring_decrypt_init(SSL_TICKET_KEY_RING *ring,
+                                     const unsigned char *name,
+                                     const unsigned char *iv,
+                                     EVP_CIPHER_CTX *ctx, int *renew)
+{
+    size_t i;
+    int ret = 0;
+
+    if (ring == NULL)
+        return 0;
+    if (!CRYPTO_THREAD_read_lock(ring->lock))
+        return -1;
+
+    for (i = 0; i < ring->num_keys; i++) {
+        if (memcmp(ring->keys[i].name, name, TLSEXT_KEYNAME_LENGTH) != 0)
+            continue;
+
+        if (!EVP_CIPHER_CTX_copy(ctx, ring->keys[i].ctx)
+                || !EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, iv)) {
+            ret = -1;
+            break;
+        }
+        *renew = i > 0 || ticket_key_ring_stale(ring);
+        ret = 1;
+        break;
+    }
+    CRYPTO_THREAD_unlock(ring->lock);
+
+    return ret;
+}
@@ -539,7 +539,7 @@ int extension_is_relevant(SSL *s, unsigned int extctx, unsigned int thisctx)
  * extensions yet, except to check their types. This function also runs the
  * initialiser functions for all known extensions if |init| is nonzero (whether
  * we have collected them or not). If successful the caller is responsible for
- * freeing the contents of |*res|.
+ * freeing the contents of |*res| with ossl_statem_arena_free().
  *
  * Per http://tools.ietf.org/html/rfc5246#section-7.4.1.4, there may not be
  * more than one extension of the same type in a ClientHello or ServerHello.
@@ -568,7 +568,8 @@ int tls_collect_extensions(SSL *s, PACKET *packet, unsigned int context,
         custom_ext_init(&s->cert->custext);
 
     num_exts = OSSL_NELEM(ext_defs) + (exts != NULL ? exts->meths_count : 0);
-    raw_extensions = OPENSSL_zalloc(num_exts * sizeof(*raw_extensions));
+    raw_extensions = ossl_statem_arena_zalloc(s, num_exts
+                                                 * sizeof(*raw_extensions));
     if (raw_extensions == NULL) {
         SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_COLLECT_EXTENSIONS,
                  ERR_R_MALLOC_FAILURE);
@@ -663,7 +664,7 @@ int tls_collect_extensions(SSL *s, PACKET *packet, unsigned int context,
     return 1;
 
  err:
-    OPENSSL_free(raw_extensions);
+    ossl_statem_arena_free(s, raw_extensions);
     return 0;
 }
 
@@ -838,6 +838,21 @@ static SUB_STATE_RETURN write_state_machine(SSL *s)
             }
             if (confunc != NULL && !confunc(s, &pkt)) {
                 WPACKET_cleanup(&pkt);
+                if (s->s3->tmp.private_key_op_pending
+                        && !ossl_statem_in_error(s)) {
+                    /*
+                     * The message is constructed again once the private key
+                     * method has finished, so give back the DTLS message
+                     * sequence number its handshake header used up. None of
+                     * the states signing a message have pre work, so it is
+                     * safe to start over from there.
+                     */
+                    if (SSL_IS_DTLS(s))
+                        s->d1->next_handshake_write_seq--;
+                    st->write_state = WRITE_STATE_PRE_WORK;
+                    st->write_state_work = WORK_MORE_A;
+                    return SUB_STATE_ERROR;
+                }
                 check_fatal(s, SSL_F_WRITE_STATE_MACHINE);
                 return SUB_STATE_ERROR;
             }
@@ -966,3 +981,94 @@ int ossl_statem_export_early_allowed(SSL *s)
     return s->ext.early_data == SSL_EARLY_DATA_ACCEPTED
            || (!s->server && s->ext.early_data != SSL_EARLY_DATA_NOT_SENT);
 }
+
+/*
+ * Transient handshake allocations (parsed ClientHellos, collected extension
+ * blocks) are carved from chunks owned by the state machine instead of being
+ * allocated individually, and are all released together once the handshake is
+ * over. Each block is preceded by its size so that freeing the most recently
+ * allocated block returns its memory to the chunk, which keeps the arena from
+ * growing when a block is repeatedly allocated and freed (e.g. once per
+ * certificate in a chain). Freeing any other block is a no-op.
+ */
+#define STATEM_ARENA_ALIGN      16
+#define STATEM_ARENA_CHUNK_SIZE 4096
+
+#define STATEM_ARENA_ROUNDUP(n) \
+    (((n) + STATEM_ARENA_ALIGN - 1) & ~((size_t)STATEM_ARENA_ALIGN - 1))
+
+struct ossl_statem_arena_chunk_st {
+    OSSL_STATEM_ARENA_CHUNK *next;
+    size_t size;
+    size_t used;
+};
+
+#define STATEM_ARENA_HDR_SIZE \
+    STATEM_ARENA_ROUNDUP(sizeof(OSSL_STATEM_ARENA_CHUNK))
+
+static unsigned char *arena_chunk_data(OSSL_STATEM_ARENA_CHUNK *chunk)
+{
+    return (unsigned char *)chunk + STATEM_ARENA_HDR_SIZE;
+}
+
+void *ossl_statem_arena_zalloc(SSL *s, size_t num)
+{
+    OSSL_STATEM_ARENA_CHUNK *chunk = s->statem.arena;
+    size_t len;
+    unsigned char *ret;
+
+    if (num == 0 || num > SIZE_MAX - 2 * STATEM_ARENA_ALIGN)
+        return NULL;
+    len = STATEM_ARENA_ALIGN + STATEM_ARENA_ROUNDUP(num);
+
+    if (chunk == NULL || chunk->size - chunk->used < len) {
+        size_t size = len > STATEM_ARENA_CHUNK_SIZE ? len
+                                                    : STATEM_ARENA_CHUNK_SIZE;
+
+        chunk = OPENSSL_malloc(STATEM_ARENA_HDR_SIZE + size);
+        if (chunk == NULL)
+            return NULL;
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->next = s->statem.arena;
+        s->statem.arena = chunk;
+    }
+
+    ret = arena_chunk_data(chunk) + chunk->used;
+    *(size_t *)ret = len;
+    chunk->used += len;
+    ret += STATEM_ARENA_ALIGN;
+    memset(ret, 0, num);
+
+    return ret;
+}
+
+void ossl_statem_arena_free(SSL *s, void *ptr)
+{
+    OSSL_STATEM_ARENA_CHUNK *chunk = s->statem.arena;
+    unsigned char *block = (unsigned char *)ptr - STATEM_ARENA_ALIGN;
+    unsigned char *data;
+
+    if (ptr == NULL || chunk == NULL)
+        return;
+
+    data = arena_chunk_data(chunk);
+    if (block >= data && block < data + chunk->used
+            && block + *(size_t *)block == data + chunk->used)
+        chunk->used -= *(size_t *)block;
+}
+
+/*
+ * Release all memory allocated through ossl_statem_arena_zalloc(). Nothing
+ * that was allocated from the arena may still be referenced.
+ */
+void ossl_statem_arena_release(SSL *s)
+{
+    OSSL_STATEM_ARENA_CHUNK *chunk, *next;
+
+    for (chunk = s->statem.arena; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        OPENSSL_clear_free(chunk, STATEM_ARENA_HDR_SIZE + chunk->size);
+    }
+    s->statem.arena = NULL;
+}
@@ -71,6 +71,9 @@ typedef enum {
     WRITE_STATE_POST_WORK
 } WRITE_STATE;
 
+/* A block of memory the transient allocations of a handshake are carved from */
+typedef struct ossl_statem_arena_chunk_st OSSL_STATEM_ARENA_CHUNK;
+
 /*****************************************************************************
  *                                                                           *
  * This structure should be considered "opaque" to anything outside of the   *
@@ -101,6 +104,11 @@ struct ossl_statem_st {
     unsigned int no_cert_verify;
     int use_timer;
     int invalid_enc_write_ctx;
+    /*
+     * Memory for messages and extension blocks that only live for the
+     * duration of the handshake. Most recently allocated chunk first.
+     */
+    OSSL_STATEM_ARENA_CHUNK *arena;
 };
 typedef struct ossl_statem_st OSSL_STATEM;
 
@@ -136,5 +144,9 @@ __owur int ossl_statem_app_data_allowed(SSL *s);
 __owur int ossl_statem_export_allowed(SSL *s);
 __owur int ossl_statem_export_early_allowed(SSL *s);
 
+void *ossl_statem_arena_zalloc(SSL *s, size_t num);
+void ossl_statem_arena_free(SSL *s, void *ptr);
+void ossl_statem_arena_release(SSL *s);
+
 /* Flush the write BIO */
 int statem_flush(SSL *s);
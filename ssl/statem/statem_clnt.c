@@ -1742,10 +1742,10 @@ MSG_PROCESS_RETURN tls_process_server_hello(SSL *s, PACKET *pkt)
         goto err;
     }
 
-    OPENSSL_free(extensions);
+    ossl_statem_arena_free(s, extensions);
     return MSG_PROCESS_CONTINUE_READING;
  err:
-    OPENSSL_free(extensions);
+    ossl_statem_arena_free(s, extensions);
     return MSG_PROCESS_ERROR;
 }
 
@@ -1769,7 +1769,7 @@ static MSG_PROCESS_RETURN tls_process_as_hello_retry_request(SSL *s,
         goto err;
     }
 
-    OPENSSL_free(extensions);
+    ossl_statem_arena_free(s, extensions);
     extensions = NULL;
 
     if (s->ext.tls13_cookie_len == 0
@@ -1810,7 +1810,7 @@ static MSG_PROCESS_RETURN tls_process_as_hello_retry_request(SSL *s,
 
     return MSG_PROCESS_FINISHED_READING;
  err:
-    OPENSSL_free(extensions);
+    ossl_statem_arena_free(s, extensions);
     return MSG_PROCESS_ERROR;
 }
 
@@ -1881,11 +1881,11 @@ MSG_PROCESS_RETURN tls_process_server_certificate(SSL *s, PACKET *pkt)
                 || !tls_parse_all_extensions(s, SSL_EXT_TLS1_3_CERTIFICATE,
                                              rawexts, x, chainidx,
                                              PACKET_remaining(pkt) == 0)) {
-                OPENSSL_free(rawexts);
+                ossl_statem_arena_free(s, rawexts);
                 /* SSLfatal already called */
                 goto err;
             }
-            OPENSSL_free(rawexts);
+            ossl_statem_arena_free(s, rawexts);
         }
 
         if (!sk_X509_push(sk, x)) {
@@ -2475,10 +2475,10 @@ MSG_PROCESS_RETURN tls_process_certificate_request(SSL *s, PACKET *pkt)
             || !tls_parse_all_extensions(s, SSL_EXT_TLS1_3_CERTIFICATE_REQUEST,
                                          rawexts, NULL, 0, 1)) {
             /* SSLfatal() already called */
-            OPENSSL_free(rawexts);
+            ossl_statem_arena_free(s, rawexts);
             return MSG_PROCESS_ERROR;
         }
-        OPENSSL_free(rawexts);
+        ossl_statem_arena_free(s, rawexts);
         if (!tls1_process_sigalgs(s)) {
             SSLfatal(s, SSL_AD_INTERNAL_ERROR,
                      SSL_F_TLS_PROCESS_CERTIFICATE_REQUEST,
@@ -2712,14 +2712,14 @@ MSG_PROCESS_RETURN tls_process_new_session_ticket(SSL *s, PACKET *pkt)
         }
         s->session->master_key_length = hashlen;
 
-        OPENSSL_free(exts);
+        ossl_statem_arena_free(s, exts);
         ssl_update_cache(s, SSL_SESS_CACHE_CLIENT);
         return MSG_PROCESS_FINISHED_READING;
     }
 
     return MSG_PROCESS_CONTINUE_READING;
  err:
-    OPENSSL_free(exts);
+    ossl_statem_arena_free(s, exts);
     return MSG_PROCESS_ERROR;
 }
 
@@ -3665,11 +3665,11 @@ static MSG_PROCESS_RETURN tls_process_encrypted_extensions(SSL *s, PACKET *pkt)
         goto err;
     }
 
-    OPENSSL_free(rawexts);
+    ossl_statem_arena_free(s, rawexts);
     return MSG_PROCESS_CONTINUE_READING;
 
  err:
-    OPENSSL_free(rawexts);
+    ossl_statem_arena_free(s, rawexts);
     return MSG_PROCESS_ERROR;
 }
 
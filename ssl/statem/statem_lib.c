@@ -221,6 +221,84 @@ static int get_cert_verify_tbs_data(SSL *s, unsigned char *tls13tbs,
     return 1;
 }
 
+/*
+ * Handle the return value |ret| of a private key method callback that produced
+ * |outlen| bytes of output into a buffer of size |maxout|. Returns 1 if the
+ * operation has completed, -1 if it is still pending and 0 on failure.
+ */
+static int private_key_op_result(SSL *s, int func, int ret, size_t outlen,
+                                 size_t maxout)
+{
+    if (ret == SSL_PRIVATE_KEY_RETRY
+            && s->ctx->private_key_complete_cb != NULL) {
+        s->s3->tmp.private_key_op_pending = 1;
+        s->rwstate = SSL_PRIVATE_KEY_OPERATION;
+        return -1;
+    }
+
+    s->s3->tmp.private_key_op_pending = 0;
+    s->rwstate = SSL_NOTHING;
+    if (ret != SSL_PRIVATE_KEY_SUCCESS) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, func,
+                 SSL_R_PRIVATE_KEY_OPERATION_FAILED);
+        return 0;
+    }
+    if (outlen > maxout) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, func, ERR_R_INTERNAL_ERROR);
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Sign |tbs| for the signature algorithm |lu| with the private key method of
+ * the SSL_CTX, or collect the signature of a pending operation. Returns 1 on
+ * success, -1 if the operation has not completed yet and 0 on failure.
+ */
+int tls_private_key_sign(SSL *s, const SIGALG_LOOKUP *lu, unsigned char *sig,
+                         size_t *siglen, size_t maxsig,
+                         const unsigned char *tbs, size_t tbslen)
+{
+    SSL_CTX *ctx = s->ctx;
+    int ret;
+
+    *siglen = 0;
+    if (s->s3->tmp.private_key_op_pending)
+        ret = ctx->private_key_complete_cb(s, sig, siglen, maxsig,
+                                           ctx->private_key_cb_arg);
+    else
+        ret = ctx->private_key_sign_cb(s, sig, siglen, maxsig, lu->sigalg,
+                                       tbs, tbslen, ctx->private_key_cb_arg);
+
+    return private_key_op_result(s, SSL_F_TLS_PRIVATE_KEY_SIGN, ret, *siglen,
+                                 maxsig);
+}
+
+/*
+ * Perform a raw RSA decryption of |in| with the private key method of the
+ * SSL_CTX, or collect the result of a pending operation. Returns 1 on success,
+ * -1 if the operation has not completed yet and 0 on failure.
+ */
+int tls_private_key_decrypt(SSL *s, unsigned char *out, size_t *outlen,
+                            size_t maxout, const unsigned char *in,
+                            size_t inlen)
+{
+    SSL_CTX *ctx = s->ctx;
+    int ret;
+
+    *outlen = 0;
+    if (s->s3->tmp.private_key_op_pending)
+        ret = ctx->private_key_complete_cb(s, out, outlen, maxout,
+                                           ctx->private_key_cb_arg);
+    else
+        ret = ctx->private_key_decrypt_cb(s, out, outlen, maxout, in, inlen,
+                                          ctx->private_key_cb_arg);
+
+    return private_key_op_result(s, SSL_F_TLS_PRIVATE_KEY_DECRYPT, ret,
+                                 *outlen, maxout);
+}
+
 int tls_construct_cert_verify(SSL *s, WPACKET *pkt)
 {
     EVP_PKEY *pkey = NULL;
@@ -272,36 +350,43 @@ int tls_construct_cert_verify(SSL *s, WPACKET *pkt)
         goto err;
     }
 
-    if (EVP_DigestSignInit(mctx, &pctx, md, NULL, pkey) <= 0) {
-        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_CONSTRUCT_CERT_VERIFY,
-                 ERR_R_EVP_LIB);
-        goto err;
-    }
-
-    if (lu->sig == EVP_PKEY_RSA_PSS) {
-        if (EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) <= 0
-            || EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx,
-                                                RSA_PSS_SALTLEN_DIGEST) <= 0) {
+    if (s->ctx->private_key_sign_cb != NULL && s->version != SSL3_VERSION) {
+        /* SSLfatal() already called on failure */
+        if (tls_private_key_sign(s, lu, sig, &siglen, siglen, hdata,
+                                 hdatalen) <= 0)
+            goto err;
+    } else {
+        if (EVP_DigestSignInit(mctx, &pctx, md, NULL, pkey) <= 0) {
             SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_CONSTRUCT_CERT_VERIFY,
                      ERR_R_EVP_LIB);
             goto err;
         }
-    }
-    if (s->version == SSL3_VERSION) {
-        if (EVP_DigestSignUpdate(mctx, hdata, hdatalen) <= 0
-            || !EVP_MD_CTX_ctrl(mctx, EVP_CTRL_SSL3_MASTER_SECRET,
-                                (int)s->session->master_key_length,
-                                s->session->master_key)
-            || EVP_DigestSignFinal(mctx, sig, &siglen) <= 0) {
 
+        if (lu->sig == EVP_PKEY_RSA_PSS) {
+            if (EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) <= 0
+                || EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx,
+                                                RSA_PSS_SALTLEN_DIGEST) <= 0) {
+                SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                         SSL_F_TLS_CONSTRUCT_CERT_VERIFY, ERR_R_EVP_LIB);
+                goto err;
+            }
+        }
+        if (s->version == SSL3_VERSION) {
+            if (EVP_DigestSignUpdate(mctx, hdata, hdatalen) <= 0
+                || !EVP_MD_CTX_ctrl(mctx, EVP_CTRL_SSL3_MASTER_SECRET,
+                                    (int)s->session->master_key_length,
+                                    s->session->master_key)
+                || EVP_DigestSignFinal(mctx, sig, &siglen) <= 0) {
+
+                SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                         SSL_F_TLS_CONSTRUCT_CERT_VERIFY, ERR_R_EVP_LIB);
+                goto err;
+            }
+        } else if (EVP_DigestSign(mctx, sig, &siglen, hdata, hdatalen) <= 0) {
             SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_CONSTRUCT_CERT_VERIFY,
                      ERR_R_EVP_LIB);
             goto err;
         }
-    } else if (EVP_DigestSign(mctx, sig, &siglen, hdata, hdatalen) <= 0) {
-        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_CONSTRUCT_CERT_VERIFY,
-                 ERR_R_EVP_LIB);
-        goto err;
     }
 
 #ifndef OPENSSL_NO_GOST
@@ -1029,6 +1114,8 @@ WORK_STATE tls_finish_handshake(SSL *s, WORK_STATE wst, int clearbufs, int stop)
         s->init_num = 0;
     }
 
+    ossl_statem_arena_release(s);
+
     if (SSL_IS_TLS13(s) && !s->server
             && s->post_handshake_auth == SSL_PHA_REQUESTED)
         s->post_handshake_auth = SSL_PHA_EXT_SENT;
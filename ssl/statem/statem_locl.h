@@ -109,6 +109,13 @@ __owur MSG_PROCESS_RETURN tls_process_key_update(SSL *s, PACKET *pkt);
 __owur WORK_STATE tls_finish_handshake(SSL *s, WORK_STATE wst, int clearbufs,
                                        int stop);
 __owur WORK_STATE dtls_wait_for_dry(SSL *s);
+__owur int tls_private_key_sign(SSL *s, const SIGALG_LOOKUP *lu,
+                                unsigned char *sig, size_t *siglen,
+                                size_t maxsig, const unsigned char *tbs,
+                                size_t tbslen);
+__owur int tls_private_key_decrypt(SSL *s, unsigned char *out, size_t *outlen,
+                                   size_t maxout, const unsigned char *in,
+                                   size_t inlen);
 
 /* some client-only functions */
 __owur int tls_construct_client_hello(SSL *s, WPACKET *pkt);
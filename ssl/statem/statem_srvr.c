@@ -1344,7 +1344,7 @@ MSG_PROCESS_RETURN tls_process_client_hello(SSL *s, PACKET *pkt)
         s->new_session = 1;
     }
 
-    clienthello = OPENSSL_zalloc(sizeof(*clienthello));
+    clienthello = ossl_statem_arena_zalloc(s, sizeof(*clienthello));
     if (clienthello == NULL) {
         SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CLIENT_HELLO,
                  ERR_R_INTERNAL_ERROR);
@@ -1539,8 +1539,8 @@ MSG_PROCESS_RETURN tls_process_client_hello(SSL *s, PACKET *pkt)
 
  err:
     if (clienthello != NULL)
-        OPENSSL_free(clienthello->pre_proc_exts);
-    OPENSSL_free(clienthello);
+        ossl_statem_arena_free(s, clienthello->pre_proc_exts);
+    ossl_statem_arena_free(s, clienthello);
 
     return MSG_PROCESS_ERROR;
 }
@@ -2032,15 +2032,15 @@ static int tls_early_post_process_client_hello(SSL *s)
 
     sk_SSL_CIPHER_free(ciphers);
     sk_SSL_CIPHER_free(scsvs);
-    OPENSSL_free(clienthello->pre_proc_exts);
-    OPENSSL_free(s->clienthello);
+    ossl_statem_arena_free(s, clienthello->pre_proc_exts);
+    ossl_statem_arena_free(s, s->clienthello);
     s->clienthello = NULL;
     return 1;
  err:
     sk_SSL_CIPHER_free(ciphers);
     sk_SSL_CIPHER_free(scsvs);
-    OPENSSL_free(clienthello->pre_proc_exts);
-    OPENSSL_free(s->clienthello);
+    ossl_statem_arena_free(s, clienthello->pre_proc_exts);
+    ossl_statem_arena_free(s, s->clienthello);
     s->clienthello = NULL;
 
     return 0;
@@ -2447,6 +2447,21 @@ int tls_construct_server_key_exchange(SSL *s, WPACKET *pkt)
         goto err;
     }
 
+    if (s->s3->tmp.ske_params != NULL) {
+        /*
+         * We have been called again because the private key method had not
+         * finished signing the parameters generated last time. Send those.
+         */
+        if (!WPACKET_memcpy(pkt, s->s3->tmp.ske_params,
+                            s->s3->tmp.ske_params_len)) {
+            SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                     SSL_F_TLS_CONSTRUCT_SERVER_KEY_EXCHANGE,
+                     ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+        goto sign;
+    }
+
     type = s->s3->tmp.new_cipher->algorithm_mkey;
 
     r[0] = r[1] = r[2] = r[3] = NULL;
@@ -2696,6 +2711,7 @@ int tls_construct_server_key_exchange(SSL *s, WPACKET *pkt)
     }
 #endif
 
+ sign:
     /* not anonymous */
     if (lu != NULL) {
         EVP_PKEY *pkey = s->s3->tmp.cert->privatekey;
@@ -2733,13 +2749,14 @@ int tls_construct_server_key_exchange(SSL *s, WPACKET *pkt)
          */
         siglen = EVP_PKEY_size(pkey);
         if (!WPACKET_sub_reserve_bytes_u16(pkt, siglen, &sigbytes1)
-            || EVP_DigestSignInit(md_ctx, &pctx, md, NULL, pkey) <= 0) {
+            || (s->ctx->private_key_sign_cb == NULL
+                && EVP_DigestSignInit(md_ctx, &pctx, md, NULL, pkey) <= 0)) {
             SSLfatal(s, SSL_AD_INTERNAL_ERROR,
                      SSL_F_TLS_CONSTRUCT_SERVER_KEY_EXCHANGE,
                      ERR_R_INTERNAL_ERROR);
             goto err;
         }
-        if (lu->sig == EVP_PKEY_RSA_PSS) {
+        if (pctx != NULL && lu->sig == EVP_PKEY_RSA_PSS) {
             if (EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) <= 0
                 || EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, RSA_PSS_SALTLEN_DIGEST) <= 0) {
                 SSLfatal(s, SSL_AD_INTERNAL_ERROR,
@@ -2755,8 +2772,36 @@ int tls_construct_server_key_exchange(SSL *s, WPACKET *pkt)
             /* SSLfatal() already called */
             goto err;
         }
-        rv = EVP_DigestSign(md_ctx, sigbytes1, &siglen, tbs, tbslen);
-        OPENSSL_free(tbs);
+        if (s->ctx->private_key_sign_cb != NULL) {
+            rv = tls_private_key_sign(s, lu, sigbytes1, &siglen, siglen, tbs,
+                                      tbslen);
+            OPENSSL_free(tbs);
+            if (rv < 0) {
+                /* Keep the parameters until their signature is available */
+                if (s->s3->tmp.ske_params == NULL) {
+                    s->s3->tmp.ske_params =
+                        OPENSSL_memdup(s->init_buf->data + paramoffset,
+                                       paramlen);
+                    if (s->s3->tmp.ske_params == NULL) {
+                        SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                                 SSL_F_TLS_CONSTRUCT_SERVER_KEY_EXCHANGE,
+                                 ERR_R_MALLOC_FAILURE);
+                        goto err;
+                    }
+                    s->s3->tmp.ske_params_len = paramlen;
+                }
+                goto err;
+            }
+            OPENSSL_free(s->s3->tmp.ske_params);
+            s->s3->tmp.ske_params = NULL;
+            if (rv == 0) {
+                /* SSLfatal() already called */
+                goto err;
+            }
+        } else {
+            rv = EVP_DigestSign(md_ctx, sigbytes1, &siglen, tbs, tbslen);
+            OPENSSL_free(tbs);
+        }
         if (rv <= 0 || !WPACKET_sub_allocate_bytes_u16(pkt, siglen, &sigbytes2)
             || sigbytes1 != sigbytes2) {
             SSLfatal(s, SSL_AD_INTERNAL_ERROR,
@@ -2918,55 +2963,17 @@ static int tls_process_cke_psk_preamble(SSL *s, PACKET *pkt)
 #endif
 }
 
-static int tls_process_cke_rsa(SSL *s, PACKET *pkt)
-{
 #ifndef OPENSSL_NO_RSA
+/*
+ * Check the PKCS#1 padding of the |decrypt_len| bytes of the RSA decrypted
+ * premaster secret in |rsa_decrypt| and generate the master secret from it.
+ */
+static int tls_process_rsa_premaster(SSL *s, unsigned char *rsa_decrypt,
+                                     size_t decrypt_len)
+{
     unsigned char rand_premaster_secret[SSL_MAX_MASTER_KEY_LENGTH];
-    int decrypt_len;
     unsigned char decrypt_good, version_good;
     size_t j, padding_len;
-    PACKET enc_premaster;
-    RSA *rsa = NULL;
-    unsigned char *rsa_decrypt = NULL;
-    int ret = 0;
-
-    rsa = EVP_PKEY_get0_RSA(s->cert->pkeys[SSL_PKEY_RSA].privatekey);
-    if (rsa == NULL) {
-        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
-                 SSL_R_MISSING_RSA_CERTIFICATE);
-        return 0;
-    }
-
-    /* SSLv3 and pre-standard DTLS omit the length bytes. */
-    if (s->version == SSL3_VERSION || s->version == DTLS1_BAD_VER) {
-        enc_premaster = *pkt;
-    } else {
-        if (!PACKET_get_length_prefixed_2(pkt, &enc_premaster)
-            || PACKET_remaining(pkt) != 0) {
-            SSLfatal(s, SSL_AD_DECODE_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
-                     SSL_R_LENGTH_MISMATCH);
-            return 0;
-        }
-    }
-
-    /*
-     * We want to be sure that the plaintext buffer size makes it safe to
-     * iterate over the entire size of a premaster secret
-     * (SSL_MAX_MASTER_KEY_LENGTH). Reject overly short RSA keys because
-     * their ciphertext cannot accommodate a premaster secret anyway.
-     */
-    if (RSA_size(rsa) < SSL_MAX_MASTER_KEY_LENGTH) {
-        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
-                 RSA_R_KEY_SIZE_TOO_SMALL);
-        return 0;
-    }
-
-    rsa_decrypt = OPENSSL_malloc(RSA_size(rsa));
-    if (rsa_decrypt == NULL) {
-        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
-                 ERR_R_MALLOC_FAILURE);
-        return 0;
-    }
 
     /*
      * We must not leak whether a decryption failure occurs because of
@@ -2978,23 +2985,9 @@ static int tls_process_cke_rsa(SSL *s, PACKET *pkt)
 
     if (RAND_priv_bytes(rand_premaster_secret,
                       sizeof(rand_premaster_secret)) <= 0) {
-        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_RSA_PREMASTER,
                  ERR_R_INTERNAL_ERROR);
-        goto err;
-    }
-
-    /*
-     * Decrypt with no padding. PKCS#1 padding will be removed as part of
-     * the timing-sensitive code below.
-     */
-     /* TODO(size_t): Convert this function */
-    decrypt_len = (int)RSA_private_decrypt((int)PACKET_remaining(&enc_premaster),
-                                           PACKET_data(&enc_premaster),
-                                           rsa_decrypt, rsa, RSA_NO_PADDING);
-    if (decrypt_len < 0) {
-        SSLfatal(s, SSL_AD_DECRYPT_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
-                 ERR_R_INTERNAL_ERROR);
-        goto err;
+        return 0;
     }
 
     /* Check the padding. See RFC 3447, section 7.2.2. */
@@ -3005,9 +2998,9 @@ static int tls_process_cke_rsa(SSL *s, PACKET *pkt)
      * PS is at least 8 bytes.
      */
     if (decrypt_len < 11 + SSL_MAX_MASTER_KEY_LENGTH) {
-        SSLfatal(s, SSL_AD_DECRYPT_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
+        SSLfatal(s, SSL_AD_DECRYPT_ERROR, SSL_F_TLS_PROCESS_RSA_PREMASTER,
                  SSL_R_DECRYPTION_FAILED);
-        goto err;
+        return 0;
     }
 
     padding_len = decrypt_len - SSL_MAX_MASTER_KEY_LENGTH;
@@ -3074,6 +3067,90 @@ static int tls_process_cke_rsa(SSL *s, PACKET *pkt)
     if (!ssl_generate_master_secret(s, rsa_decrypt + padding_len,
                                     sizeof(rand_premaster_secret), 0)) {
         /* SSLfatal() already called */
+        return 0;
+    }
+
+    return 1;
+}
+#endif
+
+static int tls_process_cke_rsa(SSL *s, PACKET *pkt)
+{
+#ifndef OPENSSL_NO_RSA
+    int decrypt_len;
+    PACKET enc_premaster;
+    RSA *rsa = NULL;
+    unsigned char *rsa_decrypt = NULL;
+    int ret = 0;
+
+    rsa = EVP_PKEY_get0_RSA(s->cert->pkeys[SSL_PKEY_RSA].privatekey);
+    if (rsa == NULL) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
+                 SSL_R_MISSING_RSA_CERTIFICATE);
+        return 0;
+    }
+
+    /* SSLv3 and pre-standard DTLS omit the length bytes. */
+    if (s->version == SSL3_VERSION || s->version == DTLS1_BAD_VER) {
+        enc_premaster = *pkt;
+    } else {
+        if (!PACKET_get_length_prefixed_2(pkt, &enc_premaster)
+            || PACKET_remaining(pkt) != 0) {
+            SSLfatal(s, SSL_AD_DECODE_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
+                     SSL_R_LENGTH_MISMATCH);
+            return 0;
+        }
+    }
+
+    /*
+     * We want to be sure that the plaintext buffer size makes it safe to
+     * iterate over the entire size of a premaster secret
+     * (SSL_MAX_MASTER_KEY_LENGTH). Reject overly short RSA keys because
+     * their ciphertext cannot accommodate a premaster secret anyway.
+     */
+    if (RSA_size(rsa) < SSL_MAX_MASTER_KEY_LENGTH) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
+                 RSA_R_KEY_SIZE_TOO_SMALL);
+        return 0;
+    }
+
+    if (s->ctx->private_key_decrypt_cb != NULL) {
+        /*
+         * Leave the decryption to tls_post_process_client_key_exchange(),
+         * where the private key method can suspend the handshake.
+         */
+        if (!PACKET_memdup(&enc_premaster, &s->s3->tmp.enc_premaster,
+                           &s->s3->tmp.enc_premaster_len)) {
+            SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
+                     ERR_R_MALLOC_FAILURE);
+            return 0;
+        }
+        return 1;
+    }
+
+    rsa_decrypt = OPENSSL_malloc(RSA_size(rsa));
+    if (rsa_decrypt == NULL) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
+                 ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+
+    /*
+     * Decrypt with no padding. PKCS#1 padding will be removed as part of
+     * the timing-sensitive code below.
+     */
+     /* TODO(size_t): Convert this function */
+    decrypt_len = (int)RSA_private_decrypt((int)PACKET_remaining(&enc_premaster),
+                                           PACKET_data(&enc_premaster),
+                                           rsa_decrypt, rsa, RSA_NO_PADDING);
+    if (decrypt_len < 0) {
+        SSLfatal(s, SSL_AD_DECRYPT_ERROR, SSL_F_TLS_PROCESS_CKE_RSA,
+                 ERR_R_INTERNAL_ERROR);
+        goto err;
+    }
+
+    if (!tls_process_rsa_premaster(s, rsa_decrypt, decrypt_len)) {
+        /* SSLfatal() already called */
         goto err;
     }
 
@@ -3089,6 +3166,56 @@ static int tls_process_cke_rsa(SSL *s, PACKET *pkt)
 #endif
 }
 
+/*
+ * Decrypt the premaster secret saved by tls_process_cke_rsa() with the private
+ * key method. Returns 1 on success, 0 on failure and -1 if the operation has
+ * not completed yet.
+ */
+static int tls_post_process_cke_rsa(SSL *s)
+{
+#ifndef OPENSSL_NO_RSA
+    RSA *rsa;
+    unsigned char *rsa_decrypt;
+    size_t decrypt_len, maxlen;
+    int ret;
+
+    rsa = EVP_PKEY_get0_RSA(s->cert->pkeys[SSL_PKEY_RSA].privatekey);
+    if (rsa == NULL) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_POST_PROCESS_CKE_RSA,
+                 SSL_R_MISSING_RSA_CERTIFICATE);
+        return 0;
+    }
+
+    maxlen = RSA_size(rsa);
+    rsa_decrypt = OPENSSL_malloc(maxlen);
+    if (rsa_decrypt == NULL) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_POST_PROCESS_CKE_RSA,
+                 ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+
+    ret = tls_private_key_decrypt(s, rsa_decrypt, &decrypt_len, maxlen,
+                                  s->s3->tmp.enc_premaster,
+                                  s->s3->tmp.enc_premaster_len);
+    if (ret > 0 && !tls_process_rsa_premaster(s, rsa_decrypt, decrypt_len)) {
+        /* SSLfatal() already called */
+        ret = 0;
+    }
+    if (ret >= 0) {
+        OPENSSL_free(s->s3->tmp.enc_premaster);
+        s->s3->tmp.enc_premaster = NULL;
+        s->s3->tmp.enc_premaster_len = 0;
+    }
+    OPENSSL_free(rsa_decrypt);
+    return ret;
+#else
+    /* Should never happen */
+    SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_POST_PROCESS_CKE_RSA,
+             ERR_R_INTERNAL_ERROR);
+    return 0;
+#endif
+}
+
 static int tls_process_cke_dhe(SSL *s, PACKET *pkt)
 {
 #ifndef OPENSSL_NO_DH
@@ -3449,6 +3576,16 @@ MSG_PROCESS_RETURN tls_process_client_key_exchange(SSL *s, PACKET *pkt)
 
 WORK_STATE tls_post_process_client_key_exchange(SSL *s, WORK_STATE wst)
 {
+    if (wst == WORK_MORE_A && s->s3->tmp.enc_premaster != NULL) {
+        switch (tls_post_process_cke_rsa(s)) {
+        case 0:
+            /* SSLfatal() already called */
+            return WORK_ERROR;
+        case -1:
+            return WORK_MORE_A;
+        }
+    }
+
 #ifndef OPENSSL_NO_SCTP
     if (wst == WORK_MORE_A) {
         if (SSL_IS_DTLS(s)) {
@@ -3580,10 +3717,10 @@ MSG_PROCESS_RETURN tls_process_client_certificate(SSL *s, PACKET *pkt)
                 || !tls_parse_all_extensions(s, SSL_EXT_TLS1_3_CERTIFICATE,
                                              rawexts, x, chainidx,
                                              PACKET_remaining(&spkt) == 0)) {
-                OPENSSL_free(rawexts);
+                ossl_statem_arena_free(s, rawexts);
                 goto err;
             }
-            OPENSSL_free(rawexts);
+            ossl_statem_arena_free(s, rawexts);
         }
 
         if (!sk_X509_push(sk, x)) {
@@ -3801,8 +3938,7 @@ static int construct_stateless_ticket(SSL *s, WPACKET *pkt, uint32_t age_add,
     }
 
     ctx = EVP_CIPHER_CTX_new();
-    hctx = HMAC_CTX_new();
-    if (ctx == NULL || hctx == NULL) {
+    if (ctx == NULL) {
         SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_CONSTRUCT_STATELESS_TICKET,
                  ERR_R_MALLOC_FAILURE);
         goto err;
@@ -3845,12 +3981,20 @@ static int construct_stateless_ticket(SSL *s, WPACKET *pkt, uint32_t age_add,
 
     /*
      * Initialize HMAC and cipher contexts. If callback present it does
-     * all the work otherwise use generated values from parent ctx.
+     * all the work otherwise use the current key of the ticket key ring,
+     * which protects the ticket with AES-256-GCM and needs no HMAC.
      */
     if (tctx->ext.ticket_key_cb) {
         /* if 0 is returned, write an empty ticket */
-        int ret = tctx->ext.ticket_key_cb(s, key_name, iv, ctx,
-                                             hctx, 1);
+        int ret;
+
+        hctx = HMAC_CTX_new();
+        if (hctx == NULL) {
+            SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                     SSL_F_CONSTRUCT_STATELESS_TICKET, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+        ret = tctx->ext.ticket_key_cb(s, key_name, iv, ctx, hctx, 1);
 
         if (ret == 0) {
 
@@ -3874,21 +4018,13 @@ static int construct_stateless_ticket(SSL *s, WPACKET *pkt, uint32_t age_add,
         }
         iv_len = EVP_CIPHER_CTX_iv_length(ctx);
     } else {
-        const EVP_CIPHER *cipher = EVP_aes_256_cbc();
-
-        iv_len = EVP_CIPHER_iv_length(cipher);
-        if (RAND_bytes(iv, iv_len) <= 0
-                || !EVP_EncryptInit_ex(ctx, cipher, NULL,
-                                       tctx->ext.secure->tick_aes_key, iv)
-                || !HMAC_Init_ex(hctx, tctx->ext.secure->tick_hmac_key,
-                                 sizeof(tctx->ext.secure->tick_hmac_key),
-                                 EVP_sha256(), NULL)) {
+        iv_len = TLSEXT_TICK_IV_LENGTH;
+        if (!ssl_ticket_key_ring_encrypt_init(tctx->ext.ticket_keys,
+                                              key_name, iv, ctx)) {
             SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_CONSTRUCT_STATELESS_TICKET,
                      ERR_R_INTERNAL_ERROR);
             goto err;
         }
-        memcpy(key_name, tctx->ext.tick_key_name,
-               sizeof(tctx->ext.tick_key_name));
     }
 
     if (!create_ticket_prequel(s, pkt, age_add, tick_nonce)) {
@@ -3901,6 +4037,10 @@ static int construct_stateless_ticket(SSL *s, WPACKET *pkt, uint32_t age_add,
             || !WPACKET_memcpy(pkt, key_name, sizeof(key_name))
                /* output IV */
             || !WPACKET_memcpy(pkt, iv, iv_len)
+               /* The key name is authenticated along with the session */
+            || (hctx == NULL
+                && !EVP_EncryptUpdate(ctx, NULL, &len, key_name,
+                                      sizeof(key_name)))
             || !WPACKET_reserve_bytes(pkt, slen + EVP_MAX_BLOCK_LENGTH,
                                       &encdata1)
                /* Encrypt session data */
@@ -3908,10 +4048,26 @@ static int construct_stateless_ticket(SSL *s, WPACKET *pkt, uint32_t age_add,
             || !WPACKET_allocate_bytes(pkt, len, &encdata2)
             || encdata1 != encdata2
             || !EVP_EncryptFinal(ctx, encdata1 + len, &lenfinal)
-            || !WPACKET_allocate_bytes(pkt, lenfinal, &encdata2)
-            || encdata1 + len != encdata2
-            || len + lenfinal > slen + EVP_MAX_BLOCK_LENGTH
-            || !WPACKET_get_total_written(pkt, &macendoffset)
+               /* Nothing is left over for AEAD and stream ciphers */
+            || (lenfinal > 0
+                && (!WPACKET_allocate_bytes(pkt, lenfinal, &encdata2)
+                    || encdata1 + len != encdata2))
+            || len + lenfinal > slen + EVP_MAX_BLOCK_LENGTH) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                 SSL_F_CONSTRUCT_STATELESS_TICKET, ERR_R_INTERNAL_ERROR);
+        goto err;
+    }
+
+    if (hctx == NULL) {
+        /* Output the GCM tag */
+        if (!WPACKET_allocate_bytes(pkt, TLSEXT_TICK_TAG_LENGTH, &macdata1)
+                || !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
+                                        TLSEXT_TICK_TAG_LENGTH, macdata1)) {
+            SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                     SSL_F_CONSTRUCT_STATELESS_TICKET, ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+    } else if (!WPACKET_get_total_written(pkt, &macendoffset)
             || !HMAC_Update(hctx,
                             (unsigned char *)s->init_buf->data + macoffset,
                             macendoffset - macoffset)
@@ -1282,7 +1282,7 @@ SSL_TICKET_STATUS tls_decrypt_ticket(SSL *s, const unsigned char *etick,
     const unsigned char *p;
     int slen, renew_ticket = 0, declen;
     SSL_TICKET_STATUS ret = SSL_TICKET_FATAL_ERR_OTHER;
-    size_t mlen;
+    size_t mlen, ivlen;
     unsigned char tick_hmac[EVP_MAX_MD_SIZE];
     HMAC_CTX *hctx = NULL;
     EVP_CIPHER_CTX *ctx = NULL;
@@ -1313,12 +1313,6 @@ SSL_TICKET_STATUS tls_decrypt_ticket(SSL *s, const unsigned char *etick,
         goto end;
     }
 
-    /* Initialize session ticket encryption and HMAC contexts */
-    hctx = HMAC_CTX_new();
-    if (hctx == NULL) {
-        ret = SSL_TICKET_FATAL_ERR_MALLOC;
-        goto end;
-    }
     ctx = EVP_CIPHER_CTX_new();
     if (ctx == NULL) {
         ret = SSL_TICKET_FATAL_ERR_MALLOC;
@@ -1326,9 +1320,17 @@ SSL_TICKET_STATUS tls_decrypt_ticket(SSL *s, const unsigned char *etick,
     }
     if (tctx->ext.ticket_key_cb) {
         unsigned char *nctick = (unsigned char *)etick;
-        int rv = tctx->ext.ticket_key_cb(s, nctick,
-                                         nctick + TLSEXT_KEYNAME_LENGTH,
-                                         ctx, hctx, 0);
+        int rv;
+
+        /* Initialize session ticket encryption and HMAC contexts */
+        hctx = HMAC_CTX_new();
+        if (hctx == NULL) {
+            ret = SSL_TICKET_FATAL_ERR_MALLOC;
+            goto end;
+        }
+        rv = tctx->ext.ticket_key_cb(s, nctick,
+                                     nctick + TLSEXT_KEYNAME_LENGTH,
+                                     ctx, hctx, 0);
         if (rv < 0) {
             ret = SSL_TICKET_FATAL_ERR_OTHER;
             goto end;
@@ -1339,57 +1341,70 @@ SSL_TICKET_STATUS tls_decrypt_ticket(SSL *s, const unsigned char *etick,
         }
         if (rv == 2)
             renew_ticket = 1;
-    } else {
-        /* Check key name matches */
-        if (memcmp(etick, tctx->ext.tick_key_name,
-                   TLSEXT_KEYNAME_LENGTH) != 0) {
-            ret = SSL_TICKET_NO_DECRYPT;
+
+        /*
+         * Attempt to process session ticket, first conduct sanity and
+         * integrity checks on ticket.
+         */
+        mlen = HMAC_size(hctx);
+        if (mlen == 0) {
+            ret = SSL_TICKET_FATAL_ERR_OTHER;
             goto end;
         }
-        if (HMAC_Init_ex(hctx, tctx->ext.secure->tick_hmac_key,
-                         sizeof(tctx->ext.secure->tick_hmac_key),
-                         EVP_sha256(), NULL) <= 0
-            || EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL,
-                                  tctx->ext.secure->tick_aes_key,
-                                  etick + TLSEXT_KEYNAME_LENGTH) <= 0) {
+        ivlen = EVP_CIPHER_CTX_iv_length(ctx);
+    } else {
+        int rv;
+
+        /* The tag stands in for the HMAC of the callback format */
+        mlen = TLSEXT_TICK_TAG_LENGTH;
+        ivlen = TLSEXT_TICK_IV_LENGTH;
+        rv = ssl_ticket_key_ring_decrypt_init(tctx->ext.ticket_keys, etick,
+                                              etick + TLSEXT_KEYNAME_LENGTH,
+                                              ctx, &renew_ticket);
+        if (rv < 0) {
             ret = SSL_TICKET_FATAL_ERR_OTHER;
             goto end;
         }
+        if (rv == 0) {
+            ret = SSL_TICKET_NO_DECRYPT;
+            goto end;
+        }
         if (SSL_IS_TLS13(s))
             renew_ticket = 1;
     }
-    /*
-     * Attempt to process session ticket, first conduct sanity and integrity
-     * checks on ticket.
-     */
-    mlen = HMAC_size(hctx);
-    if (mlen == 0) {
-        ret = SSL_TICKET_FATAL_ERR_OTHER;
-        goto end;
-    }
 
     /* Sanity check ticket length: must exceed keyname + IV + HMAC */
-    if (eticklen <=
-        TLSEXT_KEYNAME_LENGTH + EVP_CIPHER_CTX_iv_length(ctx) + mlen) {
+    if (eticklen <= TLSEXT_KEYNAME_LENGTH + ivlen + mlen) {
         ret = SSL_TICKET_NO_DECRYPT;
         goto end;
     }
     eticklen -= mlen;
-    /* Check HMAC of encrypted ticket */
-    if (HMAC_Update(hctx, etick, eticklen) <= 0
-        || HMAC_Final(hctx, tick_hmac, NULL) <= 0) {
-        ret = SSL_TICKET_FATAL_ERR_OTHER;
-        goto end;
-    }
+    if (hctx != NULL) {
+        /* Check HMAC of encrypted ticket */
+        if (HMAC_Update(hctx, etick, eticklen) <= 0
+            || HMAC_Final(hctx, tick_hmac, NULL) <= 0) {
+            ret = SSL_TICKET_FATAL_ERR_OTHER;
+            goto end;
+        }
 
-    if (CRYPTO_memcmp(tick_hmac, etick + eticklen, mlen)) {
-        ret = SSL_TICKET_NO_DECRYPT;
-        goto end;
+        if (CRYPTO_memcmp(tick_hmac, etick + eticklen, mlen)) {
+            ret = SSL_TICKET_NO_DECRYPT;
+            goto end;
+        }
+    } else {
+        /* The tag is checked by EVP_DecryptFinal() below */
+        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, (int)mlen,
+                                (unsigned char *)etick + eticklen) <= 0
+            || EVP_DecryptUpdate(ctx, NULL, &slen, etick,
+                                 TLSEXT_KEYNAME_LENGTH) <= 0) {
+            ret = SSL_TICKET_FATAL_ERR_OTHER;
+            goto end;
+        }
     }
     /* Attempt to decrypt session data */
     /* Move p after IV to start of encrypted ticket, update length */
-    p = etick + TLSEXT_KEYNAME_LENGTH + EVP_CIPHER_CTX_iv_length(ctx);
-    eticklen -= TLSEXT_KEYNAME_LENGTH + EVP_CIPHER_CTX_iv_length(ctx);
+    p = etick + TLSEXT_KEYNAME_LENGTH + ivlen;
+    eticklen -= TLSEXT_KEYNAME_LENGTH + ivlen;
     sdec = OPENSSL_malloc(eticklen);
     if (sdec == NULL || EVP_DecryptUpdate(ctx, sdec, &slen, p,
                                           (int)eticklen) <= 0) {
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Certificate decoding benchmark.
+ *
+ * Usage: asn1_dec_bench cert.pem [decodes [runs]]
+ *
+ * Every scenario decodes the DER of the certificate and frees the result
+ * |decodes| times, with or without ASN1_D2I_LAZY and with or without the
+ * template decoder's fast paths.  Reported are the nanoseconds per decode
+ * and free of the best of |runs| runs.
+ */
+
+#include <stdlib.h>
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <sys/time.h>
+#endif
+#include <openssl/asn1.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include "internal/asn1_int.h"
+#include "internal/nelem.h"
+#include "testutil.h"
+#include "testutil/output.h"
+
+#define DEFAULT_DECODES 100000
+#define DEFAULT_RUNS    5
+
+typedef struct {
+    const char *name;
+    unsigned long flags;
+    int fast_paths;
+} SCENARIO;
+
+static const SCENARIO scenarios[] = {
+    {"default", 0, 1},
+    {"default, no fast paths", 0, 0},
+    {"lazy", ASN1_D2I_LAZY, 1},
+    {"lazy, no fast paths", ASN1_D2I_LAZY, 0},
+};
+
+static size_t num_decodes = DEFAULT_DECODES;
+static size_t num_runs = DEFAULT_RUNS;
+static unsigned char *der = NULL;
+static int derlen;
+
+static double wall_time(void)
+{
+#ifdef _WIN32
+    return GetTickCount() / 1000.0;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+}
+
+static int run_scenario(int idx)
+{
+    const SCENARIO *sc = &scenarios[idx];
+    const unsigned char *p;
+    ASN1_VALUE *x;
+    double start, t, best = 0;
+    size_t i, run;
+    int ret = 0;
+
+    asn1_d2i_set_fast_paths(sc->fast_paths);
+    for (run = 0; run < num_runs; run++) {
+        start = wall_time();
+        for (i = 0; i < num_decodes; i++) {
+            p = der;
+            x = ASN1_item_d2i_flags(NULL, &p, derlen, ASN1_ITEM_rptr(X509),
+                                    sc->flags);
+            if (!TEST_ptr(x))
+                goto end;
+            ASN1_item_free(x, ASN1_ITEM_rptr(X509));
+        }
+        t = wall_time() - start;
+        if (run == 0 || t < best)
+            best = t;
+    }
+    test_printf_stdout("%-24s %8.1f ns/op\n", sc->name,
+                       best * 1e9 / num_decodes);
+    ret = 1;
+
+ end:
+    asn1_d2i_set_fast_paths(1);
+    test_flush_stdout();
+    return ret;
+}
+
+int setup_tests(void)
+{
+    BIO *bio = NULL;
+    X509 *x = NULL;
+    char *arg;
+    int ok;
+
+    if ((arg = test_get_argument(1)) != NULL) {
+        num_decodes = strtoul(arg, NULL, 10);
+        if (!TEST_size_t_gt(num_decodes, 0))
+            return 0;
+    }
+    if ((arg = test_get_argument(2)) != NULL) {
+        num_runs = strtoul(arg, NULL, 10);
+        if (!TEST_size_t_gt(num_runs, 0))
+            return 0;
+    }
+
+    ok = TEST_ptr(arg = test_get_argument(0))
+        && TEST_ptr(bio = BIO_new_file(arg, "r"))
+        && TEST_ptr(x = PEM_read_bio_X509(bio, NULL, NULL, NULL))
+        && TEST_int_gt(derlen = i2d_X509(x, &der), 0);
+    X509_free(x);
+    BIO_free(bio);
+    if (!ok) {
+        TEST_note("usage: asn1_dec_bench cert.pem [decodes [runs]]");
+        return 0;
+    }
+
+    ADD_ALL_TESTS(run_scenario, OSSL_NELEM(scenarios));
+    return 1;
+}
+
+void cleanup_tests(void)
+{
+    OPENSSL_free(der);
+}
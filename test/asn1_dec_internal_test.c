@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Internal tests of the template decoder's fast paths: every certificate
+ * given, whole, truncated and with bytes replaced, must decode the same way
+ * with and without them.
+ */
+
+#include <string.h>
+#include <openssl/asn1.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include "testutil.h"
+#include "internal/asn1_int.h"
+#include "internal/nelem.h"
+
+/* Replacements for every byte, chosen to hit the header encodings */
+static const unsigned char replacements[] = {
+    0x00, 0x1f, 0x30, 0x7f, 0x80, 0x81, 0x82, 0x83, 0xa0, 0xff
+};
+
+typedef struct {
+    X509 *x;
+    long consumed;
+    unsigned long err;
+    unsigned char *der;
+    int derlen;
+} DECODED;
+
+static void decoded_free(DECODED *d)
+{
+    X509_free(d->x);
+    OPENSSL_free(d->der);
+}
+
+static void decode(DECODED *d, const unsigned char *in, long len, int fast)
+{
+    const unsigned char *p = in;
+
+    memset(d, 0, sizeof(*d));
+    ERR_clear_error();
+    asn1_d2i_set_fast_paths(fast);
+    d->x = d2i_X509(NULL, &p, len);
+    asn1_d2i_set_fast_paths(1);
+    d->err = ERR_peek_error();
+    ERR_clear_error();
+    if (d->x != NULL) {
+        d->consumed = p - in;
+        d->derlen = i2d_X509(d->x, &d->der);
+    }
+}
+
+/*
+ * Decode |in| with and without the fast paths and compare the outcomes.
+ * With |expect_ok| set, the decode must also succeed and give |in| back.
+ */
+static int decode_same(const unsigned char *in, long len, int expect_ok)
+{
+    DECODED fast, slow;
+    int ret = 0;
+
+    decode(&fast, in, len, 1);
+    decode(&slow, in, len, 0);
+    if (!TEST_int_eq(fast.x != NULL, slow.x != NULL)
+            || !TEST_ulong_eq(fast.err, slow.err)
+            || !TEST_long_eq(fast.consumed, slow.consumed)
+            || !TEST_mem_eq(fast.der, fast.derlen, slow.der, slow.derlen))
+        goto err;
+    if (expect_ok
+            && (!TEST_ptr(fast.x)
+                || !TEST_long_eq(fast.consumed, len)
+                || !TEST_mem_eq(fast.der, fast.derlen, in, len)))
+        goto err;
+    ret = 1;
+
+ err:
+    decoded_free(&fast);
+    decoded_free(&slow);
+    return ret;
+}
+
+static unsigned char *load_der(const char *file, int *len)
+{
+    BIO *bio = NULL;
+    X509 *x = NULL;
+    unsigned char *der = NULL;
+
+    if (TEST_ptr(bio = BIO_new_file(file, "r"))
+            && TEST_ptr(x = PEM_read_bio_X509(bio, NULL, NULL, NULL))
+            && !TEST_int_gt(*len = i2d_X509(x, &der), 0)) {
+        OPENSSL_free(der);
+        der = NULL;
+    }
+    X509_free(x);
+    BIO_free(bio);
+    return der;
+}
+
+static int test_fast_paths_same(int n)
+{
+    const char *file = test_get_argument(n);
+    unsigned char *der = NULL, *buf = NULL;
+    int len, i;
+    size_t j;
+    int ret = 0;
+
+    if (!TEST_ptr(der = load_der(file, &len))
+            || !TEST_ptr(buf = OPENSSL_malloc(len)))
+        goto err;
+
+    if (!decode_same(der, len, 1))
+        goto err;
+
+    for (i = 0; i < len; i++) {
+        if (!decode_same(der, i, 0)) {
+            TEST_info("%s truncated to %d bytes", file, i);
+            goto err;
+        }
+    }
+
+    memcpy(buf, der, len);
+    for (i = 0; i < len; i++) {
+        for (j = 0; j < OSSL_NELEM(replacements); j++) {
+            if (der[i] == replacements[j])
+                continue;
+            buf[i] = replacements[j];
+            if (!decode_same(buf, len, 0)) {
+                TEST_info("%s with byte %d set to 0x%02x", file, i,
+                          replacements[j]);
+                goto err;
+            }
+        }
+        buf[i] = der[i];
+    }
+    ret = 1;
+
+ err:
+    OPENSSL_free(buf);
+    OPENSSL_free(der);
+    return ret;
+}
+
+int setup_tests(void)
+{
+    size_t n = test_get_argument_count();
+
+    if (!TEST_size_t_gt(n, 0)) {
+        TEST_note("usage: asn1_dec_internal_test cert.pem...");
+        return 0;
+    }
+
+    ADD_ALL_TESTS(test_fast_paths_same, (int)n);
+    return 1;
+}
@@ -151,6 +151,45 @@ static int rand_neg(void)
 }
 
 
+/*
+ * A context freed by the thread is handed out again, with the bignums it
+ * had, in the state of a new context.
+ */
+static int test_ctx_reuse(void)
+{
+    BN_CTX *c1 = NULL, *c2 = NULL;
+    BIGNUM *a, *b;
+    int st = 0;
+
+    if (!TEST_ptr(c1 = BN_CTX_new()))
+        goto err;
+    BN_CTX_start(c1);
+    if (!TEST_ptr(a = BN_CTX_get(c1))
+            || !TEST_true(BN_bntest_rand(a, 1024, 1, 0)))
+        goto err;
+    BN_set_flags(a, BN_FLG_CONSTTIME);
+    /* Freed without a BN_CTX_end(), as on error paths */
+    BN_CTX_free(c1);
+
+    if (!TEST_ptr(c2 = BN_CTX_new())
+            || !TEST_ptr_eq(c2, c1))
+        goto err;
+    c1 = NULL;
+    BN_CTX_start(c2);
+    if (!TEST_ptr(b = BN_CTX_get(c2))
+            || !TEST_ptr_eq(b, a)
+            || !TEST_true(BN_is_zero(b))
+            || !TEST_false(BN_get_flags(b, BN_FLG_CONSTTIME))
+            || !TEST_ptr(BN_CTX_get(c2)))
+        goto err;
+    BN_CTX_end(c2);
+    st = 1;
+ err:
+    BN_CTX_free(c1);
+    BN_CTX_free(c2);
+    return st;
+}
+
 static int test_swap(void)
 {
     BIGNUM *a = NULL, *b = NULL, *c = NULL, *d = NULL;
@@ -2262,6 +2301,7 @@ int setup_tests(void)
         ADD_TEST(test_expmodone);
         ADD_TEST(test_smallprime);
         ADD_TEST(test_swap);
+        ADD_TEST(test_ctx_reuse);
 #ifndef OPENSSL_NO_EC2M
         ADD_TEST(test_gf2m_add);
         ADD_TEST(test_gf2m_mod);
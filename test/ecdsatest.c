@@ -27,6 +27,7 @@
 # endif
 # include <openssl/err.h>
 # include <openssl/rand.h>
+# include "internal/nelem.h"
 
 /* functions to change the RAND_METHOD */
 static int fbytes(unsigned char *buf, int num);
@@ -390,6 +391,91 @@ static int test_builtin(void)
 
     return ret;
 }
+
+/* More than fits in a single batch */
+# define NUM_BATCH_SIGS 70
+
+static int test_verify_batch(void)
+{
+    static const int nids[] = {
+        NID_X9_62_prime256v1, NID_secp384r1, NID_X9_62_prime256v1
+    };
+    EC_KEY *keys[OSSL_NELEM(nids)] = { NULL };
+    unsigned char digests[NUM_BATCH_SIGS][32];
+    const unsigned char *dgst[NUM_BATCH_SIGS];
+    int dgst_len[NUM_BATCH_SIGS];
+    ECDSA_SIG *sigs[NUM_BATCH_SIGS] = { NULL };
+    EC_KEY *eckey[NUM_BATCH_SIGS];
+    int results[NUM_BATCH_SIGS], expected;
+    const BIGNUM *sig_r;
+    BIGNUM *r = NULL, *s = NULL;
+    size_t i;
+    int ret = 0;
+
+    for (i = 0; i < OSSL_NELEM(nids); i++)
+        if (!TEST_ptr(keys[i] = EC_KEY_new_by_curve_name(nids[i]))
+                || !TEST_true(EC_KEY_generate_key(keys[i])))
+            goto err;
+
+    for (i = 0; i < NUM_BATCH_SIGS; i++) {
+        eckey[i] = keys[i % OSSL_NELEM(keys)];
+        dgst[i] = digests[i];
+        /* Also exercise digests shorter and longer than the order */
+        dgst_len[i] = i % 4 == 0 ? 20 : 32;
+        if (!TEST_true(RAND_bytes(digests[i], sizeof(digests[i])))
+                || !TEST_ptr(sigs[i] = ECDSA_do_sign(dgst[i], dgst_len[i],
+                                                     eckey[i])))
+            goto err;
+    }
+
+    if (!TEST_int_eq(ECDSA_do_verify_batch(dgst, dgst_len,
+                                           (const ECDSA_SIG **)sigs, eckey,
+                                           NUM_BATCH_SIGS, results), 1))
+        goto err;
+    for (i = 0; i < NUM_BATCH_SIGS; i++)
+        if (!TEST_int_eq(results[i], 1))
+            goto err;
+
+    /* Wrong digest */
+    digests[4][1] ^= 1;
+    /* Wrong key on the same curve */
+    eckey[9] = eckey[9] == keys[0] ? keys[2] : keys[0];
+    /* Wrong key on another curve */
+    eckey[20] = keys[1];
+    eckey[22] = keys[0];
+    /* s out of range */
+    ECDSA_SIG_get0(sigs[62], &sig_r, NULL);
+    if (!TEST_ptr(r = BN_dup(sig_r))
+            || !TEST_ptr(s = BN_dup(EC_GROUP_get0_order(
+                                        EC_KEY_get0_group(eckey[62]))))
+            || !TEST_true(ECDSA_SIG_set0(sigs[62], r, s))) {
+        BN_free(r);
+        BN_free(s);
+        goto err;
+    }
+
+    if (!TEST_int_eq(ECDSA_do_verify_batch(dgst, dgst_len,
+                                           (const ECDSA_SIG **)sigs, eckey,
+                                           NUM_BATCH_SIGS, results), 0))
+        goto err;
+    for (i = 0; i < NUM_BATCH_SIGS; i++) {
+        expected = i == 4 || i == 9 || i == 20 || i == 22 || i == 62 ? 0 : 1;
+        if (!TEST_int_eq(results[i], expected)
+                || !TEST_int_eq(results[i],
+                                ECDSA_do_verify(dgst[i], dgst_len[i], sigs[i],
+                                                eckey[i])))
+            goto err;
+    }
+
+    ret = 1;
+ err:
+    ERR_clear_error();
+    for (i = 0; i < NUM_BATCH_SIGS; i++)
+        ECDSA_SIG_free(sigs[i]);
+    for (i = 0; i < OSSL_NELEM(keys); i++)
+        EC_KEY_free(keys[i]);
+    return ret;
+}
 #endif
 
 int setup_tests(void)
@@ -399,6 +485,7 @@ int setup_tests(void)
 #else
     ADD_TEST(x9_62_tests);
     ADD_TEST(test_builtin);
+    ADD_TEST(test_verify_batch);
 #endif
     return 1;
 }
@@ -1235,6 +1235,38 @@ static const struct nistp_test_params nistp_tests_params[] = {
      /* d */
      "c477f9f65c22cce20657faa5b2d1d8122336f851a508a1ed04e479c34985bf96",
      },
+    {
+     /* P-384 */
+     EC_GFp_nistp384_method,
+     384,
+     /* p */
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe"
+     "ffffffff0000000000000000ffffffff",
+     /* a */
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe"
+     "ffffffff0000000000000000fffffffc",
+     /* b */
+     "b3312fa7e23ee7e4988e056be3f82d19181d9c6efe8141120314088f5013875a"
+     "c656398d8a2ed19d2a85c8edd3ec2aef",
+     /* Qx */
+     "b1a582bffa189a33471dd7f0e6a9ea7d54bd88736c22aebf8c29e7dfd8015b59"
+     "239b1fd5b9f00ee18c55b12947b5caf1",
+     /* Qy */
+     "f7a0a754b41f0bd68b2151c7009340945754fa33d483e540c9b301923d0f9da9"
+     "34f00aba8b603800d0021bdf4546bb72",
+     /* Gx */
+     "aa87ca22be8b05378eb1c71ef320ad746e1d3b628ba79b9859f741e082542a38"
+     "5502f25dbf55296c3a545e3872760ab7",
+     /* Gy */
+     "3617de4a96262c6f5d9e98bf9292dc29f8f41dbd289a147ce9da3113b5f0b8c0"
+     "0a60b1ce1d7e819d7a431d7c90ea0e5f",
+     /* order */
+     "ffffffffffffffffffffffffffffffffffffffffffffffffc7634d81f4372ddf"
+     "581a0db248b0a77aecec196accc52973",
+     /* d */
+     "8656de516c87e45d4a0a88160248faaffd2ab58053d616f34ec5c094ccf43fa5"
+     "a02feb605c5b7fa2ebd4a2147b279060",
+     },
     {
      /* P-521 */
      EC_GFp_nistp521_method,
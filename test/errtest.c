@@ -7,6 +7,7 @@
  * https://www.openssl.org/source/license.html
  */
 
+#include <string.h>
 #include <openssl/opensslconf.h>
 #include <openssl/err.h>
 
@@ -32,8 +33,193 @@ static int preserves_system_error(void)
 #endif
 }
 
+static int formatted, freed;
+
+static char *format_arg(void *arg)
+{
+    formatted++;
+    return OPENSSL_strdup(arg);
+}
+
+static void free_arg(void *arg)
+{
+    freed++;
+}
+
+static char *format_raise(void *arg)
+{
+    ERR_put_error(ERR_LIB_USER, 0, 99, "errtest", 99);
+    return OPENSSL_strdup(arg);
+}
+
+static unsigned long last_data(const char **data)
+{
+    int flags;
+
+    return ERR_peek_last_error_line_data(NULL, NULL, data, &flags);
+}
+
+/* Deferred data is only put together when asked for */
+static int test_deferred_data(void)
+{
+    const char *data;
+    int ret = 0;
+
+    formatted = freed = 0;
+    ERR_put_error(ERR_LIB_USER, 0, 1, "errtest", 1);
+    ERR_add_error_data(1, "start");
+    ERR_add_error_data_deferred("; ", format_arg, "one", free_arg);
+    ERR_add_error_data_deferred(":", NULL, "two", free_arg);
+    if (!TEST_int_eq(formatted, 0)
+            || !TEST_ulong_ne(last_data(&data), 0)
+            || !TEST_str_eq(data, "start; one:two")
+            || !TEST_int_eq(formatted, 1)
+            || !TEST_int_eq(freed, 2))
+        goto err;
+
+    /* Discarded without ever being formatted */
+    ERR_put_error(ERR_LIB_USER, 0, 2, "errtest", 2);
+    ERR_add_error_data_deferred("", format_arg, "three", free_arg);
+    ERR_clear_error();
+    if (!TEST_int_eq(formatted, 1)
+            || !TEST_int_eq(freed, 3))
+        goto err;
+
+    /* No error to add the data to */
+    ERR_add_error_data_deferred("", format_arg, "four", free_arg);
+    if (!TEST_int_eq(freed, 4)
+            || !TEST_ulong_eq(ERR_peek_error(), 0))
+        goto err;
+
+    /* Errors raised while putting the data together don't reach the queue */
+    ERR_put_error(ERR_LIB_USER, 0, 3, "errtest", 3);
+    ERR_add_error_data_deferred("", format_raise, "five", NULL);
+    if (!TEST_ulong_eq(ERR_GET_REASON(last_data(&data)), 3)
+            || !TEST_str_eq(data, "five")
+            || !TEST_ulong_eq(ERR_GET_REASON(ERR_get_error()), 3)
+            || !TEST_ulong_eq(ERR_peek_error(), 0))
+        goto err;
+    ret = 1;
+
+ err:
+    ERR_clear_error();
+    return ret;
+}
+
+/* Errors raised in a suppressed scope are seen there, but don't last */
+static int test_suppress(void)
+{
+    const char *data;
+    int ret = 0;
+
+    formatted = freed = 0;
+    ERR_put_error(ERR_LIB_USER, 0, 1, "errtest", 1);
+    ERR_add_error_data(1, "kept");
+    if (!TEST_true(ERR_suppress_start()))
+        goto err;
+    ERR_put_error(ERR_LIB_USER, 0, 2, "errtest", 2);
+    ERR_add_error_data(1, "dropped");
+    ERR_add_error_data_deferred("", format_arg, "dropped", free_arg);
+    if (!TEST_ulong_eq(ERR_GET_REASON(last_data(&data)), 2)
+            || !TEST_str_eq(data, "")
+            || !TEST_int_eq(freed, 1)
+            || !TEST_true(ERR_suppress_end())
+            || !TEST_false(ERR_suppress_end())
+            || !TEST_ulong_eq(ERR_GET_REASON(last_data(&data)), 1)
+            || !TEST_str_eq(data, "kept")
+            || !TEST_int_eq(formatted, 0))
+        goto err;
+
+    /* The same with an empty queue to start with */
+    ERR_clear_error();
+    if (!TEST_true(ERR_suppress_start()))
+        goto err;
+    ERR_put_error(ERR_LIB_USER, 0, 2, "errtest", 2);
+    if (!TEST_true(ERR_suppress_end())
+            || !TEST_ulong_eq(ERR_peek_error(), 0))
+        goto err;
+    ret = 1;
+
+ err:
+    ERR_clear_error();
+    return ret;
+}
+
+/* Nested scopes that start at the same error keep it and its mark */
+static int test_suppress_nested(void)
+{
+    int ret = 0;
+
+    ERR_put_error(ERR_LIB_USER, 0, 1, "errtest", 1);
+    ERR_put_error(ERR_LIB_USER, 0, 2, "errtest", 2);
+    if (!TEST_true(ERR_set_mark())
+            || !TEST_true(ERR_suppress_start())
+            || !TEST_true(ERR_suppress_start()))
+        goto err;
+    ERR_put_error(ERR_LIB_USER, 0, 3, "errtest", 3);
+    if (!TEST_true(ERR_suppress_end())
+            || !TEST_ulong_eq(ERR_GET_REASON(ERR_peek_last_error()), 2))
+        goto err;
+    ERR_put_error(ERR_LIB_USER, 0, 4, "errtest", 4);
+    if (!TEST_true(ERR_suppress_start()))
+        goto err;
+    ERR_put_error(ERR_LIB_USER, 0, 5, "errtest", 5);
+    if (!TEST_true(ERR_suppress_end())
+            || !TEST_ulong_eq(ERR_GET_REASON(ERR_peek_last_error()), 4)
+            || !TEST_true(ERR_suppress_end())
+            || !TEST_ulong_eq(ERR_GET_REASON(ERR_peek_last_error()), 2)
+            || !TEST_ulong_eq(ERR_GET_REASON(ERR_peek_error()), 1))
+        goto err;
+
+    /* The caller's mark is still there */
+    ERR_put_error(ERR_LIB_USER, 0, 6, "errtest", 6);
+    if (!TEST_true(ERR_pop_to_mark())
+            || !TEST_ulong_eq(ERR_GET_REASON(ERR_peek_last_error()), 2))
+        goto err;
+    ret = 1;
+
+ err:
+    ERR_clear_error();
+    return ret;
+}
+
+static size_t printed;
+
+static int print_cb(const char *str, size_t len, void *u)
+{
+    printed = len;
+    return 1;
+}
+
+/* Data put together late can be longer than the print buffer */
+static int test_long_data(void)
+{
+    char *big;
+    int ret = 0;
+
+    if (!TEST_ptr(big = OPENSSL_malloc(10000)))
+        return 0;
+    memset(big, 'x', 9999);
+    big[9999] = '\0';
+    ERR_put_error(ERR_LIB_USER, 0, 1, "errtest", 1);
+    ERR_add_error_data_deferred(":", NULL, big, NULL);
+    printed = 0;
+    ERR_print_errors_cb(print_cb, NULL);
+    if (!TEST_size_t_gt(printed, 10000))
+        goto err;
+    ret = 1;
+
+ err:
+    OPENSSL_free(big);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(preserves_system_error);
+    ADD_TEST(test_deferred_data);
+    ADD_TEST(test_suppress);
+    ADD_TEST(test_suppress_nested);
+    ADD_TEST(test_long_data);
     return 1;
 }
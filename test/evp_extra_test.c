@@ -11,10 +11,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <openssl/bio.h>
+#include <openssl/bn.h>
 #include <openssl/crypto.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
 #include <openssl/rsa.h>
+#include <openssl/sha.h>
 #include <openssl/x509.h>
 #include "testutil.h"
 #include "internal/nelem.h"
@@ -680,6 +682,340 @@ static int test_set_get_raw_keys(int tst)
            && test_set_get_raw_keys_int(tst, 1);
 }
 
+#ifndef OPENSSL_NO_EC
+/* More than fit in a single Ed25519 batch */
+# define NUM_BATCH_SIGS 70
+
+static EVP_PKEY *gen_key(int type)
+{
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(type, NULL);
+    EVP_PKEY *pkey = NULL;
+
+    if (!TEST_ptr(ctx)
+            || !TEST_int_gt(EVP_PKEY_keygen_init(ctx), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen(ctx, &pkey), 0))
+        pkey = NULL;
+    EVP_PKEY_CTX_free(ctx);
+    return pkey;
+}
+
+static int test_EVP_DigestVerifyBatch(void)
+{
+    /* Two Ed25519 keys and an Ed448 key, which is verified one by one */
+    static const int types[] = {
+        EVP_PKEY_ED25519, EVP_PKEY_ED25519, EVP_PKEY_ED448
+    };
+    EVP_PKEY *privs[OSSL_NELEM(types)] = { NULL };
+    EVP_PKEY *pubs[OSSL_NELEM(types)] = { NULL };
+    EVP_PKEY *pkey[NUM_BATCH_SIGS];
+    unsigned char msgs[NUM_BATCH_SIGS][16];
+    unsigned char sigbufs[NUM_BATCH_SIGS][114];
+    const unsigned char *tbs[NUM_BATCH_SIGS], *sig[NUM_BATCH_SIGS];
+    size_t tbslen[NUM_BATCH_SIGS], siglen[NUM_BATCH_SIGS];
+    int results[NUM_BATCH_SIGS], expected;
+    unsigned char pub[57];
+    size_t i, k, len;
+    EVP_MD_CTX *mctx = NULL;
+    int ret = 0;
+
+    for (k = 0; k < OSSL_NELEM(types); k++) {
+        len = sizeof(pub);
+        if (!TEST_ptr(privs[k] = gen_key(types[k]))
+                || !TEST_true(EVP_PKEY_get_raw_public_key(privs[k], pub,
+                                                          &len))
+                || !TEST_ptr(pubs[k] = EVP_PKEY_new_raw_public_key(types[k],
+                                                                   NULL, pub,
+                                                                   len)))
+            goto done;
+    }
+
+    if (!TEST_ptr(mctx = EVP_MD_CTX_new()))
+        goto done;
+    for (i = 0; i < NUM_BATCH_SIGS; i++) {
+        k = i % OSSL_NELEM(types);
+        /* Verify with both private and public-only keys */
+        pkey[i] = (i / OSSL_NELEM(types)) % 2 == 0 ? pubs[k] : privs[k];
+        memset(msgs[i], 0, sizeof(msgs[i]));
+        memcpy(msgs[i], &i, sizeof(i));
+        tbs[i] = msgs[i];
+        tbslen[i] = sizeof(msgs[i]) - i % 2;
+        sig[i] = sigbufs[i];
+        siglen[i] = sizeof(sigbufs[i]);
+        EVP_MD_CTX_reset(mctx);
+        if (!TEST_true(EVP_DigestSignInit(mctx, NULL, NULL, NULL, privs[k]))
+                || !TEST_true(EVP_DigestSign(mctx, sigbufs[i], &siglen[i],
+                                             tbs[i], tbslen[i])))
+            goto done;
+    }
+
+    if (!TEST_int_eq(EVP_DigestVerifyBatch(pkey, sig, siglen, tbs, tbslen,
+                                           NUM_BATCH_SIGS, results), 1))
+        goto done;
+    for (i = 0; i < NUM_BATCH_SIGS; i++)
+        if (!TEST_int_eq(results[i], 1))
+            goto done;
+
+    /* Wrong message */
+    msgs[3][2] ^= 1;
+    /* Corrupt R and s */
+    sigbufs[7][5] ^= 1;
+    sigbufs[40][40] ^= 1;
+    /* Wrong length */
+    siglen[12]--;
+    /* Wrong key */
+    pkey[22] = pubs[0];
+    /* Ed448 */
+    msgs[5][0] ^= 1;
+
+    if (!TEST_int_eq(EVP_DigestVerifyBatch(pkey, sig, siglen, tbs, tbslen,
+                                           NUM_BATCH_SIGS, results), 0))
+        goto done;
+    for (i = 0; i < NUM_BATCH_SIGS; i++) {
+        expected = i == 3 || i == 5 || i == 7 || i == 12 || i == 22 || i == 40
+                   ? 0 : 1;
+        EVP_MD_CTX_reset(mctx);
+        if (!TEST_int_eq(results[i], expected)
+                || !TEST_true(EVP_DigestVerifyInit(mctx, NULL, NULL, NULL,
+                                                   pkey[i]))
+                || !TEST_int_eq(EVP_DigestVerify(mctx, sig[i], siglen[i],
+                                                 tbs[i], tbslen[i]),
+                                expected))
+            goto done;
+    }
+
+    ret = 1;
+ done:
+    EVP_MD_CTX_free(mctx);
+    for (k = 0; k < OSSL_NELEM(types); k++) {
+        EVP_PKEY_free(privs[k]);
+        EVP_PKEY_free(pubs[k]);
+    }
+    return ret;
+}
+
+/*
+ * A signature whose R is a point of order 8 and whose s is h * a, for the
+ * secret scalar a, satisfies the cofactored verification equation but not
+ * the one of EVP_DigestVerify(): both must reject it.
+ */
+static int test_EVP_DigestVerifyBatch_small_order(void)
+{
+    static const unsigned char seed[32] = {
+        0x4c, 0xcd, 0x08, 0x9b, 0x28, 0xff, 0x96, 0xda,
+        0x9d, 0xb6, 0xc3, 0x46, 0xec, 0x11, 0x4e, 0x0f,
+        0x5b, 0x8a, 0x31, 0x9f, 0x35, 0xab, 0xa6, 0x24,
+        0xda, 0x8c, 0xf6, 0xed, 0x4f, 0xb8, 0xa6, 0xfb
+    };
+    static const unsigned char small_r[32] = {
+        0x26, 0xe8, 0x95, 0x8f, 0xc2, 0xb2, 0x27, 0xb0,
+        0x45, 0xc3, 0xf4, 0x89, 0xf2, 0xef, 0x98, 0xf0,
+        0xd5, 0xdf, 0xac, 0x05, 0xd3, 0xc6, 0x33, 0x39,
+        0xb1, 0x38, 0x02, 0x88, 0x6d, 0x53, 0xfc, 0x05
+    };
+    static const unsigned char msg[] = "small order R";
+    unsigned char pub[32], az[SHA512_DIGEST_LENGTH], h[SHA512_DIGEST_LENGTH];
+    unsigned char sigbufs[2][64];
+    EVP_PKEY *priv = NULL, *pkey[2] = { NULL, NULL };
+    const unsigned char *tbs[2], *sig[2];
+    size_t tbslen[2], siglen[2], len = sizeof(pub);
+    int results[2];
+    BIGNUM *a = NULL, *hn = NULL, *l = NULL;
+    BN_CTX *bnctx = NULL;
+    EVP_MD_CTX *mctx = NULL;
+    SHA512_CTX sha;
+    int ret = 0;
+
+    if (!TEST_ptr(priv = EVP_PKEY_new_raw_private_key(EVP_PKEY_ED25519, NULL,
+                                                      seed, sizeof(seed)))
+            || !TEST_true(EVP_PKEY_get_raw_public_key(priv, pub, &len))
+            || !TEST_ptr(pkey[0] = EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519,
+                                                               NULL, pub,
+                                                               len))
+            || !TEST_ptr(mctx = EVP_MD_CTX_new())
+            || !TEST_ptr(bnctx = BN_CTX_new()))
+        goto done;
+    pkey[1] = pkey[0];
+
+    /* A valid signature, so that the batch is not of a single one */
+    tbs[0] = msg;
+    tbslen[0] = sizeof(msg);
+    siglen[0] = sizeof(sigbufs[0]);
+    if (!TEST_true(EVP_DigestSignInit(mctx, NULL, NULL, NULL, priv))
+            || !TEST_true(EVP_DigestSign(mctx, sigbufs[0], &siglen[0],
+                                         tbs[0], tbslen[0])))
+        goto done;
+
+    /* s = h * a mod l, with h = SHA512(R || A || M) */
+    SHA512(seed, sizeof(seed), az);
+    az[0] &= 248;
+    az[31] &= 63;
+    az[31] |= 64;
+    SHA512_Init(&sha);
+    SHA512_Update(&sha, small_r, sizeof(small_r));
+    SHA512_Update(&sha, pub, sizeof(pub));
+    SHA512_Update(&sha, msg, sizeof(msg));
+    SHA512_Final(h, &sha);
+    if (!TEST_ptr(a = BN_lebin2bn(az, 32, NULL))
+            || !TEST_ptr(hn = BN_lebin2bn(h, sizeof(h), NULL))
+            || !TEST_true(BN_hex2bn(&l, "1000000000000000000000000000000014"
+                                        "DEF9DEA2F79CD65812631A5CF5D3ED"))
+            || !TEST_true(BN_mod_mul(hn, hn, a, l, bnctx)))
+        goto done;
+    memcpy(sigbufs[1], small_r, sizeof(small_r));
+    if (!TEST_int_eq(BN_bn2lebinpad(hn, sigbufs[1] + 32, 32), 32))
+        goto done;
+    tbs[1] = msg;
+    tbslen[1] = sizeof(msg);
+    siglen[1] = sizeof(sigbufs[1]);
+    sig[0] = sigbufs[0];
+    sig[1] = sigbufs[1];
+
+    EVP_MD_CTX_reset(mctx);
+    if (!TEST_int_eq(EVP_DigestVerifyBatch(pkey, sig, siglen, tbs, tbslen, 2,
+                                           results), 0)
+            || !TEST_int_eq(results[0], 1)
+            || !TEST_int_eq(results[1], 0)
+            || !TEST_true(EVP_DigestVerifyInit(mctx, NULL, NULL, NULL,
+                                               pkey[1]))
+            || !TEST_int_eq(EVP_DigestVerify(mctx, sig[1], siglen[1], tbs[1],
+                                             tbslen[1]), 0))
+        goto done;
+
+    ret = 1;
+ done:
+    BN_free(a);
+    BN_free(hn);
+    BN_free(l);
+    BN_CTX_free(bnctx);
+    EVP_MD_CTX_free(mctx);
+    EVP_PKEY_free(pkey[0]);
+    EVP_PKEY_free(priv);
+    return ret;
+}
+#endif
+
+#define NUM_MULTI_DIGESTS 67
+
+static int test_EVP_DigestMulti(int idx)
+{
+    const EVP_MD *md;
+    unsigned char *buf = NULL;
+    unsigned char mdbufs[NUM_MULTI_DIGESTS][EVP_MAX_MD_SIZE];
+    unsigned char expected[EVP_MAX_MD_SIZE];
+    const unsigned char *data[NUM_MULTI_DIGESTS];
+    unsigned char *mds[NUM_MULTI_DIGESTS];
+    size_t datalen[NUM_MULTI_DIGESTS], i;
+    unsigned int len;
+    int ret = 0;
+
+    switch (idx) {
+    case 0:
+        md = EVP_sha1();
+        break;
+    case 1:
+        md = EVP_sha224();
+        break;
+    case 2:
+        md = EVP_sha256();
+        break;
+    default:
+        /* No multi-buffer implementation, hashed one by one */
+        md = EVP_sha512();
+        break;
+    }
+
+    if (!TEST_ptr(buf = OPENSSL_malloc(8192)))
+        goto done;
+    for (i = 0; i < 8192; i++)
+        buf[i] = (unsigned char)(i * 7 + 3);
+
+    /*
+     * A mix of lengths around the block and padding boundaries, with a few
+     * long messages so that lanes finish at different times.
+     */
+    for (i = 0; i < NUM_MULTI_DIGESTS; i++) {
+        data[i] = buf + i;
+        datalen[i] = i % 10 == 9 ? 4000 + i * 13 : (i * 37) % 200;
+        mds[i] = mdbufs[i];
+    }
+
+    if (!TEST_true(EVP_DigestMulti(md, data, datalen, mds, NUM_MULTI_DIGESTS)))
+        goto done;
+
+    for (i = 0; i < NUM_MULTI_DIGESTS; i++) {
+        if (!TEST_true(EVP_Digest(data[i], datalen[i], expected, &len, md,
+                                  NULL))
+                || !TEST_mem_eq(mds[i], EVP_MD_size(md), expected, len)) {
+            TEST_info("message %d of length %d", (int)i, (int)datalen[i]);
+            goto done;
+        }
+    }
+
+    /* Fewer messages than lanes */
+    memset(mdbufs, 0, sizeof(mdbufs));
+    if (!TEST_true(EVP_DigestMulti(md, data + 8, datalen + 8, mds, 3)))
+        goto done;
+    for (i = 0; i < 3; i++) {
+        if (!TEST_true(EVP_Digest(data[i + 8], datalen[i + 8], expected, &len,
+                                  md, NULL))
+                || !TEST_mem_eq(mds[i], EVP_MD_size(md), expected, len))
+            goto done;
+    }
+
+    ret = 1;
+ done:
+    OPENSSL_free(buf);
+    return ret;
+}
+
+static int (*sha256_update)(EVP_MD_CTX *ctx, const void *data, size_t count);
+static int counted_updates;
+
+static int counting_update(EVP_MD_CTX *ctx, const void *data, size_t count)
+{
+    counted_updates++;
+    return sha256_update(ctx, data, count);
+}
+
+/*
+ * A method copied from one with a multi-buffer implementation, but with its
+ * own update, must have that update called for every message.
+ */
+static int test_EVP_DigestMulti_dup(void)
+{
+    EVP_MD *md = NULL;
+    static const unsigned char msg1[] = "abc", msg2[] = "message digest";
+    const unsigned char *data[] = { msg1, msg2 };
+    size_t datalen[] = { sizeof(msg1) - 1, sizeof(msg2) - 1 };
+    unsigned char mdbufs[2][EVP_MAX_MD_SIZE];
+    unsigned char *mds[] = { mdbufs[0], mdbufs[1] };
+    unsigned char expected[EVP_MAX_MD_SIZE];
+    unsigned int len;
+    size_t i;
+    int ret = 0;
+
+    sha256_update = EVP_MD_meth_get_update(EVP_sha256());
+    if (!TEST_ptr(md = EVP_MD_meth_dup(EVP_sha256()))
+            || !TEST_true(EVP_MD_meth_set_update(md, counting_update)))
+        goto done;
+
+    counted_updates = 0;
+    if (!TEST_true(EVP_DigestMulti(md, data, datalen, mds, OSSL_NELEM(data)))
+            || !TEST_int_eq(counted_updates, (int)OSSL_NELEM(data)))
+        goto done;
+    for (i = 0; i < OSSL_NELEM(data); i++) {
+        if (!TEST_true(EVP_Digest(data[i], datalen[i], expected, &len,
+                                  EVP_sha256(), NULL))
+                || !TEST_mem_eq(mds[i], EVP_MD_size(md), expected, len))
+            goto done;
+    }
+
+    ret = 1;
+ done:
+    EVP_MD_meth_free(md);
+    return ret;
+}
+
 static int pkey_custom_check(EVP_PKEY *pkey)
 {
     return 0xbeef;
@@ -784,11 +1120,15 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_d2i_AutoPrivateKey, OSSL_NELEM(keydata));
 #ifndef OPENSSL_NO_EC
     ADD_TEST(test_EVP_PKCS82PKEY);
+    ADD_TEST(test_EVP_DigestVerifyBatch);
+    ADD_TEST(test_EVP_DigestVerifyBatch_small_order);
 #endif
 #ifndef OPENSSL_NO_SM2
     ADD_TEST(test_EVP_SM2);
 #endif
     ADD_ALL_TESTS(test_set_get_raw_keys, OSSL_NELEM(keys));
+    ADD_ALL_TESTS(test_EVP_DigestMulti, 4);
+    ADD_TEST(test_EVP_DigestMulti_dup);
     custom_pmeth = EVP_PKEY_meth_new(0xdefaced, 0);
     if (!TEST_ptr(custom_pmeth))
         return 0;
@@ -1258,7 +1258,7 @@ typedef enum pbe_type_enum {
 typedef struct pbe_data_st {
     PBE_TYPE pbe_type;
         /* scrypt parameters */
-    uint64_t N, r, p, maxmem;
+    uint64_t N, r, p, maxmem, threads;
         /* PKCS#12 parameters */
     int id, iter;
     const EVP_MD *md;
@@ -1314,6 +1314,8 @@ static int scrypt_test_parse(EVP_TEST *t,
         return parse_uint64(value, &pdata->r);
     if (strcmp(keyword, "maxmem") == 0)
         return parse_uint64(value, &pdata->maxmem);
+    if (strcmp(keyword, "threads") == 0)
+        return parse_uint64(value, &pdata->threads);
     return 0;
 }
 #endif
@@ -1427,10 +1429,12 @@ static int pbe_test_run(EVP_TEST *t)
         }
 #ifndef OPENSSL_NO_SCRYPT
     } else if (expected->pbe_type == PBE_TYPE_SCRYPT) {
-        if (EVP_PBE_scrypt((const char *)expected->pass, expected->pass_len,
-                           expected->salt, expected->salt_len, expected->N,
-                           expected->r, expected->p, expected->maxmem,
-                           key, expected->key_len) == 0) {
+        if (EVP_PBE_scrypt_ex((const char *)expected->pass,
+                              expected->pass_len, expected->salt,
+                              expected->salt_len, expected->N, expected->r,
+                              expected->p, expected->maxmem,
+                              (unsigned int)expected->threads,
+                              key, expected->key_len) == 0) {
             t->err = "SCRYPT_ERROR";
             goto err;
         }
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdlib.h>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include "ssltestlib.h"
+#include "testutil.h"
+#include "testutil/output.h"
+
+/*
+ * We use a proper main function here instead of the custom main from the
+ * test framework because memory accounting has to be enabled before the
+ * first allocation, and the test framework allocates before it calls
+ * setup_tests().
+ */
+
+#define HANDSHAKES      10
+
+/*
+ * The most allocations libssl may make for a full handshake, both ends
+ * together, including creating and freeing the SSL objects.  There were 29
+ * for TLSv1.2 and 33 for TLSv1.3 when this was written.  Allocating every
+ * WPACKET sub-packet and every parsed ClientHello again takes it to about
+ * 100 for TLSv1.2 and 230 for TLSv1.3.
+ */
+#define MAX_SSL_ALLOCS  48
+
+static char *cert = NULL;
+static char *privkey = NULL;
+
+static int test_handshake_allocs(int maxver)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    size_t start, end;
+    int i, testresult = 0;
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(),
+                                       TLS_client_method(), TLS1_VERSION,
+                                       maxver, &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    /* The first handshake also sets up what is shared, leave it out */
+    for (i = 0; i <= HANDSHAKES; i++) {
+        if (i == 1
+                && !TEST_true(CRYPTO_mem_acct_get(ERR_LIB_SSL, NULL, NULL,
+                                                  NULL, &start)))
+            goto end;
+        if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                          NULL, NULL))
+                || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                    SSL_ERROR_NONE)))
+            goto end;
+        shutdown_ssl_connection(serverssl, clientssl);
+        serverssl = clientssl = NULL;
+    }
+    if (!TEST_true(CRYPTO_mem_acct_get(ERR_LIB_SSL, NULL, NULL, NULL, &end)))
+        goto end;
+
+    test_printf_stdout("%s handshake: %zu libssl allocations\n",
+                       maxver == TLS1_3_VERSION ? "TLSv1.3" : "TLSv1.2",
+                       (end - start) / HANDSHAKES);
+    if (!TEST_size_t_le((end - start) / HANDSHAKES, MAX_SSL_ALLOCS))
+        goto end;
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+int main(int argc, char *argv[])
+{
+    int ret = 1;
+
+    if (argc != 3 || !CRYPTO_mem_acct_enable(0))
+        return EXIT_FAILURE;
+    cert = argv[1];
+    privkey = argv[2];
+
+    test_open_streams();
+#ifndef OPENSSL_NO_TLS1_2
+    ret = test_handshake_allocs(TLS1_2_VERSION) && ret;
+#endif
+#ifndef OPENSSL_NO_TLS1_3
+    ret = test_handshake_allocs(TLS1_3_VERSION) && ret;
+#endif
+    test_flush_stdout();
+    test_close_streams();
+    return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
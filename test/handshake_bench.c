@@ -0,0 +1,554 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * In-memory handshake benchmark. Both ends of every connection run in the
+ * same thread and talk over a BIO pair, so the figures reflect the cost of
+ * the handshake code rather than that of the network stack.
+ *
+ * Usage: handshake_bench certsdir [threads [handshakes]]
+ *
+ * Every scenario runs |handshakes| handshakes, including the creation and
+ * freeing of the SSL objects, on each of |threads| threads. Reported are the
+ * handshakes per second of wall clock time, the CPU time and TSC cycles spent
+ * per handshake and, in crypto-mdebug builds, the number of allocations per
+ * handshake.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+# include <sys/time.h>
+#endif
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include "internal/cryptlib.h"
+#include "internal/nelem.h"
+#include "testutil.h"
+#include "testutil/output.h"
+#include "threadstest.h"
+
+#define DEFAULT_THREADS         1
+#define DEFAULT_HANDSHAKES      200
+#define MAX_THREADS             256
+/* Bound on the SSL calls a single handshake may need on each side */
+#define MAX_HANDSHAKE_LOOPS     16
+
+typedef enum {
+    HS_FULL,
+    /* Resume a session from the server's session cache */
+    HS_RESUME_ID,
+    /* Resume a session from a ticket */
+    HS_RESUME_TICKET,
+    /* TLSv1.3 external PSK */
+    HS_PSK,
+    /* TLSv1.3 handshake with a HelloRetryRequest */
+    HS_HRR,
+    /* TLSv1.3 resumption sending early data */
+    HS_EARLY_DATA
+} HS_MODE;
+
+typedef struct {
+    const char *name;
+    int version;
+    /* Cipher list for TLSv1.2, ciphersuites for TLSv1.3 */
+    const char *ciphers;
+    /* Groups offered by the client, the server accepts all by default */
+    const char *groups;
+    /* Certificate and key, relative to the certificates directory */
+    const char *cert;
+    const char *key;
+    HS_MODE mode;
+} SCENARIO;
+
+static const SCENARIO scenarios[] = {
+    {"TLSv1.2 ECDHE-RSA P-256", TLS1_2_VERSION,
+     "ECDHE-RSA-AES128-GCM-SHA256", "P-256",
+     "servercert.pem", "serverkey.pem", HS_FULL},
+    {"TLSv1.2 ECDHE-ECDSA P-256", TLS1_2_VERSION,
+     "ECDHE-ECDSA-AES128-GCM-SHA256", "P-256",
+     "server-ecdsa-cert.pem", "server-ecdsa-key.pem", HS_FULL},
+    {"TLSv1.2 RSA", TLS1_2_VERSION, "AES128-GCM-SHA256", NULL,
+     "servercert.pem", "serverkey.pem", HS_FULL},
+    {"TLSv1.2 session id resumption", TLS1_2_VERSION,
+     "ECDHE-RSA-AES128-GCM-SHA256", "P-256",
+     "servercert.pem", "serverkey.pem", HS_RESUME_ID},
+    {"TLSv1.2 ticket resumption", TLS1_2_VERSION,
+     "ECDHE-RSA-AES128-GCM-SHA256", "P-256",
+     "servercert.pem", "serverkey.pem", HS_RESUME_TICKET},
+    {"TLSv1.3 X25519 RSA", TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256", "X25519",
+     "servercert.pem", "serverkey.pem", HS_FULL},
+    {"TLSv1.3 P-256 ECDSA", TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256", "P-256",
+     "server-ecdsa-cert.pem", "server-ecdsa-key.pem", HS_FULL},
+    {"TLSv1.3 X25519 Ed25519", TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256",
+     "X25519", "server-ed25519-cert.pem", "server-ed25519-key.pem", HS_FULL},
+    {"TLSv1.3 X25519 RSA ChaCha20", TLS1_3_VERSION,
+     "TLS_CHACHA20_POLY1305_SHA256", "X25519",
+     "servercert.pem", "serverkey.pem", HS_FULL},
+    {"TLSv1.3 HelloRetryRequest", TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256",
+     "X25519:P-256", "servercert.pem", "serverkey.pem", HS_HRR},
+    {"TLSv1.3 ticket resumption", TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256",
+     "X25519", "servercert.pem", "serverkey.pem", HS_RESUME_TICKET},
+    {"TLSv1.3 stateful resumption", TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256",
+     "X25519", "servercert.pem", "serverkey.pem", HS_RESUME_ID},
+    {"TLSv1.3 external PSK", TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256",
+     "X25519", "servercert.pem", "serverkey.pem", HS_PSK},
+    {"TLSv1.3 early data", TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256",
+     "X25519", "servercert.pem", "serverkey.pem", HS_EARLY_DATA},
+};
+
+typedef struct {
+    size_t handshakes;
+    uint64_t cycles;
+    int failed;
+} THREAD_RESULT;
+
+static char *certsdir = NULL;
+static size_t num_threads = DEFAULT_THREADS;
+static size_t num_handshakes = DEFAULT_HANDSHAKES;
+
+/* State shared with the worker threads for the scenario being run */
+static const SCENARIO *current;
+static SSL_CTX *sctx = NULL, *cctx = NULL;
+static SSL_SESSION *session = NULL;
+static THREAD_RESULT results[MAX_THREADS];
+static int next_thread;
+static CRYPTO_RWLOCK *thread_lock = NULL;
+
+static const unsigned char early_data[] = "early data";
+static const char pskid[] = "Identity";
+static const unsigned char pskkey[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+static int use_session_cb(SSL *ssl, const EVP_MD *md, const unsigned char **id,
+                          size_t *idlen, SSL_SESSION **sess)
+{
+    if (!SSL_SESSION_up_ref(session))
+        return 0;
+    *sess = session;
+    *id = (const unsigned char *)pskid;
+    *idlen = sizeof(pskid) - 1;
+
+    return 1;
+}
+
+static int find_session_cb(SSL *ssl, const unsigned char *identity,
+                           size_t identity_len, SSL_SESSION **sess)
+{
+    if (identity_len != sizeof(pskid) - 1
+            || memcmp(identity, pskid, identity_len) != 0) {
+        *sess = NULL;
+        return 1;
+    }
+    if (!SSL_SESSION_up_ref(session))
+        return 0;
+    *sess = session;
+
+    return 1;
+}
+
+static char *mk_file_path(const char *dir, const char *file)
+{
+#ifndef OPENSSL_SYS_VMS
+    const char *sep = "/";
+#else
+    const char *sep = "";
+#endif
+    size_t len = strlen(dir) + strlen(sep) + strlen(file) + 1;
+    char *full_file = OPENSSL_zalloc(len);
+
+    if (full_file != NULL) {
+        OPENSSL_strlcpy(full_file, dir, len);
+        OPENSSL_strlcat(full_file, sep, len);
+        OPENSSL_strlcat(full_file, file, len);
+    }
+
+    return full_file;
+}
+
+/* Wall clock time in seconds */
+static double wall_time(void)
+{
+#ifdef _WIN32
+    return GetTickCount() / 1000.0;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+}
+
+/* Whether |ret| returned from an SSL I/O call on |s| just asks for more I/O */
+static int want_io(SSL *s, int ret)
+{
+    int err = SSL_get_error(s, ret);
+
+    return err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE;
+}
+
+static int do_handshake(SSL *clientssl, SSL *serverssl)
+{
+    int cret = -1, sret = -1, i;
+
+    for (i = 0; i < MAX_HANDSHAKE_LOOPS; i++) {
+        if (cret <= 0) {
+            cret = SSL_connect(clientssl);
+            if (cret <= 0 && !want_io(clientssl, cret))
+                return 0;
+        }
+        if (sret <= 0) {
+            sret = SSL_accept(serverssl);
+            if (sret <= 0 && !want_io(serverssl, sret))
+                return 0;
+        }
+        if (cret > 0 && sret > 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Send early data from |clientssl| and read it on |serverssl| until the
+ * server has seen the end of it, then complete the handshake.
+ */
+static int do_early_data_handshake(SSL *clientssl, SSL *serverssl)
+{
+    unsigned char buf[sizeof(early_data)];
+    size_t written, readbytes;
+    int cret = -1, sret = SSL_READ_EARLY_DATA_ERROR, i;
+
+    if (!SSL_write_early_data(clientssl, early_data, sizeof(early_data),
+                              &written))
+        return 0;
+
+    for (i = 0; i < MAX_HANDSHAKE_LOOPS; i++) {
+        sret = SSL_read_early_data(serverssl, buf, sizeof(buf), &readbytes);
+        if (sret == SSL_READ_EARLY_DATA_FINISH)
+            break;
+        if (sret == SSL_READ_EARLY_DATA_ERROR && !want_io(serverssl, 0))
+            return 0;
+        if (cret <= 0) {
+            cret = SSL_connect(clientssl);
+            if (cret <= 0 && !want_io(clientssl, cret))
+                return 0;
+        }
+    }
+
+    return sret == SSL_READ_EARLY_DATA_FINISH
+           && do_handshake(clientssl, serverssl)
+           && SSL_get_early_data_status(serverssl) == SSL_EARLY_DATA_ACCEPTED;
+}
+
+/* Create, run and free one connection of the current scenario */
+static int run_one(void)
+{
+    SSL *clientssl = NULL, *serverssl = NULL;
+    BIO *cbio = NULL, *sbio = NULL;
+    int ret = 0;
+
+    if ((clientssl = SSL_new(cctx)) == NULL
+            || (serverssl = SSL_new(sctx)) == NULL
+            || !BIO_new_bio_pair(&cbio, 0, &sbio, 0))
+        goto end;
+    SSL_set_bio(clientssl, cbio, cbio);
+    SSL_set_bio(serverssl, sbio, sbio);
+
+    switch (current->mode) {
+    case HS_RESUME_ID:
+    case HS_RESUME_TICKET:
+    case HS_EARLY_DATA:
+        if (!SSL_set_session(clientssl, session))
+            goto end;
+        break;
+    default:
+        break;
+    }
+
+    if (current->mode == HS_EARLY_DATA)
+        ret = do_early_data_handshake(clientssl, serverssl);
+    else
+        ret = do_handshake(clientssl, serverssl);
+
+    switch (current->mode) {
+    case HS_RESUME_ID:
+    case HS_RESUME_TICKET:
+    case HS_PSK:
+    case HS_EARLY_DATA:
+        ret = ret && SSL_session_reused(clientssl);
+        break;
+    default:
+        break;
+    }
+
+    /* An unfinished connection would make the session unresumable */
+    if (ret) {
+        SSL_shutdown(clientssl);
+        SSL_shutdown(serverssl);
+    }
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    return ret;
+}
+
+static void worker(void)
+{
+    THREAD_RESULT *res;
+    uint32_t start;
+    size_t i;
+    int idx;
+
+    if (!CRYPTO_atomic_add(&next_thread, 1, &idx, thread_lock))
+        return;
+    res = &results[idx - 1];
+
+    for (i = 0; i < num_handshakes; i++) {
+        start = OPENSSL_rdtsc();
+        if (!run_one()) {
+            res->failed = 1;
+            break;
+        }
+        res->cycles += (uint32_t)(OPENSSL_rdtsc() - start);
+        res->handshakes++;
+    }
+}
+
+/*
+ * Create the SSL_CTX pair for the current scenario. Returns 1 on success, 0 on
+ * error and -1 if the scenario is not supported by this build.
+ */
+static int setup_scenario(void)
+{
+    char *certfile = NULL, *keyfile = NULL;
+    int ret = -1;
+
+    if (!TEST_ptr(certfile = mk_file_path(certsdir, current->cert))
+            || !TEST_ptr(keyfile = mk_file_path(certsdir, current->key))) {
+        ret = 0;
+        goto end;
+    }
+
+    sctx = SSL_CTX_new(TLS_server_method());
+    cctx = SSL_CTX_new(TLS_client_method());
+    if (sctx == NULL || cctx == NULL
+            || !SSL_CTX_set_min_proto_version(sctx, current->version)
+            || !SSL_CTX_set_max_proto_version(sctx, current->version)
+            || !SSL_CTX_set_min_proto_version(cctx, current->version)
+            || !SSL_CTX_set_max_proto_version(cctx, current->version)
+            || SSL_CTX_use_certificate_file(sctx, certfile,
+                                            SSL_FILETYPE_PEM) <= 0
+            || SSL_CTX_use_PrivateKey_file(sctx, keyfile,
+                                           SSL_FILETYPE_PEM) <= 0)
+        goto end;
+
+    if (current->version == TLS1_3_VERSION) {
+        if (!SSL_CTX_set_ciphersuites(cctx, current->ciphers))
+            goto end;
+    } else if (!SSL_CTX_set_cipher_list(cctx, current->ciphers)) {
+        goto end;
+    }
+    if (current->groups != NULL
+            && !SSL_CTX_set1_groups_list(cctx, current->groups))
+        goto end;
+    /* Only accept the second group offered, so the client has to retry */
+    if (current->mode == HS_HRR
+            && !SSL_CTX_set1_groups_list(sctx,
+                                         strchr(current->groups, ':') + 1))
+        goto end;
+
+    switch (current->mode) {
+    case HS_RESUME_ID:
+        SSL_CTX_set_options(sctx, SSL_OP_NO_TICKET);
+        break;
+    case HS_EARLY_DATA:
+        /* Every thread resumes the same session, so allow replays */
+        SSL_CTX_set_options(sctx, SSL_OP_NO_ANTI_REPLAY);
+        if (!SSL_CTX_set_max_early_data(sctx, SSL3_RT_MAX_PLAIN_LENGTH))
+            goto end;
+        break;
+    case HS_PSK:
+        SSL_CTX_set_psk_use_session_callback(cctx, use_session_cb);
+        SSL_CTX_set_psk_find_session_callback(sctx, find_session_cb);
+        break;
+    default:
+        break;
+    }
+    ret = 1;
+
+ end:
+    ERR_clear_error();
+    OPENSSL_free(certfile);
+    OPENSSL_free(keyfile);
+    return ret;
+}
+
+/* Obtain the session the threads resume or use as a PSK */
+static int setup_session(void)
+{
+    SSL *clientssl = NULL, *serverssl = NULL;
+    BIO *cbio = NULL, *sbio = NULL;
+    const SSL_CIPHER *cipher;
+    int ret = 0;
+
+    if (!TEST_ptr(clientssl = SSL_new(cctx))
+            || !TEST_ptr(serverssl = SSL_new(sctx))
+            || !TEST_true(BIO_new_bio_pair(&cbio, 0, &sbio, 0)))
+        goto end;
+    SSL_set_bio(clientssl, cbio, cbio);
+    SSL_set_bio(serverssl, sbio, sbio);
+
+    if (current->mode == HS_PSK) {
+        if (!TEST_ptr(cipher = SSL_CIPHER_find(clientssl,
+                                               (const unsigned char *)"\x13\x01"))
+                || !TEST_ptr(session = SSL_SESSION_new())
+                || !TEST_true(SSL_SESSION_set1_master_key(session, pskkey,
+                                                          sizeof(pskkey)))
+                || !TEST_true(SSL_SESSION_set_cipher(session, cipher))
+                || !TEST_true(SSL_SESSION_set_protocol_version(session,
+                                                            TLS1_3_VERSION)))
+            goto end;
+    } else {
+        unsigned char buf;
+        size_t readbytes;
+
+        /* In TLSv1.3 the client reads the tickets after the handshake */
+        if (!TEST_true(do_handshake(clientssl, serverssl))
+                || !TEST_false(SSL_read_ex(clientssl, &buf, sizeof(buf),
+                                           &readbytes))
+                || !TEST_ptr(session = SSL_get1_session(clientssl)))
+            goto end;
+        SSL_shutdown(clientssl);
+        SSL_shutdown(serverssl);
+    }
+    ret = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    return ret;
+}
+
+static int run_scenario(int idx)
+{
+    thread_t threads[MAX_THREADS];
+    size_t i, handshakes = 0;
+    uint64_t cycles = 0;
+    clock_t cpu_start, cpu;
+    double wall_start, wall;
+#ifndef OPENSSL_NO_CRYPTO_MDEBUG
+    int mstart, mcount;
+#endif
+    int ret = 0, failed = 0, rv;
+
+    current = &scenarios[idx];
+    rv = setup_scenario();
+    if (rv < 0) {
+        TEST_note("%s: not supported", current->name);
+        ret = 1;
+        goto end;
+    }
+    if (!TEST_int_eq(rv, 1))
+        goto end;
+
+    switch (current->mode) {
+    case HS_RESUME_ID:
+    case HS_RESUME_TICKET:
+    case HS_PSK:
+    case HS_EARLY_DATA:
+        if (!setup_session())
+            goto end;
+        break;
+    default:
+        break;
+    }
+
+    memset(results, 0, sizeof(results));
+    next_thread = 0;
+#ifndef OPENSSL_NO_CRYPTO_MDEBUG
+    CRYPTO_get_alloc_counts(&mstart, NULL, NULL);
+#endif
+    cpu_start = clock();
+    wall_start = wall_time();
+    for (i = 0; i < num_threads; i++) {
+        if (!TEST_true(run_thread(&threads[i], worker))) {
+            num_threads = i;
+            failed = 1;
+            break;
+        }
+    }
+    for (i = 0; i < num_threads; i++)
+        wait_for_thread(threads[i]);
+    cpu = clock() - cpu_start;
+    wall = wall_time() - wall_start;
+
+    for (i = 0; i < num_threads; i++) {
+        handshakes += results[i].handshakes;
+        cycles += results[i].cycles;
+        failed |= results[i].failed;
+    }
+    if (!TEST_false(failed) || !TEST_size_t_gt(handshakes, 0))
+        goto end;
+
+    test_printf_stdout("%-32s %9.0f hs/s %9.1f us/hs %11.0f cycles/hs",
+                       current->name, wall > 0 ? handshakes / wall : 0,
+                       1e6 * cpu / CLOCKS_PER_SEC / handshakes,
+                       (double)cycles / handshakes);
+#ifndef OPENSSL_NO_CRYPTO_MDEBUG
+    CRYPTO_get_alloc_counts(&mcount, NULL, NULL);
+    test_printf_stdout(" %6.0f allocs/hs",
+                       (double)(mcount - mstart) / handshakes);
+#endif
+    test_printf_stdout("\n");
+    test_flush_stdout();
+    ret = 1;
+
+ end:
+    SSL_SESSION_free(session);
+    session = NULL;
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    sctx = cctx = NULL;
+    return ret;
+}
+
+int setup_tests(void)
+{
+    char *arg;
+
+    if (!TEST_ptr(certsdir = test_get_argument(0)))
+        return 0;
+    if ((arg = test_get_argument(1)) != NULL) {
+        num_threads = strtoul(arg, NULL, 10);
+        if (!TEST_size_t_gt(num_threads, 0)
+                || !TEST_size_t_le(num_threads, MAX_THREADS))
+            return 0;
+    }
+    if ((arg = test_get_argument(2)) != NULL) {
+        num_handshakes = strtoul(arg, NULL, 10);
+        if (!TEST_size_t_gt(num_handshakes, 0))
+            return 0;
+    }
+    if (!TEST_ptr(thread_lock = CRYPTO_THREAD_lock_new()))
+        return 0;
+
+    ADD_ALL_TESTS(run_scenario, OSSL_NELEM(scenarios));
+    return 1;
+}
+
+void cleanup_tests(void)
+{
+    CRYPTO_THREAD_lock_free(thread_lock);
+}
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Hash table benchmark, comparing OPENSSL_LHASH with OPENSSL_OAHASH.
+ *
+ * Usage: lhash_bench [items [threads]]
+ *
+ * Every scenario fills a table with |items| entries, looks each of them up
+ * as well as as many missing ones, and deletes them again.  Reported are
+ * the nanoseconds spent per operation.  The threaded scenarios then have
+ * |threads| threads share each table, behind a lock except for the
+ * concurrent one, each thread working on entries of its own and on a
+ * shared set of entries everyone looks up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+# include <sys/time.h>
+#endif
+#include <openssl/crypto.h>
+#include <openssl/lhash.h>
+#include "internal/nelem.h"
+#include "testutil.h"
+#include "testutil/output.h"
+#include "threadstest.h"
+
+#ifdef __clang__
+#pragma clang diagnostic ignored "-Wunused-function"
+#endif
+
+#define DEFAULT_ITEMS   100000
+#define DEFAULT_THREADS 4
+#define MAX_THREADS     64
+
+typedef struct {
+    char name[24];
+} ITEM;
+
+static unsigned long item_hash(const ITEM *a)
+{
+    return OPENSSL_LH_strhash(a->name);
+}
+
+static int item_cmp(const ITEM *a, const ITEM *b)
+{
+    return strcmp(a->name, b->name);
+}
+
+typedef struct {
+    const char *name;
+    void *(*new)(void);
+    void (*free)(void *h);
+    void *(*insert)(void *h, void *d);
+    void *(*retrieve)(void *h, const void *d);
+    void *(*delete)(void *h, const void *d);
+} TABLE_METHOD;
+
+static void *chained_new(void)
+{
+    return OPENSSL_LH_new((OPENSSL_LH_HASHFUNC)item_hash,
+                          (OPENSSL_LH_COMPFUNC)item_cmp);
+}
+
+static void chained_free(void *h)
+{
+    OPENSSL_LH_free(h);
+}
+
+static void *chained_insert(void *h, void *d)
+{
+    return OPENSSL_LH_insert(h, d);
+}
+
+static void *chained_retrieve(void *h, const void *d)
+{
+    return OPENSSL_LH_retrieve(h, d);
+}
+
+static void *chained_delete(void *h, const void *d)
+{
+    return OPENSSL_LH_delete(h, d);
+}
+
+static void *oa_new(void)
+{
+    return OPENSSL_OAH_new((OPENSSL_LH_HASHFUNC)item_hash,
+                           (OPENSSL_LH_COMPFUNC)item_cmp, 0);
+}
+
+static void *oa_new_concurrent(void)
+{
+    return OPENSSL_OAH_new((OPENSSL_LH_HASHFUNC)item_hash,
+                           (OPENSSL_LH_COMPFUNC)item_cmp,
+                           OPENSSL_OAH_CONCURRENT);
+}
+
+static void oa_free(void *h)
+{
+    OPENSSL_OAH_free(h);
+}
+
+static void *oa_insert(void *h, void *d)
+{
+    return OPENSSL_OAH_insert(h, d);
+}
+
+static void *oa_retrieve(void *h, const void *d)
+{
+    return OPENSSL_OAH_retrieve(h, d);
+}
+
+static void *oa_delete(void *h, const void *d)
+{
+    return OPENSSL_OAH_delete(h, d);
+}
+
+static const TABLE_METHOD methods[] = {
+    {"OPENSSL_LHASH", chained_new, chained_free, chained_insert, chained_retrieve, chained_delete},
+    {"OPENSSL_OAHASH", oa_new, oa_free, oa_insert, oa_retrieve,
+     oa_delete},
+    {"OPENSSL_OAHASH concurrent", oa_new_concurrent, oa_free, oa_insert,
+     oa_retrieve, oa_delete},
+};
+
+static size_t num_items = DEFAULT_ITEMS;
+static size_t num_threads = DEFAULT_THREADS;
+static ITEM *items, *missing;
+
+static double wall_time(void)
+{
+#ifdef _WIN32
+    return GetTickCount() / 1000.0;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+}
+
+static void report(const char *table, const char *op, double secs, size_t n)
+{
+    test_printf_stdout("%-28s %-16s %8.1f ns/op\n", table, op,
+                       secs * 1e9 / n);
+}
+
+static int run_method(int idx)
+{
+    const TABLE_METHOD *meth = &methods[idx];
+    void *h;
+    double start;
+    size_t i;
+    int ret = 0;
+
+    if (!TEST_ptr(h = meth->new()))
+        return 0;
+
+    start = wall_time();
+    for (i = 0; i < num_items; i++)
+        meth->insert(h, &items[i]);
+    report(meth->name, "insert", wall_time() - start, num_items);
+
+    start = wall_time();
+    for (i = 0; i < num_items; i++)
+        if (!TEST_ptr_eq(meth->retrieve(h, &items[i]), &items[i]))
+            goto end;
+    report(meth->name, "retrieve hit", wall_time() - start, num_items);
+
+    start = wall_time();
+    for (i = 0; i < num_items; i++)
+        if (!TEST_ptr_null(meth->retrieve(h, &missing[i])))
+            goto end;
+    report(meth->name, "retrieve miss", wall_time() - start, num_items);
+
+    start = wall_time();
+    for (i = 0; i < num_items; i++)
+        if (!TEST_ptr_eq(meth->delete(h, &items[i]), &items[i]))
+            goto end;
+    report(meth->name, "delete", wall_time() - start, num_items);
+    ret = 1;
+
+ end:
+    meth->free(h);
+    test_flush_stdout();
+    return ret;
+}
+
+/* State shared with the worker threads of a threaded scenario */
+static const TABLE_METHOD *current;
+static void *table;
+static CRYPTO_RWLOCK *table_lock, *thread_lock;
+static size_t next_thread;
+static int thread_failed;
+
+static void *locked_insert(void *d)
+{
+    void *ret;
+
+    if (table_lock == NULL)
+        return current->insert(table, d);
+    CRYPTO_THREAD_write_lock(table_lock);
+    ret = current->insert(table, d);
+    CRYPTO_THREAD_unlock(table_lock);
+    return ret;
+}
+
+static void *locked_retrieve(const void *d)
+{
+    void *ret;
+
+    if (table_lock == NULL)
+        return current->retrieve(table, d);
+    CRYPTO_THREAD_read_lock(table_lock);
+    ret = current->retrieve(table, d);
+    CRYPTO_THREAD_unlock(table_lock);
+    return ret;
+}
+
+static void *locked_delete(const void *d)
+{
+    void *ret;
+
+    if (table_lock == NULL)
+        return current->delete(table, d);
+    CRYPTO_THREAD_write_lock(table_lock);
+    ret = current->delete(table, d);
+    CRYPTO_THREAD_unlock(table_lock);
+    return ret;
+}
+
+/*
+ * Insert, look up and delete the entries of this thread, looking up one of
+ * the shared ones, the second half of |items|, after each operation.
+ */
+static void worker(void)
+{
+    size_t n = num_items / 2 / num_threads, shared = num_items / 2;
+    ITEM *own;
+    size_t i;
+    int failed = 0;
+
+    CRYPTO_THREAD_write_lock(thread_lock);
+    own = items + n * next_thread++;
+    CRYPTO_THREAD_unlock(thread_lock);
+
+    for (i = 0; i < n; i++) {
+        locked_insert(&own[i]);
+        if (locked_retrieve(&items[shared + i % shared]) == NULL)
+            failed = 1;
+    }
+    for (i = 0; i < n; i++) {
+        if (locked_retrieve(&own[i]) != &own[i])
+            failed = 1;
+        if (locked_retrieve(&items[shared + i % shared]) == NULL)
+            failed = 1;
+    }
+    for (i = 0; i < n; i++) {
+        if (locked_delete(&own[i]) != &own[i])
+            failed = 1;
+        if (locked_retrieve(&items[shared + i % shared]) == NULL)
+            failed = 1;
+    }
+    if (failed) {
+        CRYPTO_THREAD_write_lock(thread_lock);
+        thread_failed = 1;
+        CRYPTO_THREAD_unlock(thread_lock);
+    }
+}
+
+static int run_threads(int idx)
+{
+    thread_t threads[MAX_THREADS];
+    size_t i, started, ops;
+    double start;
+    int ret = 0;
+
+    current = &methods[idx];
+    /* Only the concurrent table can do without a lock around it */
+    if (idx != 2 && !TEST_ptr(table_lock = CRYPTO_THREAD_lock_new()))
+        return 0;
+    if (!TEST_ptr(table = current->new()))
+        goto end;
+    for (i = num_items / 2; i < num_items; i++)
+        current->insert(table, &items[i]);
+
+    next_thread = 0;
+    thread_failed = 0;
+    start = wall_time();
+    for (started = 0; started < num_threads; started++)
+        if (!TEST_true(run_thread(&threads[started], worker)))
+            break;
+    for (i = 0; i < started; i++)
+        wait_for_thread(threads[i]);
+    if (!TEST_size_t_eq(started, num_threads) || !TEST_false(thread_failed))
+        goto end;
+
+    ops = num_items / 2 / num_threads * num_threads * 6;
+    report(current->name, "threads", wall_time() - start, ops);
+    ret = 1;
+
+ end:
+    current->free(table);
+    table = NULL;
+    CRYPTO_THREAD_lock_free(table_lock);
+    table_lock = NULL;
+    test_flush_stdout();
+    return ret;
+}
+
+int setup_tests(void)
+{
+    char *arg;
+    size_t i;
+
+    if ((arg = test_get_argument(0)) != NULL) {
+        num_items = strtoul(arg, NULL, 10);
+        if (!TEST_size_t_gt(num_items, 0))
+            return 0;
+    }
+    if ((arg = test_get_argument(1)) != NULL) {
+        num_threads = strtoul(arg, NULL, 10);
+        if (!TEST_size_t_gt(num_threads, 0)
+                || !TEST_size_t_le(num_threads, MAX_THREADS))
+            return 0;
+    }
+    /* Every thread needs at least one entry of its own */
+    if (!TEST_size_t_ge(num_items, 2 * num_threads))
+        return 0;
+    if (!TEST_ptr(items = OPENSSL_malloc(num_items * sizeof(*items)))
+            || !TEST_ptr(missing = OPENSSL_malloc(num_items * sizeof(*items)))
+            || !TEST_ptr(thread_lock = CRYPTO_THREAD_lock_new()))
+        return 0;
+    for (i = 0; i < num_items; i++) {
+        BIO_snprintf(items[i].name, sizeof(items[i].name), "item-%lu",
+                     (unsigned long)i);
+        BIO_snprintf(missing[i].name, sizeof(missing[i].name), "missing-%lu",
+                     (unsigned long)i);
+    }
+
+    ADD_ALL_TESTS(run_method, OSSL_NELEM(methods));
+    ADD_ALL_TESTS(run_threads, OSSL_NELEM(methods));
+    return 1;
+}
+
+void cleanup_tests(void)
+{
+    OPENSSL_free(items);
+    OPENSSL_free(missing);
+    CRYPTO_THREAD_lock_free(thread_lock);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/bio.h>
+#include <openssl/buffer.h>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+
+#include "testutil.h"
+#include "testutil/output.h"
+
+/*
+ * We use a proper main function here instead of the custom main from the
+ * test framework because memory accounting has to be enabled before the
+ * first allocation, and the test framework allocates before it calls
+ * setup_tests().
+ */
+
+static int check(int lib, size_t live_bytes, size_t live_num,
+                 size_t peak_bytes, size_t num_allocs)
+{
+    size_t lb, ln, pb, na;
+
+    return TEST_true(CRYPTO_mem_acct_get(lib, &lb, &ln, &pb, &na))
+           && TEST_size_t_eq(lb, live_bytes)
+           && TEST_size_t_eq(ln, live_num)
+           && TEST_size_t_eq(pb, peak_bytes)
+           && TEST_size_t_eq(na, num_allocs);
+}
+
+static int test_accounting(void)
+{
+    void *a, *b, *c, *d, *e;
+    BIO *bio = NULL;
+    BUF_MEM *report;
+    size_t crypto_bytes, crypto_num, cb, cn;
+    int ret = 0;
+
+    if (!TEST_true(CRYPTO_mem_acct_get(ERR_LIB_CRYPTO, &crypto_bytes,
+                                       &crypto_num, NULL, NULL)))
+        return 0;
+
+    a = CRYPTO_malloc(100, "crypto/x509/x509_lu.c", 1);
+    b = CRYPTO_zalloc(50, "../../crypto/x509/x_all.c", 2);
+    c = CRYPTO_malloc(10, "/src/openssl/ssl/statem/statem.c", 3);
+    d = CRYPTO_malloc(7, "crypto\\ts\\ts_rsp.c", 4);
+    e = CRYPTO_malloc(3, "crypto/stack/stack.c", 5);
+    if (!TEST_ptr(a) || !TEST_ptr(b) || !TEST_ptr(c) || !TEST_ptr(d)
+            || !TEST_ptr(e)
+            || !check(ERR_LIB_X509, 150, 2, 150, 2)
+            || !check(ERR_LIB_SSL, 10, 1, 10, 1)
+            || !check(ERR_LIB_TS, 7, 1, 7, 1)
+            || !TEST_true(CRYPTO_mem_acct_get(ERR_LIB_CRYPTO, &cb, &cn,
+                                              NULL, NULL))
+            || !TEST_size_t_eq(cb, crypto_bytes + 3)
+            || !TEST_size_t_eq(cn, crypto_num + 1)
+            || !TEST_false(CRYPTO_mem_acct_get(ERR_LIB_USER + 1, NULL, NULL,
+                                               NULL, NULL)))
+        goto end;
+
+    /* A block is accounted to whoever resized it last */
+    if (!TEST_ptr(b = CRYPTO_realloc(b, 500, "crypto/x509v3/v3_lib.c", 6))
+            || !check(ERR_LIB_X509, 100, 1, 150, 2)
+            || !check(ERR_LIB_X509V3, 500, 1, 500, 1))
+        goto end;
+
+    CRYPTO_free(a, "crypto/x509/x509_lu.c", 7);
+    CRYPTO_free(c, "ssl/statem/statem.c", 8);
+    if (!check(ERR_LIB_X509, 0, 0, 150, 2)
+            || !check(ERR_LIB_SSL, 0, 0, 10, 1))
+        goto end;
+
+    /* Every allocation is sampled, those still there are reported */
+    if (!TEST_ptr(bio = BIO_new(BIO_s_mem()))
+            || !TEST_true(CRYPTO_mem_acct_report(bio))
+            || !TEST_int_eq(BIO_write(bio, "", 1), 1))
+        goto end;
+    BIO_get_mem_ptr(bio, &report);
+    if (!TEST_ptr(strstr(report->data, "\nx509v3 "))
+            || !TEST_ptr(strstr(report->data, "x509v3/v3_lib.c:6"))
+            || !TEST_ptr(strstr(report->data, "ts_rsp.c:4"))
+            || !TEST_ptr_null(strstr(report->data, "x509_lu.c:1")))
+        goto end;
+
+    CRYPTO_mem_acct_reset();
+    if (!check(ERR_LIB_X509, 0, 0, 0, 0)
+            || !check(ERR_LIB_X509V3, 500, 1, 500, 0))
+        goto end;
+    ret = 1;
+
+ end:
+    BIO_free(bio);
+    CRYPTO_free(b, "crypto/x509v3/v3_lib.c", 9);
+    CRYPTO_free(d, "crypto/ts/ts_rsp.c", 10);
+    CRYPTO_free(e, "crypto/stack/stack.c", 11);
+    return ret && check(ERR_LIB_X509V3, 0, 0, 500, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    int ret;
+
+    if (!CRYPTO_mem_acct_enable(1))
+        return EXIT_FAILURE;
+    test_open_streams();
+    ret = TEST_false(CRYPTO_mem_acct_enable(1)) && test_accounting();
+    test_close_streams();
+    return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/* Tests for the open addressing hash table behind DEFINE_OAHASH_OF() */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <openssl/opensslconf.h>
+#include <openssl/lhash.h>
+#include <openssl/err.h>
+#include <openssl/crypto.h>
+
+#include "internal/nelem.h"
+#include "testutil.h"
+#include "threadstest.h"
+
+#ifdef __clang__
+#pragma clang diagnostic ignored "-Wunused-function"
+#endif
+
+DEFINE_OAHASH_OF(int);
+
+static int int_tests[] = { 65537, 13, 1, 3, -5, 6, 7, 4, -10, -12, -14, 22, 9,
+                           -17, 16, 17, -23, 35, 37, 173, 11 };
+static const unsigned int n_int_tests = OSSL_NELEM(int_tests);
+static short int_found[OSSL_NELEM(int_tests)];
+
+static unsigned long int int_hash(const int *p)
+{
+    return 3 & *p;      /* To force collisions */
+}
+
+static int int_cmp(const int *p, const int *q)
+{
+    return *p != *q;
+}
+
+static int int_find(int n)
+{
+    unsigned int i;
+
+    for (i = 0; i < n_int_tests; i++)
+        if (int_tests[i] == n)
+            return i;
+    return -1;
+}
+
+static void int_doall(int *v)
+{
+    int_found[int_find(*v)]++;
+}
+
+static void int_doall_arg(int *p, short *f)
+{
+    f[int_find(*p)]++;
+}
+
+IMPLEMENT_OAHASH_DOALL_ARG(int, short);
+
+static int test_int_oahash(int concurrent)
+{
+    static struct {
+        int data;
+        int null;
+    } dels[] = {
+        { 65537,    0 },
+        { 173,      0 },
+        { 999,      1 },
+        { 37,       0 },
+        { 1,        0 },
+        { 34,       1 }
+    };
+    const unsigned int n_dels = OSSL_NELEM(dels);
+    LHASH_OF(int) *h = concurrent ? lh_int_new_concurrent(&int_hash, &int_cmp)
+                                  : lh_int_new(&int_hash, &int_cmp);
+    unsigned int i;
+    int testresult = 0, j, *p;
+
+    if (!TEST_ptr(h))
+        goto end;
+
+    /* insert */
+    for (i = 0; i < n_int_tests; i++)
+        if (!TEST_ptr_null(lh_int_insert(h, int_tests + i))) {
+            TEST_info("int insert %d", i);
+            goto end;
+        }
+
+    /* num_items */
+    if (!TEST_int_eq(lh_int_num_items(h), n_int_tests))
+        goto end;
+
+    /* retrieve */
+    for (i = 0; i < n_int_tests; i++)
+        if (!TEST_ptr_eq(lh_int_retrieve(h, int_tests + i), int_tests + i)) {
+            TEST_info("oahash int retrieve address %d", i);
+            goto end;
+        }
+    j = 1;
+    if (!TEST_ptr_eq(lh_int_retrieve(h, &j), int_tests + 2))
+        goto end;
+    j = 2;
+    if (!TEST_ptr_null(lh_int_retrieve(h, &j)))
+        goto end;
+
+    /* replace */
+    j = 13;
+    if (!TEST_ptr(p = lh_int_insert(h, &j)))
+        goto end;
+    if (!TEST_ptr_eq(p, int_tests + 1))
+        goto end;
+    if (!TEST_ptr_eq(lh_int_retrieve(h, int_tests + 1), &j)
+            || !TEST_int_eq(lh_int_num_items(h), n_int_tests))
+        goto end;
+
+    /* do_all */
+    memset(int_found, 0, sizeof(int_found));
+    lh_int_doall(h, &int_doall);
+    for (i = 0; i < n_int_tests; i++)
+        if (!TEST_int_eq(int_found[i], 1)) {
+            TEST_info("oahash int doall %d", i);
+            goto end;
+        }
+
+    /* do_all_arg */
+    memset(int_found, 0, sizeof(int_found));
+    lh_int_doall_short(h, int_doall_arg, int_found);
+    for (i = 0; i < n_int_tests; i++)
+        if (!TEST_int_eq(int_found[i], 1)) {
+            TEST_info("oahash int doall arg %d", i);
+            goto end;
+        }
+
+    /* delete */
+    for (i = 0; i < n_dels; i++) {
+        const int b = lh_int_delete(h, &dels[i].data) == NULL;
+        if (!TEST_int_eq(b ^ dels[i].null,  0)) {
+            TEST_info("oahash int delete %d", i);
+            goto end;
+        }
+    }
+    if (!TEST_int_eq(lh_int_num_items(h), n_int_tests - 4)
+            || !TEST_ptr_null(lh_int_retrieve(h, &dels[0].data))
+            || !TEST_ptr_eq(lh_int_retrieve(h, int_tests + 20), int_tests + 20))
+        goto end;
+
+    /* error */
+    if (!TEST_int_eq(lh_int_error(h), 0))
+        goto end;
+
+    testresult = 1;
+end:
+    lh_int_free(h);
+    return testresult;
+}
+
+static unsigned long int stress_hash(const int *p)
+{
+    return *p;
+}
+
+static int test_stress(void)
+{
+    LHASH_OF(int) *h = lh_int_new(&stress_hash, &int_cmp);
+    const unsigned int n = 2500000;
+    unsigned int i;
+    int testresult = 0, *p;
+
+    if (!TEST_ptr(h))
+        goto end;
+
+    /* insert */
+    for (i = 0; i < n; i++) {
+        p = OPENSSL_malloc(sizeof(i));
+        if (!TEST_ptr(p)) {
+            TEST_info("oahash stress out of memory %d", i);
+            goto end;
+        }
+        *p = 3 * i + 1;
+        lh_int_insert(h, p);
+    }
+
+    /* num_items */
+    if (!TEST_int_eq(lh_int_num_items(h), n))
+            goto end;
+
+    TEST_info("hash full statistics:");
+    lh_int_stats_bio(h, bio_err);
+
+    /* delete in a different order */
+    for (i = 0; i < n; i++) {
+        const int j = (7 * i + 4) % n * 3 + 1;
+
+        if (!TEST_ptr(p = lh_int_delete(h, &j))) {
+            TEST_info("oahash stress delete %d\n", i);
+            goto end;
+        }
+        if (!TEST_int_eq(*p, j)) {
+            TEST_info("oahash stress bad value %d", i);
+            goto end;
+        }
+        OPENSSL_free(p);
+    }
+
+    TEST_info("hash empty statistics:");
+    lh_int_stats_bio(h, bio_err);
+
+    testresult = 1;
+end:
+    lh_int_free(h);
+    return testresult;
+}
+
+/* Deleting every other entry while walking through the table */
+static LHASH_OF(int) *walked;
+
+static void delete_odd(int *p)
+{
+    if ((*p & 1) != 0)
+        lh_int_delete(walked, p);
+}
+
+static int test_delete_in_doall(void)
+{
+    static int vals[1000];
+    unsigned int i;
+    int testresult = 0;
+
+    if (!TEST_ptr(walked = lh_int_new(&stress_hash, &int_cmp)))
+        goto end;
+    for (i = 0; i < OSSL_NELEM(vals); i++) {
+        vals[i] = i;
+        lh_int_insert(walked, vals + i);
+    }
+    lh_int_doall(walked, delete_odd);
+    if (!TEST_int_eq(lh_int_num_items(walked), OSSL_NELEM(vals) / 2))
+        goto end;
+    for (i = 0; i < OSSL_NELEM(vals); i++)
+        if (!TEST_ptr_eq(lh_int_retrieve(walked, vals + i),
+                         (i & 1) != 0 ? NULL : vals + i)) {
+            TEST_info("oahash doall delete %d", i);
+            goto end;
+        }
+
+    /* Deleted slots are reused and don't stop searches */
+    for (i = 0; i < 100 * OSSL_NELEM(vals); i++) {
+        int *v = vals + 1 + 2 * (i % (OSSL_NELEM(vals) / 2));
+
+        if (!TEST_ptr_null(lh_int_insert(walked, v))
+                || !TEST_ptr_eq(lh_int_delete(walked, v), v))
+            goto end;
+    }
+    for (i = 0; i < OSSL_NELEM(vals); i += 2)
+        if (!TEST_ptr_eq(lh_int_retrieve(walked, vals + i), vals + i))
+            goto end;
+
+    testresult = 1;
+end:
+    lh_int_free(walked);
+    walked = NULL;
+    return testresult;
+}
+
+/* A high down load is capped, and the table never shrinks below its items */
+static int test_high_down_load(void)
+{
+    static int vals[1000];
+    LHASH_OF(int) *h;
+    unsigned int i, j;
+    int testresult = 0;
+
+    if (!TEST_ptr(h = lh_int_new(&stress_hash, &int_cmp)))
+        goto end;
+    lh_int_set_down_load(h, 4 * LH_LOAD_MULT);
+    if (!TEST_ulong_le(lh_int_get_down_load(h), LH_LOAD_MULT / 2))
+        goto end;
+    for (i = 0; i < OSSL_NELEM(vals); i++) {
+        vals[i] = i;
+        lh_int_insert(h, vals + i);
+    }
+    for (i = 0; i < OSSL_NELEM(vals); i++) {
+        if (!TEST_ptr_eq(lh_int_delete(h, vals + i), vals + i))
+            goto end;
+        for (j = i + 1; j < OSSL_NELEM(vals); j += 97)
+            if (!TEST_ptr_eq(lh_int_retrieve(h, vals + j), vals + j))
+                goto end;
+    }
+    if (!TEST_int_eq(lh_int_num_items(h), 0))
+        goto end;
+
+    testresult = 1;
+end:
+    lh_int_free(h);
+    return testresult;
+}
+
+#define THREADS         4
+#define PER_THREAD      20000
+
+static LHASH_OF(int) *shared;
+static CRYPTO_RWLOCK *thread_lock;
+static int next_thread;
+static int thread_vals[THREADS][PER_THREAD];
+static int thread_failed;
+
+static void worker(void)
+{
+    int *vals, i, failed = 0;
+
+    CRYPTO_THREAD_write_lock(thread_lock);
+    vals = thread_vals[next_thread++];
+    CRYPTO_THREAD_unlock(thread_lock);
+
+    for (i = 0; i < PER_THREAD; i++)
+        if (lh_int_insert(shared, vals + i) != NULL)
+            failed = 1;
+    for (i = 0; i < PER_THREAD; i++)
+        if (lh_int_retrieve(shared, vals + i) != vals + i)
+            failed = 1;
+    for (i = 0; i < PER_THREAD; i += 2)
+        if (lh_int_delete(shared, vals + i) != vals + i)
+            failed = 1;
+
+    if (failed) {
+        CRYPTO_THREAD_write_lock(thread_lock);
+        thread_failed = 1;
+        CRYPTO_THREAD_unlock(thread_lock);
+    }
+}
+
+static int test_concurrent(void)
+{
+    thread_t threads[THREADS];
+    int i, j, testresult = 0;
+
+    if (!TEST_ptr(thread_lock = CRYPTO_THREAD_lock_new())
+            || !TEST_ptr(shared = lh_int_new_concurrent(&stress_hash,
+                                                        &int_cmp)))
+        goto end;
+    for (i = 0; i < THREADS; i++)
+        for (j = 0; j < PER_THREAD; j++)
+            thread_vals[i][j] = i * PER_THREAD + j;
+
+    for (i = 0; i < THREADS; i++)
+        if (!TEST_true(run_thread(&threads[i], worker)))
+            goto end;
+    for (i = 0; i < THREADS; i++)
+        if (!TEST_true(wait_for_thread(threads[i])))
+            goto end;
+
+    if (!TEST_false(thread_failed)
+            || !TEST_int_eq(lh_int_num_items(shared), THREADS * PER_THREAD / 2))
+        goto end;
+    for (i = 0; i < THREADS; i++)
+        for (j = 0; j < PER_THREAD; j++)
+            if (!TEST_ptr_eq(lh_int_retrieve(shared, &thread_vals[i][j]),
+                             (j & 1) != 0 ? &thread_vals[i][j] : NULL))
+                goto end;
+
+    testresult = 1;
+end:
+    lh_int_free(shared);
+    shared = NULL;
+    CRYPTO_THREAD_lock_free(thread_lock);
+    return testresult;
+}
+
+int setup_tests(void)
+{
+    ADD_ALL_TESTS(test_int_oahash, 2);
+    ADD_TEST(test_stress);
+    ADD_TEST(test_delete_in_doall);
+    ADD_TEST(test_high_down_load);
+    ADD_TEST(test_concurrent);
+    return 1;
+}
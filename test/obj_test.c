@@ -0,0 +1,202 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/* Tests for the OBJ_* name and OID lookups */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/objects.h>
+#include "testutil.h"
+#include "threadstest.h"
+
+#define NUM_CREATED     200
+
+static int test_builtin(void)
+{
+    int n, num = OBJ_new_nid(0), found = 0;
+    ASN1_OBJECT *o, *tmp = NULL;
+    const char *sn, *ln;
+
+    for (n = 0; n < num; n++) {
+        if ((o = OBJ_nid2obj(n)) == NULL) {
+            ERR_clear_error();
+            continue;
+        }
+        sn = OBJ_nid2sn(n);
+        ln = OBJ_nid2ln(n);
+        /* Where names are shared, any NID with the same name will do */
+        if (!TEST_str_eq(OBJ_nid2sn(OBJ_sn2nid(sn)), sn)
+                || !TEST_str_eq(OBJ_nid2ln(OBJ_ln2nid(ln)), ln))
+            return 0;
+        if (OBJ_length(o) == 0)
+            continue;
+        /* A copy without the NID has to be looked up by its OID */
+        if (!TEST_ptr(tmp = ASN1_OBJECT_create(0,
+                                               (unsigned char *)OBJ_get0_data(o),
+                                               OBJ_length(o), NULL, NULL))
+                || !TEST_int_eq(OBJ_cmp(OBJ_nid2obj(OBJ_obj2nid(tmp)), o), 0))
+            goto err;
+        ASN1_OBJECT_free(tmp);
+        tmp = NULL;
+        found++;
+    }
+    if (!TEST_int_gt(found, 1000)
+            || !TEST_int_eq(OBJ_sn2nid("no-such-name"), NID_undef)
+            || !TEST_int_eq(OBJ_ln2nid(""), NID_undef)
+            || !TEST_int_eq(OBJ_txt2nid("1.2.3.4.5.6.7.8.9"), NID_undef))
+        return 0;
+    return 1;
+
+ err:
+    ASN1_OBJECT_free(tmp);
+    return 0;
+}
+
+static int test_created(void)
+{
+    char oid[40], sn[40], ln[40];
+    int i, nid;
+
+    for (i = 0; i < NUM_CREATED; i++) {
+        BIO_snprintf(oid, sizeof(oid), "1.2.3.4.5.6.7.8.9.%d", i);
+        BIO_snprintf(sn, sizeof(sn), "obj-test-%d", i);
+        BIO_snprintf(ln, sizeof(ln), "obj test %d", i);
+        if (!TEST_int_ne(nid = OBJ_create(oid, sn, ln), NID_undef)
+                || !TEST_int_eq(OBJ_txt2nid(oid), nid)
+                || !TEST_int_eq(OBJ_sn2nid(sn), nid)
+                || !TEST_int_eq(OBJ_ln2nid(ln), nid)
+                || !TEST_str_eq(OBJ_nid2sn(nid), sn))
+            return 0;
+    }
+    /* The first ones are still there after the table has grown */
+    for (i = 0; i < NUM_CREATED; i++) {
+        BIO_snprintf(oid, sizeof(oid), "1.2.3.4.5.6.7.8.9.%d", i);
+        BIO_snprintf(sn, sizeof(sn), "obj-test-%d", i);
+        if (!TEST_int_ne(nid = OBJ_txt2nid(oid), NID_undef)
+                || !TEST_int_eq(OBJ_sn2nid(sn), nid))
+            return 0;
+    }
+    if (!TEST_false(OBJ_create("1.2.3.4.5.6.7.8.9.0", "other", "other"))
+            || !TEST_false(OBJ_create("1.2.840.113549", "rsadsi", NULL)))
+        return 0;
+    ERR_clear_error();
+    return 1;
+}
+
+static int test_names(void)
+{
+    int type;
+
+    if (!TEST_true(OBJ_NAME_add("obj-test-alias",
+                                OBJ_NAME_TYPE_MD_METH | OBJ_NAME_ALIAS,
+                                "SHA256"))
+            || !TEST_ptr_eq(EVP_get_digestbyname("obj-test-alias"),
+                            EVP_sha256())
+            || !TEST_str_eq(OBJ_NAME_get("obj-test-alias",
+                                         OBJ_NAME_TYPE_MD_METH
+                                         | OBJ_NAME_ALIAS), "SHA256")
+            || !TEST_true(OBJ_NAME_remove("obj-test-alias",
+                                          OBJ_NAME_TYPE_MD_METH))
+            || !TEST_ptr_null(EVP_get_digestbyname("obj-test-alias")))
+        return 0;
+
+    /* Replacing and removing the names of a custom type */
+    if (!TEST_int_ge(type = OBJ_NAME_new_index(NULL, NULL, NULL),
+                     OBJ_NAME_TYPE_NUM)
+            || !TEST_true(OBJ_NAME_add("name", type, "one"))
+            || !TEST_true(OBJ_NAME_add("name", type, "two"))
+            || !TEST_str_eq(OBJ_NAME_get("name", type), "two")
+            || !TEST_ptr_null(OBJ_NAME_get("name", OBJ_NAME_TYPE_MD_METH))
+            || !TEST_true(OBJ_NAME_remove("name", type))
+            || !TEST_false(OBJ_NAME_remove("name", type))
+            || !TEST_ptr_null(OBJ_NAME_get("name", type)))
+        return 0;
+    return 1;
+}
+
+/*
+ * Names looked up while another thread keeps replacing and removing them,
+ * which frees what was there before.  The main thread also reads, so we'll
+ * have THREADS+1 in parallel.
+ */
+#define THREADS         3
+#define CHANGES         1000
+
+static int names_type = 0;
+static int names_done = 0;
+static int names_threads_succeeded = 1;
+
+static void names_reader_cb(void)
+{
+    const char *v;
+
+    while (!names_done) {
+        v = OBJ_NAME_get("name", names_type);
+        if (v != NULL && strcmp(v, "one") != 0 && strcmp(v, "two") != 0)
+            names_threads_succeeded = 0;
+        v = OBJ_NAME_get("obj-test-alias", OBJ_NAME_TYPE_MD_METH);
+        if (v != NULL && strcmp(v, "SHA256") != 0)
+            names_threads_succeeded = 0;
+    }
+}
+
+static void names_writer_cb(void)
+{
+    int i;
+
+    for (i = 0; i < CHANGES; i++) {
+        if (!OBJ_NAME_add("name", names_type, i % 2 ? "one" : "two")
+                || !OBJ_NAME_add("obj-test-alias", OBJ_NAME_TYPE_MD_METH,
+                                 "SHA256")
+                || (i % 3 == 0
+                    && !OBJ_NAME_remove("obj-test-alias",
+                                        OBJ_NAME_TYPE_MD_METH)))
+            names_threads_succeeded = 0;
+    }
+    names_done = 1;
+}
+
+static int test_names_threads(void)
+{
+    thread_t t[THREADS + 1];
+    int i, started, ret = 1;
+
+    if (!TEST_int_ge(names_type = OBJ_NAME_new_index(NULL, NULL, NULL),
+                     OBJ_NAME_TYPE_NUM))
+        return 0;
+
+    for (started = 0; started < THREADS; started++)
+        if (!TEST_true(run_thread(&t[started], names_reader_cb))) {
+            ret = 0;
+            break;
+        }
+    if (ret && !TEST_true(run_thread(&t[started++], names_writer_cb)))
+        ret = 0;
+    names_done = !ret;
+    names_reader_cb();
+    for (i = 0; i < started; i++)
+        if (!TEST_true(wait_for_thread(t[i])))
+            ret = 0;
+
+    OBJ_NAME_remove("name", names_type);
+    OBJ_NAME_remove("obj-test-alias", OBJ_NAME_TYPE_MD_METH);
+    return ret && TEST_true(names_threads_succeeded);
+}
+
+int setup_tests(void)
+{
+    ADD_TEST(test_builtin);
+    ADD_TEST(test_created);
+    ADD_TEST(test_names);
+    ADD_TEST(test_names_threads);
+    return 1;
+}
@@ -0,0 +1,26 @@
+#! /usr/bin/env perl
+# Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the OpenSSL license (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+
+use OpenSSL::Test qw/:DEFAULT srctop_file/;
+use OpenSSL::Test::Utils;
+
+setup("test_internal_asn1_dec");
+
+plan skip_all => "This test is unsupported in a shared library build on Windows"
+    if $^O eq 'MSWin32' && !disabled("shared");
+
+plan tests => 1;
+
+ok(run(test(["asn1_dec_internal_test",
+             srctop_file("test", "certs", "ee-cert.pem"),
+             srctop_file("test", "certs", "root-cert.pem"),
+             srctop_file("test", "certs", "ee-ecdsa-client-chain.pem"),
+             srctop_file("test", "certs", "ee-pss-sha256-cert.pem"),
+             srctop_file("test", "certs", "ee-ed25519.pem"),
+             srctop_file("test", "certs", "cyrillic.pem")])));
@@ -0,0 +1,24 @@
+#! /usr/bin/env perl
+# Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the OpenSSL license (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+
+use OpenSSL::Test qw/:DEFAULT srctop_file/;
+use OpenSSL::Test::Utils;
+
+setup("test_asn1_dec_bench");
+
+plan skip_all => "This test is unsupported in a shared library build on Windows"
+    if $^O eq 'MSWin32' && !disabled("shared");
+
+plan tests => 1;
+
+# Only check that every scenario works, with a few decodes.  Run
+# asn1_dec_bench directly to obtain meaningful figures.
+ok(run(test(["asn1_dec_bench", srctop_file("test", "certs", "ee-cert.pem"),
+             "100", "1"])),
+   "running asn1_dec_bench");
@@ -0,0 +1,16 @@
+#! /usr/bin/env perl
+# Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the OpenSSL license (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+
+use OpenSSL::Test;
+
+setup("test_mem_acct");
+plan tests => 2;
+ok(run(test(["mem_acct_test"])), "running memory accounting test");
+$ENV{OPENSSL_MEM_ACCOUNTING} = "10";
+ok(run(app(["openssl", "version"])), "running openssl with accounting");
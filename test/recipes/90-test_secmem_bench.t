@@ -0,0 +1,18 @@
+#! /usr/bin/env perl
+# Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the OpenSSL license (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+
+use OpenSSL::Test;
+
+setup("test_secmem_bench");
+
+plan tests => 1;
+
+# Only check that every scenario works, with a few operations on two threads.
+# Run secmem_bench directly to obtain meaningful figures.
+ok(run(test(["secmem_bench", "2000", "2"])), "running secmem_bench");
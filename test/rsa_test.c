@@ -1,5 +1,5 @@
 /*
- * Copyright 1999-2017 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1999-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -18,8 +18,10 @@
 #include <openssl/err.h>
 #include <openssl/rand.h>
 #include <openssl/bn.h>
+#include <openssl/async.h>
 
 #include "testutil.h"
+#include "threadstest.h"
 
 #ifdef OPENSSL_NO_RSA
 int setup_tests(void)
@@ -329,10 +331,198 @@ err:
     return ret;
 }
 
+/*
+ * Several threads sharing one key, each of which gets its own blinding, or
+ * which all share the one set with RSA_blinding_on() for the second run.
+ * The main thread also runs the test, so we'll have THREADS+1 in parallel.
+ */
+# define THREADS 3
+
+static RSA *shared_key = NULL;
+static unsigned char shared_ctext[256];
+static int shared_clen = 0;
+static int shared_key_succeeded = 1;
+
+static void shared_key_thread_cb(void)
+{
+    static unsigned char ptext_ex[] = "\x54\x85\x9b\x34\x2c\x49\xea\x2a";
+    unsigned char ptext[256];
+    int i, num;
+
+    for (i = 0; i < 50; i++) {
+        num = RSA_private_decrypt(shared_clen, shared_ctext, ptext,
+                                  shared_key, RSA_PKCS1_OAEP_PADDING);
+        if (num != (int)sizeof(ptext_ex) - 1
+                || memcmp(ptext, ptext_ex, num) != 0)
+            shared_key_succeeded = 0;
+    }
+}
+
+static int test_rsa_shared_key_threads(int idx)
+{
+    thread_t t[THREADS];
+    int i, started, ret = 1;
+
+    shared_clen = rsa_setkey(&shared_key, shared_ctext, 2);
+    shared_key_succeeded = 1;
+    if (idx == 1 && !TEST_true(RSA_blinding_on(shared_key, NULL))) {
+        RSA_free(shared_key);
+        shared_key = NULL;
+        return 0;
+    }
+
+    for (started = 0; started < THREADS; started++)
+        if (!TEST_true(run_thread(&t[started], shared_key_thread_cb))) {
+            ret = 0;
+            break;
+        }
+    shared_key_thread_cb();
+    for (i = 0; i < started; i++)
+        if (!TEST_true(wait_for_thread(t[i])))
+            ret = 0;
+
+    if (!TEST_true(shared_key_succeeded))
+        ret = 0;
+    RSA_free(shared_key);
+    shared_key = NULL;
+    return ret;
+}
+
+/*
+ * An ASYNC job paused between blinding and unblinding, while the same thread
+ * uses more keys than its blinding cache holds, must find its blinding
+ * intact when it resumes.
+ */
+# define EVICT_KEYS 12
+
+static int (*default_mod_exp)(BIGNUM *r0, const BIGNUM *i, RSA *rsa,
+                              BN_CTX *ctx);
+static unsigned char paused_ctext[256];
+static int paused_clen = 0;
+
+static int pausing_mod_exp(BIGNUM *r0, const BIGNUM *i, RSA *rsa, BN_CTX *ctx)
+{
+    if (ASYNC_get_current_job() != NULL && !ASYNC_pause_job())
+        return 0;
+    return default_mod_exp(r0, i, rsa, ctx);
+}
+
+static int paused_decrypt_job(void *arg)
+{
+    static unsigned char ptext_ex[] = "\x54\x85\x9b\x34\x2c\x49\xea\x2a";
+    unsigned char ptext[256];
+    RSA *key = *(RSA **)arg;
+    int num;
+
+    num = RSA_private_decrypt(paused_clen, paused_ctext, ptext, key,
+                              RSA_PKCS1_OAEP_PADDING);
+    return num == (int)sizeof(ptext_ex) - 1
+           && memcmp(ptext, ptext_ex, num) == 0;
+}
+
+static int test_rsa_blinding_paused_job(void)
+{
+    static unsigned char ptext_ex[] = "\x54\x85\x9b\x34\x2c\x49\xea\x2a";
+    RSA_METHOD *meth = NULL;
+    RSA *key = NULL, *others[EVICT_KEYS] = { NULL };
+    ASYNC_JOB *job = NULL;
+    ASYNC_WAIT_CTX *waitctx = NULL;
+    unsigned char ctext[256], ptext[256];
+    int clen, i, jobret = 0, ret = 0;
+
+    if (!ASYNC_is_capable()) {
+        TEST_info("Skipping: no ASYNC support");
+        return 1;
+    }
+
+    paused_clen = rsa_setkey(&key, paused_ctext, 2);
+    default_mod_exp = RSA_meth_get_mod_exp(RSA_PKCS1_OpenSSL());
+    if (!TEST_ptr(meth = RSA_meth_dup(RSA_PKCS1_OpenSSL()))
+            || !TEST_true(RSA_meth_set_mod_exp(meth, pausing_mod_exp))
+            || !TEST_true(RSA_set_method(key, meth))
+            || !TEST_ptr(waitctx = ASYNC_WAIT_CTX_new())
+            || !TEST_int_eq(ASYNC_start_job(&job, waitctx, &jobret,
+                                            paused_decrypt_job, &key,
+                                            sizeof(key)), ASYNC_PAUSE))
+        goto err;
+
+    for (i = 0; i < EVICT_KEYS; i++) {
+        clen = rsa_setkey(&others[i], ctext, i % 3);
+        if (!TEST_int_eq(RSA_private_decrypt(clen, ctext, ptext, others[i],
+                                             RSA_PKCS1_OAEP_PADDING),
+                         (int)sizeof(ptext_ex) - 1)
+                || !TEST_mem_eq(ptext, sizeof(ptext_ex) - 1,
+                                ptext_ex, sizeof(ptext_ex) - 1))
+            goto err;
+    }
+
+    if (!TEST_int_eq(ASYNC_start_job(&job, waitctx, &jobret,
+                                     paused_decrypt_job, &key, sizeof(key)),
+                     ASYNC_FINISH)
+            || !TEST_true(jobret))
+        goto err;
+    ret = 1;
+
+ err:
+    for (i = 0; i < EVICT_KEYS; i++)
+        RSA_free(others[i]);
+    RSA_free(key);
+    RSA_meth_free(meth);
+    ASYNC_WAIT_CTX_free(waitctx);
+    return ret;
+}
+
+/*
+ * The thread's blinding cache may be freed while an operation still uses one
+ * of its entries, as when an ASYNC job paused in that operation is resumed
+ * on another thread after the first one has stopped.  Simulate that by
+ * stopping the thread in the middle of the operation.
+ */
+static int stop_thread_succeeded = 0;
+
+static int stopping_mod_exp(BIGNUM *r0, const BIGNUM *i, RSA *rsa,
+                            BN_CTX *ctx)
+{
+    OPENSSL_thread_stop();
+    return default_mod_exp(r0, i, rsa, ctx);
+}
+
+static void stop_thread_cb(void)
+{
+    stop_thread_succeeded = paused_decrypt_job(&shared_key);
+}
+
+static int test_rsa_blinding_thread_stop(void)
+{
+    RSA_METHOD *meth = NULL;
+    thread_t t;
+    int ret = 0;
+
+    paused_clen = rsa_setkey(&shared_key, paused_ctext, 2);
+    default_mod_exp = RSA_meth_get_mod_exp(RSA_PKCS1_OpenSSL());
+    if (!TEST_ptr(meth = RSA_meth_dup(RSA_PKCS1_OpenSSL()))
+            || !TEST_true(RSA_meth_set_mod_exp(meth, stopping_mod_exp))
+            || !TEST_true(RSA_set_method(shared_key, meth))
+            || !TEST_true(run_thread(&t, stop_thread_cb))
+            || !TEST_true(wait_for_thread(t))
+            || !TEST_true(stop_thread_succeeded))
+        goto err;
+    ret = 1;
+
+ err:
+    RSA_free(shared_key);
+    shared_key = NULL;
+    RSA_meth_free(meth);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_ALL_TESTS(test_rsa_pkcs1, 3);
     ADD_ALL_TESTS(test_rsa_oaep, 3);
+    ADD_ALL_TESTS(test_rsa_shared_key_threads, 2);
+    ADD_TEST(test_rsa_blinding_paused_job);
+    ADD_TEST(test_rsa_blinding_thread_stop);
     return 1;
 }
 #endif
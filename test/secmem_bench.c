@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Secure heap stress benchmark.
+ *
+ * Usage: secmem_bench [ops [threads]]
+ *
+ * Every scenario has |threads| threads, or a single one, each allocate and
+ * free |ops| blocks of the secure heap, keeping up to SLOTS of them at a
+ * time.  Each block is filled with a pattern of its thread when allocated,
+ * which is checked before it is freed.  The small blocks are of the sizes
+ * the per-thread caches keep, the large ones are not, and the heap is made
+ * of a single arena or of one per thread.  Reported are the nanoseconds
+ * spent per allocation and free.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+# include <sys/time.h>
+#endif
+#include <openssl/crypto.h>
+#include "internal/nelem.h"
+#include "testutil.h"
+#include "testutil/output.h"
+#include "threadstest.h"
+
+#ifdef __clang__
+#pragma clang diagnostic ignored "-Wunused-function"
+#endif
+
+#define DEFAULT_OPS     200000
+#define DEFAULT_THREADS 4
+#define MAX_THREADS     16
+#define SLOTS           16
+#define ARENA_SIZE      (1024 * 1024)
+
+typedef struct {
+    const char *name;
+    size_t min_size, max_size;
+    int arena_per_thread;
+    int threaded;
+} SCENARIO;
+
+static const SCENARIO scenarios[] = {
+    {"small, 1 thread", 16, 512, 0, 0},
+    {"large, 1 thread", 1024, 4096, 0, 0},
+    {"small, 1 arena", 16, 512, 0, 1},
+    {"large, 1 arena", 1024, 4096, 0, 1},
+    {"small, arena per thread", 16, 512, 1, 1},
+    {"large, arena per thread", 1024, 4096, 1, 1},
+};
+
+static size_t num_ops = DEFAULT_OPS;
+static size_t num_threads = DEFAULT_THREADS;
+
+/* State shared with the worker threads of a scenario */
+static const SCENARIO *current;
+static CRYPTO_RWLOCK *thread_lock;
+static int next_thread;
+static int thread_failed;
+
+static double wall_time(void)
+{
+#ifdef _WIN32
+    return GetTickCount() / 1000.0;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+}
+
+static void worker(void)
+{
+    unsigned char *block[SLOTS] = { NULL };
+    size_t len[SLOTS], i, j, range;
+    unsigned int rnd;
+    unsigned char pattern;
+    int failed = 0;
+
+    CRYPTO_THREAD_write_lock(thread_lock);
+    pattern = (unsigned char)(0x5a + next_thread++);
+    CRYPTO_THREAD_unlock(thread_lock);
+
+    rnd = pattern;
+    range = current->max_size - current->min_size + 1;
+    for (i = 0; i < num_ops; i++) {
+        unsigned char *p;
+        size_t slot;
+
+        rnd = rnd * 1103515245 + 12345;
+        slot = (rnd >> 16) % SLOTS;
+        if ((p = block[slot]) != NULL) {
+            for (j = 0; j < len[slot]; j++)
+                if (p[j] != pattern)
+                    failed = 1;
+            OPENSSL_secure_clear_free(p, len[slot]);
+            block[slot] = NULL;
+            continue;
+        }
+        len[slot] = current->min_size + (rnd >> 8) % range;
+        if ((p = OPENSSL_secure_malloc(len[slot])) == NULL
+                || !CRYPTO_secure_allocated(p)) {
+            failed = 1;
+            OPENSSL_free(p);
+            continue;
+        }
+        memset(p, pattern, len[slot]);
+        block[slot] = p;
+    }
+    for (i = 0; i < SLOTS; i++)
+        OPENSSL_secure_free(block[i]);
+    if (failed) {
+        CRYPTO_THREAD_write_lock(thread_lock);
+        thread_failed = 1;
+        CRYPTO_THREAD_unlock(thread_lock);
+    }
+}
+
+static int run_scenario(int idx)
+{
+    thread_t threads[MAX_THREADS];
+    size_t i, started, threads_used;
+    double start;
+    int ret = 0;
+
+    current = &scenarios[idx];
+    threads_used = current->threaded ? num_threads : 1;
+    if (!TEST_true(CRYPTO_secure_malloc_init_ex(ARENA_SIZE, 16,
+                                                current->arena_per_thread
+                                                ? (int)threads_used : 1)))
+        return 0;
+
+    next_thread = 0;
+    thread_failed = 0;
+    start = wall_time();
+    if (current->threaded) {
+        for (started = 0; started < threads_used; started++)
+            if (!TEST_true(run_thread(&threads[started], worker)))
+                break;
+        for (i = 0; i < started; i++)
+            wait_for_thread(threads[i]);
+    } else {
+        worker();
+        started = 1;
+    }
+    if (!TEST_size_t_eq(started, threads_used) || !TEST_false(thread_failed))
+        goto end;
+    test_printf_stdout("%-28s %8.1f ns/op\n", current->name,
+                       (wall_time() - start) * 1e9 / (num_ops * threads_used));
+    ret = 1;
+
+ end:
+    /* The threads have put back what they kept, all should be free again */
+    if (!TEST_true(CRYPTO_secure_malloc_done()))
+        ret = 0;
+    test_flush_stdout();
+    return ret;
+}
+
+int setup_tests(void)
+{
+    char *arg;
+
+    if ((arg = test_get_argument(0)) != NULL) {
+        num_ops = strtoul(arg, NULL, 10);
+        if (!TEST_size_t_gt(num_ops, 0))
+            return 0;
+    }
+    if ((arg = test_get_argument(1)) != NULL) {
+        num_threads = strtoul(arg, NULL, 10);
+        if (!TEST_size_t_gt(num_threads, 0)
+                || !TEST_size_t_le(num_threads, MAX_THREADS))
+            return 0;
+    }
+    if (!TEST_ptr(thread_lock = CRYPTO_THREAD_lock_new()))
+        return 0;
+
+    ADD_ALL_TESTS(run_scenario, OSSL_NELEM(scenarios));
+    return 1;
+}
+
+void cleanup_tests(void)
+{
+    CRYPTO_THREAD_lock_free(thread_lock);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright 2015-2017 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2015-2018 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -7,9 +7,11 @@
  * https://www.openssl.org/source/license.html
  */
 
+#include <string.h>
 #include <openssl/crypto.h>
 
 #include "testutil.h"
+#include "threadstest.h"
 
 static int test_sec_mem(void)
 {
@@ -129,8 +131,141 @@ static int test_sec_mem(void)
 #endif
 }
 
+static int test_sec_mem_cache(void)
+{
+#if defined(OPENSSL_SYS_LINUX) || defined(OPENSSL_SYS_UNIX)
+    int testresult = 0;
+    unsigned char *p = NULL, *q = NULL;
+    size_t i;
+
+    if (!TEST_true(CRYPTO_secure_malloc_init(4096, 32)))
+        return 0;
+    if (!TEST_ptr(p = OPENSSL_secure_malloc(20)))
+        goto end;
+    memset(p, 0xaa, 20);
+    OPENSSL_secure_free(p);
+    /* The chunk is kept for this thread, but no longer counts as used */
+    if (!TEST_size_t_eq(CRYPTO_secure_used(), 0)
+            || !TEST_ptr_eq(q = OPENSSL_secure_malloc(30), p)
+            || !TEST_size_t_eq(CRYPTO_secure_used(), 32)
+            || !TEST_size_t_eq(CRYPTO_secure_actual_size(q), 32))
+        goto end;
+    /* It was cleansed before it was kept */
+    for (i = 0; i < 20; i++)
+        if (!TEST_uchar_eq(q[i], 0))
+            goto end;
+    OPENSSL_secure_free(q);
+    q = NULL;
+
+    /* Kept chunks are handed back when the heap runs out */
+    for (i = 0; i < 8; i++)
+        OPENSSL_secure_free(OPENSSL_secure_malloc(32 << (i % 4)));
+    if (!TEST_ptr(q = OPENSSL_secure_malloc(4096)))
+        goto end;
+    OPENSSL_secure_free(q);
+    q = NULL;
+    if (!TEST_true(CRYPTO_secure_malloc_done()))
+        goto end;
+    testresult = 1;
+ end:
+    OPENSSL_secure_free(q);
+    CRYPTO_secure_malloc_done();
+    return testresult;
+#else
+    return 1;
+#endif
+}
+
+/*
+ * The heap can't be released from another thread while this one still
+ * keeps chunks of it.
+ */
+static int done_thread_result = -1;
+
+static void done_thread_cb(void)
+{
+    done_thread_result = CRYPTO_secure_malloc_done();
+}
+
+static int test_sec_mem_cache_threads(void)
+{
+#if defined(OPENSSL_SYS_LINUX) || defined(OPENSSL_SYS_UNIX)
+    int testresult = 0;
+    unsigned char *p = NULL, *q = NULL;
+    thread_t t;
+
+    if (!TEST_true(CRYPTO_secure_malloc_init(4096, 32)))
+        return 0;
+    if (!TEST_ptr(p = OPENSSL_secure_malloc(20)))
+        goto end;
+    OPENSSL_secure_free(p);
+    if (!TEST_size_t_eq(CRYPTO_secure_used(), 0)
+            || !TEST_true(run_thread(&t, done_thread_cb))
+            || !TEST_true(wait_for_thread(t))
+            || !TEST_int_eq(done_thread_result, 0)
+            || !TEST_true(CRYPTO_secure_malloc_initialized())
+            || !TEST_ptr_eq(q = OPENSSL_secure_malloc(20), p)
+            || !TEST_true(CRYPTO_secure_allocated(q)))
+        goto end;
+    OPENSSL_secure_free(q);
+    q = NULL;
+    if (!TEST_true(CRYPTO_secure_malloc_done()))
+        goto end;
+    testresult = 1;
+ end:
+    OPENSSL_secure_free(q);
+    CRYPTO_secure_malloc_done();
+    return testresult;
+#else
+    return 1;
+#endif
+}
+
+static int test_sec_mem_arenas(void)
+{
+#if defined(OPENSSL_SYS_LINUX) || defined(OPENSSL_SYS_UNIX)
+    int testresult = 0;
+    void *p[5] = { NULL };
+    size_t i;
+
+    if (!TEST_false(CRYPTO_secure_malloc_init_ex(4096, 32, 0))
+            || !TEST_false(CRYPTO_secure_malloc_init_ex(4096, 32, 17))
+            || !TEST_true(CRYPTO_secure_malloc_init_ex(4096, 32, 4))
+            || !TEST_false(CRYPTO_secure_malloc_init_ex(4096, 32, 4)))
+        goto end;
+
+    /* Every arena holds one block of its whole size, once full all fail */
+    for (i = 0; i < 4; i++)
+        if (!TEST_ptr(p[i] = OPENSSL_secure_malloc(4096))
+                || !TEST_true(CRYPTO_secure_allocated(p[i]))
+                || !TEST_size_t_eq(CRYPTO_secure_used(), 4096 * (i + 1)))
+            goto end;
+    if (!TEST_ptr_null(p[4] = OPENSSL_secure_malloc(16))
+            || !TEST_false(CRYPTO_secure_malloc_done()))
+        goto end;
+    for (i = 0; i < 4; i++) {
+        OPENSSL_secure_clear_free(p[i], 4096);
+        p[i] = NULL;
+    }
+    if (!TEST_size_t_eq(CRYPTO_secure_used(), 0)
+            || !TEST_true(CRYPTO_secure_malloc_done()))
+        goto end;
+    testresult = 1;
+ end:
+    for (i = 0; i < 4; i++)
+        OPENSSL_secure_free(p[i]);
+    CRYPTO_secure_malloc_done();
+    return testresult;
+#else
+    return TEST_false(CRYPTO_secure_malloc_init_ex(4096, 32, 4));
+#endif
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_sec_mem);
+    ADD_TEST(test_sec_mem_cache);
+    ADD_TEST(test_sec_mem_cache_threads);
+    ADD_TEST(test_sec_mem_arenas);
     return 1;
 }
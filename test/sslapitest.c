@@ -1430,6 +1430,308 @@ static int test_stateful_tickets(int idx)
 {
     return test_tickets(1, idx);
 }
+
+/*
+ * Test that setting the ticket keys of an SSL_CTX changes its own ring when
+ * it is private, and leaves a shared ring, and the other contexts using it,
+ * alone.
+ */
+static int test_ticket_key_ring_set_keys(void)
+{
+    SSL_CTX *sctx = NULL, *sctx2 = NULL;
+    SSL_TICKET_KEY_RING *ring = NULL, *priv;
+    unsigned char keys[80], before[80], after[80];
+    int testresult = 0;
+
+    memset(keys, 0x42, sizeof(keys));
+    if (!TEST_ptr(sctx = SSL_CTX_new(TLS_server_method()))
+            || !TEST_ptr(sctx2 = SSL_CTX_new(TLS_server_method()))
+            || !TEST_ptr(priv = SSL_CTX_get0_ticket_key_ring(sctx))
+            || !TEST_true(SSL_CTX_set_tlsext_ticket_keys(sctx, keys,
+                                                         sizeof(keys)))
+            || !TEST_ptr_eq(SSL_CTX_get0_ticket_key_ring(sctx), priv)
+            || !TEST_true(SSL_CTX_get_tlsext_ticket_keys(sctx, after,
+                                                         sizeof(after)))
+            || !TEST_mem_eq(keys, sizeof(keys), after, sizeof(after)))
+        goto end;
+
+    if (!TEST_ptr(ring = SSL_TICKET_KEY_RING_new(2, 0))
+            || !TEST_true(SSL_CTX_set1_ticket_key_ring(sctx, ring))
+            || !TEST_true(SSL_CTX_set1_ticket_key_ring(sctx2, ring))
+            || !TEST_true(SSL_CTX_get_tlsext_ticket_keys(sctx2, before,
+                                                         sizeof(before))))
+        goto end;
+    keys[0] ^= 1;
+    if (!TEST_true(SSL_CTX_set_tlsext_ticket_keys(sctx, keys, sizeof(keys)))
+            || !TEST_ptr_ne(SSL_CTX_get0_ticket_key_ring(sctx), ring)
+            || !TEST_ptr_eq(SSL_CTX_get0_ticket_key_ring(sctx2), ring)
+            || !TEST_true(SSL_CTX_get_tlsext_ticket_keys(sctx, after,
+                                                         sizeof(after)))
+            || !TEST_mem_eq(keys, sizeof(keys), after, sizeof(after))
+            || !TEST_true(SSL_CTX_get_tlsext_ticket_keys(sctx2, after,
+                                                         sizeof(after)))
+            || !TEST_mem_eq(before, sizeof(before), after, sizeof(after)))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_TICKET_KEY_RING_free(ring);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(sctx2);
+
+    return testresult;
+}
+
+/*
+ * Test that a ticket issued through one SSL_CTX can be resumed through
+ * another sharing its ticket key ring, that it survives one key rotation and
+ * that it is rejected once its key has been dropped from the ring.
+ * Test 0: TLSv1.2
+ * Test 1: TLSv1.3
+ */
+static int test_ticket_key_ring(int tst)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL, *cctx2 = NULL, *sctx2 = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    SSL_SESSION *sess = NULL;
+    SSL_TICKET_KEY_RING *ring = NULL;
+    int maxver = (tst == 0) ? TLS1_2_VERSION : TLS1_3_VERSION;
+    int testresult = 0;
+    size_t i;
+    /* Whether the session is resumed after 0, 1 and 2 rotations */
+    static const int reused[] = { 1, 1, 0 };
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (tst == 0)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_TLS1_3
+    if (tst == 1)
+        return 1;
+#endif
+
+    if (!TEST_ptr(ring = SSL_TICKET_KEY_RING_new(2, 0))
+            || !TEST_true(create_ssl_ctx_pair(TLS_server_method(),
+                                              TLS_client_method(),
+                                              TLS1_VERSION, maxver,
+                                              &sctx, &cctx, cert, privkey))
+            || !TEST_true(create_ssl_ctx_pair(TLS_server_method(),
+                                              TLS_client_method(),
+                                              TLS1_VERSION, maxver,
+                                              &sctx2, &cctx2, cert, privkey))
+            || !TEST_true(SSL_CTX_set1_ticket_key_ring(sctx, ring))
+            || !TEST_true(SSL_CTX_set1_ticket_key_ring(sctx2, ring))
+            || !TEST_ptr_eq(SSL_CTX_get0_ticket_key_ring(sctx2), ring))
+        goto end;
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_ptr(sess = SSL_get1_session(clientssl)))
+        goto end;
+    shutdown_ssl_connection(serverssl, clientssl);
+    serverssl = clientssl = NULL;
+
+    for (i = 0; i < OSSL_NELEM(reused); i++) {
+        if (i > 0 && !TEST_true(SSL_TICKET_KEY_RING_rotate(ring)))
+            goto end;
+        if (!TEST_true(create_ssl_objects(sctx2, cctx, &serverssl, &clientssl,
+                                          NULL, NULL))
+                || !TEST_true(SSL_set_session(clientssl, sess))
+                || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                    SSL_ERROR_NONE))
+                || !TEST_int_eq(SSL_session_reused(clientssl), reused[i]))
+            goto end;
+        shutdown_ssl_connection(serverssl, clientssl);
+        serverssl = clientssl = NULL;
+    }
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_SESSION_free(sess);
+    SSL_TICKET_KEY_RING_free(ring);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx2);
+    SSL_CTX_free(cctx2);
+
+    return testresult;
+}
+#endif
+
+#ifndef OPENSSL_NO_RSA
+/*
+ * Private key method that performs each operation straight away with the
+ * server key, but only hands out the result once asked to complete it.
+ */
+static EVP_PKEY *pkm_key = NULL;
+static unsigned char pkm_out[1024];
+static size_t pkm_outlen;
+static int pkm_sign_called, pkm_decrypt_called, pkm_complete_called;
+
+static int pkm_sign_cb(SSL *s, unsigned char *out, size_t *outlen,
+                       size_t maxout, unsigned int sigalg,
+                       const unsigned char *in, size_t inlen, void *arg)
+{
+    EVP_MD_CTX *mctx = EVP_MD_CTX_new();
+    EVP_PKEY_CTX *pctx = NULL;
+    const EVP_MD *md;
+    int pss = 0, ret = SSL_PRIVATE_KEY_FAILURE;
+
+    pkm_sign_called++;
+    switch (sigalg) {
+    case 0:
+        md = EVP_md5_sha1();
+        break;
+    case 0x0201:
+        md = EVP_sha1();
+        break;
+    case 0x0804:
+        pss = 1;
+        /* fall through */
+    case 0x0401:
+        md = EVP_sha256();
+        break;
+    case 0x0805:
+        pss = 1;
+        /* fall through */
+    case 0x0501:
+        md = EVP_sha384();
+        break;
+    case 0x0806:
+        pss = 1;
+        /* fall through */
+    case 0x0601:
+        md = EVP_sha512();
+        break;
+    default:
+        goto end;
+    }
+
+    pkm_outlen = sizeof(pkm_out);
+    if (mctx == NULL
+            || EVP_DigestSignInit(mctx, &pctx, md, NULL, pkm_key) <= 0
+            || (pss && (EVP_PKEY_CTX_set_rsa_padding(pctx,
+                                                     RSA_PKCS1_PSS_PADDING) <= 0
+                        || EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx,
+                                            RSA_PSS_SALTLEN_DIGEST) <= 0))
+            || EVP_DigestSign(mctx, pkm_out, &pkm_outlen, in, inlen) <= 0)
+        goto end;
+    ret = SSL_PRIVATE_KEY_RETRY;
+
+ end:
+    EVP_MD_CTX_free(mctx);
+    return ret;
+}
+
+static int pkm_decrypt_cb(SSL *s, unsigned char *out, size_t *outlen,
+                          size_t maxout, const unsigned char *in, size_t inlen,
+                          void *arg)
+{
+    int len;
+
+    pkm_decrypt_called++;
+    len = RSA_private_decrypt((int)inlen, in, pkm_out,
+                              EVP_PKEY_get0_RSA(pkm_key), RSA_NO_PADDING);
+    if (len < 0)
+        return SSL_PRIVATE_KEY_FAILURE;
+    pkm_outlen = len;
+
+    return SSL_PRIVATE_KEY_RETRY;
+}
+
+static int pkm_complete_cb(SSL *s, unsigned char *out, size_t *outlen,
+                           size_t maxout, void *arg)
+{
+    pkm_complete_called++;
+    if (pkm_outlen > maxout)
+        return SSL_PRIVATE_KEY_FAILURE;
+    memcpy(out, pkm_out, pkm_outlen);
+    *outlen = pkm_outlen;
+
+    return SSL_PRIVATE_KEY_SUCCESS;
+}
+
+/*
+ * Test that the private key method can suspend the handshake and that the
+ * server works with only the public key of its certificate loaded.
+ * Test 0: TLSv1.3, CertificateVerify is signed
+ * Test 1: TLSv1.2 ECDHE, ServerKeyExchange is signed
+ * Test 2: TLSv1.2 RSA key exchange, premaster secret is decrypted
+ */
+static int test_private_key_method(int tst)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    BIO *keybio = NULL;
+    int maxver = (tst == 0) ? TLS1_3_VERSION : TLS1_2_VERSION;
+    int testresult = 0;
+
+#ifdef OPENSSL_NO_TLS1_3
+    if (tst == 0)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_TLS1_2
+    if (tst > 0)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_EC
+    if (tst == 1)
+        return 1;
+#endif
+
+    pkm_sign_called = pkm_decrypt_called = pkm_complete_called = 0;
+    if (!TEST_ptr(keybio = BIO_new_file(privkey, "r"))
+            || !TEST_ptr(pkm_key = PEM_read_bio_PrivateKey(keybio, NULL, NULL,
+                                                           NULL))
+            || !TEST_true(create_ssl_ctx_pair(TLS_server_method(),
+                                              TLS_client_method(),
+                                              TLS1_VERSION, maxver,
+                                              &sctx, &cctx, cert, privkey))
+            || !TEST_true(SSL_CTX_use_PrivateKey(sctx,
+                              X509_get0_pubkey(SSL_CTX_get0_certificate(sctx))))
+            || (tst == 1
+                && !TEST_true(SSL_CTX_set_cipher_list(cctx,
+                                             "ECDHE-RSA-AES128-GCM-SHA256")))
+            || (tst == 2
+                && !TEST_true(SSL_CTX_set_cipher_list(cctx,
+                                                      "AES128-GCM-SHA256"))))
+        goto end;
+    SSL_CTX_set_private_key_method(sctx, pkm_sign_cb, pkm_decrypt_cb,
+                                   pkm_complete_cb, NULL);
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_false(create_ssl_connection(serverssl, clientssl,
+                               SSL_ERROR_WANT_PRIVATE_KEY_OPERATION))
+            || !TEST_int_eq(SSL_get_error(serverssl, -1),
+                            SSL_ERROR_WANT_PRIVATE_KEY_OPERATION)
+            || !TEST_true(SSL_want_private_key_operation(serverssl))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_int_eq(pkm_sign_called, tst == 2 ? 0 : 1)
+            || !TEST_int_eq(pkm_decrypt_called, tst == 2 ? 1 : 0)
+            || !TEST_int_eq(pkm_complete_called, 1))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    EVP_PKEY_free(pkm_key);
+    pkm_key = NULL;
+    BIO_free(keybio);
+
+    return testresult;
+}
 #endif
 
 #define USE_NULL            0
@@ -4918,6 +5220,177 @@ static int test_ssl_pending(int tst)
     return testresult;
 }
 
+/*
+ * A filter that makes every other write fail with a retry, and writes at
+ * most SHORT_WRITE_MAX bytes otherwise.
+ */
+#define BIO_TYPE_SHORT_WRITE_FILTER (0x82 | BIO_TYPE_FILTER)
+#define SHORT_WRITE_MAX             1000
+
+static BIO_METHOD *meth_short_write = NULL;
+static int short_write_blocked = 0;
+
+static int short_write_new(BIO *bio)
+{
+    BIO_set_init(bio, 1);
+    return 1;
+}
+
+static int short_write_write(BIO *bio, const char *in, int inl)
+{
+    BIO_clear_retry_flags(bio);
+    short_write_blocked = !short_write_blocked;
+    if (short_write_blocked) {
+        BIO_set_retry_write(bio);
+        return -1;
+    }
+    return BIO_write(BIO_next(bio), in,
+                     inl < SHORT_WRITE_MAX ? inl : SHORT_WRITE_MAX);
+}
+
+static long short_write_ctrl(BIO *bio, int cmd, long num, void *ptr)
+{
+    if (BIO_next(bio) == NULL)
+        return 0;
+    return BIO_ctrl(BIO_next(bio), cmd, num, ptr);
+}
+
+static const BIO_METHOD *bio_f_short_write(void)
+{
+    if (meth_short_write == NULL) {
+        if (!TEST_ptr(meth_short_write
+                          = BIO_meth_new(BIO_TYPE_SHORT_WRITE_FILTER,
+                                         "Short write filter"))
+                || !TEST_true(BIO_meth_set_write(meth_short_write,
+                                                 short_write_write))
+                || !TEST_true(BIO_meth_set_ctrl(meth_short_write,
+                                                short_write_ctrl))
+                || !TEST_true(BIO_meth_set_create(meth_short_write,
+                                                  short_write_new)))
+            return NULL;
+    }
+    return meth_short_write;
+}
+
+/* Write all of |msg|, retrying the same write for as long as asked to */
+static int write_with_retries(SSL *ssl, const unsigned char *msg, size_t len)
+{
+    size_t written;
+    int i;
+
+    for (i = 0; i < 10000; i++) {
+        if (SSL_write_ex(ssl, msg, len, &written))
+            return TEST_size_t_eq(written, len);
+        if (!TEST_int_eq(SSL_get_error(ssl, 0), SSL_ERROR_WANT_WRITE))
+            return 0;
+    }
+    return 0;
+}
+
+/*
+ * Test that data written with SSL_MODE_BATCH_WRITES arrives intact.
+ * Test 0: TLSv1.3
+ * Test 1: TLSv1.2 with an AEAD ciphersuite
+ * Test 2: TLSv1.2 with a CBC ciphersuite
+ * Test 3: TLSv1.0 with a CBC ciphersuite, which sends empty fragments
+ * Test 4: TLSv1.2 with a CBC ciphersuite over a BIO that writes little at a
+ *         time, followed by a write of fewer records
+ */
+static int test_batch_writes(int tst)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    BIO *wbio, *filter;
+    int testresult = 0;
+    unsigned char *msg = NULL, *buf = NULL;
+    size_t msglen = 5 * SSL3_RT_MAX_PLAIN_LENGTH + 100;
+    size_t shortlen = 3 * SHORT_WRITE_MAX, explen = msglen;
+    size_t readbytes, total, i;
+
+#ifdef OPENSSL_NO_TLS1_3
+    if (tst == 0)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_TLS1_2
+    if (tst == 1 || tst == 2 || tst == 4)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_TLS1
+    if (tst == 3)
+        return 1;
+#endif
+
+    if (tst == 4)
+        explen += shortlen;
+    if (!TEST_ptr(msg = OPENSSL_malloc(msglen))
+            || !TEST_ptr(buf = OPENSSL_malloc(explen)))
+        goto end;
+    for (i = 0; i < msglen; i++)
+        msg[i] = (unsigned char)i;
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(),
+                                       TLS_client_method(),
+                                       TLS1_VERSION,
+                                       tst == 0 ? TLS_MAX_VERSION
+                                       : tst == 3 ? TLS1_VERSION
+                                                  : TLS1_2_VERSION,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    if ((tst == 1
+                && !TEST_true(SSL_CTX_set_cipher_list(cctx,
+                                                      "AES128-GCM-SHA256")))
+            || (tst >= 2
+                && !TEST_true(SSL_CTX_set_cipher_list(cctx, "AES128-SHA"))))
+        goto end;
+
+    SSL_CTX_set_mode(cctx, SSL_MODE_BATCH_WRITES);
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    if (tst == 4) {
+        wbio = SSL_get_wbio(clientssl);
+        if (!TEST_ptr(bio_f_short_write())
+                || !TEST_ptr(filter = BIO_new(bio_f_short_write()))
+                || !TEST_true(BIO_up_ref(wbio)))
+            goto end;
+        BIO_push(filter, wbio);
+        SSL_set0_wbio(clientssl, filter);
+    }
+
+    if (!TEST_true(write_with_retries(clientssl, msg, msglen))
+            || (tst == 4
+                && !TEST_true(write_with_retries(clientssl, msg, shortlen))))
+        goto end;
+
+    for (total = 0; total < explen; total += readbytes) {
+        if (!TEST_true(SSL_read_ex(serverssl, buf + total, explen - total,
+                                   &readbytes)))
+            goto end;
+    }
+
+    if (!TEST_mem_eq(buf, msglen, msg, msglen)
+            || !TEST_mem_eq(buf + msglen, explen - msglen, msg,
+                            explen - msglen))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    OPENSSL_free(msg);
+    OPENSSL_free(buf);
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
 static struct {
     unsigned int maxprot;
     const char *clntciphers;
@@ -5427,6 +5900,11 @@ int setup_tests(void)
 #ifndef OPENSSL_NO_TLS1_3
     ADD_ALL_TESTS(test_stateful_tickets, 3);
     ADD_ALL_TESTS(test_stateless_tickets, 3);
+    ADD_ALL_TESTS(test_ticket_key_ring, 2);
+    ADD_TEST(test_ticket_key_ring_set_keys);
+#endif
+#ifndef OPENSSL_NO_RSA
+    ADD_ALL_TESTS(test_private_key_method, 3);
 #endif
     ADD_ALL_TESTS(test_ssl_set_bio, TOTAL_SSL_SET_BIO_TESTS);
     ADD_TEST(test_ssl_bio_pop_next_bio);
@@ -5487,6 +5965,7 @@ int setup_tests(void)
 #endif
     ADD_ALL_TESTS(test_info_callback, 6);
     ADD_ALL_TESTS(test_ssl_pending, 2);
+    ADD_ALL_TESTS(test_batch_writes, 5);
     ADD_ALL_TESTS(test_ssl_get_shared_ciphers, OSSL_NELEM(shared_ciphers_data));
     ADD_ALL_TESTS(test_ticket_callbacks, 12);
     ADD_ALL_TESTS(test_shutdown, 6);
@@ -5496,4 +5975,5 @@ int setup_tests(void)
 void cleanup_tests(void)
 {
     bio_s_mempacket_test_free();
+    BIO_meth_free(meth_short_write);
 }
@@ -334,6 +334,110 @@ end:
     return testresult;
 }
 
+/*
+ * Searching after every few pushes to a sorted stack puts the new values in
+ * place without sorting everything again, in batches of each of these sizes.
+ */
+static const int sorted_batches[] = { 1, 3, 8, 9, 50, 400 };
+
+static int test_sorted_push_find(int idx)
+{
+    static int v[1000];
+    const int n = OSSL_NELEM(v), batch = sorted_batches[idx];
+    STACK_OF(sint) *s = sk_sint_new(&int_compare);
+    unsigned int seed = 1;
+    int i, j, *p, testresult = 0;
+
+    if (!TEST_ptr(s))
+        goto end;
+    for (i = 0; i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        v[i] = (int)(seed >> 16) % 500;
+    }
+
+    for (i = 0; i < n; i += batch) {
+        for (j = i; j < i + batch && j < n; j++)
+            sk_sint_push(s, v + j);
+        if (!TEST_false(sk_sint_is_sorted(s)))
+            goto end;
+        for (j = i; j < i + batch && j < n; j++)
+            if (!TEST_ptr(p = sk_sint_value(s, sk_sint_find(s, v + j)))
+                    || !TEST_int_eq(*p, v[j])) {
+                TEST_info("sorted find %d after %d", j, i);
+                goto end;
+            }
+        if (!TEST_true(sk_sint_is_sorted(s)))
+            goto end;
+        for (j = 1; j < sk_sint_num(s); j++)
+            if (!TEST_int_le(*sk_sint_value(s, j - 1), *sk_sint_value(s, j))) {
+                TEST_info("sorted order %d after %d", j, i);
+                goto end;
+            }
+    }
+    if (!TEST_int_eq(sk_sint_num(s), n))
+        goto end;
+
+    /* Appending in order keeps the stack sorted, anything else doesn't */
+    sk_sint_push(s, v + n - 1);
+    sk_sint_delete(s, 0);
+    sk_sint_insert(s, v, 10);
+    sk_sint_set(s, n - 2, v + 1);
+    for (j = 0; j < n; j++)
+        if (!TEST_int_eq(*sk_sint_value(s, sk_sint_find(s, v + j)), v[j]))
+            goto end;
+    for (j = 1; j < sk_sint_num(s); j++)
+        if (!TEST_int_le(*sk_sint_value(s, j - 1), *sk_sint_value(s, j)))
+            goto end;
+
+    testresult = 1;
+end:
+    sk_sint_free(s);
+    return testresult;
+}
+
+/* Stacks start out with room for a few values, and move on when full */
+static int test_small_stack(void)
+{
+    static int v[] = { 5, 4, 3, 2, 1, 0 };
+    const int n = OSSL_NELEM(v);
+    STACK_OF(sint) *s = sk_sint_new_null(), *r = NULL, *t = NULL;
+    int i, testresult = 0;
+
+    if (!TEST_ptr(s))
+        goto end;
+    for (i = 0; i < 3; i++)
+        sk_sint_push(s, v + i);
+    if (!TEST_ptr(r = sk_sint_dup(s)))
+        goto end;
+    for (i = 3; i < n; i++) {
+        sk_sint_push(s, v + i);
+        sk_sint_unshift(r, v + i);
+    }
+    if (!TEST_ptr(t = sk_sint_dup(s)))
+        goto end;
+    sk_sint_set(t, 0, v + 5);
+    for (i = 0; i < n; i++)
+        if (!TEST_ptr_eq(sk_sint_value(s, i), v + i)
+                || !TEST_ptr_eq(sk_sint_value(r, i),
+                                v + (i < 3 ? n - 1 - i : i - 3))
+                || !TEST_ptr_eq(sk_sint_value(t, i), v + (i == 0 ? 5 : i))) {
+            TEST_info("small stack value %d", i);
+            goto end;
+        }
+    sk_sint_set_cmp_func(r, &int_compare);
+    sk_sint_sort(r);
+    for (i = 0; i < n; i++)
+        if (!TEST_ptr_eq(sk_sint_value(r, i), v + n - 1 - i))
+            goto end;
+
+    testresult = 1;
+end:
+    sk_sint_free(s);
+    sk_sint_free(r);
+    sk_sint_free(t);
+    return testresult;
+}
+
 static int test_SU_stack(void)
 {
     STACK_OF(SU) *s = sk_SU_new_null();
@@ -376,5 +480,7 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_uchar_stack, 4);
     ADD_TEST(test_SS_stack);
     ADD_TEST(test_SU_stack);
+    ADD_ALL_TESTS(test_sorted_push_find, OSSL_NELEM(sorted_batches));
+    ADD_TEST(test_small_stack);
     return 1;
 }
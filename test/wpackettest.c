@@ -164,11 +164,15 @@ static int test_WPACKET_set_max_size(void)
     return 1;
 }
 
+/* Deeper than WPACKET_SUBPOOL_SIZE */
+#define DEEP_NESTING    12
+
 static int test_WPACKET_start_sub_packet(void)
 {
     WPACKET pkt;
     size_t written;
     size_t len;
+    int i;
 
     if (!TEST_true(WPACKET_init(&pkt, buf))
             || !TEST_true(WPACKET_start_sub_packet(&pkt))
@@ -242,6 +246,34 @@ static int test_WPACKET_start_sub_packet(void)
             || !TEST_true(WPACKET_finish(&pkt)))
         return cleanup(&pkt);
 
+    /* Sub-packets nested deeper than those kept in the WPACKET itself */
+    if (!TEST_true(WPACKET_init(&pkt, buf)))
+        return cleanup(&pkt);
+    for (i = 0; i < DEEP_NESTING; i++)
+        if (!TEST_true(WPACKET_start_sub_packet_u8(&pkt))
+                || !TEST_true(WPACKET_put_bytes_u8(&pkt, 0xff)))
+            return cleanup(&pkt);
+    for (i = 0; i < DEEP_NESTING; i++)
+        if (!TEST_true(WPACKET_close(&pkt)))
+            return cleanup(&pkt);
+    if (!TEST_true(WPACKET_finish(&pkt))
+            || !TEST_true(WPACKET_get_total_written(&pkt, &written))
+            || !TEST_size_t_eq(written, 2 * DEEP_NESTING))
+        return cleanup(&pkt);
+    for (i = 0; i < DEEP_NESTING; i++)
+        if (!TEST_int_eq((unsigned char)buf->data[2 * i],
+                         2 * (DEEP_NESTING - i) - 1)
+                || !TEST_int_eq((unsigned char)buf->data[2 * i + 1], 0xff))
+            return 0;
+
+    /* Cleaning up frees them wherever they are */
+    if (!TEST_true(WPACKET_init(&pkt, buf)))
+        return cleanup(&pkt);
+    for (i = 0; i < DEEP_NESTING; i++)
+        if (!TEST_true(WPACKET_start_sub_packet_u8(&pkt)))
+            return cleanup(&pkt);
+    WPACKET_cleanup(&pkt);
+
     return 1;
 }
 
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2018 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/asn1.h>
+#include <openssl/asn1t.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+#include "testutil.h"
+#include "threadstest.h"
+
+static const char *ee_f, *ca_f, *root_f;
+
+/* Read a PEM certificate and decode its DER again with ASN1_D2I_LAZY */
+static X509 *load_cert(const char *file, int lazy)
+{
+    BIO *bio = NULL;
+    X509 *x = NULL, *ret = NULL;
+    unsigned char *der = NULL;
+    const unsigned char *p;
+    int len;
+
+    if (!TEST_ptr(bio = BIO_new_file(file, "r"))
+            || !TEST_ptr(x = PEM_read_bio_X509(bio, NULL, NULL, NULL))
+            || !TEST_int_gt(len = i2d_X509(x, &der), 0))
+        goto err;
+    p = der;
+    ret = (X509 *)ASN1_item_d2i_flags(NULL, &p, len, ASN1_ITEM_rptr(X509),
+                                      lazy ? ASN1_D2I_LAZY : 0);
+    if (!TEST_ptr(ret) || !TEST_ptr_eq(p, der + len)) {
+        X509_free(ret);
+        ret = NULL;
+    }
+
+ err:
+    OPENSSL_free(der);
+    X509_free(x);
+    BIO_free(bio);
+    return ret;
+}
+
+static int test_lazy_same(int n)
+{
+    const char *files[] = { ee_f, ca_f, root_f };
+    X509 *eager = NULL, *lazy = NULL;
+    unsigned char *der1 = NULL, *der2 = NULL;
+    int len1, len2, ret = 0;
+
+    if (!TEST_ptr(eager = load_cert(files[n], 0))
+            || !TEST_ptr(lazy = load_cert(files[n], 1)))
+        goto err;
+
+    /* Nothing is lost in the encoding */
+    len1 = i2d_X509(eager, &der1);
+    len2 = i2d_X509(lazy, &der2);
+    if (!TEST_mem_eq(der1, len1, der2, len2))
+        goto err;
+
+    /* The deferred parts are the same once decoded */
+    if (!TEST_ulong_eq(X509_NAME_hash(X509_get_subject_name(lazy)),
+                       X509_NAME_hash(X509_get_subject_name(eager)))
+            || !TEST_int_eq(X509_NAME_cmp(X509_get_issuer_name(lazy),
+                                          X509_get_issuer_name(eager)), 0)
+            || !TEST_int_eq(X509_subject_name_cmp(lazy, eager), 0)
+            || !TEST_ptr(X509_get0_pubkey(lazy))
+            || !TEST_ptr_eq(X509_get0_pubkey(lazy), X509_get0_pubkey(lazy))
+            || !TEST_int_eq(EVP_PKEY_cmp(X509_get0_pubkey(lazy),
+                                         X509_get0_pubkey(eager)), 1))
+        goto err;
+    ret = 1;
+
+ err:
+    OPENSSL_free(der1);
+    OPENSSL_free(der2);
+    X509_free(eager);
+    X509_free(lazy);
+    return ret;
+}
+
+static int test_lazy_verify(void)
+{
+    X509 *ee = NULL, *ca = NULL, *root = NULL;
+    X509_STORE *store = NULL;
+    X509_STORE_CTX *ctx = NULL;
+    STACK_OF(X509) *untrusted = NULL;
+    int ret = 0;
+
+    if (!TEST_ptr(ee = load_cert(ee_f, 1))
+            || !TEST_ptr(ca = load_cert(ca_f, 1))
+            || !TEST_ptr(root = load_cert(root_f, 1))
+            || !TEST_ptr(untrusted = sk_X509_new_null())
+            || !TEST_true(sk_X509_push(untrusted, ca)))
+        goto err;
+    ca = NULL;
+    if (!TEST_ptr(store = X509_STORE_new())
+            || !TEST_true(X509_STORE_add_cert(store, root))
+            || !TEST_ptr(ctx = X509_STORE_CTX_new())
+            || !TEST_true(X509_STORE_CTX_init(ctx, store, ee, untrusted))
+            || !TEST_int_eq(X509_verify_cert(ctx), 1))
+        goto err;
+    ret = 1;
+
+ err:
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    sk_X509_pop_free(untrusted, X509_free);
+    X509_free(ee);
+    X509_free(ca);
+    X509_free(root);
+    return ret;
+}
+
+/* CN=<UTF8String 0xff>, which has no canonical encoding */
+static const unsigned char bad_name[] = {
+    0x30, 0x0c, 0x31, 0x0a, 0x30, 0x08, 0x06, 0x03, 0x55, 0x04, 0x03,
+    0x0c, 0x01, 0xff
+};
+
+static int test_lazy_bad_name(void)
+{
+    X509_NAME *nm = NULL;
+    ASN1_VALUE *val = NULL;
+    ASN1_TLC tlc;
+    const unsigned char *p = bad_name;
+    int ret = 0;
+
+    if (!TEST_ptr_null(d2i_X509_NAME(NULL, &p, sizeof(bad_name))))
+        goto err;
+    p = bad_name;
+    if (!TEST_ptr(nm = (X509_NAME *)ASN1_item_d2i_flags(NULL, &p,
+                                                        sizeof(bad_name),
+                                                        ASN1_ITEM_rptr(X509_NAME),
+                                                        ASN1_D2I_LAZY))
+            || !TEST_ulong_eq(X509_NAME_hash(nm), 0)
+            || !TEST_int_eq(X509_NAME_cmp(nm, nm), -2))
+        goto err;
+
+    /* A caller's own ASN1_TLC never asks for laziness */
+    p = bad_name;
+    memset(&tlc, 0, sizeof(tlc));
+    if (!TEST_int_le(ASN1_item_ex_d2i(&val, &p, sizeof(bad_name),
+                                      ASN1_ITEM_rptr(X509_NAME), -1, 0, 0,
+                                      &tlc), 0)
+            || !TEST_ptr_null(val))
+        goto err;
+    ret = 1;
+
+ err:
+    X509_NAME_free(nm);
+    return ret;
+}
+
+/*
+ * Several threads filling in the deferred parts of one certificate at once
+ * must all end up with the same ones.
+ */
+#define THREADS 4
+
+static X509 *shared_cert;
+static EVP_PKEY *thread_pkey[THREADS];
+static unsigned long thread_hash[THREADS];
+static CRYPTO_RWLOCK *thread_lock;
+static int next_thread;
+
+static void lazy_thread_cb(void)
+{
+    int n;
+
+    CRYPTO_THREAD_write_lock(thread_lock);
+    n = next_thread++;
+    CRYPTO_THREAD_unlock(thread_lock);
+    thread_hash[n] = X509_NAME_hash(X509_get_subject_name(shared_cert));
+    thread_pkey[n] = X509_get0_pubkey(shared_cert);
+}
+
+static int test_lazy_threads(void)
+{
+    X509 *eager = NULL;
+    thread_t t[THREADS - 1];
+    int i, started, ret = 0;
+
+    next_thread = 0;
+    if (!TEST_ptr(eager = load_cert(ee_f, 0))
+            || !TEST_ptr(shared_cert = load_cert(ee_f, 1))
+            || !TEST_ptr(thread_lock = CRYPTO_THREAD_lock_new()))
+        goto err;
+    for (started = 0; started < THREADS - 1; started++)
+        if (!TEST_true(run_thread(&t[started], lazy_thread_cb)))
+            break;
+    lazy_thread_cb();
+    for (i = 0; i < started; i++)
+        wait_for_thread(t[i]);
+    if (!TEST_int_eq(started, THREADS - 1))
+        goto err;
+
+    for (i = 0; i < THREADS; i++)
+        if (!TEST_ulong_eq(thread_hash[i],
+                           X509_NAME_hash(X509_get_subject_name(eager)))
+                || !TEST_ptr_eq(thread_pkey[i], X509_get0_pubkey(shared_cert)))
+            goto err;
+    if (!TEST_int_eq(EVP_PKEY_cmp(X509_get0_pubkey(shared_cert),
+                                  X509_get0_pubkey(eager)), 1))
+        goto err;
+    ret = 1;
+
+ err:
+    CRYPTO_THREAD_lock_free(thread_lock);
+    thread_lock = NULL;
+    X509_free(shared_cert);
+    shared_cert = NULL;
+    X509_free(eager);
+    return ret;
+}
+
+int setup_tests(void)
+{
+    if (!TEST_ptr(ee_f = test_get_argument(0))
+            || !TEST_ptr(ca_f = test_get_argument(1))
+            || !TEST_ptr(root_f = test_get_argument(2))) {
+        TEST_note("usage: x509_lazy_test ee-cert.pem ca-cert.pem root-cert.pem");
+        return 0;
+    }
+
+    ADD_ALL_TESTS(test_lazy_same, 3);
+    ADD_TEST(test_lazy_verify);
+    ADD_TEST(test_lazy_bad_name);
+    ADD_TEST(test_lazy_threads);
+    return 1;
+}